@@ -2,6 +2,7 @@
 #include "aare/CalculateEta.hpp"
 #include "aare/ClusterFile.hpp"
 #include <benchmark/benchmark.h>
+#include <random>
 
 using namespace aare;
 
@@ -101,4 +102,135 @@ BENCHMARK_F(ClusterFixture, Calculate2x2Etawithoutreduction)
     }
 }
 
+class ClusterVectorFixture : public benchmark::Fixture {
+  public:
+    ClusterVector<Cluster<int, 3, 3>> clusters_3x3;
+    ClusterVector<Cluster<float, 3, 3>> clusters_3x3_float;
+    ClusterVector<Cluster<int, 2, 2>> clusters_2x2;
+
+    static constexpr int64_t n_clusters = 100000;
+
+  private:
+    using benchmark::Fixture::SetUp;
+    using benchmark::Fixture::TearDown;
+
+    void SetUp([[maybe_unused]] const benchmark::State &state) override {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> dist(0, 1000);
+        for (int64_t i = 0; i < n_clusters; ++i) {
+            Cluster<int, 3, 3> c3{};
+            Cluster<float, 3, 3> c3f{};
+            Cluster<int, 2, 2> c2{};
+            for (size_t k = 0; k < c3.data.size(); ++k) {
+                c3.data[k] = dist(gen);
+                c3f.data[k] = static_cast<float>(c3.data[k]) * 0.1F;
+            }
+            for (auto &v : c2.data) {
+                v = dist(gen);
+            }
+            clusters_3x3.push_back(c3);
+            clusters_3x3_float.push_back(c3f);
+            clusters_2x2.push_back(c2);
+        }
+    }
+
+    void TearDown([[maybe_unused]] const benchmark::State &state) override {
+        clusters_3x3.resize(0);
+        clusters_3x3_float.resize(0);
+        clusters_2x2.resize(0);
+    }
+};
+
+// one cluster at a time, results as a vector of Eta2
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3EtaVector)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta2(clusters_3x3);
+        benchmark::DoNotOptimize(eta.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+// tiles of clusters, results as separate arrays
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3EtaBatch)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta2_batch(clusters_3x3);
+        benchmark::DoNotOptimize(eta.x.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3FloatEtaVector)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta2(clusters_3x3_float);
+        benchmark::DoNotOptimize(eta.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3FloatEtaBatch)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta2_batch(clusters_3x3_float);
+        benchmark::DoNotOptimize(eta.x.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3FullEtaVector)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_full_eta2(clusters_3x3);
+        benchmark::DoNotOptimize(eta.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3FullEtaBatch)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_full_eta2_batch(clusters_3x3);
+        benchmark::DoNotOptimize(eta.x.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate2x2EtaVector)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta2(clusters_2x2);
+        benchmark::DoNotOptimize(eta.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate2x2EtaBatch)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta2_batch(clusters_2x2);
+        benchmark::DoNotOptimize(eta.x.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3Eta3Vector)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta3(clusters_3x3);
+        benchmark::DoNotOptimize(eta.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
+BENCHMARK_F(ClusterVectorFixture, Calculate3x3Eta3Batch)
+(benchmark::State &st) {
+    for (auto _ : st) {
+        auto eta = calculate_eta3_batch(clusters_3x3);
+        benchmark::DoNotOptimize(eta.x.data());
+    }
+    st.SetItemsProcessed(st.iterations() * n_clusters);
+}
+
 // BENCHMARK_MAIN();
\ No newline at end of file
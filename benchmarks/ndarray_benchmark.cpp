@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: MPL-2.0
 #include "aare/NDArray.hpp"
+#include "aare/Pedestal.hpp"
 #include <benchmark/benchmark.h>
 
 using aare::NDArray;
@@ -130,4 +131,76 @@ BENCHMARK_F(TwoArrays, MultiplyAddDivideWithIndex)(benchmark::State &st) {
     }
 }
 
+// Frame stack of a 1 MPixel detector, state.range(0) is the number of
+// evaluation threads
+class FrameStack : public benchmark::Fixture {
+  public:
+    NDArray<uint16_t, 3> frames{{16, 1024, 1024}, 0};
+    NDArray<double, 2> accumulator{{1024, 1024}, 0.0};
+    NDArray<double, 2> image{{1024, 1024}, 1.0};
+    void SetUp(::benchmark::State &state) {
+        for (ssize_t i = 0; i < frames.size(); i++)
+            frames[i] = static_cast<uint16_t>((i * 7919) % 4096);
+        aare::set_eval_threads(static_cast<size_t>(state.range(0)));
+    }
+    void TearDown(::benchmark::State &) { aare::set_eval_threads(1); }
+};
+
+BENCHMARK_DEFINE_F(FrameStack, Accumulate)(benchmark::State &st) {
+    for (auto _ : st) {
+        accumulator += image;
+        benchmark::DoNotOptimize(accumulator.data());
+    }
+}
+BENCHMARK_REGISTER_F(FrameStack, Accumulate)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+BENCHMARK_DEFINE_F(FrameStack, SumAxis0)(benchmark::State &st) {
+    for (auto _ : st) {
+        auto sum = aare::sum(frames, 0);
+        benchmark::DoNotOptimize(sum.data());
+    }
+}
+BENCHMARK_REGISTER_F(FrameStack, SumAxis0)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+BENCHMARK_DEFINE_F(FrameStack, StddevAxis0)(benchmark::State &st) {
+    for (auto _ : st) {
+        auto sd = aare::stddev(frames, 0);
+        benchmark::DoNotOptimize(sd.data());
+    }
+}
+BENCHMARK_REGISTER_F(FrameStack, StddevAxis0)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+BENCHMARK_DEFINE_F(FrameStack, FusedMeanOfDifference)(benchmark::State &st) {
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(aare::mean(accumulator - image));
+    }
+}
+BENCHMARK_REGISTER_F(FrameStack, FusedMeanOfDifference)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+
+// Per frame pedestal update of a 400x400 detector: push_no_update followed
+// by update_mean, which can be evaluated on the pool. state.range(0) is the
+// number of evaluation threads, 1 is the default serial evaluation and 0
+// uses all cores. With several benchmark threads the updates run
+// concurrently like the workers of ClusterFinderMT would.
+static void PedestalUpdate400(benchmark::State &st) {
+    if (st.thread_index() == 0)
+        aare::set_eval_threads(static_cast<size_t>(st.range(0)));
+    aare::Pedestal<double> pedestal(400, 400);
+    NDArray<uint16_t, 2> frame({400, 400}, 0);
+    for (ssize_t i = 0; i < frame.size(); i++)
+        frame[i] = static_cast<uint16_t>((i * 7919) % 4096);
+    for (auto _ : st) {
+        pedestal.push_no_update(frame.view());
+        pedestal.update_mean();
+        benchmark::DoNotOptimize(pedestal.view().data());
+    }
+    if (st.thread_index() == 0)
+        aare::set_eval_threads(1);
+}
+BENCHMARK(PedestalUpdate400)->Arg(1)->Arg(0)->ThreadRange(1, 4)->UseRealTime();
+
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,378 @@
+// SPDX-License-Identifier: MPL-2.0
+//
+// Throughput of the processing pipeline, component by component and end to
+// end, on deterministic synthetic data (see synthetic_data.hpp). Rates are
+// reported as frames/s, clusters/s and bytes_per_second (MB/s of raw
+// frame data).
+
+#include "aare/CalculateEta.hpp"
+#include "aare/ClusterFile.hpp"
+#include "aare/ClusterFinder.hpp"
+#include "aare/ClusterFinderMT.hpp"
+#include "aare/EtaCubeBuilder.hpp"
+#include "aare/Interpolator.hpp"
+#include "aare/Pedestal.hpp"
+#include "aare/RawFile.hpp"
+#include "aare/RawSubFile.hpp"
+#include "aare/calibration.hpp"
+#include "aare/hist/PedestalTrackingPixelHistogram.hpp"
+#include "aare/hist/PixelHistogram.hpp"
+
+#include "synthetic_data.hpp"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+using namespace aare;
+using namespace aare::bench;
+
+namespace {
+
+using ClusterType = Cluster<int32_t, 3, 3>;
+
+constexpr ssize_t N_FRAMES = 50;
+constexpr ssize_t N_PEDESTAL_FRAMES = 100;
+// default number of samples of Pedestal, the cluster finder assumes the
+// pedestal is filled before it starts to track it
+constexpr ssize_t N_PEDESTAL_SAMPLES = 1000;
+constexpr double PHOTONS_PER_FRAME = 200.0;
+
+NDView<uint16_t, 2> frame_view(const NDArray<uint16_t, 3> &frames,
+                               ssize_t i) {
+    return NDView<uint16_t, 2>(const_cast<uint16_t *>(&frames(i, 0, 0)),
+                               {frames.shape(1), frames.shape(2)});
+}
+
+void set_frame_rates(benchmark::State &state, const NDArray<uint16_t, 3> &f,
+                     int64_t frames_per_iteration) {
+    const int64_t frames = state.iterations() * frames_per_iteration;
+    state.counters["frames/s"] =
+        benchmark::Counter(static_cast<double>(frames),
+                           benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(frames * f.shape(1) * f.shape(2) *
+                            static_cast<int64_t>(sizeof(uint16_t)));
+}
+
+void set_cluster_rate(benchmark::State &state, size_t clusters) {
+    state.counters["clusters/s"] = benchmark::Counter(
+        static_cast<double>(clusters), benchmark::Counter::kIsRate);
+}
+
+// cycles through the dark frames until the pedestal is filled
+template <typename Finder>
+void push_pedestal(Finder &finder, ssize_t rows, ssize_t cols) {
+    const auto &dark = cached_frames(N_PEDESTAL_FRAMES, rows, cols, 0.0);
+    for (ssize_t i = 0; i < N_PEDESTAL_SAMPLES; ++i)
+        finder.push_pedestal_frame(frame_view(dark, i % dark.shape(0)));
+}
+
+// ── Components ──────────────────────────────────────────────────────────
+
+void BM_Pedestal(benchmark::State &state) {
+    const ssize_t rows = state.range(0), cols = state.range(1);
+    const auto &frames = cached_frames(N_PEDESTAL_FRAMES, rows, cols, 0.0);
+    Pedestal<double> pedestal(static_cast<uint32_t>(rows),
+                              static_cast<uint32_t>(cols));
+    for (auto _ : state) {
+        for (ssize_t i = 0; i < frames.shape(0); ++i)
+            pedestal.push(frame_view(frames, i));
+        benchmark::ClobberMemory();
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+}
+BENCHMARK(BM_Pedestal)
+    ->Args({MOENCH_ROWS, MOENCH_COLS})
+    ->Args({JUNGFRAU_ROWS, JUNGFRAU_COLS})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ClusterFinder(benchmark::State &state) {
+    const ssize_t rows = state.range(0), cols = state.range(1);
+    const auto &frames = cached_frames(N_FRAMES, rows, cols, PHOTONS_PER_FRAME);
+    ClusterFinder<ClusterType, uint16_t, double> finder({rows, cols}, 5.0);
+    push_pedestal(finder, rows, cols);
+
+    size_t n_clusters = 0;
+    for (auto _ : state) {
+        for (ssize_t i = 0; i < frames.shape(0); ++i) {
+            finder.find_clusters(frame_view(frames, i), i);
+            n_clusters += finder.steal_clusters().size();
+        }
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+    set_cluster_rate(state, n_clusters);
+}
+BENCHMARK(BM_ClusterFinder)
+    ->Args({MOENCH_ROWS, MOENCH_COLS})
+    ->Args({JUNGFRAU_ROWS, JUNGFRAU_COLS})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ClusterFinderMT(benchmark::State &state) {
+    const ssize_t rows = JUNGFRAU_ROWS, cols = JUNGFRAU_COLS;
+    const auto n_threads = static_cast<size_t>(state.range(0));
+    const auto &frames = cached_frames(N_FRAMES, rows, cols, PHOTONS_PER_FRAME);
+    ClusterFinderMT<ClusterType, uint16_t, double> finder({rows, cols}, 5.0,
+                                                          2000, n_threads);
+    push_pedestal(finder, rows, cols);
+    // the pedestal frames are queued, process them before timing
+    finder.sync();
+
+    // drain the sink, the finder blocks once it is full
+    std::atomic<bool> done{false};
+    std::atomic<size_t> n_clusters{0};
+    std::thread drain([&]() {
+        auto *sink = finder.sink();
+        while (!done || !sink->isEmpty()) {
+            if (auto *clusters = sink->frontPtr(); clusters != nullptr) {
+                n_clusters += clusters->size();
+                sink->popFront();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    });
+
+    for (auto _ : state) {
+        for (ssize_t i = 0; i < frames.shape(0); ++i)
+            finder.find_clusters(frame_view(frames, i), i);
+        finder.sync();
+    }
+    done = true;
+    drain.join();
+    finder.stop();
+
+    set_frame_rates(state, frames, frames.shape(0));
+    set_cluster_rate(state, n_clusters);
+}
+BENCHMARK(BM_ClusterFinderMT)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_RawFileRead(benchmark::State &state) {
+    const auto n_modules = static_cast<size_t>(state.range(0));
+    const auto &frames =
+        cached_frames(N_FRAMES, JUNGFRAU_ROWS * static_cast<ssize_t>(n_modules),
+                      JUNGFRAU_COLS, PHOTONS_PER_FRAME);
+    TempRawFile raw(frames, n_modules);
+    RawFile file(raw.master());
+    NDArray<uint16_t, 3> buffer(frames.shape());
+
+    for (auto _ : state) {
+        file.seek(0);
+        file.read_into(reinterpret_cast<std::byte *>(buffer.data()),
+                       static_cast<size_t>(frames.shape(0)));
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+}
+BENCHMARK(BM_RawFileRead)
+    ->ArgName("modules")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_RawSubFileRead(benchmark::State &state) {
+    const auto &frames = cached_frames(N_FRAMES, JUNGFRAU_ROWS, JUNGFRAU_COLS,
+                                       PHOTONS_PER_FRAME);
+    TempRawFile raw(frames, 1);
+    RawSubFile file(raw.dir() / "bench_d0_f0_0.raw", DetectorType::Jungfrau,
+                    JUNGFRAU_ROWS, JUNGFRAU_COLS, 16);
+    NDArray<uint16_t, 3> buffer(frames.shape());
+
+    for (auto _ : state) {
+        file.seek(0);
+        file.read_into(reinterpret_cast<std::byte *>(buffer.data()),
+                       static_cast<size_t>(frames.shape(0)));
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+}
+BENCHMARK(BM_RawSubFileRead)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_ClusterFileWrite(benchmark::State &state) {
+    const auto clusters = generate_clusters(100000);
+    const auto path =
+        std::filesystem::temp_directory_path() / "aare_bench_write.clust";
+    for (auto _ : state) {
+        ClusterFile<ClusterType> file(path, 1000, "w");
+        file.write_frame(clusters);
+        file.close();
+    }
+    std::filesystem::remove(path);
+    set_cluster_rate(state, state.iterations() * clusters.size());
+    state.SetBytesProcessed(state.iterations() * clusters.size() *
+                            static_cast<int64_t>(sizeof(ClusterType)));
+}
+BENCHMARK(BM_ClusterFileWrite)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_ClusterFileRead(benchmark::State &state) {
+    const auto clusters = generate_clusters(100000);
+    const auto path =
+        std::filesystem::temp_directory_path() / "aare_bench_read.clust";
+    {
+        ClusterFile<ClusterType> file(path, 1000, "w");
+        file.write_frame(clusters);
+    }
+    size_t n_read = 0;
+    for (auto _ : state) {
+        ClusterFile<ClusterType> file(path, 10000, "r");
+        for (auto chunk = file.read_clusters(10000); chunk.size() > 0;
+             chunk = file.read_clusters(10000))
+            n_read += chunk.size();
+    }
+    std::filesystem::remove(path);
+    set_cluster_rate(state, n_read);
+    state.SetBytesProcessed(static_cast<int64_t>(n_read * sizeof(ClusterType)));
+}
+BENCHMARK(BM_ClusterFileRead)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_PixelHistogram(benchmark::State &state) {
+    const ssize_t rows = MOENCH_ROWS, cols = MOENCH_COLS;
+    const int n_threads = static_cast<int>(state.range(0));
+    const auto &frames = cached_frames(N_FRAMES, rows, cols, PHOTONS_PER_FRAME);
+    PixelHistogram<uint16_t, float> hist(static_cast<int>(rows),
+                                         static_cast<int>(cols), 400, 800.0f,
+                                         2000.0f, n_threads);
+    for (auto _ : state) {
+        for (ssize_t i = 0; i < frames.shape(0); ++i) {
+            auto image = hist.acquire_buffer();
+            for (ssize_t j = 0; j < image.size(); ++j)
+                image[j] = frames(i, j / cols, j % cols);
+            hist.fill_async(std::move(image));
+        }
+        hist.flush();
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+}
+BENCHMARK(BM_PixelHistogram)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_PedestalTrackingPixelHistogram(benchmark::State &state) {
+    const ssize_t rows = MOENCH_ROWS, cols = MOENCH_COLS;
+    const int n_threads = static_cast<int>(state.range(0));
+    const auto &frames = cached_frames(N_FRAMES, rows, cols, PHOTONS_PER_FRAME);
+    PedestalTrackingPixelHistogram hist(static_cast<int>(rows),
+                                        static_cast<int>(cols), 400, -200.0f,
+                                        1000.0f, n_threads);
+    const auto &dark = cached_frames(N_PEDESTAL_FRAMES, rows, cols, 0.0);
+    for (ssize_t i = 0; i < dark.shape(0); ++i)
+        hist.push_pedestal_no_update(frame_view(dark, i));
+    hist.update_mean();
+    hist.flush();
+
+    for (auto _ : state) {
+        for (ssize_t i = 0; i < frames.shape(0); ++i)
+            hist.fill_async(frame_view(frames, i));
+        hist.flush();
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+}
+BENCHMARK(BM_PedestalTrackingPixelHistogram)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_Interpolator(benchmark::State &state) {
+    const auto clusters = generate_clusters(100000);
+    NDArray<double, 1> eta_bins({51});
+    for (ssize_t i = 0; i < eta_bins.size(); ++i)
+        eta_bins[i] = -1.0 + 3.0 * static_cast<double>(i) / 50.0;
+    NDArray<double, 1> energy_bins({2});
+    energy_bins[0] = -1e6;
+    energy_bins[1] = 1e6;
+
+    EtaCubeBuilder builder(eta_bins.view(), eta_bins.view(),
+                           energy_bins.view());
+    builder.fill<calculate_eta2<int32_t, 3, 3>>(clusters);
+    auto cube = builder.values();
+    Interpolator interpolator(cube.view(), eta_bins.view(), eta_bins.view(),
+                              energy_bins.view());
+
+    for (auto _ : state) {
+        auto photons =
+            interpolator.interpolate<calculate_eta2<int32_t, 3, 3>>(clusters);
+        benchmark::DoNotOptimize(photons.data());
+    }
+    set_cluster_rate(state, state.iterations() * clusters.size());
+}
+BENCHMARK(BM_Interpolator)->Unit(benchmark::kMillisecond);
+
+void BM_ApplyCalibration(benchmark::State &state) {
+    const ssize_t rows = JUNGFRAU_ROWS, cols = JUNGFRAU_COLS;
+    const auto n_threads = static_cast<ssize_t>(state.range(0));
+    const auto &frames = cached_frames(N_FRAMES, rows, cols, PHOTONS_PER_FRAME);
+    NDArray<double, 3> pedestal({3, rows, cols}, 1000.0);
+    NDArray<double, 3> calibration({3, rows, cols}, 40.0);
+    NDArray<double, 3> result(frames.shape());
+    auto raw = NDView<uint16_t, 3>(const_cast<uint16_t *>(frames.data()),
+                                   frames.shape());
+
+    for (auto _ : state) {
+        apply_calibration<double>(result.view(), raw, pedestal.view(),
+                                  calibration.view(), n_threads);
+        benchmark::DoNotOptimize(result.data());
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+}
+BENCHMARK(BM_ApplyCalibration)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// ── End to end ──────────────────────────────────────────────────────────
+
+// Raw file on disk -> cluster finding -> cluster file
+void BM_EndToEnd(benchmark::State &state) {
+    const auto n_modules = static_cast<size_t>(state.range(0));
+    const ssize_t rows = JUNGFRAU_ROWS * static_cast<ssize_t>(n_modules);
+    const ssize_t cols = JUNGFRAU_COLS;
+    const auto &frames = cached_frames(N_FRAMES, rows, cols, PHOTONS_PER_FRAME);
+    TempRawFile raw(frames, n_modules);
+    const auto out = raw.dir() / "clusters.clust";
+    ClusterFinder<ClusterType, uint16_t, double> finder({rows, cols}, 5.0);
+    push_pedestal(finder, rows, cols);
+
+    size_t n_clusters = 0;
+    NDArray<uint16_t, 2> image({rows, cols});
+    auto *buffer = reinterpret_cast<std::byte *>(image.data());
+    for (auto _ : state) {
+        RawFile file(raw.master());
+        ClusterFile<ClusterType> cluster_file(out, 1000, "w");
+        for (size_t i = 0; i < file.total_frames(); ++i) {
+            file.read_into(buffer, nullptr);
+            finder.find_clusters(image.view(), i);
+            auto clusters = finder.steal_clusters();
+            n_clusters += clusters.size();
+            cluster_file.write_frame(clusters);
+        }
+    }
+    set_frame_rates(state, frames, frames.shape(0));
+    set_cluster_rate(state, n_clusters);
+}
+BENCHMARK(BM_EndToEnd)
+    ->ArgName("modules")
+    ->Arg(1)
+    ->Arg(2)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+// Deterministic synthetic detector data for the pipeline benchmarks: frames
+// with pedestal, noise and photons, clusters, and raw files on disk.
+
+#include "aare/Cluster.hpp"
+#include "aare/ClusterVector.hpp"
+#include "aare/NDArray.hpp"
+#include "aare/defs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace aare::bench {
+
+inline constexpr unsigned SEED = 42;
+inline constexpr double NOISE_ADU = 10.0;
+inline constexpr double PHOTON_ADU = 300.0;
+
+// Jungfrau module and Moench 03 frame sizes
+inline constexpr ssize_t JUNGFRAU_ROWS = 512;
+inline constexpr ssize_t JUNGFRAU_COLS = 1024;
+inline constexpr ssize_t MOENCH_ROWS = 400;
+inline constexpr ssize_t MOENCH_COLS = 400;
+
+/** @brief Fixed per pixel pedestal pattern around 1000 ADU */
+inline uint16_t pedestal_adu(ssize_t row, ssize_t col) {
+    return static_cast<uint16_t>(1000 + (row * 7 + col * 13) % 200);
+}
+
+/**
+ * @brief n_frames frames of pedestal plus Gaussian noise and, on average,
+ * photons_per_frame photons at random positions. Each photon deposits 70%
+ * of its charge in one pixel and the rest in a random neighbour.
+ */
+inline NDArray<uint16_t, 3> generate_frames(ssize_t n_frames, ssize_t rows,
+                                            ssize_t cols,
+                                            double photons_per_frame,
+                                            unsigned seed = SEED) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, NOISE_ADU);
+    std::poisson_distribution<int> n_photons(photons_per_frame);
+    std::uniform_int_distribution<ssize_t> row_dist(1, rows - 2);
+    std::uniform_int_distribution<ssize_t> col_dist(1, cols - 2);
+    std::uniform_int_distribution<int> neighbour(0, 3);
+
+    NDArray<uint16_t, 3> frames({n_frames, rows, cols});
+    std::vector<double> image(static_cast<size_t>(rows * cols));
+    for (ssize_t f = 0; f < n_frames; ++f) {
+        for (ssize_t row = 0; row < rows; ++row)
+            for (ssize_t col = 0; col < cols; ++col)
+                image[row * cols + col] = pedestal_adu(row, col) + noise(rng);
+
+        const int n = photons_per_frame > 0 ? n_photons(rng) : 0;
+        for (int p = 0; p < n; ++p) {
+            const ssize_t row = row_dist(rng);
+            const ssize_t col = col_dist(rng);
+            const ssize_t drow[] = {-1, 1, 0, 0};
+            const ssize_t dcol[] = {0, 0, -1, 1};
+            const int k = neighbour(rng);
+            image[row * cols + col] += 0.7 * PHOTON_ADU;
+            image[(row + drow[k]) * cols + col + dcol[k]] += 0.3 * PHOTON_ADU;
+        }
+
+        for (ssize_t i = 0; i < rows * cols; ++i)
+            frames(f, i / cols, i % cols) = static_cast<uint16_t>(
+                std::clamp(image[i], 0.0, 16383.0));
+    }
+    return frames;
+}
+
+/**
+ * @brief generate_frames() memoised per argument set, so the benchmarks
+ * do not regenerate the data for every run
+ */
+inline const NDArray<uint16_t, 3> &cached_frames(ssize_t n_frames,
+                                                 ssize_t rows, ssize_t cols,
+                                                 double photons_per_frame) {
+    using Key = std::tuple<ssize_t, ssize_t, ssize_t, double>;
+    static std::map<Key, NDArray<uint16_t, 3>> cache;
+    const Key key{n_frames, rows, cols, photons_per_frame};
+    auto it = cache.find(key);
+    if (it == cache.end())
+        it = cache
+                 .emplace(key, generate_frames(n_frames, rows, cols,
+                                               photons_per_frame))
+                 .first;
+    return it->second;
+}
+
+/** @brief 3x3 photon clusters with charge sharing, energies in ADU */
+inline ClusterVector<Cluster<int32_t, 3, 3>>
+generate_clusters(size_t n_clusters, unsigned seed = SEED) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int16_t> pos(1, 398);
+    std::uniform_real_distribution<double> share(0.0, 0.5);
+    std::normal_distribution<double> noise(0.0, NOISE_ADU);
+
+    ClusterVector<Cluster<int32_t, 3, 3>> clusters(n_clusters);
+    for (size_t i = 0; i < n_clusters; ++i) {
+        Cluster<int32_t, 3, 3> c{};
+        c.x = pos(rng);
+        c.y = pos(rng);
+        for (auto &v : c.data)
+            v = static_cast<int32_t>(noise(rng));
+        const double fx = share(rng);
+        const double fy = share(rng);
+        c.data[4] += static_cast<int32_t>((1 - fx) * (1 - fy) * PHOTON_ADU);
+        c.data[5] += static_cast<int32_t>(fx * (1 - fy) * PHOTON_ADU);
+        c.data[7] += static_cast<int32_t>((1 - fx) * fy * PHOTON_ADU);
+        c.data[8] += static_cast<int32_t>(fx * fy * PHOTON_ADU);
+        clusters.push_back(c);
+    }
+    return clusters;
+}
+
+/**
+ * @brief Jungfrau raw file set with n_modules modules stacked vertically in
+ * a fresh directory under the system temp path, removed again on
+ * destruction. Module m holds rows [m * 512, (m + 1) * 512) of frames.
+ */
+class TempRawFile {
+    std::filesystem::path m_dir;
+    std::filesystem::path m_master;
+
+  public:
+    TempRawFile(const NDArray<uint16_t, 3> &frames, size_t n_modules) {
+        const ssize_t module_rows =
+            frames.shape(1) / static_cast<ssize_t>(n_modules);
+        const ssize_t cols = frames.shape(2);
+        m_dir = std::filesystem::temp_directory_path() /
+                ("aare_bench_" + std::to_string(n_modules) + "_" +
+                 std::to_string(frames.shape(0)) + "_" +
+                 std::to_string(reinterpret_cast<uintptr_t>(this)));
+        std::filesystem::create_directories(m_dir);
+        m_master = m_dir / "bench_master_0.json";
+
+        std::ofstream master(m_master);
+        master << R"({"Version": 8.0, "Detector Type": "Jungfrau", )"
+               << R"("Timing Mode": "auto", "Geometry": {"x": 1, "y": )"
+               << n_modules << "}, \"Image Size\": "
+               << module_rows * cols * 2
+               << ", \"Frames in File\": " << frames.shape(0)
+               << R"(, "Pixels": {"x": )" << cols << ", \"y\": " << module_rows
+               << R"(}, "Max Frames Per File": 100000, "Total Frames": )"
+               << frames.shape(0)
+               << R"(, "Frame Padding": 1, "Frame Discard Policy": )"
+               << R"("nodiscard", "Dynamic Range": 16, )"
+               << R"("Number of UDP Interfaces": 1})";
+
+        for (size_t m = 0; m < n_modules; ++m) {
+            std::ofstream sub(m_dir / ("bench_d" + std::to_string(m) +
+                                       "_f0_0.raw"),
+                              std::ios::binary);
+            for (ssize_t f = 0; f < frames.shape(0); ++f) {
+                DetectorHeader header{};
+                header.frameNumber = static_cast<uint64_t>(f + 1);
+                header.row = static_cast<uint16_t>(m);
+                sub.write(reinterpret_cast<const char *>(&header),
+                          sizeof(header));
+                sub.write(reinterpret_cast<const char *>(&frames(
+                              f, static_cast<ssize_t>(m) * module_rows, 0)),
+                          module_rows * cols * sizeof(uint16_t));
+            }
+        }
+    }
+    ~TempRawFile() {
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+    TempRawFile(const TempRawFile &) = delete;
+    TempRawFile &operator=(const TempRawFile &) = delete;
+
+    const std::filesystem::path &master() const { return m_master; }
+    const std::filesystem::path &dir() const { return m_dir; }
+};
+
+} // namespace aare::bench
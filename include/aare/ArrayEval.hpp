@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+/*
+Evaluation engine for elementwise array operations and reductions. Large
+arrays are split into chunks of eval_chunk_size elements that are handed out
+to a process wide pool of eval_threads() threads, the calling thread helps
+with the work. Arrays of a single chunk are evaluated directly on the calling
+thread without touching the pool.
+
+The pool is off by default (eval_threads() == 1), most of the time arrays
+are evaluated on worker threads that already keep the cores busy, e.g. those
+of ClusterFinderMT or fit_3d. A single threaded program can turn it on with
+set_eval_threads(). Only one evaluation uses the pool at a time, if it is
+busy the caller evaluates serially instead of waiting. Threads that should
+never use it, like the workers of ClusterFinderMT, call
+set_serial_eval_on_this_thread(). Chunk boundaries do not depend on the
+number of threads, which keeps floating point reductions reproducible.
+
+The inner loops are marked with #pragma omp simd when compiled with
+-fopenmp-simd (AARE_OPENMP_SIMD), which needs no OpenMP runtime.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#define AARE_PRAGMA(x) _Pragma(#x)
+#ifdef AARE_OPENMP_SIMD
+#define AARE_PRAGMA_SIMD AARE_PRAGMA(omp simd)
+#define AARE_PRAGMA_SIMD_REDUCTION(op, ...)                                    \
+    AARE_PRAGMA(omp simd reduction(op : __VA_ARGS__))
+#else
+#define AARE_PRAGMA_SIMD
+#define AARE_PRAGMA_SIMD_REDUCTION(op, ...)
+#endif
+
+namespace aare {
+
+/** @brief Number of elements evaluated as one task */
+constexpr size_t eval_chunk_size = size_t{1} << 16;
+
+/** @brief Number of threads used to evaluate large arrays */
+size_t eval_threads();
+
+/**
+ * @brief Set the number of threads used to evaluate large arrays, including
+ * the calling thread. 1, the default, disables multithreading, 0 uses
+ * std::thread::hardware_concurrency() threads.
+ */
+void set_eval_threads(size_t n_threads);
+
+/**
+ * @brief Evaluate large arrays serially on the calling thread while serial is
+ * set, regardless of eval_threads(). Returns the previous setting.
+ */
+bool set_serial_eval_on_this_thread(bool serial);
+
+namespace detail {
+/**
+ * @brief Call func(chunk) for every chunk in [0, n_chunks) on the evaluation
+ * pool and wait for all of them. Exceptions are rethrown in the caller.
+ */
+void run_chunks(size_t n_chunks, const std::function<void(size_t)> &func);
+} // namespace detail
+
+/**
+ * @brief Call func(first, last) for consecutive ranges of at most
+ * eval_chunk_size elements covering [0, n), in parallel if there is more
+ * than one range.
+ */
+template <typename F> void for_each_chunk(size_t n, F &&func) {
+    const size_t n_chunks = (n + eval_chunk_size - 1) / eval_chunk_size;
+    if (n_chunks <= 1) {
+        if (n > 0)
+            func(size_t{0}, n);
+        return;
+    }
+    detail::run_chunks(n_chunks, [&func, n](size_t chunk) {
+        const size_t first = chunk * eval_chunk_size;
+        func(first, std::min(first + eval_chunk_size, n));
+    });
+}
+
+/**
+ * @brief Call func(i) for every i in [0, n). func must only read and write
+ * element i of its arrays, the loop is marked as vectorisable.
+ */
+template <typename F> void for_each_element(size_t n, F &&func) {
+    for_each_chunk(n, [&func](size_t first, size_t last) {
+        AARE_PRAGMA_SIMD
+        for (size_t i = first; i < last; ++i)
+            func(i);
+    });
+}
+
+/**
+ * @brief Reduce [0, n) chunk by chunk. reduce(first, last) returns the
+ * result R of one chunk, the chunk results are then folded from left to
+ * right with combine(R, R). Returns init for n == 0.
+ */
+template <typename R, typename Reduce, typename Combine>
+R reduce_chunks(size_t n, R init, Reduce &&reduce, Combine &&combine) {
+    const size_t n_chunks = (n + eval_chunk_size - 1) / eval_chunk_size;
+    if (n_chunks == 0)
+        return init;
+    if (n_chunks == 1)
+        return reduce(size_t{0}, n);
+
+    std::vector<R> partial(n_chunks, init);
+    detail::run_chunks(n_chunks, [&](size_t chunk) {
+        const size_t first = chunk * eval_chunk_size;
+        partial[chunk] = reduce(first, std::min(first + eval_chunk_size, n));
+    });
+    R result = partial[0];
+    for (size_t i = 1; i < n_chunks; ++i)
+        result = combine(result, partial[i]);
+    return result;
+}
+
+} // namespace aare
@@ -27,9 +27,10 @@ class ArrayAdd : public ArrayExpr<ArrayAdd<A, B, Ndim>, Ndim> {
 
   public:
     ArrayAdd(const A &arr1, const B &arr2) : arr1_(arr1), arr2_(arr2) {
-        assert(arr1.size() == arr2.size());
+        assert(static_cast<size_t>(arr1.size()) ==
+               static_cast<size_t>(arr2.size()));
     }
-    auto operator[](int i) const { return arr1_[i] + arr2_[i]; }
+    auto operator[](size_t i) const { return arr1_[i] + arr2_[i]; }
     size_t size() const { return arr1_.size(); }
     std::array<ssize_t, Ndim> shape() const { return arr1_.shape(); }
 };
@@ -41,9 +42,10 @@ class ArraySub : public ArrayExpr<ArraySub<A, B, Ndim>, Ndim> {
 
   public:
     ArraySub(const A &arr1, const B &arr2) : arr1_(arr1), arr2_(arr2) {
-        assert(arr1.size() == arr2.size());
+        assert(static_cast<size_t>(arr1.size()) ==
+               static_cast<size_t>(arr2.size()));
     }
-    auto operator[](int i) const { return arr1_[i] - arr2_[i]; }
+    auto operator[](size_t i) const { return arr1_[i] - arr2_[i]; }
     size_t size() const { return arr1_.size(); }
     std::array<ssize_t, Ndim> shape() const { return arr1_.shape(); }
 };
@@ -55,9 +57,10 @@ class ArrayMul : public ArrayExpr<ArrayMul<A, B, Ndim>, Ndim> {
 
   public:
     ArrayMul(const A &arr1, const B &arr2) : arr1_(arr1), arr2_(arr2) {
-        assert(arr1.size() == arr2.size());
+        assert(static_cast<size_t>(arr1.size()) ==
+               static_cast<size_t>(arr2.size()));
     }
-    auto operator[](int i) const { return arr1_[i] * arr2_[i]; }
+    auto operator[](size_t i) const { return arr1_[i] * arr2_[i]; }
     size_t size() const { return arr1_.size(); }
     std::array<ssize_t, Ndim> shape() const { return arr1_.shape(); }
 };
@@ -69,9 +72,10 @@ class ArrayDiv : public ArrayExpr<ArrayDiv<A, B, Ndim>, Ndim> {
 
   public:
     ArrayDiv(const A &arr1, const B &arr2) : arr1_(arr1), arr2_(arr2) {
-        assert(arr1.size() == arr2.size());
+        assert(static_cast<size_t>(arr1.size()) ==
+               static_cast<size_t>(arr2.size()));
     }
-    auto operator[](int i) const { return arr1_[i] / arr2_[i]; }
+    auto operator[](size_t i) const { return arr1_[i] / arr2_[i]; }
     size_t size() const { return arr1_.size(); }
     std::array<ssize_t, Ndim> shape() const { return arr1_.shape(); }
 };
@@ -2,10 +2,17 @@
 #pragma once
 
 #include "aare/Cluster.hpp"
+#include "aare/ClusterArrays.hpp"
 #include "aare/ClusterVector.hpp"
 #include "aare/NDArray.hpp"
 #include "aare/defs.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
 namespace aare {
 
 enum class pixel : int {
@@ -145,7 +152,7 @@ calculate_eta2(const Cluster<T, ClusterSizeX, ClusterSizeY, CoordType> &cl) {
     static_assert(ClusterSizeX > 1 && ClusterSizeY > 1);
     Eta2<T> eta{};
 
-    size_t cluster_center_index =
+    constexpr size_t cluster_center_index =
         (ClusterSizeX / 2) + (ClusterSizeY / 2) * ClusterSizeX;
 
     auto max_sum = cl.max_sum_2x2();
@@ -387,7 +394,7 @@ Eta2<T> calculate_cross_eta3(
                   "calculate_eta3 only defined for clusters larger than 2x2");
 
     if constexpr (ClusterSizeX != 3 || ClusterSizeY != 3) {
-        auto reduced_cluster = reduce_cluster_to_3x3(cl);
+        auto reduced_cluster = reduce_to_3x3(cl);
         return calculate_cross_eta3(reduced_cluster);
     } else {
         return calculate_cross_eta3(cl);
@@ -437,11 +444,395 @@ calculate_eta3(const Cluster<T, ClusterSizeX, ClusterSizeY, CoordType> &cl) {
                   "calculate_eta3 only defined for clusters larger than 2x2");
 
     if constexpr (ClusterSizeX != 3 || ClusterSizeY != 3) {
-        auto reduced_cluster = reduce_cluster_to_3x3(cl);
+        auto reduced_cluster = reduce_to_3x3(cl);
         return calculate_eta3(reduced_cluster);
     } else {
         return calculate_eta3(cl);
     }
 }
 
-} // namespace aare
\ No newline at end of file
+/**
+ * @brief Eta values of many clusters as separate arrays, one entry per
+ * cluster, filled by the batch eta functions
+ */
+template <typename T> struct EtaArrays {
+    /// @brief eta in x direction
+    NDArray<double, 1> x;
+    /// @brief eta in y direction
+    NDArray<double, 1> y;
+    /// @brief photon energy, same meaning as Eta2::sum
+    NDArray<T, 1> sum;
+    /// @brief corner of the subcluster as int, same meaning as Eta2::c
+    NDArray<int, 1> c;
+
+    EtaArrays() = default;
+    explicit EtaArrays(ssize_t size)
+        : x(std::array<ssize_t, 1>{size}), y(std::array<ssize_t, 1>{size}),
+          sum(std::array<ssize_t, 1>{size}), c(std::array<ssize_t, 1>{size}) {
+    }
+
+    ssize_t size() const { return x.size(); }
+
+    void set(ssize_t i, const Eta2<T> &eta) {
+        x[i] = eta.x;
+        y[i] = eta.y;
+        sum[i] = eta.sum;
+        c[i] = static_cast<int>(eta.c);
+    }
+};
+
+namespace detail {
+
+/// @brief number of clusters the batch eta kernels process together
+inline constexpr size_t eta_tile_size = 16;
+
+/// @brief value types the batch eta kernels are specialised for, other
+/// types fall back to the single cluster functions
+template <typename T>
+inline constexpr bool has_eta_kernel_v =
+    std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+template <typename ClusterType, uint8_t SizeX, uint8_t SizeY>
+inline constexpr bool is_eta_kernel_layout_v =
+    ClusterType::cluster_size_x == SizeX &&
+    ClusterType::cluster_size_y == SizeY &&
+    has_eta_kernel_v<typename ClusterType::value_type>;
+
+/// @brief Output arrays of EtaArrays offset to the first cluster of a tile
+template <typename T> struct EtaTileOutput {
+    double *x;
+    double *y;
+    T *sum;
+    int *c;
+};
+
+/**
+ * @brief Call kernel(pixels, n, out) for consecutive tiles of at most
+ * eta_tile_size clusters, pixels[k][j] is pixel k of the j-th cluster of the
+ * tile and out its output. Having the same pixel of all clusters next to
+ * each other lets the compiler vectorize the kernel loops over j.
+ */
+template <typename ClusterType, typename Kernel>
+void for_each_eta_tile(const ClusterVector<ClusterType> &clusters,
+                       EtaArrays<typename ClusterType::value_type> &eta,
+                       Kernel &&kernel) {
+    using T = typename ClusterType::value_type;
+    constexpr size_t n_pixels =
+        ClusterType::cluster_size_x * ClusterType::cluster_size_y;
+
+    T pixels[n_pixels][eta_tile_size];
+    for (size_t first = 0; first < clusters.size(); first += eta_tile_size) {
+        const size_t n = std::min(eta_tile_size, clusters.size() - first);
+        for (size_t j = 0; j < n; ++j) {
+            const auto &data = clusters[first + j].data;
+            for (size_t k = 0; k < n_pixels; ++k) {
+                pixels[k][j] = data[k];
+            }
+        }
+        kernel(pixels, n,
+               EtaTileOutput<T>{eta.x.data() + first, eta.y.data() + first,
+                                eta.sum.data() + first, eta.c.data() + first});
+    }
+}
+
+/**
+ * @brief Call kernel(pixels, n, out) once for all clusters, pixels[k] is the
+ * plane of pixel k so no transposing is needed
+ */
+template <typename ClusterType, typename Kernel>
+void for_each_eta_tile(const ClusterArrays<ClusterType> &clusters,
+                       EtaArrays<typename ClusterType::value_type> &eta,
+                       Kernel &&kernel) {
+    using T = typename ClusterType::value_type;
+    std::array<const T *, ClusterArrays<ClusterType>::n_pixels> pixels;
+    for (size_t k = 0; k < pixels.size(); ++k) {
+        pixels[k] = clusters.pixel_data(k);
+    }
+    kernel(pixels, clusters.size(),
+           EtaTileOutput<T>{eta.x.data(), eta.y.data(), eta.sum.data(),
+                            eta.c.data()});
+}
+
+/// @brief Pixels of the j-th cluster of a tile
+template <typename Tile, typename T, size_t NPixels>
+inline void load_pixels(const Tile &pixels, size_t j, T (&v)[NPixels]) {
+    for (size_t k = 0; k < NPixels; ++k) {
+        v[k] = pixels[k][j];
+    }
+}
+
+/// @brief Sum of the pixels of a cluster, in the order of Cluster::sum()
+template <size_t NPixels, typename T>
+inline T pixel_sum(const T (&v)[NPixels]) {
+    T sum{};
+    for (size_t k = 0; k < NPixels; ++k) {
+        sum = sum + v[k];
+    }
+    return sum;
+}
+
+/**
+ * @brief num / den, or 0 if den is zero. The zero denominator is masked
+ * with arithmetic instead of a branch, a conditional division can not be
+ * vectorized. For floating point values the result can differ from the
+ * branch in the sign of a zero and is NaN for an infinite num.
+ */
+template <typename T> inline double eta_ratio(const T num, const T den) {
+    if constexpr (std::is_integral_v<T>) {
+        const T valid = static_cast<T>(den != 0);
+        return static_cast<double>(num * valid) /
+               static_cast<double>(den + (1 - valid));
+    } else {
+        const double valid = den != 0 ? 1.0 : 0.0;
+        return (static_cast<double>(num) * valid + 0.0) /
+               (static_cast<double>(den) + (1.0 - valid));
+    }
+}
+
+/**
+ * @brief a > b, for floating point values without raising FE_INVALID on NaN
+ * which allows the compiler to replace branches on it by selects
+ */
+template <typename T> inline bool is_greater(const T a, const T b) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::isgreater(a, b);
+    } else {
+        return a > b;
+    }
+}
+
+/**
+ * @brief Branch free version of max_sum_2x2() for a 3x3 cluster, the first
+ * of equal sums wins like in std::max_element
+ */
+template <typename T>
+inline void max_sum_2x2_3x3(const T (&v)[9], T &sum, int &c) {
+    const T s[4] = {v[0] + v[1] + v[3] + v[4], v[1] + v[2] + v[4] + v[5],
+                    v[3] + v[4] + v[6] + v[7], v[4] + v[5] + v[7] + v[8]};
+    sum = s[0];
+    c = 0;
+    for (int k = 1; k < 4; ++k) {
+        const bool larger = is_greater(s[k], sum);
+        sum = larger ? s[k] : sum;
+        c = larger ? k : c;
+    }
+}
+
+/**
+ * @brief Corner of the maximum pixel of a 2x2 cluster, 3 - index of the
+ * first maximum like in calculate_eta2 for 2x2 clusters
+ */
+template <typename T> inline int max_pixel_corner_2x2(const T (&v)[4]) {
+    T max = v[0];
+    int index = 0;
+    for (int k = 1; k < 4; ++k) {
+        const bool larger = is_greater(v[k], max);
+        max = larger ? v[k] : max;
+        index = larger ? k : index;
+    }
+    return 3 - index;
+}
+
+} // namespace detail
+
+/**
+ * @brief Calculate the eta2 values of all clusters in a ClusterVector or
+ * ClusterArrays into separate arrays. Gives the same values as
+ * calculate_eta2 for each cluster but 3x3 and 2x2 clusters of int32_t and
+ * float are processed in tiles with branch free kernels.
+ */
+template <typename Clusters,
+          typename ClusterType = typename Clusters::ClusterType,
+          typename = std::enable_if_t<is_cluster_v<ClusterType>>>
+EtaArrays<typename ClusterType::value_type>
+calculate_eta2_batch(const Clusters &clusters) {
+    using T = typename ClusterType::value_type;
+    EtaArrays<T> eta(static_cast<ssize_t>(clusters.size()));
+
+    if constexpr (detail::is_eta_kernel_layout_v<ClusterType, 3, 3>) {
+        detail::for_each_eta_tile(clusters, eta, [](const auto &pixels,
+                                                     size_t n, auto out) {
+            for (size_t j = 0; j < n; ++j) {
+                T v[9];
+                detail::load_pixels(pixels, j, v);
+                T sum;
+                int c;
+                detail::max_sum_2x2_3x3(v, sum, c);
+                const bool right = (c & 1) != 0;
+                const bool bottom = (c & 2) != 0;
+                const T left_x = right ? v[4] : v[3];
+                const T right_x = right ? v[5] : v[4];
+                const T bottom_y = bottom ? v[4] : v[1];
+                const T top_y = bottom ? v[7] : v[4];
+                out.x[j] = detail::eta_ratio<T>(right_x, right_x + left_x);
+                out.y[j] = detail::eta_ratio<T>(top_y, top_y + bottom_y);
+                out.sum[j] = sum;
+                out.c[j] = c;
+            }
+        });
+    } else if constexpr (detail::is_eta_kernel_layout_v<ClusterType, 2, 2> &&
+                         std::is_same_v<typename ClusterType::coord_type,
+                                        uint16_t>) {
+        detail::for_each_eta_tile(clusters, eta, [](const auto &pixels,
+                                                     size_t n, auto out) {
+            for (size_t j = 0; j < n; ++j) {
+                T v[4];
+                detail::load_pixels(pixels, j, v);
+                const int c = detail::max_pixel_corner_2x2(v);
+                const bool right = (c & 1) != 0;
+                const bool bottom = (c & 2) != 0;
+                const T left_x = bottom ? v[0] : v[2];
+                const T right_x = bottom ? v[1] : v[3];
+                const T bottom_y = right ? v[0] : v[1];
+                const T top_y = right ? v[2] : v[3];
+                out.x[j] = detail::eta_ratio<T>(right_x, right_x + left_x);
+                out.y[j] = detail::eta_ratio<T>(top_y, top_y + bottom_y);
+                out.sum[j] = detail::pixel_sum(v);
+                out.c[j] = c;
+            }
+        });
+    } else {
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            eta.set(static_cast<ssize_t>(i), calculate_eta2(clusters[i]));
+        }
+    }
+    return eta;
+}
+
+/**
+ * @brief Calculate the full eta2 values of all clusters into separate
+ * arrays. Gives the same values as calculate_full_eta2 for each cluster,
+ * with the same specialisations as calculate_eta2_batch.
+ */
+template <typename Clusters,
+          typename ClusterType = typename Clusters::ClusterType,
+          typename = std::enable_if_t<is_cluster_v<ClusterType>>>
+EtaArrays<typename ClusterType::value_type>
+calculate_full_eta2_batch(const Clusters &clusters) {
+    using T = typename ClusterType::value_type;
+    EtaArrays<T> eta(static_cast<ssize_t>(clusters.size()));
+
+    if constexpr (detail::is_eta_kernel_layout_v<ClusterType, 3, 3>) {
+        detail::for_each_eta_tile(clusters, eta, [](const auto &pixels,
+                                                     size_t n, auto out) {
+            for (size_t j = 0; j < n; ++j) {
+                T v[9];
+                detail::load_pixels(pixels, j, v);
+                T sum;
+                int c;
+                detail::max_sum_2x2_3x3(v, sum, c);
+                const bool right = (c & 1) != 0;
+                const bool bottom = (c & 2) != 0;
+                // pixels of the 2x2 subcluster except its top left one
+                const T top_right = bottom ? (right ? v[5] : v[4])
+                                           : (right ? v[2] : v[1]);
+                const T bottom_left = bottom ? (right ? v[7] : v[6])
+                                             : (right ? v[4] : v[3]);
+                const T bottom_right = bottom ? (right ? v[8] : v[7])
+                                              : (right ? v[5] : v[4]);
+                const T x_sum = top_right + bottom_right;
+                const T y_sum = bottom_left + bottom_right;
+                out.x[j] = detail::eta_ratio<T>(x_sum, sum);
+                out.y[j] = detail::eta_ratio<T>(y_sum, sum);
+                out.sum[j] = sum;
+                out.c[j] = c;
+            }
+        });
+    } else if constexpr (detail::is_eta_kernel_layout_v<ClusterType, 2, 2> &&
+                         std::is_same_v<typename ClusterType::coord_type,
+                                        uint16_t>) {
+        detail::for_each_eta_tile(clusters, eta, [](const auto &pixels,
+                                                     size_t n, auto out) {
+            for (size_t j = 0; j < n; ++j) {
+                T v[4];
+                detail::load_pixels(pixels, j, v);
+                const T sum = detail::pixel_sum(v);
+                out.x[j] = detail::eta_ratio<T>(v[1] + v[3], sum);
+                out.y[j] = detail::eta_ratio<T>(v[2] + v[3], sum);
+                out.sum[j] = sum;
+                out.c[j] = detail::max_pixel_corner_2x2(v);
+            }
+        });
+    } else {
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            eta.set(static_cast<ssize_t>(i), calculate_full_eta2(clusters[i]));
+        }
+    }
+    return eta;
+}
+
+/**
+ * @brief Calculate eta3 of all clusters into separate arrays. Gives the same
+ * values as calculate_eta3 for each cluster, 3x3 clusters of int32_t and float
+ * are processed in tiles.
+ */
+template <typename Clusters,
+          typename ClusterType = typename Clusters::ClusterType,
+          typename = std::enable_if_t<is_cluster_v<ClusterType>>>
+EtaArrays<typename ClusterType::value_type>
+calculate_eta3_batch(const Clusters &clusters) {
+    using T = typename ClusterType::value_type;
+    EtaArrays<T> eta(static_cast<ssize_t>(clusters.size()));
+
+    if constexpr (detail::is_eta_kernel_layout_v<ClusterType, 3, 3>) {
+        detail::for_each_eta_tile(clusters, eta, [](const auto &pixels,
+                                                     size_t n, auto out) {
+            for (size_t j = 0; j < n; ++j) {
+                T v[9];
+                detail::load_pixels(pixels, j, v);
+                const T sum = detail::pixel_sum(v);
+                const T left = v[0] + v[3] + v[6];
+                const T right = v[2] + v[5] + v[8];
+                const T bottom = v[0] + v[1] + v[2];
+                const T top = v[6] + v[7] + v[8];
+                out.x[j] = detail::eta_ratio<T>(-left + right, sum);
+                out.y[j] = detail::eta_ratio<T>(-bottom + top, sum);
+                out.sum[j] = sum;
+                out.c[j] = 0;
+            }
+        });
+    } else {
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            eta.set(static_cast<ssize_t>(i), calculate_eta3(clusters[i]));
+        }
+    }
+    return eta;
+}
+
+/**
+ * @brief Calculate cross eta3 of all clusters into separate arrays. Gives the
+ * same values as calculate_cross_eta3 for each cluster, 3x3 clusters of
+ * int32_t and float are processed in tiles.
+ */
+template <typename Clusters,
+          typename ClusterType = typename Clusters::ClusterType,
+          typename = std::enable_if_t<is_cluster_v<ClusterType>>>
+EtaArrays<typename ClusterType::value_type>
+calculate_cross_eta3_batch(const Clusters &clusters) {
+    using T = typename ClusterType::value_type;
+    EtaArrays<T> eta(static_cast<ssize_t>(clusters.size()));
+
+    if constexpr (detail::is_eta_kernel_layout_v<ClusterType, 3, 3>) {
+        detail::for_each_eta_tile(clusters, eta, [](const auto &pixels,
+                                                     size_t n, auto out) {
+            for (size_t j = 0; j < n; ++j) {
+                T v[9];
+                detail::load_pixels(pixels, j, v);
+                const T row = v[3] + v[4] + v[5];
+                const T column = v[1] + v[4] + v[7];
+                out.x[j] = detail::eta_ratio<T>(-v[3] + v[5], row);
+                out.y[j] = detail::eta_ratio<T>(-v[1] + v[7], column);
+                out.sum[j] = detail::pixel_sum(v);
+                out.c[j] = 0;
+            }
+        });
+    } else {
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            eta.set(static_cast<ssize_t>(i),
+                    calculate_cross_eta3(clusters[i]));
+        }
+    }
+    return eta;
+}
+
+} // namespace aare
@@ -4,6 +4,7 @@
 #include "aare/NDView.hpp"
 #include <Minuit2/FCNGradientBase.h>
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <stdexcept>
 #include <vector>
@@ -17,10 +18,11 @@ namespace func {
  *
  * @tparam Model  A model struct that satisfies:
  *   - static constexpr std::size_t npar;
- *   - static double eval(double x, const std::vector<double>& par);
- *   - static void eval_and_grad(double x, const std::vector<double>& par,
+ *   - static double eval(double x, const Par& par);
+ *   - static void eval_and_grad(double x, const Par& par,
  *                                double& f, std::array<double, npar>& g);
- *   - static bool is_valid(const std::vector<double>& par);
+ *   - static bool is_valid(const Par& par);
+ *   templated on the parameter container Par (std::vector or std::array).
  *
  * Gradient:
  *   d(chi2)/dp_k = -2 * sum_i  w_i * (y_i - f_i) * df_i/dp_k
@@ -30,6 +32,12 @@ namespace func {
  * By providing analytic gradients we avoid 2*npar extra function evaluations
  * per Minuit step that would otherwise be spent on finite differences.
  *
+ * Value and gradient are computed together in one pass over the points and
+ * memoised for the last parameter vector: Minuit2 asks for the gradient at
+ * the point it has just evaluated, which is then answered from the cache
+ * instead of evaluating the model again. The cache makes an instance
+ * unsafe to share between threads, fit_3d builds one per pixel.
+ *
  * @throws std::invalid_argument if par.size() != Model::npar.
  *
  * Invalid model parameters do not throw; they return a large penalty
@@ -48,91 +56,74 @@ class Chi2Model1DGrad : public ROOT::Minuit2::FCNGradientBase {
     ~Chi2Model1DGrad() override = default;
 
     double operator()(const std::vector<double> &par) const override {
-        if (par.size() != Model::npar) {
-            throw std::invalid_argument(
-                "Chi2Model1DGrad: wrong parameter vector size.");
-        }
-
-        if (!Model::is_valid(par))
-            return 1e20;
-
-        double chi2 = 0.0;
-
-        if (weighted_) {
-            for (ssize_t i = 0; i < x_.size(); ++i) {
-                const double si = s_[i];
-                if (si == 0.0)
-                    continue;
-
-                const double f_i = Model::eval(x_[i], par);
-                const double r_i = y_[i] - f_i;
-                chi2 += (r_i * r_i) / (si * si);
-            }
-        } else {
-            for (ssize_t i = 0; i < x_.size(); ++i) {
-                const double f_i = Model::eval(x_[i], par);
-                const double r_i = y_[i] - f_i;
-                chi2 += r_i * r_i;
-            }
-        }
-
-        return chi2;
+        evaluate(par);
+        return chi2_;
     }
 
     std::vector<double>
     Gradient(const std::vector<double> &par) const override {
+        evaluate(par);
+        return std::vector<double>(grad_.begin(), grad_.end());
+    }
+
+    /** @brief Error definition: 1.0 for chi-squared (delta_chi2 = 1 ->
+     * 1-sigma). */
+    double Up() const override { return 1.0; }
+
+  private:
+    /** @brief Fill chi2_ and grad_ for par unless they are cached */
+    void evaluate(const std::vector<double> &par) const {
         if (par.size() != Model::npar) {
             throw std::invalid_argument(
                 "Chi2Model1DGrad: wrong parameter vector size.");
         }
+        if (cached_ && std::equal(par.begin(), par.end(), par_.begin()))
+            return;
 
-        std::vector<double> grad(Model::npar, 0.0);
-        if (!Model::is_valid(par))
-            return grad;
+        std::copy(par.begin(), par.end(), par_.begin());
+        cached_ = true;
+        chi2_ = 0.0;
+        grad_.fill(0.0);
+
+        if (!Model::is_valid(par_)) {
+            chi2_ = 1e20;
+            return;
+        }
 
         std::array<double, Model::npar> df{};
         double f_i = 0.0;
 
-        if (weighted_) {
-            for (ssize_t i = 0; i < x_.size(); ++i) {
+        for (ssize_t i = 0; i < x_.size(); ++i) {
+            double w = 1.0;
+            if (weighted_) {
                 const double si = s_[i];
                 if (si == 0.0)
                     continue;
-
-                Model::eval_and_grad(x_[i], par, f_i, df);
-
-                const double r_i = y_[i] - f_i;
-                const double c = -2.0 * r_i / (si * si);
-
-                for (std::size_t k = 0; k < Model::npar; ++k) {
-                    grad[k] += c * df[k];
-                }
+                w = 1.0 / (si * si);
             }
-        } else {
-            for (ssize_t i = 0; i < x_.size(); ++i) {
-                Model::eval_and_grad(x_[i], par, f_i, df);
 
-                const double r_i = y_[i] - f_i;
-                const double c = -2.0 * r_i;
+            Model::eval_and_grad(x_[i], par_, f_i, df);
+
+            const double r_i = y_[i] - f_i;
+            chi2_ += w * r_i * r_i;
 
-                for (std::size_t k = 0; k < Model::npar; ++k) {
-                    grad[k] += c * df[k];
-                }
+            const double c = -2.0 * w * r_i;
+            for (std::size_t k = 0; k < Model::npar; ++k) {
+                grad_[k] += c * df[k];
             }
         }
-
-        return grad;
     }
 
-    /** @brief Error definition: 1.0 for chi-squared (delta_chi2 = 1 ->
-     * 1-sigma). */
-    double Up() const override { return 1.0; }
-
-  private:
     NDView<double, 1> x_;
     NDView<double, 1> y_;
     NDView<double, 1> s_;
     bool weighted_;
+
+    // last evaluated parameters with their chi2 and gradient
+    mutable std::array<double, Model::npar> par_{};
+    mutable std::array<double, Model::npar> grad_{};
+    mutable double chi2_{};
+    mutable bool cached_{false};
 };
 
 // ── Convenient aliases ──────────────────────────────────────────────
@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "aare/Cluster.hpp"
+#include "aare/ClusterVector.hpp"
+#include "aare/NDView.hpp"
+#include "aare/defs.hpp"
+
+namespace aare {
+
+template <typename ClusterType,
+          typename = std::enable_if_t<is_cluster_v<ClusterType>>>
+class ClusterArrays; // Forward declaration
+
+/**
+ * @brief Clusters stored as structure of arrays: one array each for x, y and
+ * the frame number and one plane per pixel position, plane k holding pixel k
+ * of all clusters. Operations that look at the same pixels of every cluster
+ * (sums, eta, gain correction) then read contiguous memory instead of
+ * striding over whole clusters like with ClusterVector.
+ * @note push_back and reserve can invalidate views and pointers to the
+ * arrays
+ * @tparam T data type of the pixels in the cluster
+ * @tparam CoordType data type of the x and y coordinates of the cluster
+ */
+template <typename T, uint8_t ClusterSizeX, uint8_t ClusterSizeY,
+          typename CoordType>
+class ClusterArrays<Cluster<T, ClusterSizeX, ClusterSizeY, CoordType>> {
+  public:
+    using value_type = T;
+    using coord_type = CoordType;
+    using ClusterType = Cluster<T, ClusterSizeX, ClusterSizeY, CoordType>;
+
+    /// @brief number of pixels, and therefore planes, per cluster
+    static constexpr size_t n_pixels =
+        static_cast<size_t>(ClusterSizeX) * ClusterSizeY;
+
+  private:
+    std::vector<CoordType> m_x{};
+    std::vector<CoordType> m_y{};
+    std::vector<int32_t> m_frame_numbers{};
+    // n_pixels planes of m_capacity values each, only the first m_size values
+    // of a plane are valid
+    std::vector<T> m_pixels{};
+    size_t m_size{0};
+    size_t m_capacity{0};
+
+  public:
+    /**
+     * @brief Construct an empty ClusterArrays
+     * @param capacity initial capacity in number of clusters
+     */
+    explicit ClusterArrays(size_t capacity = 1024) { reserve(capacity); }
+
+    /**
+     * @brief Copy the clusters of a ClusterVector, all of them get the
+     * frame number of the ClusterVector
+     */
+    explicit ClusterArrays(const ClusterVector<ClusterType> &clusters) {
+        append(clusters);
+    }
+
+    /**
+     * @brief Reserve space for at least capacity clusters
+     * @note If capacity is less than the current capacity, the function does
+     * nothing.
+     */
+    void reserve(size_t capacity) {
+        if (capacity <= m_capacity) {
+            return;
+        }
+        m_x.reserve(capacity);
+        m_y.reserve(capacity);
+        m_frame_numbers.reserve(capacity);
+        std::vector<T> pixels(n_pixels * capacity);
+        for (size_t k = 0; k < n_pixels; ++k) {
+            std::copy_n(m_pixels.data() + k * m_capacity, m_size,
+                        pixels.data() + k * capacity);
+        }
+        m_pixels = std::move(pixels);
+        m_capacity = capacity;
+    }
+
+    void push_back(const ClusterType &cluster, int32_t frame_number = 0) {
+        if (m_size == m_capacity) {
+            reserve(std::max<size_t>(2 * m_capacity, 1024));
+        }
+        m_x.push_back(cluster.x);
+        m_y.push_back(cluster.y);
+        m_frame_numbers.push_back(frame_number);
+        for (size_t k = 0; k < n_pixels; ++k) {
+            m_pixels[k * m_capacity + m_size] = cluster.data[k];
+        }
+        ++m_size;
+    }
+
+    /**
+     * @brief Append the clusters of a ClusterVector, all of them get the
+     * frame number of the ClusterVector
+     */
+    void append(const ClusterVector<ClusterType> &clusters) {
+        if (m_size + clusters.size() > m_capacity) {
+            reserve(std::max(m_size + clusters.size(), 2 * m_capacity));
+        }
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            m_x.push_back(clusters[i].x);
+            m_y.push_back(clusters[i].y);
+        }
+        m_frame_numbers.insert(m_frame_numbers.end(), clusters.size(),
+                               clusters.frame_number());
+        // one plane at a time so that the writes are contiguous
+        for (size_t k = 0; k < n_pixels; ++k) {
+            T *plane = pixel_data(k) + m_size;
+            for (size_t i = 0; i < clusters.size(); ++i) {
+                plane[i] = clusters[i].data[k];
+            }
+        }
+        m_size += clusters.size();
+    }
+
+    /**
+     * @brief Copy the clusters back into a ClusterVector. The frame number of
+     * the ClusterVector is the frame number of the clusters if they all have
+     * the same, otherwise 0.
+     */
+    ClusterVector<ClusterType> to_cluster_vector() const {
+        int32_t frame_number = m_size > 0 ? m_frame_numbers[0] : 0;
+        for (size_t i = 1; i < m_size; ++i) {
+            if (m_frame_numbers[i] != frame_number) {
+                frame_number = 0;
+                break;
+            }
+        }
+        ClusterVector<ClusterType> clusters(m_size, frame_number);
+        clusters.resize(m_size);
+        for (size_t i = 0; i < m_size; ++i) {
+            clusters[i].x = m_x[i];
+            clusters[i].y = m_y[i];
+        }
+        for (size_t k = 0; k < n_pixels; ++k) {
+            const T *plane = pixel_data(k);
+            for (size_t i = 0; i < m_size; ++i) {
+                clusters[i].data[k] = plane[i];
+            }
+        }
+        return clusters;
+    }
+
+    /**
+     * @brief Create a copy containing only the clusters where the mask is
+     * true
+     * @param mask boolean 1d mask
+     */
+    ClusterArrays operator()(NDView<bool, 1> mask) const {
+        if (static_cast<size_t>(mask.size()) != m_size) {
+            throw std::runtime_error(
+                LOCATION + "Mask size does not match number of clusters");
+        }
+        size_t n_selected = 0;
+        for (size_t i = 0; i < m_size; ++i) {
+            n_selected += mask(i) ? 1 : 0;
+        }
+        ClusterArrays result(n_selected);
+        for (size_t i = 0; i < m_size; ++i) {
+            if (mask(i)) {
+                result.m_x.push_back(m_x[i]);
+                result.m_y.push_back(m_y[i]);
+                result.m_frame_numbers.push_back(m_frame_numbers[i]);
+            }
+        }
+        for (size_t k = 0; k < n_pixels; ++k) {
+            const T *plane = pixel_data(k);
+            T *dst = result.pixel_data(k);
+            for (size_t i = 0; i < m_size; ++i) {
+                if (mask(i)) {
+                    *dst++ = plane[i];
+                }
+            }
+        }
+        result.m_size = n_selected;
+        return result;
+    }
+
+    /**
+     * @brief Sum the pixels in each cluster, in the same order as
+     * Cluster::sum()
+     */
+    std::vector<T> sum() const {
+        std::vector<T> sums(m_size, T{});
+        for (size_t k = 0; k < n_pixels; ++k) {
+            const T *plane = pixel_data(k);
+            for (size_t i = 0; i < m_size; ++i) {
+                sums[i] = sums[i] + plane[i];
+            }
+        }
+        return sums;
+    }
+
+    /**
+     * @brief Sum the pixels in the 2x2 subcluster with the biggest pixel sum in
+     * each cluster
+     */
+    std::vector<Sum_index_pair<T, corner>> sum_2x2() const {
+        std::vector<Sum_index_pair<T, corner>> sums_2x2(m_size);
+        for (size_t i = 0; i < m_size; ++i) {
+            sums_2x2[i] = (*this)[i].max_sum_2x2();
+        }
+        return sums_2x2;
+    }
+
+    /**
+     * @brief Gather the i-th cluster
+     */
+    ClusterType operator[](size_t i) const {
+        ClusterType cluster{};
+        cluster.x = m_x[i];
+        cluster.y = m_y[i];
+        for (size_t k = 0; k < n_pixels; ++k) {
+            cluster.data[k] = m_pixels[k * m_capacity + i];
+        }
+        return cluster;
+    }
+
+    void clear() {
+        m_x.clear();
+        m_y.clear();
+        m_frame_numbers.clear();
+        m_size = 0;
+    }
+
+    size_t size() const { return m_size; }
+
+    bool empty() const { return m_size == 0; }
+
+    size_t capacity() const { return m_capacity; }
+
+    uint8_t cluster_size_x() const { return ClusterSizeX; }
+
+    uint8_t cluster_size_y() const { return ClusterSizeY; }
+
+    NDView<CoordType, 1> x() {
+        return NDView<CoordType, 1>(m_x.data(), {static_cast<ssize_t>(m_size)});
+    }
+    NDView<CoordType, 1> y() {
+        return NDView<CoordType, 1>(m_y.data(), {static_cast<ssize_t>(m_size)});
+    }
+    NDView<int32_t, 1> frame_numbers() {
+        return NDView<int32_t, 1>(m_frame_numbers.data(),
+                                  {static_cast<ssize_t>(m_size)});
+    }
+
+    /**
+     * @brief Plane of pixel k (row major in the cluster) of all clusters
+     */
+    NDView<T, 1> pixels(size_t k) {
+        return NDView<T, 1>(pixel_data(k), {static_cast<ssize_t>(m_size)});
+    }
+
+    const CoordType *x_data() const { return m_x.data(); }
+    const CoordType *y_data() const { return m_y.data(); }
+    const int32_t *frame_numbers_data() const {
+        return m_frame_numbers.data();
+    }
+
+    /**
+     * @brief Pointer to plane k, planes are capacity() values apart
+     */
+    T *pixel_data(size_t k) { return m_pixels.data() + k * m_capacity; }
+    const T *pixel_data(size_t k) const {
+        return m_pixels.data() + k * m_capacity;
+    }
+};
+
+} // namespace aare
@@ -6,6 +6,7 @@
 
 #include "aare/ClusterFinderMT.hpp"
 #include "aare/ClusterVector.hpp"
+#include "aare/Metrics.hpp"
 #include "aare/ProducerConsumerQueue.hpp"
 
 namespace aare {
@@ -21,12 +22,33 @@ class ClusterFileSink {
     std::thread m_thread;
     std::ofstream m_file;
 
+    // Telemetry, see metrics()
+    MetricsRegistry m_metrics;
+    MetricCounter &m_frames_total =
+        m_metrics.counter("cluster_file_sink_frames_total", "Frames written");
+    MetricCounter &m_clusters_total = m_metrics.counter(
+        "cluster_file_sink_clusters_total", "Clusters written");
+    MetricCounter &m_bytes_total = m_metrics.counter(
+        "cluster_file_sink_bytes_total", "Bytes written to the file");
+    MetricCounter &m_busy = m_metrics.duration(
+        "cluster_file_sink_busy_seconds_total", "Time spent writing");
+    MetricCounter &m_idle =
+        m_metrics.duration("cluster_file_sink_idle_seconds_total",
+                           "Time spent waiting for clusters");
+    MetricGauge &m_queue_depth =
+        m_metrics.gauge("cluster_file_sink_queue_depth",
+                        "Cluster vectors waiting in the source queue");
+    LatencyHistogram &m_write_latency =
+        m_metrics.histogram("cluster_file_sink_write_seconds",
+                            "Time to write the clusters of one frame");
+
     void process() {
         m_stopped = false;
         LOG(logDEBUG) << "ClusterFileSink started";
         while (!m_stop_requested || !m_source->isEmpty()) {
             if (ClusterVector<ClusterType> *clusters = m_source->frontPtr();
                 clusters != nullptr) {
+                const auto start = MetricsClock::now();
                 // Write clusters to file
                 int32_t frame_number =
                     clusters->frame_number(); // TODO! Should we store frame
@@ -38,9 +60,19 @@ class ClusterFileSink {
                              sizeof(num_clusters));
                 m_file.write(reinterpret_cast<const char *>(clusters->data()),
                              clusters->size() * clusters->item_size());
+                m_frames_total.add();
+                m_clusters_total.add(num_clusters);
+                m_bytes_total.add(sizeof(frame_number) + sizeof(num_clusters) +
+                                  clusters->size() * clusters->item_size());
                 m_source->popFront();
+                m_queue_depth.set(static_cast<int64_t>(m_source->sizeGuess()));
+                const auto ns = elapsed_ns(start);
+                m_write_latency.record(ns);
+                m_busy.add(ns);
             } else {
+                const auto start = MetricsClock::now();
                 std::this_thread::sleep_for(m_default_wait);
+                m_idle.add(elapsed_ns(start));
             }
         }
         LOG(logDEBUG) << "ClusterFileSink stopped";
@@ -62,6 +94,12 @@ class ClusterFileSink {
         m_thread.join();
         m_file.close();
     }
+
+    /**
+     * @brief Snapshot of the telemetry: frames, clusters and bytes written,
+     * busy and idle time, source queue depth and write latency
+     */
+    MetricsSnapshot metrics() const { return m_metrics.snapshot(); }
 };
 
 } // namespace aare
\ No newline at end of file
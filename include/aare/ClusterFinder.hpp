@@ -82,106 +82,128 @@ class ClusterFinder {
         return tmp;
     }
     void find_clusters(NDView<FRAME_TYPE, 2> frame, uint64_t frame_number = 0) {
-        // // TODO! deal with even size clusters
-        // // currently 3,3 -> +/- 1
-        // //  4,4 -> +/- 2
-        int dy = ClusterSizeY / 2;
-        int dx = ClusterSizeX / 2;
-        int has_center_pixel_x =
-            ClusterSizeX %
-            2; // for even sized clusters there is no proper cluster center and
-               // even amount of pixels around the center
-        int has_center_pixel_y = ClusterSizeY % 2;
+        // Pixels far enough from the border to have the whole cluster inside
+        // the frame take the path without bounds checks
+        const int first_row = dy;
+        const int last_row = static_cast<int>(frame.shape(0)) - dy_end + 1;
+        const int first_col = dx;
+        const int last_col = static_cast<int>(frame.shape(1)) - dx_end + 1;
 
         m_clusters.set_frame_number(frame_number);
         for (int iy = 0; iy < frame.shape(0); iy++) {
+            const bool interior_row = iy >= first_row && iy < last_row;
             for (int ix = 0; ix < frame.shape(1); ix++) {
+                if (interior_row && ix >= first_col && ix < last_col)
+                    process_pixel<false>(frame, iy, ix);
+                else
+                    process_pixel<true>(frame, iy, ix);
+            }
+        }
+    }
 
-                PEDESTAL_TYPE max = std::numeric_limits<FRAME_TYPE>::min();
-                PEDESTAL_TYPE total = 0;
+  private:
+    // // TODO! deal with even size clusters
+    // // currently 3,3 -> +/- 1
+    // //  4,4 -> +/- 2
+    static constexpr int dy = ClusterSizeY / 2;
+    static constexpr int dx = ClusterSizeX / 2;
+    // for even sized clusters there is no proper cluster center and even
+    // amount of pixels around the center, so the cluster spans
+    // [-dx, dx_end) x [-dy, dy_end)
+    static constexpr int dx_end = dx + ClusterSizeX % 2;
+    static constexpr int dy_end = dy + ClusterSizeY % 2;
+
+    template <bool CheckBounds>
+    static bool inside(NDView<FRAME_TYPE, 2> frame, int row, int col) {
+        if constexpr (CheckBounds) {
+            return col >= 0 && col < frame.shape(1) && row >= 0 &&
+                   row < frame.shape(0);
+        } else {
+            return true;
+        }
+    }
 
-                // What can we short circuit here?
-                PEDESTAL_TYPE rms = m_pedestal.std(iy, ix);
-                PEDESTAL_TYPE value = (frame(iy, ix) - m_pedestal.mean(iy, ix));
+    template <bool CheckBounds>
+    void process_pixel(NDView<FRAME_TYPE, 2> frame, int iy, int ix) {
+        PEDESTAL_TYPE max = std::numeric_limits<FRAME_TYPE>::min();
+        PEDESTAL_TYPE total = 0;
 
-                if (value < -m_nSigma * rms)
-                    continue; // NEGATIVE_PEDESTAL go to next pixel
-                              // TODO! No pedestal update???
+        // What can we short circuit here?
+        PEDESTAL_TYPE rms = m_pedestal.std(iy, ix);
+        PEDESTAL_TYPE value = (frame(iy, ix) - m_pedestal.mean(iy, ix));
 
-                for (int ir = -dy; ir < dy + has_center_pixel_y; ir++) {
-                    for (int ic = -dx; ic < dx + has_center_pixel_x; ic++) {
-                        if (ix + ic >= 0 && ix + ic < frame.shape(1) &&
-                            iy + ir >= 0 && iy + ir < frame.shape(0)) {
-                            PEDESTAL_TYPE val =
-                                frame(iy + ir, ix + ic) -
-                                m_pedestal.mean(iy + ir, ix + ic);
+        if (value < -m_nSigma * rms)
+            return; // NEGATIVE_PEDESTAL go to next pixel
+                    // TODO! No pedestal update???
 
-                            total += val;
-                            max = std::max(max, val);
-                        }
-                    }
-                }
+        // the loop bounds are compile time constants so the loops get unrolled
+        for (int ir = -dy; ir < dy_end; ir++) {
+            for (int ic = -dx; ic < dx_end; ic++) {
+                if (inside<CheckBounds>(frame, iy + ir, ix + ic)) {
+                    PEDESTAL_TYPE val = frame(iy + ir, ix + ic) -
+                                        m_pedestal.mean(iy + ir, ix + ic);
 
-                if ((max > m_nSigma * rms)) {
-                    if (value < max)
-                        continue; // Not max go to the next pixel
-                                  // but also no pedestal update
-                } else if (total > c3 * m_nSigma * rms) {
-                    // pass
-                } else {
-                    // m_pedestal.push(iy, ix, frame(iy, ix));   // Safe option
-                    m_pedestal.push_fast(
-                        iy, ix,
-                        frame(iy,
-                              ix)); // Assume we have reached n_samples in the
-                                    // pedestal, slight performance improvement
-                    continue;       // It was a pedestal value nothing to store
+                    total += val;
+                    max = std::max(max, val);
                 }
+            }
+        }
 
-                // Store cluster
-                if (value == max) {
-                    ClusterType cluster{};
-                    cluster.x = ix;
-                    cluster.y = iy;
-
-                    // Fill the cluster data since we have a photon to store
-                    // It's worth redoing the look since most of the time we
-                    // don't have a photon
-                    int i = 0;
-                    for (int ir = -dy; ir < dy + has_center_pixel_y; ir++) {
-                        for (int ic = -dx; ic < dx + has_center_pixel_x; ic++) {
-                            if (ix + ic >= 0 && ix + ic < frame.shape(1) &&
-                                iy + ir >= 0 && iy + ir < frame.shape(0)) {
-
-                                // If the cluster type is an integral type, and
-                                // the pedestal is a floating point type then we
-                                // need to round the value before storing it
-                                if constexpr (std::is_integral_v<CT> &&
-                                              std::is_floating_point_v<
-                                                  PEDESTAL_TYPE>) {
-                                    auto tmp = std::lround(
-                                        frame(iy + ir, ix + ic) -
-                                        m_pedestal.mean(iy + ir, ix + ic));
-                                    cluster.data[i] = static_cast<CT>(tmp);
-                                }
-                                // On the other hand if both are floating point
-                                // or both are integral then we can just static
-                                // cast directly
-                                else {
-                                    auto tmp =
-                                        frame(iy + ir, ix + ic) -
-                                        m_pedestal.mean(iy + ir, ix + ic);
-                                    cluster.data[i] = static_cast<CT>(tmp);
-                                }
-                            }
-                            i++;
+        if ((max > m_nSigma * rms)) {
+            if (value < max)
+                return; // Not max go to the next pixel
+                        // but also no pedestal update
+        } else if (total > c3 * m_nSigma * rms) {
+            // pass
+        } else {
+            // m_pedestal.push(iy, ix, frame(iy, ix));   // Safe option
+            m_pedestal.push_fast(
+                iy, ix,
+                frame(iy, ix)); // Assume we have reached n_samples in the
+                                // pedestal, slight performance improvement
+            return;             // It was a pedestal value nothing to store
+        }
+
+        // Store cluster
+        if (value == max) {
+            ClusterType cluster{};
+            cluster.x = ix;
+            cluster.y = iy;
+
+            // Fill the cluster data since we have a photon to store
+            // It's worth redoing the look since most of the time we
+            // don't have a photon
+            int i = 0;
+            for (int ir = -dy; ir < dy_end; ir++) {
+                for (int ic = -dx; ic < dx_end; ic++) {
+                    if (inside<CheckBounds>(frame, iy + ir, ix + ic)) {
+
+                        // If the cluster type is an integral type, and
+                        // the pedestal is a floating point type then we
+                        // need to round the value before storing it
+                        if constexpr (std::is_integral_v<CT> &&
+                                      std::is_floating_point_v<
+                                          PEDESTAL_TYPE>) {
+                            auto tmp =
+                                std::lround(frame(iy + ir, ix + ic) -
+                                            m_pedestal.mean(iy + ir, ix + ic));
+                            cluster.data[i] = static_cast<CT>(tmp);
+                        }
+                        // On the other hand if both are floating point
+                        // or both are integral then we can just static
+                        // cast directly
+                        else {
+                            auto tmp = frame(iy + ir, ix + ic) -
+                                       m_pedestal.mean(iy + ir, ix + ic);
+                            cluster.data[i] = static_cast<CT>(tmp);
                         }
                     }
-
-                    // Add the cluster to the output ClusterVector
-                    m_clusters.push_back(cluster);
+                    i++;
                 }
             }
+
+            // Add the cluster to the output ClusterVector
+            m_clusters.push_back(cluster);
         }
     }
 };
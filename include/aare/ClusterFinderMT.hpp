@@ -3,10 +3,12 @@
 #include <atomic>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include "aare/ClusterFinder.hpp"
+#include "aare/Metrics.hpp"
 #include "aare/NDArray.hpp"
 #include "aare/ProducerConsumerQueue.hpp"
 #include "aare/logger.hpp"
@@ -22,6 +24,7 @@ struct FrameWrapper {
     FrameType type;
     uint64_t frame_number;
     NDArray<uint16_t, 2> data;
+    MetricsClock::time_point queued{}; //!< when the frame was pushed
 };
 
 /**
@@ -58,6 +61,69 @@ class ClusterFinderMT {
     std::atomic<bool> m_stop_requested{false};
     std::atomic<bool> m_processing_threads_stopped{true};
 
+    // Telemetry, registered in the constructor, see metrics()
+    struct WorkerMetrics {
+        MetricCounter *busy;
+        MetricCounter *idle;
+        MetricGauge *queue_depth;
+    };
+    MetricsRegistry m_metrics;
+    std::vector<WorkerMetrics> m_worker_metrics;
+    MetricCounter &m_frames_total = m_metrics.counter(
+        "cluster_finder_frames_total", "Data frames processed");
+    MetricCounter &m_pedestal_frames_total =
+        m_metrics.counter("cluster_finder_pedestal_frames_total",
+                          "Pedestal frames processed by each thread");
+    MetricCounter &m_clusters_total =
+        m_metrics.counter("cluster_finder_clusters_total", "Clusters found");
+    MetricCounter &m_input_blocked_total = m_metrics.counter(
+        "cluster_finder_input_blocked_total",
+        "Frames that had to wait for space in a full input queue");
+    MetricCounter &m_input_blocked_seconds = m_metrics.duration(
+        "cluster_finder_input_blocked_seconds_total",
+        "Time the caller waited for space in the input queues");
+    MetricCounter &m_output_blocked_seconds = m_metrics.duration(
+        "cluster_finder_output_blocked_seconds_total",
+        "Time the threads waited for space in their output queue");
+    MetricGauge &m_sink_queue_depth =
+        m_metrics.gauge("cluster_finder_sink_queue_depth",
+                        "Cluster vectors waiting in the sink");
+    LatencyHistogram &m_queue_latency =
+        m_metrics.histogram("cluster_finder_queue_latency_seconds",
+                            "Time a frame waited in the input queue");
+    LatencyHistogram &m_frame_latency =
+        m_metrics.histogram("cluster_finder_frame_seconds",
+                            "Time to find the clusters of one frame");
+
+    void register_worker_metrics() {
+        for (size_t i = 0; i < m_n_threads; i++) {
+            const MetricLabels labels{{"thread", std::to_string(i)}};
+            m_worker_metrics.push_back(
+                {&m_metrics.duration("cluster_finder_busy_seconds_total",
+                                     "Time spent processing frames", labels),
+                 &m_metrics.duration("cluster_finder_idle_seconds_total",
+                                     "Time spent waiting for frames", labels),
+                 &m_metrics.gauge("cluster_finder_input_queue_depth",
+                                  "Frames waiting in the input queue",
+                                  labels)});
+        }
+    }
+
+    // Push to the input queue of thread_id, waiting while it is full
+    void push_frame(size_t thread_id, const FrameWrapper &fw) {
+        auto *queue = m_input_queues[thread_id].get();
+        if (!queue->write(fw)) {
+            const auto start = MetricsClock::now();
+            while (!queue->write(fw)) {
+                std::this_thread::sleep_for(m_default_wait);
+            }
+            m_input_blocked_total.add();
+            m_input_blocked_seconds.add(elapsed_ns(start));
+        }
+        m_worker_metrics[thread_id].queue_depth->set(
+            static_cast<int64_t>(queue->sizeGuess()));
+    }
+
     /**
      * @brief Function called by the processing threads. It reads the frames
      * from the input queue and processes them.
@@ -65,31 +131,54 @@ class ClusterFinderMT {
     void process(int thread_id) {
         auto cf = m_cluster_finders[thread_id].get();
         auto q = m_input_queues[thread_id].get();
+        auto &metrics = m_worker_metrics[thread_id];
         bool realloc_same_capacity = true;
+        // the n_threads finders keep the cores busy, array expressions must
+        // not add the threads of the evaluation pool on top
+        set_serial_eval_on_this_thread(true);
 
         while (!m_stop_requested || !q->isEmpty()) {
             if (FrameWrapper *frame = q->frontPtr(); frame != nullptr) {
+                const auto start = MetricsClock::now();
 
                 switch (frame->type) {
-                case FrameType::DATA:
+                case FrameType::DATA: {
+                    m_queue_latency.record(elapsed_ns(frame->queued, start));
                     cf->find_clusters(frame->data.view(), frame->frame_number);
-                    while (!m_output_queues[thread_id]->write(
-                        cf->steal_clusters(realloc_same_capacity))) {
-                        std::this_thread::sleep_for(m_default_wait);
+                    auto clusters = cf->steal_clusters(realloc_same_capacity);
+                    m_frame_latency.record(elapsed_ns(start));
+                    m_frames_total.add();
+                    m_clusters_total.add(clusters.size());
+
+                    // steal only once, write() leaves clusters untouched
+                    // until there is a free slot
+                    if (!m_output_queues[thread_id]->write(
+                            std::move(clusters))) {
+                        const auto blocked = MetricsClock::now();
+                        while (!m_output_queues[thread_id]->write(
+                            std::move(clusters))) {
+                            std::this_thread::sleep_for(m_default_wait);
+                        }
+                        m_output_blocked_seconds.add(elapsed_ns(blocked));
                     }
-
                     break;
+                }
 
                 case FrameType::PEDESTAL:
                     m_cluster_finders[thread_id]->push_pedestal_frame(
                         frame->data.view());
+                    m_pedestal_frames_total.add();
                     break;
                 }
 
                 // frame is processed now discard it
                 m_input_queues[thread_id]->popFront();
+                metrics.queue_depth->set(static_cast<int64_t>(q->sizeGuess()));
+                metrics.busy->add(elapsed_ns(start));
             } else {
+                const auto start = MetricsClock::now();
                 std::this_thread::sleep_for(m_default_wait);
+                metrics.idle->add(elapsed_ns(start));
             }
         }
     }
@@ -100,7 +189,11 @@ class ClusterFinderMT {
      */
     void collect() {
         bool empty = true;
-        while (!m_stop_requested || !empty || !m_processing_threads_stopped) {
+        bool threads_stopped = false;
+        while (!m_stop_requested || !empty || !threads_stopped) {
+            // read before the pass, so a pass that finds the queues empty
+            // after the threads stopped has seen all of their output
+            threads_stopped = m_processing_threads_stopped;
             empty = true;
             for (auto &queue : m_output_queues) {
                 if (!queue->isEmpty()) {
@@ -109,6 +202,8 @@ class ClusterFinderMT {
                         std::this_thread::sleep_for(m_default_wait);
                     }
                     queue->popFront();
+                    m_sink_queue_depth.set(
+                        static_cast<int64_t>(m_sink.sizeGuess()));
                     empty = false;
                 }
             }
@@ -145,6 +240,7 @@ class ClusterFinderMT {
             m_input_queues.emplace_back(std::make_unique<InputQueue>(200));
             m_output_queues.emplace_back(std::make_unique<OutputQueue>(200));
         }
+        register_worker_metrics();
         // TODO! Should we start automatically?
         start();
     }
@@ -158,6 +254,15 @@ class ClusterFinderMT {
         return &m_sink;
     }
 
+    /**
+     * @brief Snapshot of the telemetry: frames and clusters processed, busy
+     * and idle time and input queue depth per thread, time spent blocked on
+     * full queues, and latency histograms for the time frames wait in the
+     * queue and the time to process them. Frames are never dropped, a full
+     * input queue blocks the caller instead.
+     */
+    MetricsSnapshot metrics() const { return m_metrics.snapshot(); }
+
     /**
      * @brief Start all processing threads
      */
@@ -212,13 +317,11 @@ class ClusterFinderMT {
      * expected to be dark. No photon finding is done. Just pedestal update.
      */
     void push_pedestal_frame(NDView<FRAME_TYPE, 2> frame) {
-        FrameWrapper fw{FrameType::PEDESTAL, 0,
-                        NDArray(frame)}; // TODO! copies the data!
+        FrameWrapper fw{FrameType::PEDESTAL, 0, NDArray(frame),
+                        MetricsClock::now()}; // TODO! copies the data!
 
-        for (auto &queue : m_input_queues) {
-            while (!queue->write(fw)) {
-                std::this_thread::sleep_for(m_default_wait);
-            }
+        for (size_t i = 0; i < m_n_threads; i++) {
+            push_frame(i, fw);
         }
     }
 
@@ -228,11 +331,9 @@ class ClusterFinderMT {
      * @note Spin locks with a default wait if the queue is full.
      */
     void find_clusters(NDView<FRAME_TYPE, 2> frame, uint64_t frame_number = 0) {
-        FrameWrapper fw{FrameType::DATA, frame_number,
-                        NDArray(frame)}; // TODO! copies the data!
-        while (!m_input_queues[m_current_thread % m_n_threads]->write(fw)) {
-            std::this_thread::sleep_for(m_default_wait);
-        }
+        FrameWrapper fw{FrameType::DATA, frame_number, NDArray(frame),
+                        MetricsClock::now()}; // TODO! copies the data!
+        push_frame(m_current_thread % m_n_threads, fw);
         m_current_thread++;
     }
 
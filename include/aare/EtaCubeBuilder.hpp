@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include "aare/CalculateEta.hpp"
+#include "aare/ClusterFile.hpp"
+#include "aare/ClusterVector.hpp"
+#include "aare/NDArray.hpp"
+#include "aare/NDView.hpp"
+#include "aare/utils/par.hpp"
+
+#include <vector>
+
+namespace aare {
+
+/**
+ * @brief Histogram of (eta_x, eta_y, photon energy) of clusters, the
+ * etacube the Interpolator is built from. Each thread fills its own partial
+ * cube; the partial cubes are summed in values().
+ */
+class EtaCubeBuilder {
+    NDArray<double, 1> m_etabinsx;
+    NDArray<double, 1> m_etabinsy;
+    NDArray<double, 1> m_energy_bins;
+    int m_n_threads;
+
+    std::vector<NDArray<double, 3>> m_partial_cubes;
+
+    /**
+     * @brief Bin of value for sorted edges, -1 if it is outside of
+     * [edges[0], edges[n-1]]. Bins are closed on the left except for the
+     * last one which also includes the last edge, like numpy.histogramdd.
+     */
+    static ssize_t bin_index(const NDArray<double, 1> &edges, double value);
+
+  public:
+    /**
+     * @brief Construct an empty etacube
+     * @param xbins bin edges for etaX
+     * @param ybins bin edges for etaY
+     * @param ebins bin edges for photon energy
+     * @param n_threads number of threads used by fill()
+     * @throws std::invalid_argument if any axis has less than one bin or
+     * n_threads is not positive
+     */
+    EtaCubeBuilder(NDView<double, 1> xbins, NDView<double, 1> ybins,
+                   NDView<double, 1> ebins, int n_threads = 1);
+
+    /**
+     * @brief Add the eta values and energies of all clusters. Clusters
+     * outside of the bin edges are skipped.
+     * @tparam EtaFunction function calculating eta of a cluster, e.g.
+     * calculate_eta2 or calculate_eta3
+     */
+    template <auto EtaFunction = calculate_eta2, typename ClusterType,
+              typename Enable = std::enable_if_t<is_cluster_v<ClusterType>>>
+    void fill(const ClusterVector<ClusterType> &clusters);
+
+    /**
+     * @brief fill() with all remaining clusters of `file`, read in chunks of
+     * chunk_size clusters. The next chunk is read while the current one is
+     * being filled.
+     */
+    template <auto EtaFunction = calculate_eta2, typename ClusterType>
+    void fill_from_file(ClusterFile<ClusterType> &file,
+                        size_t chunk_size = 100000);
+
+    /**
+     * @brief Sum of the partial cubes, indexed (eta_x, eta_y, energy) as
+     * expected by the Interpolator
+     */
+    NDArray<double, 3> values() const;
+
+    void clear();
+
+    NDArray<double, 1> get_etabinsx() const { return m_etabinsx; }
+    NDArray<double, 1> get_etabinsy() const { return m_etabinsy; }
+    NDArray<double, 1> get_energy_bins() const { return m_energy_bins; }
+};
+
+template <auto EtaFunction, typename ClusterType, typename Enable>
+void EtaCubeBuilder::fill(const ClusterVector<ClusterType> &clusters) {
+    auto process = [&](int thread_id, int first, int last) {
+        auto &cube = m_partial_cubes[thread_id];
+        for (int i = first; i < last; ++i) {
+            const auto eta = EtaFunction(clusters[static_cast<size_t>(i)]);
+            const ssize_t ix = bin_index(m_etabinsx, eta.x);
+            const ssize_t iy = bin_index(m_etabinsy, eta.y);
+            const ssize_t ie =
+                bin_index(m_energy_bins, static_cast<double>(eta.sum));
+            if (ix < 0 || iy < 0 || ie < 0) {
+                continue;
+            }
+            cube(ix, iy, ie) += 1.0;
+        }
+    };
+
+    RunInParallelIndexed(process, 0, static_cast<int>(clusters.size()),
+                         m_n_threads);
+}
+
+template <auto EtaFunction, typename ClusterType>
+void EtaCubeBuilder::fill_from_file(ClusterFile<ClusterType> &file,
+                                    size_t chunk_size) {
+    RunWithReadAhead(
+        [&file, chunk_size]() { return file.read_clusters(chunk_size); },
+        [this](const ClusterVector<ClusterType> &clusters) {
+            fill<EtaFunction>(clusters);
+        });
+}
+
+} // namespace aare
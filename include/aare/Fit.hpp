@@ -1,13 +1,19 @@
 // SPDX-License-Identifier: MPL-2.0
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <fmt/core.h>
+#include <type_traits>
 #include <vector>
 
 #include "aare/Chi2.hpp"
 #include "aare/FitModel.hpp"
+#include "aare/LMFit.hpp"
 #include "aare/NDArray.hpp"
+#include "aare/PolynomialFit.hpp"
+#include "aare/ScanAccumulator.hpp"
 #include "aare/utils/par.hpp"
 #include "aare/utils/task.hpp"
 
@@ -123,7 +129,8 @@ void fit_scurve2(NDView<double, 1> x, NDView<double, 3> y,
 // _____________________________________________________________________
 
 /**
- * @brief Fit a single pixel's data using Minuit2.
+ * @brief Fit a single pixel's data using Minuit2, writing the result to
+ * caller owned buffers.
  *
  * The caller provides a thread-local clone of MnUserParameters so that
  * no heap allocation happens here (only SetValue/SetError stores).
@@ -132,6 +139,8 @@ void fit_scurve2(NDView<double, 1> x, NDView<double, 3> y,
  *   - Fixed parameters: untouched (value and fixed flag preserved from clone).
  *   - User-set start:   value preserved, step size auto-filled.
  *   - Neither:          both value and step size auto-filled from data.
+ * A start given by the caller (warm start) replaces the automatic estimate
+ * and the user-set start values.
  *
  * @tparam Model  Model struct (Gaussian, RisingScurve, …).
  * @tparam FCN    Chi2 functor type (Chi2Model1D or Chi2Model1DGrad
@@ -142,35 +151,49 @@ void fit_scurve2(NDView<double, 1> x, NDView<double, 3> y,
  * @param x           Scan points (shared across all pixels).
  * @param y           Measured values for this pixel.
  * @param y_err       Per-point uncertainties (empty view -> unweighted fit).
+ * @param start       Start parameters, or nullptr to estimate them from y.
+ * @param par         Output parameters, npar values.
+ * @param err         Output errors, npar values, or nullptr to skip them.
+ * @param chi2_out    Output minimum of the chi2.
+ * @param n_calls     Incremented by the number of FCN calls.
  *
- * @return NDArray<double,1> of size:
- *   - compute_errors: [p0..pN, err0..errN, chi2]  -> 2*npar + 1
- *   - otherwise:      [p0..pN, chi2]              -> npar + 1
+ * @return false for invalid start values or if Migrad did not converge,
+ * par, err and chi2_out are then set to zero.
  */
 template <typename Model, typename FCN>
-NDArray<double, 1> fit_pixel(const FitModel<Model> &model,
-                             ROOT::Minuit2::MnUserParameters &upar_local,
-                             NDView<double, 1> x, NDView<double, 1> y,
-                             NDView<double, 1> y_err) {
+bool fit_pixel_minuit_into(const FitModel<Model> &model,
+                           ROOT::Minuit2::MnUserParameters &upar_local,
+                           NDView<double, 1> x, NDView<double, 1> y,
+                           NDView<double, 1> y_err,
+                           const std::array<double, Model::npar> *start,
+                           double *par, double *err, double &chi2_out,
+                           unsigned int &n_calls) {
 
     constexpr std::size_t npar = Model::npar;
-    const bool want_errors = model.compute_errors();
-    const ssize_t result_size = want_errors ? (2 * npar + 1) : (npar + 1);
+
+    auto fail = [&]() {
+        for (std::size_t k = 0; k < npar; ++k) {
+            par[k] = 0.0;
+            if (err)
+                err[k] = 0.0;
+        }
+        chi2_out = 0.0;
+        return false;
+    };
 
     // ──── automatic parameter estimation ─────────────
-    auto start = Model::estimate_par(x, y);
+    const auto estimate = start ? *start : Model::estimate_par(x, y);
 
     // dead / degenerate pixel guard
-    if (!Model::is_valid(std::vector<double>(start.begin(), start.end()))) {
-        return NDArray<double, 1>({result_size}, 0.0);
-    }
+    if (!Model::is_valid(estimate))
+        return fail();
 
     // ──── data-range statistics for step sizes ─────────────
     double x_range, y_range, slope_scale;
     model::compute_ranges(x, y, x_range, y_range, slope_scale);
 
     std::array<double, npar> steps{};
-    Model::compute_steps(start, x_range, y_range, slope_scale, steps);
+    Model::compute_steps(estimate, x_range, y_range, slope_scale, steps);
 
     // ── apply auto-estimates respecting user precedence ─────────────
     for (std::size_t i = 0; i < npar; ++i) {
@@ -179,10 +202,10 @@ NDArray<double, 1> fit_pixel(const FitModel<Model> &model,
             continue;
         }
 
-        if (!model.is_user_start(i)) {
-            upar_local.SetValue(i, start[i]);
-        }
-
+        // restore the user start, the clone may hold a previous warm start
+        upar_local.SetValue(i, (start || !model.is_user_start(i))
+                                   ? estimate[i]
+                                   : model.upar().Value(i));
         upar_local.SetError(i, steps[i]);
     }
 
@@ -193,35 +216,134 @@ NDArray<double, 1> fit_pixel(const FitModel<Model> &model,
     ROOT::Minuit2::MnMigrad migrad(chi2, upar_local, model.strategy());
     ROOT::Minuit2::FunctionMinimum min =
         migrad(model.max_calls(), model.tolerance());
+    n_calls += static_cast<unsigned int>(min.NFcn());
 
     if (!min.IsValid())
-        return NDArray<double, 1>({result_size}, 0.0);
+        return fail();
 
     // ──── pack results ────────
-    if (want_errors) {
+    if (err) {
         ROOT::Minuit2::MnHesse hesse;
         hesse(chi2, min);
-
-        const auto &values = min.UserState().Params();
         const auto &errors = min.UserState().Errors();
-
-        NDArray<double, 1> result({result_size});
-        for (std::size_t k = 0; k < npar; ++k) {
-            result[k] = values[k];
-            result[npar + k] = errors[k];
-        }
-        result[2 * npar] = min.Fval();
-        return result;
+        for (std::size_t k = 0; k < npar; ++k)
+            err[k] = errors[k];
     }
 
     const auto &values = min.UserState().Params();
-    NDArray<double, 1> result({result_size});
     for (std::size_t k = 0; k < npar; ++k)
-        result[k] = values[k];
-    result[npar] = min.Fval();
+        par[k] = values[k];
+    chi2_out = min.Fval();
+    return true;
+}
+
+/**
+ * @brief Fit a single pixel's data using Minuit2, see fit_pixel_minuit_into
+ * for the handling of start values.
+ *
+ * @return NDArray<double,1> of size:
+ *   - compute_errors: [p0..pN, err0..errN, chi2]  -> 2*npar + 1
+ *   - otherwise:      [p0..pN, chi2]              -> npar + 1
+ */
+template <typename Model, typename FCN>
+NDArray<double, 1> fit_pixel_minuit(const FitModel<Model> &model,
+                                    ROOT::Minuit2::MnUserParameters &upar_local,
+                                    NDView<double, 1> x, NDView<double, 1> y,
+                                    NDView<double, 1> y_err) {
+    constexpr std::size_t npar = Model::npar;
+    const bool want_errors = model.compute_errors();
+    NDArray<double, 1> result(
+        {static_cast<ssize_t>(want_errors ? 2 * npar + 1 : npar + 1)});
+
+    unsigned int n_calls = 0;
+    fit_pixel_minuit_into<Model, FCN>(
+        model, upar_local, x, y, y_err, nullptr, result.data(),
+        want_errors ? result.data() + npar : nullptr,
+        result[want_errors ? 2 * npar : npar], n_calls);
     return result;
 }
 
+/**
+ * @brief Solver settings for lm_fit taken from the FitModel: limits and
+ * fixed parameters of model.upar(), max_calls() as budget of model
+ * evaluations and tolerance() as EDM target like in Minuit2, where MIGRAD
+ * stops at EDM < 0.002 * tolerance (Up = 1 for chi2).
+ */
+template <typename Model>
+LMOptions<Model> lm_options(const FitModel<Model> &model) {
+    LMOptions<Model> opt;
+    // every iteration evaluates the model at least twice, the Jacobian at
+    // the current point and one trial step
+    opt.max_calls = model.max_calls();
+    opt.max_iterations = std::max(1U, model.max_calls() / 2);
+    opt.abs_tolerance = 0.002 * model.tolerance();
+    opt.compute_errors = model.compute_errors();
+    for (std::size_t i = 0; i < Model::npar; ++i) {
+        const auto &p = model.upar().Parameter(i);
+        opt.fixed[i] = p.IsFixed();
+        if (p.HasLowerLimit())
+            opt.lower[i] = p.LowerLimit();
+        if (p.HasUpperLimit())
+            opt.upper[i] = p.UpperLimit();
+    }
+    return opt;
+}
+
+/**
+ * @brief Fit a single pixel with the Levenberg-Marquardt solver.
+ *
+ * Same start values as fit_pixel: automatic estimates unless the parameter
+ * is fixed or has a user-set start value. A warm start given by the caller
+ * replaces both, only fixed parameters keep their value.
+ *
+ * @return false if the start values are invalid or the fit did not
+ * converge, the caller should then fall back to Minuit2.
+ */
+template <typename Model>
+bool fit_pixel_lm(const FitModel<Model> &model, const LMOptions<Model> &opt,
+                  NDView<double, 1> x, NDView<double, 1> y,
+                  NDView<double, 1> y_err, LMResult<Model::npar> &result,
+                  const std::array<double, Model::npar> *warm = nullptr) {
+    auto start = warm ? *warm : Model::estimate_par(x, y);
+    for (std::size_t i = 0; i < Model::npar; ++i) {
+        if (model.is_user_fixed(i) || (!warm && model.is_user_start(i)))
+            start[i] = model.upar().Value(i);
+    }
+    if (!Model::is_valid(start))
+        return false;
+
+    result = lm_fit<Model>(x, y, y_err, start, opt);
+    return result.converged;
+}
+
+/**
+ * @brief Fit a single pixel, with the Levenberg-Marquardt solver if
+ * model.use_lm() is set and Minuit2 otherwise or if it fails. Same result
+ * layout as fit_pixel_minuit.
+ */
+template <typename Model, typename FCN>
+NDArray<double, 1> fit_pixel(const FitModel<Model> &model,
+                             ROOT::Minuit2::MnUserParameters &upar_local,
+                             NDView<double, 1> x, NDView<double, 1> y,
+                             NDView<double, 1> y_err) {
+    constexpr std::size_t npar = Model::npar;
+    LMResult<npar> lm;
+    if (model.use_lm() &&
+        fit_pixel_lm(model, lm_options(model), x, y, y_err, lm)) {
+        const bool want_errors = model.compute_errors();
+        NDArray<double, 1> result(
+            {static_cast<ssize_t>(want_errors ? 2 * npar + 1 : npar + 1)});
+        for (std::size_t k = 0; k < npar; ++k) {
+            result[k] = lm.par[k];
+            if (want_errors)
+                result[npar + k] = lm.err[k];
+        }
+        result[want_errors ? 2 * npar : npar] = lm.chi2;
+        return result;
+    }
+    return fit_pixel_minuit<Model, FCN>(model, upar_local, x, y, y_err);
+}
+
 // ── self-contained for 1D / standalone use ─────────
 template <typename Model, typename FCN>
 NDArray<double, 1> fit_pixel(const FitModel<Model> &model, NDView<double, 1> x,
@@ -242,9 +364,26 @@ NDArray<double, 1> fit_pixel(const FitModel<Model> &model, NDView<double, 1> x,
 //
 // fit_3d — row-parallel fitting over (rows, cols) pixel grid
 // _____________________________________________________________________
+
+/// Index of the entries per pixel in the fit_3d statistics output
+struct FitStat {
+    static constexpr ssize_t calls = 0;
+    static constexpr ssize_t failed = 1;
+    static constexpr ssize_t seconds = 2;
+    static constexpr ssize_t size = 3;
+};
+
 /**
  * @brief Fit all pixels in a 3D data cube (rows x cols x n_scan).
  *
+ * Rows are handed out to the threads on demand, so threads that get rows
+ * with many dead pixels do not sit idle while others still fit.
+ *
+ * Start values, in order of precedence: par_start of the pixel if given and
+ * valid, the result of the left neighbour if model.warm_start() is set and
+ * that fit succeeded, the automatic estimate. Warm-started pixels that fail
+ * in Minuit2 are refitted from the estimate.
+ *
  * @tparam Model  Model struct.
  * @tparam FCN    Chi2 functor type.
  *
@@ -258,7 +397,14 @@ NDArray<double, 1> fit_pixel(const FitModel<Model> &model, NDView<double, 1> x,
  * used.
  * @param chi2_out   Output chi-squared / objective values, shape `(rows,
  * cols)`.
- * @param n_threads  Number of threads used to split rows.
+ * @param n_threads  Number of threads fitting rows.
+ * @param par_start  Start parameters, e.g. par_out of a previous scan, shape
+ * `(rows, cols, npar)`, or empty.
+ * @param stats_out  Output convergence statistics, shape `(rows, cols,
+ * FitStat::size)` indexed by FitStat, or empty. calls counts the FCN calls of
+ * Minuit2 plus the model evaluations of the Levenberg-Marquardt solver (1
+ * for the closed form polynomial fit), failed is 1 for pixels without a
+ * valid fit and seconds is the wall time spent on the pixel.
  *
  */
 template <typename Model, typename FCN>
@@ -267,8 +413,10 @@ void fit_3d(
     NDView<double, 3> y,                               // (rows, cols, n_scan)
     NDView<double, 3> y_err, // (rows, cols, n_scan) or empty for unweighted fit
     NDView<double, 3> par_out, NDView<double, 3> err_out,
-    NDView<double, 2> chi2_out, int n_threads) {
-    const std::size_t npar = Model::npar;
+    NDView<double, 2> chi2_out, int n_threads,
+    NDView<double, 3> par_start = {}, NDView<double, 3> stats_out = {}) {
+    constexpr std::size_t npar = Model::npar;
+    using clock = std::chrono::steady_clock;
 
     // ──── checks ───────
     if (x.size() != y.shape(2))
@@ -283,6 +431,8 @@ void fit_3d(
 
     const bool has_errors = (y_err.size() > 0);
     const bool want_par_errors = (err_out.size() > 0) && model.compute_errors();
+    const bool has_start = (par_start.size() > 0);
+    const bool want_stats = (stats_out.size() > 0);
 
     if (has_errors) {
         if (y.shape(0) != y_err.shape(0) || y.shape(1) != y_err.shape(1) ||
@@ -296,41 +446,169 @@ void fit_3d(
                 "err_out must have shape [rows, cols, npar].");
     }
 
+    if (has_start && par_start.shape() != par_out.shape())
+        throw std::runtime_error(
+            "par_start must have shape [rows, cols, npar].");
+
+    if (want_stats &&
+        (stats_out.shape(0) != y.shape(0) || stats_out.shape(1) != y.shape(1) ||
+         stats_out.shape(2) != FitStat::size))
+        throw std::runtime_error(
+            "stats_out must have shape [rows, cols, FitStat::size].");
+
+    // ──── closed form for linear models ───────
+    if constexpr (std::is_same_v<Model, model::Pol1> ||
+                  std::is_same_v<Model, model::Pol2>) {
+        if (!model.has_constraints()) {
+            const auto t0 = clock::now();
+            NDArray<bool, 2> singular({y.shape(0), y.shape(1)});
+            fit_polynomial_3d<npar - 1>(
+                x, y, y_err, par_out,
+                want_par_errors ? err_out : NDView<double, 3>{}, chi2_out,
+                n_threads, singular.view());
+            if (want_stats) {
+                const double seconds =
+                    std::chrono::duration<double>(clock::now() - t0).count() /
+                    static_cast<double>(chi2_out.size());
+                for (ssize_t row = 0; row < y.shape(0); ++row) {
+                    for (ssize_t col = 0; col < y.shape(1); ++col) {
+                        stats_out(row, col, FitStat::calls) = 1.0;
+                        stats_out(row, col, FitStat::failed) =
+                            singular(row, col);
+                        stats_out(row, col, FitStat::seconds) = seconds;
+                    }
+                }
+            }
+            return;
+        }
+    }
+
     // ──── parallel dispatch ───────
-    auto process = [&](ssize_t first_row, ssize_t last_row) {
-        // one clone per thread
+    auto process = [&](int first_row, int last_row) {
+        // one clone per row
         auto upar_local = model.upar();
+        const auto lm_opt = lm_options(model);
+        LMResult<npar> lm;
+        std::array<double, npar> start{};
+        std::array<double, npar> err{};
 
         for (ssize_t row = first_row; row < last_row; row++) {
+            bool left_ok = false;
             for (ssize_t col = 0; col < y.shape(1); col++) {
+                const auto t0 = want_stats ? clock::now() : clock::time_point{};
 
                 NDView<double, 1> values(&y(row, col, 0), {y.shape(2)});
                 NDView<double, 1> errors =
                     has_errors ? NDView<double, 1>(&y_err(row, col, 0),
                                                    {y_err.shape(2)})
                                : NDView<double, 1>{};
+                double *par = &par_out(row, col, 0);
+
+                const std::array<double, npar> *seed = nullptr;
+                if (has_start) {
+                    for (std::size_t k = 0; k < npar; ++k)
+                        start[k] = par_start(row, col, k);
+                    if (Model::is_valid(start))
+                        seed = &start;
+                }
+                if (!seed && model.warm_start() && left_ok) {
+                    for (std::size_t k = 0; k < npar; ++k)
+                        start[k] = par_out(row, col - 1, k);
+                    seed = &start;
+                }
 
-                auto res =
-                    fit_pixel<Model, FCN>(model, upar_local, x, values, errors);
-
-                for (std::size_t k = 0; k < npar; ++k) {
-                    par_out(row, col, k) = res(k);
+                // Levenberg-Marquardt first if enabled, Minuit2 only runs
+                // for the pixels where it fails
+                unsigned int n_calls = 0;
+                bool ok = false;
+                if (model.use_lm()) {
+                    ok = fit_pixel_lm(model, lm_opt, x, values, errors, lm,
+                                      seed);
+                    n_calls += lm.n_calls;
+                    if (ok) {
+                        std::copy(lm.par.begin(), lm.par.end(), par);
+                        err = lm.err;
+                        chi2_out(row, col) = lm.chi2;
+                    }
+                }
+                for (int attempt = 0; !ok && attempt < (seed ? 2 : 1);
+                     ++attempt) {
+                    ok = fit_pixel_minuit_into<Model, FCN>(
+                        model, upar_local, x, values, errors,
+                        attempt == 0 ? seed : nullptr, par,
+                        want_par_errors ? err.data() : nullptr,
+                        chi2_out(row, col), n_calls);
                 }
 
                 if (want_par_errors) {
-                    for (std::size_t k = 0; k < npar; ++k) {
-                        err_out(row, col, k) = res(npar + k);
-                    }
-                    chi2_out(row, col) = res(2 * npar);
-                } else {
-                    chi2_out(row, col) = res(npar);
+                    for (std::size_t k = 0; k < npar; ++k)
+                        err_out(row, col, k) = err[k];
+                }
+                left_ok = ok;
+
+                if (want_stats) {
+                    stats_out(row, col, FitStat::calls) = n_calls;
+                    stats_out(row, col, FitStat::failed) = !ok;
+                    stats_out(row, col, FitStat::seconds) =
+                        std::chrono::duration<double>(clock::now() - t0)
+                            .count();
                 }
             }
         }
     };
 
-    auto tasks = split_task(0, static_cast<int>(y.shape(0)), n_threads);
-    RunInParallel(process, tasks);
+    RunInParallelDynamic(process, 0, static_cast<int>(y.shape(0)), 1,
+                         n_threads);
+}
+
+/**
+ * @brief Fit all pixels of an accumulated scan with fit_3d. The counts per
+ * frame of each step are fitted with their Poisson errors, see
+ * ScanAccumulator::fill_block, so steps with different numbers of frames do
+ * not bias the fit.
+ *
+ * The counts are converted to double block_rows rows at a time, so only one
+ * block of y and y_err is held in memory next to the integer counts of the
+ * ScanAccumulator.
+ *
+ * @param model      Fit configuration shared by all pixels.
+ * @param scan       Accumulated scan, its scan points are used as x.
+ * @param par_out    Output parameters, shape `(rows, cols, npar)`.
+ * @param err_out    Output parameter errors, shape `(rows, cols, npar)`.
+ * @param chi2_out   Output chi-squared values, shape `(rows, cols)`.
+ * @param n_threads  Number of threads fitting rows.
+ * @param block_rows Number of rows converted and fitted at a time.
+ */
+template <typename Model, typename FCN>
+void fit_scan(const FitModel<Model> &model, const ScanAccumulator &scan,
+              NDView<double, 3> par_out, NDView<double, 3> err_out,
+              NDView<double, 2> chi2_out, int n_threads,
+              ssize_t block_rows = 64) {
+    constexpr std::size_t npar = Model::npar;
+    const std::array<ssize_t, 3> par_shape{scan.rows(), scan.cols(),
+                                           static_cast<ssize_t>(npar)};
+    if (par_out.shape() != par_shape || err_out.shape() != par_shape)
+        throw std::runtime_error(
+            "fit_scan: par_out and err_out must have shape [rows, cols, "
+            "npar].");
+    if (chi2_out.shape(0) != scan.rows() || chi2_out.shape(1) != scan.cols())
+        throw std::runtime_error("fit_scan: chi2_out must have shape [rows, "
+                                 "cols].");
+
+    block_rows = std::clamp<ssize_t>(block_rows, 1, scan.rows());
+    NDArray<double, 3> y({block_rows, scan.cols(), scan.n_steps()});
+    NDArray<double, 3> y_err(y.shape());
+
+    for (ssize_t first = 0; first < scan.rows(); first += block_rows) {
+        const ssize_t last = std::min(first + block_rows, scan.rows());
+        auto y_block = y.view().sub_view(0, last - first);
+        auto y_err_block = y_err.view().sub_view(0, last - first);
+        scan.fill_block(first, last, y_block, y_err_block);
+        fit_3d<Model, FCN>(model, scan.scan_points().view(), y_block,
+                           y_err_block, par_out.sub_view(first, last),
+                           err_out.sub_view(first, last),
+                           chi2_out.sub_view(first, last), n_threads);
+    }
 }
 
 } // namespace aare
\ No newline at end of file
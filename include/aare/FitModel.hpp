@@ -15,6 +15,8 @@ template <typename Model> class FitModel {
     unsigned int max_calls_;
     double tolerance_;
     bool compute_errors_;
+    bool use_lm_{false};
+    bool warm_start_{false};
 
     std::array<bool, Model::npar> user_fixed_{};
     std::array<bool, Model::npar> user_start_{};
@@ -124,12 +126,37 @@ template <typename Model> class FitModel {
     void SetTolerance(double t) { tolerance_ = t; }
     void SetComputeErrors(bool b) { compute_errors_ = b; }
 
+    /**
+     * @brief Fit with the built in Levenberg-Marquardt solver first and only
+     * fall back to Minuit2 for pixels where it does not converge.
+     */
+    void SetUseLM(bool b) { use_lm_ = b; }
+
+    /**
+     * @brief In fit_3d start each pixel from the result of its left
+     * neighbour in the same row if that fit succeeded, instead of the
+     * automatic estimate. Fixed parameters keep their value.
+     */
+    void SetWarmStart(bool b) { warm_start_ = b; }
+
     // accessors
     const ROOT::Minuit2::MnUserParameters &upar() const { return upar_; }
     const ROOT::Minuit2::MnStrategy &strategy() const { return strategy_; }
     unsigned int max_calls() const { return max_calls_; }
     double tolerance() const { return tolerance_; }
     bool compute_errors() const { return compute_errors_; }
+    bool use_lm() const { return use_lm_; }
+    bool warm_start() const { return warm_start_; }
+
+    /** @brief True if any parameter is fixed or has limits.*/
+    bool has_constraints() const {
+        for (std::size_t i = 0; i < npar; ++i) {
+            const auto &p = upar_.Parameter(i);
+            if (p.IsFixed() || p.HasLowerLimit() || p.HasUpperLimit())
+                return true;
+        }
+        return false;
+    }
     bool is_user_fixed(unsigned int idx) const { return user_fixed_[idx]; }
     bool is_user_start(unsigned int idx) const { return user_start_[idx]; }
 };
@@ -7,10 +7,13 @@
 
 #pragma once
 #include "aare/Cluster.hpp"
+#include "aare/ClusterArrays.hpp"
 #include "aare/ClusterVector.hpp"
 #include "aare/NDArray.hpp"
 #include "aare/NDView.hpp"
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace aare {
 
@@ -62,6 +65,46 @@ class InvertedGainMap {
         }
     }
 
+    /**
+     * @brief Same as apply_gain_map for a ClusterVector, but for clusters
+     * stored as ClusterArrays. Works on one pixel plane at a time.
+     */
+    template <typename ClusterType,
+              typename = std::enable_if_t<is_cluster_v<ClusterType>>>
+    void apply_gain_map(ClusterArrays<ClusterType> &clusters) {
+        using T = typename ClusterType::value_type;
+        const int64_t cluster_size_x = clusters.cluster_size_x();
+        const int64_t index_cluster_center_x = cluster_size_x / 2;
+        const int64_t index_cluster_center_y = clusters.cluster_size_y() / 2;
+        const auto *xs = clusters.x_data();
+        const auto *ys = clusters.y_data();
+
+        // edge clusters are cleared
+        std::vector<uint8_t> inside(clusters.size());
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            inside[i] = xs[i] > 0 && ys[i] > 0 &&
+                        xs[i] < m_gain_map.shape(1) - 1 &&
+                        ys[i] < m_gain_map.shape(0) - 1;
+        }
+
+        for (size_t k = 0; k < ClusterArrays<ClusterType>::n_pixels; ++k) {
+            const auto pixel = static_cast<int64_t>(k);
+            const int64_t dx = pixel % cluster_size_x - index_cluster_center_x;
+            const int64_t dy = pixel / cluster_size_x - index_cluster_center_y;
+            T *plane = clusters.pixel_data(k);
+            for (size_t i = 0; i < clusters.size(); ++i) {
+                if (inside[i]) {
+                    // cast after conversion to keep precision
+                    plane[i] = static_cast<T>(
+                        static_cast<double>(plane[i]) *
+                        m_gain_map(ys[i] + dy, xs[i] + dx));
+                } else {
+                    plane[i] = 0;
+                }
+            }
+        }
+    }
+
   private:
     NDArray<double, 2> m_gain_map{};
 };
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include "aare/CalculateEta.hpp"
+#include "aare/ClusterFile.hpp"
+#include "aare/ClusterVector.hpp"
+#include "aare/Interpolator.hpp"
+#include "aare/NDArray.hpp"
+#include "aare/utils/par.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace aare {
+
+/**
+ * @brief Super-resolution image of interpolated photon positions. Clusters
+ * are interpolated and binned straight into the image, without building the
+ * intermediate list of photons. Each thread fills its own partial image; the
+ * partial images are summed in values().
+ */
+class InterpolatedImage {
+    ssize_t m_rows;
+    ssize_t m_cols;
+    int m_subpixels;
+    double m_emin;
+    double m_emax;
+    int m_n_threads;
+
+    std::vector<NDArray<uint32_t, 2>> m_partial_images;
+    std::vector<size_t> m_partial_photons;
+
+  public:
+    /**
+     * @brief Construct an empty image
+     * @param rows number of detector rows
+     * @param cols number of detector columns
+     * @param subpixels number of image pixels per detector pixel along each
+     * axis, the image has shape (rows * subpixels, cols * subpixels)
+     * @param emin photons with energy below emin are skipped
+     * @param emax photons with energy at or above emax are skipped
+     * @param n_threads number of threads used by fill()
+     * @throws std::invalid_argument if rows, cols, subpixels or n_threads
+     * are not positive or the energy window is empty
+     */
+    InterpolatedImage(ssize_t rows, ssize_t cols, int subpixels,
+                      double emin = std::numeric_limits<double>::lowest(),
+                      double emax = std::numeric_limits<double>::max(),
+                      int n_threads = 1);
+
+    /**
+     * @brief Interpolate all clusters with `interpolator` and add the photons
+     * inside the energy window and the image to it. Clusters with eta values
+     * out of bounds of the eta distribution are skipped.
+     */
+    template <auto EtaFunction = calculate_eta2, typename ClusterType,
+              typename Enable = std::enable_if_t<is_cluster_v<ClusterType>>>
+    void fill(const Interpolator &interpolator,
+              const ClusterVector<ClusterType> &clusters);
+
+    /**
+     * @brief fill() with all remaining clusters of `file`, read in chunks of
+     * chunk_size clusters. The next chunk is read while the current one is
+     * being filled.
+     */
+    template <auto EtaFunction = calculate_eta2, typename ClusterType>
+    void fill_from_file(const Interpolator &interpolator,
+                        ClusterFile<ClusterType> &file,
+                        size_t chunk_size = 100000);
+
+    /**
+     * @brief Sum of the partial images, shape (rows * subpixels,
+     * cols * subpixels)
+     */
+    NDArray<uint32_t, 2> values() const;
+
+    /**
+     * @brief Number of photons added to the image so far
+     */
+    size_t n_photons() const;
+
+    void clear();
+
+    int subpixels() const { return m_subpixels; }
+    double emin() const { return m_emin; }
+    double emax() const { return m_emax; }
+};
+
+template <auto EtaFunction, typename ClusterType, typename Enable>
+void InterpolatedImage::fill(const Interpolator &interpolator,
+                             const ClusterVector<ClusterType> &clusters) {
+    const double scale = static_cast<double>(m_subpixels);
+    const double image_rows = static_cast<double>(m_rows * m_subpixels);
+    const double image_cols = static_cast<double>(m_cols * m_subpixels);
+
+    auto process = [&](int thread_id, int first, int last) {
+        auto &image = m_partial_images[thread_id];
+        size_t n_photons = 0;
+        for (int i = first; i < last; ++i) {
+            Photon photon;
+            if (!interpolator.try_interpolate<EtaFunction>(
+                    clusters[static_cast<size_t>(i)], photon) ||
+                !(photon.energy >= m_emin && photon.energy < m_emax)) {
+                continue;
+            }
+            // photon.x is along the columns and photon.y along the rows
+            const double col = std::floor(photon.x * scale);
+            const double row = std::floor(photon.y * scale);
+            if (!(row >= 0 && row < image_rows && col >= 0 &&
+                  col < image_cols)) {
+                continue;
+            }
+            ++image(static_cast<ssize_t>(row), static_cast<ssize_t>(col));
+            ++n_photons;
+        }
+        m_partial_photons[thread_id] += n_photons;
+    };
+
+    RunInParallelIndexed(process, 0, static_cast<int>(clusters.size()),
+                         m_n_threads);
+}
+
+template <auto EtaFunction, typename ClusterType>
+void InterpolatedImage::fill_from_file(const Interpolator &interpolator,
+                                       ClusterFile<ClusterType> &file,
+                                       size_t chunk_size) {
+    RunWithReadAhead(
+        [&file, chunk_size]() { return file.read_clusters(chunk_size); },
+        [&](const ClusterVector<ClusterType> &clusters) {
+            fill<EtaFunction>(interpolator, clusters);
+        });
+}
+
+} // namespace aare
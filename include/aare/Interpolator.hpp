@@ -8,6 +8,15 @@
 #include "aare/NDArray.hpp"
 #include "aare/NDView.hpp"
 #include "aare/algorithm.hpp"
+#include "aare/utils/par.hpp"
+#include "aare/utils/task.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
 
 namespace aare {
 
@@ -22,6 +31,18 @@ struct Coordinate2D {
     double y{};
 };
 
+/**
+ * @brief Interpolated photons in structure-of-arrays layout, one entry per
+ * cluster. valid(i) is false for clusters whose eta values are out of bounds
+ * of the eta distribution; their x and y are NaN.
+ */
+struct PhotonArrays {
+    NDArray<double, 1> x;
+    NDArray<double, 1> y;
+    NDArray<double, 1> energy;
+    NDArray<bool, 1> valid;
+};
+
 class Interpolator {
 
     /**
@@ -44,6 +65,30 @@ class Interpolator {
     NDArray<double, 1> m_etabinsy;
     NDArray<double, 1> m_energy_bins;
 
+    /**
+     * @brief How to find the bin of a value along one axis. For uniformly
+     * spaced edges the bin index is computed directly, otherwise it falls
+     * back to a binary search over the edges.
+     */
+    struct BinIndex {
+        double first{};
+        double inv_width{};
+        bool uniform{false};
+    };
+
+    BinIndex m_xindex;
+    BinIndex m_yindex;
+    BinIndex m_eindex;
+
+    /**
+     * @brief m_ietax and m_ietay compiled into one float table used by
+     * transform_eta_values. Layout is [energy][eta_x][eta_y][2] with the
+     * x and y values of a bin next to each other, so a lookup touches a
+     * single cache line and all photons of one energy share a compact
+     * block of the table.
+     */
+    std::vector<float> m_lut;
+
   public:
     /**
      * @brief Constructor for the Interpolator class
@@ -52,9 +97,12 @@ class Interpolator {
      * @param xbins bin edges for etaX
      * @param ybins bin edges for etaY
      * @param ebins bin edges for photon energy
+     * @param n_threads number of threads to split the energy bins over when
+     * computing the CDFs
      */
     Interpolator(NDView<double, 3> etacube, NDView<double, 1> xbins,
-                 NDView<double, 1> ybins, NDView<double, 1> ebins);
+                 NDView<double, 1> ybins, NDView<double, 1> ebins,
+                 int n_threads = 1);
 
     /**
      * @brief Constructor for the Interpolator class
@@ -71,8 +119,9 @@ class Interpolator {
      * each energy level
      * @param etacube joint distribution of etaX, etaY and photon energy (first
      * dimension is etaX, second etaY, third photon energy)
+     * @param n_threads number of threads to split the energy bins over
      */
-    void rosenblatttransform(NDView<double, 3> etacube);
+    void rosenblatttransform(NDView<double, 3> etacube, int n_threads = 1);
 
     NDArray<double, 3> get_ietax() { return m_ietax; }
     NDArray<double, 3> get_ietay() { return m_ietay; }
@@ -113,6 +162,44 @@ class Interpolator {
             &clusters,
         const std::vector<Eta2<T>> &etas) const;
 
+    /**
+     * @brief interpolates a single cluster like interpolate() does
+     * @param photon set to the interpolated photon; only its energy is
+     * meaningful if the cluster is out of bounds
+     * @return false if the eta values of the cluster are out of bounds of
+     * the eta distribution
+     */
+    template <auto EtaFunction = calculate_eta2, typename ClusterType,
+              typename Eanble = std::enable_if_t<is_cluster_v<ClusterType>>>
+    bool try_interpolate(const ClusterType &cluster, Photon &photon) const;
+
+    /**
+     * @brief interpolates all clusters like interpolate() but in parallel and
+     * into preallocated arrays. Out of bounds clusters do not throw, they are
+     * flagged in `valid` instead.
+     * @param x, y, energy output photon positions and energies, one entry
+     * per cluster
+     * @param valid set to false for clusters with eta values out of bounds
+     * of the eta distribution (x and y are NaN for those)
+     * @param n_threads number of threads to split the clusters over
+     * @throws std::invalid_argument if an output does not have
+     * clusters.size() entries
+     */
+    template <auto EtaFunction = calculate_eta2, typename ClusterType,
+              typename Eanble = std::enable_if_t<is_cluster_v<ClusterType>>>
+    void interpolate_into(const ClusterVector<ClusterType> &clusters,
+                          NDView<double, 1> x, NDView<double, 1> y,
+                          NDView<double, 1> energy, NDView<bool, 1> valid,
+                          int n_threads = 1) const;
+
+    /**
+     * @brief interpolate_into() with newly allocated output arrays
+     */
+    template <auto EtaFunction = calculate_eta2, typename ClusterType,
+              typename Eanble = std::enable_if_t<is_cluster_v<ClusterType>>>
+    PhotonArrays interpolate_batch(const ClusterVector<ClusterType> &clusters,
+                                   int n_threads = 1) const;
+
     /**
      * @brief transforms the eta values to uniform coordinates based on the CDF
      * ieta_x and ieta_y
@@ -123,6 +210,37 @@ class Interpolator {
     Coordinate2D transform_eta_values(const Eta2<T> &eta) const;
 
   private:
+    /**
+     * @brief Rebuild m_lut from m_ietax and m_ietay. Must be called
+     * whenever they change.
+     */
+    void compile_lut();
+
+    static BinIndex make_bin_index(const NDArray<double, 1> &edges);
+
+    /**
+     * @brief transform_eta_values without the exception: returns false if
+     * the eta values are out of bounds of the eta distribution
+     */
+    template <typename T>
+    bool try_transform_eta_values(const Eta2<T> &eta,
+                                  Coordinate2D &uniform) const;
+
+    /**
+     * @brief offset of the interpolated photon position from the cluster
+     * position, given the uniform coordinates of its eta values
+     */
+    template <auto EtaFunction, typename ClusterType, typename EtaType>
+    static Coordinate2D photon_offset(const EtaType &eta,
+                                      const Coordinate2D &uniform);
+
+    /**
+     * @brief Same result as last_smaller(edges, value) for sorted edges,
+     * in O(1) for uniform bins and O(log n) otherwise.
+     */
+    static size_t find_bin(const NDArray<double, 1> &edges,
+                           const BinIndex &index, double value);
+
     /**
      * @brief bilinear interpolation of the transformed eta values
      * @param ix index of etaX bin
@@ -180,24 +298,43 @@ Interpolator::bilinear_interpolation(const size_t ix, const size_t iy,
     return {ietax_interpolated, ietay_interpolated};
 }
 
-template <typename T>
-Coordinate2D Interpolator::transform_eta_values(const Eta2<T> &eta) const {
+inline size_t Interpolator::find_bin(const NDArray<double, 1> &edges,
+                                     const BinIndex &index, double value) {
+    // Bins are closed on the right: value in (e[i], e[i+1]] gives i,
+    // anything up to e[1] gives 0 and anything above the last edge
+    // (or NaN) gives n - 1, which callers treat as out of bounds.
+    const double *e = edges.data();
+    const auto n = static_cast<size_t>(edges.size());
+    if (n < 2 || !(value <= e[n - 1])) {
+        return n - 1;
+    }
+    if (!index.uniform) {
+        return static_cast<size_t>(std::lower_bound(e + 1, e + n, value) - e) -
+               1;
+    }
+    const double pos = std::ceil((value - index.first) * index.inv_width) - 1;
+    size_t i = pos > 0 ? std::min(static_cast<size_t>(pos), n - 2) : 0;
+    // Correct for rounding when the value sits on an edge.
+    while (i > 0 && e[i] >= value) {
+        --i;
+    }
+    while (e[i + 1] < value) {
+        ++i;
+    }
+    return i;
+}
 
-    // Finding the index of the last element that is smaller
-    // should work fine as long as we have many bins
-    auto ie = last_smaller(m_energy_bins, static_cast<double>(eta.sum));
-    auto ix = last_smaller(m_etabinsx, eta.x);
-    auto iy = last_smaller(m_etabinsy, eta.y);
+template <typename T>
+bool Interpolator::try_transform_eta_values(const Eta2<T> &eta,
+                                            Coordinate2D &uniform) const {
+    auto ie = find_bin(m_energy_bins, m_eindex, static_cast<double>(eta.sum));
+    auto ix = find_bin(m_etabinsx, m_xindex, eta.x);
+    auto iy = find_bin(m_etabinsy, m_yindex, eta.y);
 
     if (static_cast<ssize_t>(ix) >= m_etabinsx.size() - 1 ||
         static_cast<ssize_t>(iy) >= m_etabinsy.size() - 1 ||
         static_cast<ssize_t>(ie) >= m_energy_bins.size() - 1) {
-        throw std::runtime_error(fmt::format(
-            "Eta values (eta.x = {:4f}, eta.y = {:4f}, energy = {}) out of "
-            "bounds of eta distribution with largest values: (eta.x = {:4f}, "
-            "eta.y = {:4f}, energy = {:4f})",
-            eta.x, eta.y, eta.sum, *(m_etabinsx.end() - 1),
-            *(m_etabinsy.end() - 1), *(m_energy_bins.end() - 1)));
+        return false;
     }
 
     // TODO: bilinear interpolation only works if all bins have a size > 1 -
@@ -207,7 +344,64 @@ Coordinate2D Interpolator::transform_eta_values(const Eta2<T> &eta) const {
     // auto [ietax_interpolated, ietay_interpolated] =
     // bilinear_interpolation(ix, iy, ie, eta);
 
-    return Coordinate2D{m_ietax(ix, iy, ie), m_ietay(ix, iy, ie)};
+    const auto n_x = static_cast<size_t>(m_etabinsx.size() - 1);
+    const auto n_y = static_cast<size_t>(m_etabinsy.size() - 1);
+    const float *cell = m_lut.data() + ((ie * n_x + ix) * n_y + iy) * 2;
+    uniform = Coordinate2D{cell[0], cell[1]};
+    return true;
+}
+
+template <typename T>
+Coordinate2D Interpolator::transform_eta_values(const Eta2<T> &eta) const {
+    Coordinate2D uniform{};
+    if (!try_transform_eta_values(eta, uniform)) {
+        throw std::runtime_error(fmt::format(
+            "Eta values (eta.x = {:4f}, eta.y = {:4f}, energy = {}) out of "
+            "bounds of eta distribution with largest values: (eta.x = {:4f}, "
+            "eta.y = {:4f}, energy = {:4f})",
+            eta.x, eta.y, eta.sum, *(m_etabinsx.end() - 1),
+            *(m_etabinsy.end() - 1), *(m_energy_bins.end() - 1)));
+    }
+    return uniform;
+}
+
+template <auto EtaFunction, typename ClusterType, typename EtaType>
+Coordinate2D Interpolator::photon_offset(const EtaType &eta,
+                                         const Coordinate2D &uniform) {
+    if (EtaFunction == &calculate_eta2<typename ClusterType::value_type,
+                                       ClusterType::cluster_size_x,
+                                       ClusterType::cluster_size_y,
+                                       typename ClusterType::coord_type> ||
+        EtaFunction == &calculate_full_eta2<typename ClusterType::value_type,
+                                            ClusterType::cluster_size_x,
+                                            ClusterType::cluster_size_y,
+                                            typename ClusterType::coord_type>) {
+        double dX{}, dY{};
+
+        // TODO: could also chaneg the sign of the eta calculation
+        switch (eta.c) {
+        case corner::cTopLeft:
+            dX = -1.0;
+            dY = -1.0;
+            break;
+        case corner::cTopRight:;
+            dX = 0.0;
+            dY = -1.0;
+            break;
+        case corner::cBottomLeft:
+            dX = -1.0;
+            dY = 0.0;
+            break;
+        case corner::cBottomRight:
+            dX = 0.0;
+            dY = 0.0;
+            break;
+        }
+        // use pixel center + 0.5, eta2 calculates the ratio between bottom
+        // and sum of bottom and top shift by 1 add eta value correctly
+        return Coordinate2D{0.5 + uniform.x + dX, 0.5 + uniform.y + dY};
+    }
+    return uniform;
 }
 
 template <auto EtaFunction, typename ClusterType, typename Enable>
@@ -236,46 +430,10 @@ Interpolator::interpolate(const ClusterVector<ClusterType> &clusters) const {
                 fmt::format("{} for cluster: {}", e.what(), cluster_index));
         }
 
-        if (EtaFunction == &calculate_eta2<typename ClusterType::value_type,
-                                           ClusterType::cluster_size_x,
-                                           ClusterType::cluster_size_y,
-                                           typename ClusterType::coord_type> ||
-            EtaFunction ==
-                &calculate_full_eta2<typename ClusterType::value_type,
-                                     ClusterType::cluster_size_x,
-                                     ClusterType::cluster_size_y,
-                                     typename ClusterType::coord_type>) {
-            double dX{}, dY{};
-
-            // TODO: could also chaneg the sign of the eta calculation
-            switch (eta.c) {
-            case corner::cTopLeft:
-                dX = -1.0;
-                dY = -1.0;
-                break;
-            case corner::cTopRight:;
-                dX = 0.0;
-                dY = -1.0;
-                break;
-            case corner::cBottomLeft:
-                dX = -1.0;
-                dY = 0.0;
-                break;
-            case corner::cBottomRight:
-                dX = 0.0;
-                dY = 0.0;
-                break;
-            }
-            photon.x = photon.x + 0.5 + uniform_coordinates.x +
-                       dX; // use pixel center + 0.5
-            photon.y =
-                photon.y + 0.5 + uniform_coordinates.y +
-                dY; // eta2 calculates the ratio between bottom and sum of
-                    // bottom and top  shift by 1 add eta value correctly
-        } else {
-            photon.x += uniform_coordinates.x;
-            photon.y += uniform_coordinates.y;
-        }
+        const auto offset =
+            photon_offset<EtaFunction, ClusterType>(eta, uniform_coordinates);
+        photon.x += offset.x;
+        photon.y += offset.y;
 
         ++cluster_index;
 
@@ -285,6 +443,75 @@ Interpolator::interpolate(const ClusterVector<ClusterType> &clusters) const {
     return photons;
 }
 
+template <auto EtaFunction, typename ClusterType, typename Enable>
+bool Interpolator::try_interpolate(const ClusterType &cluster,
+                                   Photon &photon) const {
+    const auto eta = EtaFunction(cluster);
+    photon.energy = static_cast<decltype(photon.energy)>(eta.sum);
+
+    Coordinate2D uniform_coordinates{};
+    if (!try_transform_eta_values(eta, uniform_coordinates)) {
+        return false;
+    }
+    const auto offset =
+        photon_offset<EtaFunction, ClusterType>(eta, uniform_coordinates);
+    photon.x = static_cast<double>(cluster.x) + offset.x;
+    photon.y = static_cast<double>(cluster.y) + offset.y;
+    return true;
+}
+
+template <auto EtaFunction, typename ClusterType, typename Enable>
+void Interpolator::interpolate_into(const ClusterVector<ClusterType> &clusters,
+                                    NDView<double, 1> x, NDView<double, 1> y,
+                                    NDView<double, 1> energy,
+                                    NDView<bool, 1> valid,
+                                    int n_threads) const {
+    const auto n_clusters = static_cast<ssize_t>(clusters.size());
+    if (x.size() != n_clusters || y.size() != n_clusters ||
+        energy.size() != n_clusters || valid.size() != n_clusters) {
+        throw std::invalid_argument(fmt::format(
+            "Output arrays must have one entry per cluster ({})", n_clusters));
+    }
+
+    // Each thread writes a disjoint range of the outputs, so no
+    // synchronisation is needed beyond the join.
+    auto process = [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            Photon photon;
+            valid[i] = try_interpolate<EtaFunction>(
+                clusters[static_cast<size_t>(i)], photon);
+            energy[i] = photon.energy;
+            if (!valid[i]) {
+                x[i] = std::numeric_limits<double>::quiet_NaN();
+                y[i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            x[i] = photon.x;
+            y[i] = photon.y;
+        }
+    };
+
+    if (n_threads <= 1) {
+        process(0, static_cast<int>(n_clusters));
+        return;
+    }
+    RunInParallel(process,
+                  split_task(0, static_cast<int>(n_clusters), n_threads));
+}
+
+template <auto EtaFunction, typename ClusterType, typename Enable>
+PhotonArrays
+Interpolator::interpolate_batch(const ClusterVector<ClusterType> &clusters,
+                                int n_threads) const {
+    const std::array<ssize_t, 1> shape{static_cast<ssize_t>(clusters.size())};
+    PhotonArrays photons{NDArray<double, 1>(shape), NDArray<double, 1>(shape),
+                         NDArray<double, 1>(shape), NDArray<bool, 1>(shape)};
+    interpolate_into<EtaFunction>(clusters, photons.x.view(),
+                                  photons.y.view(), photons.energy.view(),
+                                  photons.valid.view(), n_threads);
+    return photons;
+}
+
 template <typename T, uint8_t ClusterSizeX, uint8_t ClusterSizeY,
           typename CoordType, typename Enable>
 std::vector<Photon> Interpolator::interpolate(
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include "aare/Models.hpp"
+#include "aare/NDView.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace aare {
+
+/**
+ * @brief Settings of the Levenberg-Marquardt solver for one model. The
+ * bounds default to Model::param_info, parameters marked as fixed keep
+ * their start value.
+ */
+template <typename Model> struct LMOptions {
+    static constexpr std::size_t npar = Model::npar;
+
+    unsigned int max_iterations{100};
+    unsigned int max_calls{0}; //!< model evaluations, 0 for no limit
+    double tolerance{1e-8}; //!< relative change of chi2 and parameters
+    /** @brief chi2 decrease that counts as converged, e.g. the EDM target
+     * of Minuit2 */
+    double abs_tolerance{0.0};
+    bool compute_errors{false};
+    std::array<bool, npar> fixed{};
+    std::array<double, npar> lower{};
+    std::array<double, npar> upper{};
+
+    LMOptions() {
+        for (std::size_t i = 0; i < npar; ++i) {
+            lower[i] = Model::param_info[i].default_lo;
+            upper[i] = Model::param_info[i].default_hi;
+        }
+    }
+};
+
+template <std::size_t N> struct LMResult {
+    std::array<double, N> par{};
+    std::array<double, N> err{}; //!< only filled if compute_errors is set
+    double chi2{};
+    unsigned int iterations{};
+    unsigned int n_calls{}; //!< model evaluations over all points
+    bool converged{false};
+};
+
+namespace lm {
+
+inline constexpr double lambda_start = 1e-3;
+inline constexpr double lambda_min = 1e-12;
+inline constexpr double lambda_max = 1e10;
+
+/**
+ * @brief Accumulate chi2, J^T W r and J^T W J of the model at par, with W
+ * the 1/sigma^2 weights. Points with sigma == 0 are skipped like in
+ * Chi2Model1DGrad.
+ */
+template <typename Model>
+double accumulate(NDView<double, 1> x, NDView<double, 1> y,
+                  NDView<double, 1> y_err,
+                  const std::array<double, Model::npar> &par,
+                  std::array<double, Model::npar * Model::npar> &jtj,
+                  std::array<double, Model::npar> &jtr) {
+    constexpr std::size_t N = Model::npar;
+    const bool weighted = y_err.size() > 0;
+    jtj.fill(0.0);
+    jtr.fill(0.0);
+    double chi2 = 0.0;
+    double f = 0.0;
+    std::array<double, N> g{};
+    for (ssize_t i = 0; i < x.size(); ++i) {
+        double w = 1.0;
+        if (weighted) {
+            if (y_err[i] == 0.0)
+                continue;
+            w = 1.0 / (y_err[i] * y_err[i]);
+        }
+        Model::eval_and_grad(x[i], par, f, g);
+        const double r = y[i] - f;
+        chi2 += w * r * r;
+        for (std::size_t k = 0; k < N; ++k) {
+            const double wg = w * g[k];
+            jtr[k] += wg * r;
+            for (std::size_t l = 0; l <= k; ++l)
+                jtj[k * N + l] += wg * g[l];
+        }
+    }
+    for (std::size_t k = 0; k < N; ++k)
+        for (std::size_t l = 0; l < k; ++l)
+            jtj[l * N + k] = jtj[k * N + l];
+    return chi2;
+}
+
+template <typename Model>
+double chi2(NDView<double, 1> x, NDView<double, 1> y, NDView<double, 1> y_err,
+            const std::array<double, Model::npar> &par) {
+    const bool weighted = y_err.size() > 0;
+    double sum = 0.0;
+    for (ssize_t i = 0; i < x.size(); ++i) {
+        const double r = y[i] - Model::eval(x[i], par);
+        if (weighted) {
+            if (y_err[i] == 0.0)
+                continue;
+            sum += r * r / (y_err[i] * y_err[i]);
+        } else {
+            sum += r * r;
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief True if par is a stationary point of chi2: for every free parameter
+ * the cosine between the residuals and its Jacobian column is below
+ * tolerance (the gtol test of MINPACK). Parameters on a bound with the
+ * gradient pointing outwards are at a constrained minimum and ignored, as
+ * are parameters the model does not depend on.
+ */
+template <typename Model>
+bool gradient_vanishes(const LMOptions<Model> &opt,
+                       const std::array<double, Model::npar * Model::npar> &jtj,
+                       const std::array<double, Model::npar> &jtr,
+                       const std::array<double, Model::npar> &par,
+                       double chi2) {
+    constexpr std::size_t N = Model::npar;
+    if (!(chi2 > 0.0))
+        return true;
+    for (std::size_t k = 0; k < N; ++k) {
+        const double d = jtj[k * N + k];
+        if (opt.fixed[k] || !(d > 0.0))
+            continue;
+        if ((par[k] <= opt.lower[k] && jtr[k] < 0) ||
+            (par[k] >= opt.upper[k] && jtr[k] > 0))
+            continue;
+        if (!(std::abs(jtr[k]) <= opt.tolerance * std::sqrt(d * chi2)))
+            return false;
+    }
+    return true;
+}
+
+/** @brief In place Cholesky factorisation, false if a is not positive
+ * definite */
+template <std::size_t N> bool cholesky(std::array<double, N * N> &a) {
+    for (std::size_t j = 0; j < N; ++j) {
+        double d = a[j * N + j];
+        for (std::size_t k = 0; k < j; ++k)
+            d -= a[j * N + k] * a[j * N + k];
+        if (!(d > 0.0))
+            return false;
+        d = std::sqrt(d);
+        a[j * N + j] = d;
+        for (std::size_t i = j + 1; i < N; ++i) {
+            double s = a[i * N + j];
+            for (std::size_t k = 0; k < j; ++k)
+                s -= a[i * N + k] * a[j * N + k];
+            a[i * N + j] = s / d;
+        }
+    }
+    return true;
+}
+
+/** @brief Solve L L^T x = b with the factor from cholesky(), in place */
+template <std::size_t N>
+void cholesky_solve(const std::array<double, N * N> &l,
+                    std::array<double, N> &b) {
+    for (std::size_t i = 0; i < N; ++i) {
+        double s = b[i];
+        for (std::size_t k = 0; k < i; ++k)
+            s -= l[i * N + k] * b[k];
+        b[i] = s / l[i * N + i];
+    }
+    for (std::size_t i = N; i-- > 0;) {
+        double s = b[i];
+        for (std::size_t k = i + 1; k < N; ++k)
+            s -= l[k * N + i] * b[k];
+        b[i] = s / l[i * N + i];
+    }
+}
+
+/**
+ * @brief Factorise J^T W J scaled to unit diagonal with the damping lambda
+ * added to the diagonal. Fixed parameters and parameters the model does not
+ * depend on are decoupled so their step is zero.
+ */
+template <std::size_t N>
+bool factorise_scaled(const std::array<double, N * N> &jtj,
+                      const std::array<bool, N> &fixed, double lambda,
+                      std::array<double, N * N> &a,
+                      std::array<double, N> &scale) {
+    for (std::size_t k = 0; k < N; ++k) {
+        const double d = jtj[k * N + k];
+        scale[k] = (fixed[k] || !(d > 0.0)) ? 0.0 : 1.0 / std::sqrt(d);
+    }
+    for (std::size_t k = 0; k < N; ++k) {
+        for (std::size_t l = 0; l < N; ++l)
+            a[k * N + l] = jtj[k * N + l] * scale[k] * scale[l];
+        a[k * N + k] = (scale[k] == 0.0) ? 1.0 : 1.0 + lambda;
+    }
+    return cholesky<N>(a);
+}
+
+/**
+ * @brief Damped Gauss-Newton step. Parameters sitting on a bound that the
+ * step would push further out are held for this step, so the remaining
+ * parameters are solved without them instead of being dragged along by a
+ * clamped one.
+ */
+template <typename Model>
+bool solve_step(const LMOptions<Model> &opt,
+                const std::array<double, Model::npar * Model::npar> &jtj,
+                const std::array<double, Model::npar> &jtr,
+                const std::array<double, Model::npar> &par, double lambda,
+                std::array<double, Model::npar> &step) {
+    constexpr std::size_t N = Model::npar;
+    std::array<double, N * N> a{};
+    std::array<double, N> scale{};
+    std::array<bool, N> held = opt.fixed;
+    for (std::size_t pass = 0; pass <= N; ++pass) {
+        if (!factorise_scaled<N>(jtj, held, lambda, a, scale))
+            return false;
+        for (std::size_t k = 0; k < N; ++k)
+            step[k] = jtr[k] * scale[k];
+        cholesky_solve<N>(a, step);
+
+        bool changed = false;
+        for (std::size_t k = 0; k < N; ++k) {
+            step[k] *= scale[k];
+            if (!held[k] && ((par[k] <= opt.lower[k] && step[k] < 0) ||
+                             (par[k] >= opt.upper[k] && step[k] > 0))) {
+                held[k] = true;
+                changed = true;
+            }
+        }
+        if (!changed)
+            break;
+    }
+    return true;
+}
+
+} // namespace lm
+
+/**
+ * @brief Fit a model to one pixel with the Levenberg-Marquardt algorithm,
+ * using the analytic gradient of Model::eval_and_grad.
+ *
+ * Works on fixed size arrays only, nothing is allocated. Steps that leave
+ * the bounds are clamped, steps to invalid parameters are rejected. If no
+ * step reduces chi2 any more the fit only counts as converged when the
+ * gradient vanishes, a fit that is stuck is reported as not converged.
+ *
+ * @param x scan points
+ * @param y measured values
+ * @param y_err uncertainties, empty view for an unweighted fit
+ * @param start start parameters
+ * @param opt solver settings
+ * @return LMResult, the errors are sqrt(diag((J^T W J)^-1)) at the minimum,
+ * the same definition as Minuit2 uses for chi2 functions (Up = 1)
+ */
+template <typename Model>
+LMResult<Model::npar> lm_fit(NDView<double, 1> x, NDView<double, 1> y,
+                             NDView<double, 1> y_err,
+                             const std::array<double, Model::npar> &start,
+                             const LMOptions<Model> &opt) {
+    constexpr std::size_t N = Model::npar;
+    LMResult<N> result;
+
+    auto &par = result.par;
+    for (std::size_t k = 0; k < N; ++k)
+        par[k] = std::clamp(start[k], opt.lower[k], opt.upper[k]);
+    if (!Model::is_valid(par))
+        return result;
+
+    std::array<double, N * N> jtj{};
+    std::array<double, N * N> a{};
+    std::array<double, N> jtr{};
+    std::array<double, N> scale{};
+    std::array<double, N> step{};
+    std::array<double, N> trial{};
+
+    double chi2 = lm::accumulate<Model>(x, y, y_err, par, jtj, jtr);
+    ++result.n_calls;
+    if (!std::isfinite(chi2))
+        return result;
+    result.chi2 = chi2;
+
+    auto budget_left = [&] {
+        return opt.max_calls == 0 || result.n_calls < opt.max_calls;
+    };
+
+    double lambda = lm::lambda_start;
+    while (result.iterations < opt.max_iterations && budget_left()) {
+        ++result.iterations;
+
+        // increase the damping until the step reduces chi2
+        bool accepted = false;
+        double trial_chi2 = chi2;
+        bool small_step = true;
+        for (; lambda <= lm::lambda_max && budget_left(); lambda *= 10) {
+            if (!lm::solve_step<Model>(opt, jtj, jtr, par, lambda, step))
+                continue;
+
+            small_step = true;
+            for (std::size_t k = 0; k < N; ++k) {
+                trial[k] = std::clamp(par[k] + step[k], opt.lower[k],
+                                      opt.upper[k]);
+                if (std::abs(trial[k] - par[k]) >
+                    opt.tolerance * (std::abs(par[k]) + opt.tolerance))
+                    small_step = false;
+            }
+            if (!Model::is_valid(trial))
+                continue;
+            trial_chi2 = lm::chi2<Model>(x, y, y_err, trial);
+            ++result.n_calls;
+            if (std::isfinite(trial_chi2) && trial_chi2 <= chi2) {
+                accepted = true;
+                break;
+            }
+        }
+
+        // no step reduces chi2 any more, either we are at the minimum or
+        // stuck, e.g. because every step leads to invalid parameters
+        if (!accepted) {
+            result.converged =
+                budget_left() &&
+                lm::gradient_vanishes<Model>(opt, jtj, jtr, par, chi2);
+            break;
+        }
+
+        const bool small_change =
+            chi2 - trial_chi2 <=
+            std::max(opt.tolerance * trial_chi2, opt.abs_tolerance);
+        par = trial;
+        chi2 = lm::accumulate<Model>(x, y, y_err, par, jtj, jtr);
+        ++result.n_calls;
+        lambda = std::max(lambda / 10, lm::lambda_min);
+        if (small_change || small_step) {
+            result.converged = true;
+            break;
+        }
+    }
+    result.chi2 = chi2;
+
+    if (result.converged && opt.compute_errors) {
+        // covariance from the undamped scaled normal matrix
+        if (!lm::factorise_scaled<N>(jtj, opt.fixed, 0.0, a, scale)) {
+            result.converged = false;
+            return result;
+        }
+        for (std::size_t k = 0; k < N; ++k) {
+            std::array<double, N> e{};
+            e[k] = 1.0;
+            lm::cholesky_solve<N>(a, e);
+            result.err[k] = std::sqrt(e[k]) * scale[k];
+        }
+    }
+    return result;
+}
+
+} // namespace aare
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+/*
+Memory resources used by NDArray to allocate its data. Modelled on
+std::pmr::memory_resource but kept minimal. An NDArray remembers the resource
+it was allocated from and returns the memory there, so arrays from different
+resources can be freely mixed and moved around. A resource has to outlive the
+arrays allocated from it.
+
+- AlignedMemoryResource (the default) aligns every allocation to 64 bytes,
+  the size of a cache line and of an AVX-512 register. Optionally large
+  allocations are aligned to 2 MB and marked for transparent huge pages.
+- PoolMemoryResource keeps freed blocks and hands them out again for the next
+  allocation of the same size. Use it when arrays of the same shape are
+  created and destroyed over and over, e.g. frame buffers, to avoid a round
+  trip to malloc (and for large blocks to mmap/munmap) every time.
+*/
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace aare {
+
+/** @brief Alignment of NDArray data, one cache line */
+constexpr size_t default_alignment = 64;
+
+/** @brief Size of a transparent huge page on x86_64 and most aarch64 */
+constexpr size_t huge_page_size = size_t{2} << 20;
+
+class MemoryResource {
+  public:
+    virtual ~MemoryResource() = default;
+
+    /**
+     * @brief Allocate at least bytes with the given alignment (a power of
+     * two). Returns nullptr for bytes == 0.
+     * @throws std::bad_alloc if the memory could not be allocated
+     */
+    void *allocate(size_t bytes, size_t alignment = default_alignment) {
+        return bytes ? do_allocate(bytes, alignment) : nullptr;
+    }
+
+    /**
+     * @brief Return memory obtained from allocate() with the same bytes and
+     * alignment
+     */
+    void deallocate(void *p, size_t bytes,
+                    size_t alignment = default_alignment) noexcept {
+        if (p)
+            do_deallocate(p, bytes, alignment);
+    }
+
+  private:
+    virtual void *do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void *p, size_t bytes,
+                               size_t alignment) noexcept = 0;
+};
+
+/**
+ * @brief Aligned operator new. If huge_page_threshold is not 0, allocations
+ * of at least that many bytes are aligned to and rounded up to a multiple of
+ * huge_page_size and, on Linux, madvise(MADV_HUGEPAGE)'d so the kernel backs
+ * them with transparent huge pages (needs THP set to "madvise" or "always").
+ */
+class AlignedMemoryResource : public MemoryResource {
+    size_t m_alignment;
+    size_t m_huge_page_threshold;
+
+  public:
+    explicit AlignedMemoryResource(size_t alignment = default_alignment,
+                                   size_t huge_page_threshold = 0);
+
+    size_t alignment() const { return m_alignment; }
+    size_t huge_page_threshold() const { return m_huge_page_threshold; }
+
+  private:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes,
+                       size_t alignment) noexcept override;
+    std::pair<size_t, size_t> layout(size_t bytes, size_t alignment) const;
+};
+
+/**
+ * @brief Caches freed blocks by size and alignment and reuses them for the
+ * next allocation of the same size. Blocks are taken from upstream when the
+ * cache has none and returned to it when more than max_cached_bytes would be
+ * kept. Thread safe, a block may be freed on another thread than it was
+ * allocated on.
+ */
+class PoolMemoryResource : public MemoryResource {
+  public:
+    explicit PoolMemoryResource(size_t max_cached_bytes = size_t{256} << 20);
+    PoolMemoryResource(MemoryResource &upstream, size_t max_cached_bytes);
+    PoolMemoryResource(const PoolMemoryResource &) = delete;
+    PoolMemoryResource &operator=(const PoolMemoryResource &) = delete;
+    ~PoolMemoryResource() override;
+
+    /** @brief Return all cached blocks to upstream */
+    void release();
+
+    size_t cached_bytes() const;
+    size_t hits() const;   //!< allocations served from the cache
+    size_t misses() const; //!< allocations forwarded to upstream
+
+  private:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes,
+                       size_t alignment) noexcept override;
+
+    MemoryResource *m_upstream;
+    size_t m_max_cached_bytes;
+    mutable std::mutex m_mutex;
+    // (bytes, alignment) -> free blocks of that layout
+    std::map<std::pair<size_t, size_t>, std::vector<void *>> m_free;
+    size_t m_cached_bytes{};
+    size_t m_hits{};
+    size_t m_misses{};
+};
+
+/** @brief 64 byte aligned resource, the initial default */
+MemoryResource *aligned_memory_resource() noexcept;
+
+/**
+ * @brief 64 byte aligned resource that puts allocations of huge_page_size
+ * and larger on transparent huge pages
+ */
+MemoryResource *huge_page_memory_resource() noexcept;
+
+/** @brief Resource used by NDArrays constructed without one */
+MemoryResource *default_memory_resource() noexcept;
+
+/**
+ * @brief Set the resource used by NDArrays constructed without one, nullptr
+ * restores aligned_memory_resource(). Returns the previous default.
+ */
+MemoryResource *set_default_memory_resource(MemoryResource *resource) noexcept;
+
+} // namespace aare
@@ -0,0 +1,249 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+/*
+Lightweight pipeline telemetry. Classes with a processing pipeline own a
+MetricsRegistry, register their counters, gauges and latency histograms once
+in the constructor and afterwards update them from the hot paths with relaxed
+atomics only; no locks are taken after registration. snapshot() copies the
+current values into a MetricsSnapshot that can be inspected or exported as
+JSON or in the Prometheus text exposition format.
+
+LatencyHistogram uses HDR-style log-linear buckets: values below 16 ns get a
+bucket each, above that every power of two is split into 16 sub-buckets, so
+any recorded value is known to within 1/16 (6.25%) over the full uint64
+range.
+*/
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aare {
+
+using MetricsClock = std::chrono::steady_clock;
+
+/** @brief (name, value) pairs attached to a metric, e.g. {{"thread", "0"}} */
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/** @brief Nanoseconds between `start` and `stop` (default now) */
+inline uint64_t
+elapsed_ns(MetricsClock::time_point start,
+           MetricsClock::time_point stop = MetricsClock::now()) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start)
+            .count());
+}
+
+/** @brief Monotonically increasing count */
+class MetricCounter {
+    std::atomic<uint64_t> m_value{0};
+
+  public:
+    void add(uint64_t n = 1) {
+        m_value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+};
+
+/** @brief Value that can go up and down, e.g. a queue depth */
+class MetricGauge {
+    std::atomic<int64_t> m_value{0};
+
+  public:
+    void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(int64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+};
+
+/** @brief Distribution of durations in nanoseconds */
+class LatencyHistogram {
+  public:
+    static constexpr int sub_bucket_bits = 4;
+    static constexpr size_t sub_buckets = size_t{1} << sub_bucket_bits;
+    static constexpr size_t n_buckets =
+        (64 - sub_bucket_bits + 1) * sub_buckets;
+
+    static size_t bucket_index(uint64_t ns) {
+        if (ns < sub_buckets)
+            return static_cast<size_t>(ns);
+        const int exponent = floor_log2(ns);
+        const auto sub = static_cast<size_t>(
+            (ns >> (exponent - sub_bucket_bits)) & (sub_buckets - 1));
+        return static_cast<size_t>(exponent - sub_bucket_bits + 1) *
+                   sub_buckets +
+               sub;
+    }
+
+    /** @brief Exclusive upper edge of bucket i in nanoseconds */
+    static double bucket_upper(size_t i);
+
+    void record(uint64_t ns) {
+        m_buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (ns > max && !m_max.compare_exchange_weak(
+                               max, ns, std::memory_order_relaxed)) {
+        }
+    }
+    void record(std::chrono::nanoseconds duration) {
+        record(static_cast<uint64_t>(duration.count()));
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return m_sum.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+    uint64_t bucket(size_t i) const {
+        return m_buckets[i].load(std::memory_order_relaxed);
+    }
+
+  private:
+    static int floor_log2(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        int result = 0;
+        while (value >>= 1)
+            ++result;
+        return result;
+#endif
+    }
+
+    std::array<std::atomic<uint64_t>, n_buckets> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+/** @brief Value of a counter or gauge at the time of the snapshot */
+struct MetricValue {
+    std::string name;
+    std::string help;
+    MetricLabels labels;
+    double value{};
+};
+
+/** @brief LatencyHistogram at the time of the snapshot, in seconds */
+struct LatencySummary {
+    std::string name;
+    std::string help;
+    MetricLabels labels;
+    uint64_t count{};
+    double sum{};
+    double max{};
+    // (exclusive upper edge, count) of the non-empty buckets
+    std::vector<std::pair<double, uint64_t>> buckets;
+
+    double mean() const;
+    /**
+     * @brief Upper edge of the bucket holding the q-quantile, clamped to
+     * max. 0 if nothing was recorded.
+     */
+    double quantile(double q) const;
+};
+
+struct MetricsSnapshot {
+    double seconds{}; //!< time since the registry was created
+    std::vector<MetricValue> counters;
+    std::vector<MetricValue> gauges;
+    std::vector<LatencySummary> histograms;
+
+    /**
+     * @brief Sum of the counter or gauge `name` over all its label sets
+     * @throws std::invalid_argument if there is no such metric
+     */
+    double total(const std::string &name) const;
+
+    /**
+     * @throws std::invalid_argument if there is no such histogram
+     */
+    const LatencySummary &histogram(const std::string &name,
+                                    const MetricLabels &labels = {}) const;
+
+    /**
+     * @brief Add the metrics of another snapshot, e.g. to export a cluster
+     * finder and its file sink together
+     */
+    void append(const MetricsSnapshot &other);
+
+    std::string to_json() const;
+    /**
+     * @brief Prometheus text exposition format, every metric name prefixed
+     * with `prefix`. Histograms have a fixed bucket edge at every power of
+     * two nanoseconds from 1 ns to 2^64 ns.
+     */
+    std::string to_prometheus(const std::string &prefix = "aare_") const;
+
+    /**
+     * @brief Write to_json() / to_prometheus() to fname. The file is written
+     * to a temporary name and renamed, so a scraper never reads a partial
+     * file.
+     */
+    void write_json(const std::filesystem::path &fname) const;
+    void write_prometheus(const std::filesystem::path &fname,
+                          const std::string &prefix = "aare_") const;
+};
+
+/**
+ * @brief Owns the metrics of one pipeline. Registration takes a lock and
+ * returns a reference that stays valid for the lifetime of the registry;
+ * updates through it are lock free. Registering the same name and labels
+ * again returns the existing metric.
+ */
+class MetricsRegistry {
+  public:
+    MetricsRegistry();
+    MetricsRegistry(const MetricsRegistry &) = delete;
+    MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+    /**
+     * @throws std::invalid_argument if name is not a valid Prometheus metric
+     * name or is already registered as a different kind of metric
+     */
+    MetricCounter &counter(const std::string &name, const std::string &help,
+                           const MetricLabels &labels = {});
+    /**
+     * @brief Counter of nanoseconds, reported in seconds. By convention the
+     * name ends in _seconds_total.
+     */
+    MetricCounter &duration(const std::string &name, const std::string &help,
+                            const MetricLabels &labels = {});
+    MetricGauge &gauge(const std::string &name, const std::string &help,
+                       const MetricLabels &labels = {});
+    LatencyHistogram &histogram(const std::string &name,
+                                const std::string &help,
+                                const MetricLabels &labels = {});
+
+    MetricsSnapshot snapshot() const;
+
+  private:
+    enum class Kind { Counter, Duration, Gauge, Histogram };
+    struct Entry {
+        Kind kind;
+        std::string name;
+        std::string help;
+        MetricLabels labels;
+        size_t index; //!< into the deque of its kind
+    };
+
+    size_t find_or_add(Kind kind, const std::string &name,
+                       const std::string &help, const MetricLabels &labels);
+
+    mutable std::mutex m_mutex;
+    MetricsClock::time_point m_created;
+    std::vector<Entry> m_entries;
+    // deques never move their elements, so references stay valid
+    std::deque<MetricCounter> m_counters;
+    std::deque<MetricGauge> m_gauges;
+    std::deque<LatencyHistogram> m_histograms;
+};
+
+} // namespace aare
@@ -13,7 +13,11 @@ namespace aare::model {
 inline constexpr double inv_sqrt2 = 0.70710678118654752440;
 inline constexpr double inv_sqrt_2pi = 0.39894228040143267794;
 
-inline double fast_erf(double x) {
+/**
+ * @brief fast_erf with exp(-x^2) supplied by the caller. The models below
+ * need the Gaussian at the same point anyway, this saves the second exp.
+ */
+inline double fast_erf(double x, double exp_mx2) {
     // Abramowitz–Stegun Handbook of Mathematical Functions
     // erf approximation with max error ~1.5e-7, faster than std::erf.
 
@@ -31,11 +35,13 @@ inline double fast_erf(double x) {
     const double t = 1.0 / (1.0 + p * x);
     const double y =
         1.0 -
-        (((((a5 * t + a4) * t + a3) * t + a2) * t + a1) * t) * std::exp(-x * x);
+        (((((a5 * t + a4) * t + a3) * t + a2) * t + a1) * t) * exp_mx2;
 
     return sign * y;
 }
 
+inline double fast_erf(double x) { return fast_erf(x, std::exp(-x * x)); }
+
 /**
  * @brief Per-parameter metadata: name and optional default bounds.
  *
@@ -93,19 +99,21 @@ struct Pol1 {
         {"p1", -no_bound, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         return par[0] + par[1] * x;
     }
 
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         f = par[0] + par[1] * x;
 
         g[0] = 1.0; // df/dp0
         g[1] = x;   // df/dp1
     }
 
-    static bool is_valid([[maybe_unused]] const std::vector<double> &par) {
+    template <typename Par>
+    static bool is_valid([[maybe_unused]] const Par &par) {
         return true; // always valid
     }
 
@@ -159,12 +167,13 @@ struct Pol2 {
         {"p2", -no_bound, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         return par[0] + par[1] * x + par[2] * x * x;
     }
 
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         f = par[0] + par[1] * x + par[2] * x * x;
 
         g[0] = 1.0;   // df/dp0
@@ -172,7 +181,8 @@ struct Pol2 {
         g[2] = x * x; // df/dp2
     }
 
-    static bool is_valid([[maybe_unused]] const std::vector<double> &par) {
+    template <typename Par>
+    static bool is_valid([[maybe_unused]] const Par &par) {
         return true; // always valid
     }
 
@@ -260,7 +270,7 @@ struct Gaussian {
         {"sigma", 1e-12, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         const double A = par[0];
         const double mu = par[1];
         const double sig = par[2];
@@ -270,8 +280,9 @@ struct Gaussian {
         return A * std::exp(-dx * dx * inv_2sig2);
     }
 
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         const double A = par[0];
         const double mu = par[1];
         const double sig = par[2];
@@ -289,7 +300,7 @@ struct Gaussian {
     }
 
     /** @brief Reject degenerate sigma (zero width). */
-    static bool is_valid(const std::vector<double> &par) {
+    template <typename Par> static bool is_valid(const Par &par) {
         return par[2] != 0.0;
     }
 
@@ -383,7 +394,7 @@ struct GaussianErfcPlateau {
         {"sigma", 1e-12, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         const double A = par[0];
         const double S = par[1];
         const double mu = par[2];
@@ -393,13 +404,14 @@ struct GaussianErfcPlateau {
         const double z = dx * inv_sqrt2 / sig;
 
         const double e = std::exp(-z * z);
-        const double step = 0.5 * (1.0 - fast_erf(z));
+        const double step = 0.5 * (1.0 - fast_erf(z, e));
 
         return A * e + S * step;
     }
 
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         const double A = par[0];
         const double S = par[1];
         const double mu = par[2];
@@ -409,7 +421,7 @@ struct GaussianErfcPlateau {
         const double z = dx * inv_sqrt2 / sig;
 
         const double e = std::exp(-z * z);
-        const double step = 0.5 * (1.0 - fast_erf(z));
+        const double step = 0.5 * (1.0 - fast_erf(z, e));
 
         f = A * e + S * step;
 
@@ -427,7 +439,7 @@ struct GaussianErfcPlateau {
     }
 
     /** @brief Reject degenerate or negative width. */
-    static bool is_valid(const std::vector<double> &par) {
+    template <typename Par> static bool is_valid(const Par &par) {
         return par[3] > 0.0;
     }
 
@@ -544,7 +556,7 @@ struct GaussianChargeSharing {
         {"C", -no_bound, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double mu = par[2];
@@ -556,13 +568,14 @@ struct GaussianChargeSharing {
         const double u = dx / sig;
 
         const double G = std::exp(-0.5 * u * u);
-        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2));
+        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2, G));
 
         return p0 - p1 * x + N * (G + C * H);
     }
 
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double mu = par[2];
@@ -574,7 +587,7 @@ struct GaussianChargeSharing {
         const double u = dx / sig;
 
         const double G = std::exp(-0.5 * u * u);
-        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2));
+        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2, G));
 
         f = p0 - p1 * x + N * (G + C * H);
 
@@ -596,7 +609,7 @@ struct GaussianChargeSharing {
         g[5] = N * H;
     }
 
-    static bool is_valid(const std::vector<double> &par) {
+    template <typename Par> static bool is_valid(const Par &par) {
         return par[3] > 0.0;
     }
 
@@ -709,7 +722,7 @@ struct GaussianChargeSharingKb {
         {"kb_frac", -no_bound, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double mu = par[2];
@@ -730,8 +743,8 @@ struct GaussianChargeSharingKb {
         const double G = std::exp(-0.5 * u * u);
         const double Gb = std::exp(-0.5 * ub * ub);
 
-        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2));
-        const double Hb = 0.5 * (1.0 - fast_erf(ub * inv_sqrt2));
+        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2, G));
+        const double Hb = 0.5 * (1.0 - fast_erf(ub * inv_sqrt2, Gb));
 
         const double ka = G + C * H;
         const double kb = Gb + C * Hb;
@@ -739,8 +752,9 @@ struct GaussianChargeSharingKb {
         return p0 - p1 * x + N * (ka + q * kb);
     }
 
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double mu = par[2];
@@ -761,8 +775,8 @@ struct GaussianChargeSharingKb {
         const double G = std::exp(-0.5 * u * u);
         const double Gb = std::exp(-0.5 * ub * ub);
 
-        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2));
-        const double Hb = 0.5 * (1.0 - fast_erf(ub * inv_sqrt2));
+        const double H = 0.5 * (1.0 - fast_erf(u * inv_sqrt2, G));
+        const double Hb = 0.5 * (1.0 - fast_erf(ub * inv_sqrt2, Gb));
 
         const double ka = G + C * H;
         const double kb = Gb + C * Hb;
@@ -807,7 +821,7 @@ struct GaussianChargeSharingKb {
         g[7] = N * kb;
     }
 
-    static bool is_valid(const std::vector<double> &par) {
+    template <typename Par> static bool is_valid(const Par &par) {
         return par[3] > 0.0;
     }
 
@@ -876,7 +890,7 @@ struct RisingScurve {
         {"C", -no_bound, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double p2 = par[2];
@@ -897,8 +911,9 @@ struct RisingScurve {
      *   dS/dp2 = -(1/sqrt(2*pi)) * exp(-z^2) / p3
      *   dS/dp3 = -(1/sqrt(2*pi)) * exp(-z^2) * (x-p2) / p3^2
      */
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double p2 = par[2];
@@ -908,12 +923,12 @@ struct RisingScurve {
 
         const double dx = x - p2;
         const double z = dx * inv_sqrt2 / p3;
-        const double step = 0.5 * (1.0 + fast_erf(z));
+        const double e = std::exp(-z * z);
+        const double step = 0.5 * (1.0 + fast_erf(z, e));
         const double amp = p4 + p5 * dx;
 
         f = (p0 + p1 * x) + step * amp;
 
-        const double e = std::exp(-z * z);
         const double dSdp2 = -inv_sqrt_2pi * e / p3;
         const double dSdp3 = -inv_sqrt_2pi * e * dx / (p3 * p3);
 
@@ -926,7 +941,7 @@ struct RisingScurve {
     }
 
     /** @brief Reject degenerate width (zero transition width). */
-    static bool is_valid(const std::vector<double> &par) {
+    template <typename Par> static bool is_valid(const Par &par) {
         return par[3] != 0.0;
     }
 
@@ -1037,7 +1052,7 @@ struct FallingScurve {
         {"C", -no_bound, no_bound},
     }};
 
-    static double eval(double x, const std::vector<double> &par) {
+    template <typename Par> static double eval(double x, const Par &par) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double p2 = par[2];
@@ -1050,8 +1065,9 @@ struct FallingScurve {
         return (p0 + p1 * x) + step * (p4 + p5 * dx);
     }
 
-    static void eval_and_grad(double x, const std::vector<double> &par,
-                              double &f, std::array<double, npar> &g) {
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
         const double p0 = par[0];
         const double p1 = par[1];
         const double p2 = par[2];
@@ -1061,12 +1077,12 @@ struct FallingScurve {
 
         const double dx = x - p2;
         const double z = dx * inv_sqrt2 / p3;
-        const double step = 0.5 * (1.0 - fast_erf(z));
+        const double e = std::exp(-z * z);
+        const double step = 0.5 * (1.0 - fast_erf(z, e));
         const double amp = p4 + p5 * dx;
 
         f = (p0 + p1 * x) + step * amp;
 
-        const double e = std::exp(-z * z);
         const double dSdp2 = +inv_sqrt_2pi * e / p3; // sign flipped vs rising
         const double dSdp3 = +inv_sqrt_2pi * e * dx / (p3 * p3);
 
@@ -1079,7 +1095,7 @@ struct FallingScurve {
     }
 
     /** @brief Reject degenerate width (zero transition width). */
-    static bool is_valid(const std::vector<double> &par) {
+    template <typename Par> static bool is_valid(const Par &par) {
         return par[3] != 0.0;
     }
 
@@ -1,11 +1,14 @@
 // SPDX-License-Identifier: MPL-2.0
 //
 // Container holding image data, or a time series of image data in contigious
-// memory. Used for all data processing in Aare.
+// memory. Used for all data processing in Aare. The data is allocated from a
+// MemoryResource, by default 64 byte aligned, see MemoryResource.hpp.
 //
 
 #pragma once
+#include "aare/ArrayEval.hpp"
 #include "aare/ArrayExpr.hpp"
+#include "aare/MemoryResource.hpp"
 #include "aare/NDView.hpp"
 
 #include <algorithm>
@@ -15,7 +18,11 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace aare {
 
@@ -24,6 +31,7 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     std::array<ssize_t, Ndim> shape_;
     std::array<ssize_t, Ndim> strides_;
     size_t size_{}; // TODO! do we need to store size when we have shape?
+    MemoryResource *resource_{default_memory_resource()};
     T *data_;
 
   public:
@@ -46,7 +54,18 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      */
     explicit NDArray(std::array<ssize_t, Ndim> shape)
         : shape_(shape), strides_(c_strides<Ndim>(shape_)),
-          size_(num_elements(shape_)), data_(new T[size_]) {}
+          size_(num_elements(shape_)), data_(allocate(size_)) {}
+
+    /**
+     * @brief Construct a new NDArray object with a given shape, allocating
+     * the data from resource instead of the default memory resource. The
+     * resource has to outlive the array.
+     * @note The data is uninitialized.
+     */
+    NDArray(std::array<ssize_t, Ndim> shape, MemoryResource &resource)
+        : shape_(shape), strides_(c_strides<Ndim>(shape_)),
+          size_(num_elements(shape_)), resource_(&resource),
+          data_(allocate(size_)) {}
 
     /**
      * @brief Construct a new NDArray object with a shape and value.
@@ -88,7 +107,7 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      */
     NDArray(NDArray &&other) noexcept
         : shape_(other.shape_), strides_(c_strides<Ndim>(shape_)),
-          size_(other.size_), data_(other.data_) {
+          size_(other.size_), resource_(other.resource_), data_(other.data_) {
         other.reset(); // Needed to avoid double free
     }
 
@@ -101,7 +120,7 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     NDArray(NDArray<T, M> &&other)
         : shape_(drop_first_dim(other.shape())),
           strides_(c_strides<Ndim>(shape_)), size_(num_elements(shape_)),
-          data_(other.data()) {
+          resource_(other.resource_), data_(other.data()) {
 
         // For now only allow move if the size matches, to avoid unreachable
         // data if the use case arises we can remove this check
@@ -116,35 +135,37 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     }
 
     /**
-     * @brief Copy construct a new NDArray object from another NDArray.
+     * @brief Copy construct a new NDArray object from another NDArray. Like
+     * std::pmr containers the copy uses the default memory resource, not the
+     * one of other.
      *
      * @param other
      */
     NDArray(const NDArray &other)
         : shape_(other.shape_), strides_(c_strides<Ndim>(shape_)),
-          size_(other.size_), data_(new T[size_]) {
+          size_(other.size_), data_(allocate(size_)) {
         std::copy(other.data_, other.data_ + size_, data_);
     }
 
     /**
      * @brief Conversion from a ArrayExpr to an actual NDArray. Used when
-     * the expression is evaluated and data needed.
+     * the expression is evaluated and data needed. Large expressions are
+     * evaluated in parallel, see ArrayEval.hpp.
      *
      * @tparam E
      * @param expr
      */
     template <typename E>
     NDArray(ArrayExpr<E, Ndim> &&expr) : NDArray(expr.shape()) {
-        for (size_t i = 0; i < size_; ++i) {
-            data_[i] = expr[i];
-        }
+        T *out = data_;
+        for_each_element(size_, [out, &expr](size_t i) { out[i] = expr[i]; });
     }
 
     /**
      * @brief Destroy the NDArray object. Frees the allocated memory.
      *
      */
-    ~NDArray() { delete[] data_; }
+    ~NDArray() { free_data(); }
 
     ///////////////////////////////////////////////////////////////////////////////
     // Iterators and indexing
@@ -225,6 +246,9 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     /** @brief Return the total number of bytes in the array */
     size_t total_bytes() const { return size_ * sizeof(T); }
 
+    /** @brief Return the resource the data was allocated from */
+    MemoryResource *resource() const noexcept { return resource_; }
+
     /** @brief Return the shape of the array */
     Shape<Ndim> shape() const noexcept { return shape_; }
 
@@ -266,9 +290,9 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     template <size_t Size>
     NDArray<T, 1> &operator=(const std::array<T, Size> &other) {
         if (Size != size_) {
-            delete[] data_;
+            free_data();
             size_ = Size;
-            data_ = new T[size_];
+            data_ = allocate(size_);
         }
         for (size_t i = 0; i < Size; ++i) {
             data_[i] = other[i];
@@ -282,8 +306,9 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     NDArray &operator=(NDArray &&other) noexcept {
         // TODO! Should we use swap?
         if (this != &other) {
-            delete[] data_;
+            free_data();
             data_ = other.data_;
+            resource_ = other.resource_;
             shape_ = other.shape_;
             size_ = other.size_;
             strides_ = other.strides_;
@@ -293,15 +318,20 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     }
 
     /**
-     * @brief Copy assignment operator.
+     * @brief Copy assignment operator. Keeps the current allocation if the
+     * number of elements matches. If the allocation throws the array is left
+     * unchanged.
      */
     NDArray &operator=(const NDArray &other) {
         if (this != &other) {
-            delete[] data_;
+            if (size_ != other.size_) {
+                T *data = allocate(other.size_);
+                free_data();
+                data_ = data;
+                size_ = other.size_;
+            }
             shape_ = other.shape_;
             strides_ = other.strides_;
-            size_ = other.size_;
-            data_ = new T[size_];
             std::copy(other.data_, other.data_ + size_, data_);
         }
         return *this;
@@ -320,9 +350,9 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
             throw(std::runtime_error(
                 "Shape of NDArray must match for operator +="));
 
-        for (size_t i = 0; i < size_; ++i) {
-            data_[i] += other.data_[i];
-        }
+        T *data = data_;
+        const T *src = other.data_;
+        for_each_element(size_, [data, src](size_t i) { data[i] += src[i]; });
         return *this;
     }
 
@@ -334,9 +364,9 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
             throw(std::runtime_error(
                 "Shape of NDArray must match for operator -="));
 
-        for (size_t i = 0; i < size_; ++i) {
-            data_[i] -= other.data_[i];
-        }
+        T *data = data_;
+        const T *src = other.data_;
+        for_each_element(size_, [data, src](size_t i) { data[i] -= src[i]; });
         return *this;
     }
 
@@ -348,9 +378,9 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
             throw(std::runtime_error(
                 "Shape of NDArray must match for operator *="));
 
-        for (size_t i = 0; i < size_; ++i) {
-            data_[i] *= other.data_[i];
-        }
+        T *data = data_;
+        const T *src = other.data_;
+        for_each_element(size_, [data, src](size_t i) { data[i] *= src[i]; });
         return *this;
     }
 
@@ -363,9 +393,10 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     template <typename V> NDArray &operator/=(const NDArray<V, Ndim> &other) {
         // check shape
         if (shape_ == other.shape()) {
-            for (size_t i = 0; i < size_; ++i) {
-                data_[i] /= other(i);
-            }
+            T *data = data_;
+            const V *src = other.data();
+            for_each_element(size_,
+                             [data, src](size_t i) { data[i] /= src[i]; });
             return *this;
         }
         throw(std::runtime_error("Shape of NDArray must match"));
@@ -375,7 +406,8 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      * @brief Assign a scalar value to all elements in the NDArray.
      */
     NDArray &operator=(const T &value) {
-        std::fill_n(data_, size_, value);
+        T *data = data_;
+        for_each_element(size_, [data, value](size_t i) { data[i] = value; });
         return *this;
     }
 
@@ -383,8 +415,8 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      * @brief Add a scalar value to all elements in the NDArray.
      */
     NDArray &operator+=(const T &value) {
-        for (size_t i = 0; i < size_; ++i)
-            data_[i] += value;
+        T *data = data_;
+        for_each_element(size_, [data, value](size_t i) { data[i] += value; });
         return *this;
     }
 
@@ -392,8 +424,8 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      * @brief Subtract a scalar value to all elements in the NDArray.
      */
     NDArray &operator-=(const T &value) {
-        for (size_t i = 0; i < size_; ++i)
-            data_[i] -= value;
+        T *data = data_;
+        for_each_element(size_, [data, value](size_t i) { data[i] -= value; });
         return *this;
     }
 
@@ -401,8 +433,8 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      * @brief Multiply all elements in the NDArray with a scalar value
      */
     NDArray &operator*=(const T &value) {
-        for (size_t i = 0; i < size_; ++i)
-            data_[i] *= value;
+        T *data = data_;
+        for_each_element(size_, [data, value](size_t i) { data[i] *= value; });
         return *this;
     }
 
@@ -410,8 +442,8 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      * @brief Divide all elements in the NDArray with a scalar value
      */
     NDArray &operator/=(const T &value) {
-        for (size_t i = 0; i < size_; ++i)
-            data_[i] /= value;
+        T *data = data_;
+        for_each_element(size_, [data, value](size_t i) { data[i] /= value; });
         return *this;
     }
 
@@ -420,8 +452,8 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      * Used for example to mask out gain bits for Jungfrau detectors.
      */
     NDArray &operator&=(const T &mask) {
-        for (auto it = begin(); it != end(); ++it)
-            *it &= mask;
+        T *data = data_;
+        for_each_element(size_, [data, mask](size_t i) { data[i] &= mask; });
         return *this;
     }
 
@@ -492,17 +524,17 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
      * @brief Compute the square root of all elements in the NDArray.
      */
     void sqrt() {
-        for (size_t i = 0; i < size_; ++i) {
-            data_[i] = std::sqrt(data_[i]);
-        }
+        T *data = data_;
+        for_each_element(size_,
+                         [data](size_t i) { data[i] = std::sqrt(data[i]); });
     }
 
     /*
      * @brief Prefix increment operator. Increments all elements by 1.
      */
     NDArray &operator++() {
-        for (size_t i = 0; i < size_; ++i)
-            data_[i] += T{1};
+        T *data = data_;
+        for_each_element(size_, [data](size_t i) { data[i] += T{1}; });
         return *this;
     }
 
@@ -514,6 +546,36 @@ class NDArray : public ArrayExpr<NDArray<T, Ndim>, Ndim> {
     NDView<T, Ndim> view() const { return NDView<T, Ndim>{data_, shape_}; }
 
   private:
+    // at least a cache line, more if T needs it
+    static constexpr size_t alignment = std::max(default_alignment, alignof(T));
+
+    /**
+     * @brief Allocate and default initialize n elements from resource_,
+     * nullptr for n == 0
+     */
+    T *allocate(size_t n) {
+        auto *ptr =
+            static_cast<T *>(resource_->allocate(n * sizeof(T), alignment));
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            try {
+                std::uninitialized_default_construct_n(ptr, n);
+            } catch (...) {
+                resource_->deallocate(ptr, n * sizeof(T), alignment);
+                throw;
+            }
+        }
+        return ptr;
+    }
+
+    /** @brief Destroy the elements and return the data to resource_ */
+    void free_data() noexcept {
+        if (!data_)
+            return;
+        std::destroy_n(data_, size_);
+        resource_->deallocate(data_, size_ * sizeof(T), alignment);
+        data_ = nullptr;
+    }
+
     /**
      * @brief Reset the NDArray to an empty state. Dropping the ownership of
      * the data. Used internally for move operations to avoid double free or
@@ -587,15 +649,293 @@ NDArray<RT, Ndim> safe_divide(const NDArray<NT, Ndim> &numerator,
             "Shapes of numerator and denominator must match");
     }
     NDArray<RT, Ndim> result(numerator.shape());
-    for (ssize_t i = 0; i < numerator.size(); ++i) {
-        if (denominator[i] != 0) {
-            result[i] =
-                static_cast<RT>(numerator[i]) / static_cast<RT>(denominator[i]);
-        } else {
-            result[i] = RT{0}; // or handle division by zero as needed
-        }
+    RT *out = result.data();
+    const NT *num = numerator.data();
+    const DT *den = denominator.data();
+    for_each_element(static_cast<size_t>(result.size()),
+                     [out, num, den](size_t i) {
+                         // or handle division by zero as needed
+                         out[i] = den[i] != 0 ? static_cast<RT>(num[i]) /
+                                                    static_cast<RT>(den[i])
+                                              : RT{0};
+                     });
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reductions
+//
+// Work on NDArray, NDView and unevaluated expressions like a - b, which are
+// reduced in the same pass without allocating a temporary. Large inputs are
+// reduced in parallel, see ArrayEval.hpp. sum accumulates in int64_t,
+// uint64_t or double, mean and stddev in double. stddev is the population
+// standard deviation (ddof = 0) like numpy.std.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+template <typename E, ssize_t Ndim>
+using expr_value_t =
+    std::decay_t<decltype(std::declval<const ArrayExpr<E, Ndim> &>()[0])>;
+
+template <typename T>
+using sum_t = std::conditional_t<
+    std::is_floating_point_v<T>, double,
+    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+/**
+ * @brief Count, mean and sum of squared deviations of a set of values. Each
+ * chunk is accumulated relative to its first value to avoid cancellation and
+ * chunks are merged with the pairwise update of Chan et al.
+ */
+struct Moments {
+    double count{};
+    double mean{};
+    double m2{};
+
+    static Moments from_shifted(double count, double shift, double sum,
+                                double sum2) {
+        return {count, shift + sum / count, sum2 - sum * sum / count};
     }
+
+    static Moments merge(const Moments &a, const Moments &b) {
+        const double count = a.count + b.count;
+        const double delta = b.mean - a.mean;
+        return {count, a.mean + delta * b.count / count,
+                a.m2 + b.m2 + delta * delta * a.count * b.count / count};
+    }
+
+    double stddev() const { return std::sqrt(std::max(m2, 0.0) / count); }
+};
+
+template <typename E, ssize_t Ndim>
+Moments moments(const ArrayExpr<E, Ndim> &expr, const char *name) {
+    const auto n = static_cast<size_t>(expr.size());
+    if (n == 0)
+        throw std::runtime_error(LOCATION + name + " of an empty array");
+    return reduce_chunks(
+        n, Moments{},
+        [&expr](size_t first, size_t last) {
+            const auto shift = static_cast<double>(expr[first]);
+            double sum = 0.0;
+            double sum2 = 0.0;
+            AARE_PRAGMA_SIMD_REDUCTION(+, sum, sum2)
+            for (size_t i = first; i < last; ++i) {
+                const double d = static_cast<double>(expr[i]) - shift;
+                sum += d;
+                sum2 += d * d;
+            }
+            return Moments::from_shifted(static_cast<double>(last - first),
+                                         shift, sum, sum2);
+        },
+        Moments::merge);
+}
+
+/**
+ * @brief Reduce expr along axis. The input is traversed as (outer, n, inner)
+ * with n the length of axis; every output element (o, k) starts with
+ * init(expr(o, 0, k)), is updated with step(acc, expr(o, j, k)) for j in
+ * [1, n) and written as finish(acc, n). Output chunks are reduced in parallel,
+ * within a chunk the innermost loop runs over contiguous k.
+ */
+template <typename R, typename E, ssize_t Ndim, typename Init, typename Step,
+          typename Finish>
+NDArray<R, Ndim - 1> reduce_axis(const ArrayExpr<E, Ndim> &expr, ssize_t axis,
+                                 Init init, Step step, Finish finish) {
+    static_assert(Ndim > 1, "Use the overload without axis for 1D arrays");
+    const auto shape = expr.shape();
+    if (axis < 0)
+        axis += Ndim;
+    if (axis < 0 || axis >= Ndim)
+        throw std::runtime_error(LOCATION + "Axis out of range");
+    if (shape[axis] == 0)
+        throw std::runtime_error(LOCATION + "Cannot reduce an empty axis");
+
+    Shape<Ndim - 1> out_shape{};
+    size_t outer = 1;
+    size_t inner = 1;
+    for (ssize_t i = 0, j = 0; i < Ndim; ++i) {
+        if (i == axis)
+            continue;
+        out_shape[j++] = shape[i];
+        (i < axis ? outer : inner) *= static_cast<size_t>(shape[i]);
+    }
+    const auto n = static_cast<size_t>(shape[axis]);
+
+    NDArray<R, Ndim - 1> result(out_shape);
+    R *out = result.data();
+    using Acc = decltype(init(expr[0]));
+    for_each_chunk(outer * inner, [&](size_t first, size_t last) {
+        std::vector<Acc> acc(std::min(last - first, inner));
+        for (size_t f = first; f < last;) {
+            const size_t o = f / inner;
+            const size_t k0 = f % inner;
+            const size_t len = std::min(inner - k0, last - f);
+            const size_t base = o * n * inner + k0;
+            for (size_t k = 0; k < len; ++k)
+                acc[k] = init(expr[base + k]);
+            for (size_t j = 1; j < n; ++j) {
+                const size_t row = base + j * inner;
+                AARE_PRAGMA_SIMD
+                for (size_t k = 0; k < len; ++k)
+                    step(acc[k], expr[row + k]);
+            }
+            for (size_t k = 0; k < len; ++k)
+                out[f + k] = finish(acc[k], n);
+            f += len;
+        }
+    });
     return result;
 }
 
+} // namespace detail
+
+/** @brief Sum of all elements */
+template <typename E, ssize_t Ndim> auto sum(const ArrayExpr<E, Ndim> &expr) {
+    using R = detail::sum_t<detail::expr_value_t<E, Ndim>>;
+    return reduce_chunks(
+        static_cast<size_t>(expr.size()), R{},
+        [&expr](size_t first, size_t last) {
+            R acc{};
+            AARE_PRAGMA_SIMD_REDUCTION(+, acc)
+            for (size_t i = first; i < last; ++i)
+                acc += static_cast<R>(expr[i]);
+            return acc;
+        },
+        std::plus<R>());
+}
+
+/**
+ * @brief Smallest element
+ * @throws std::runtime_error if the array is empty
+ */
+template <typename E, ssize_t Ndim> auto min(const ArrayExpr<E, Ndim> &expr) {
+    using V = detail::expr_value_t<E, Ndim>;
+    if (expr.size() == 0)
+        throw std::runtime_error(LOCATION + "min of an empty array");
+    return reduce_chunks(
+        static_cast<size_t>(expr.size()), V{},
+        [&expr](size_t first, size_t last) {
+            V acc = expr[first];
+            AARE_PRAGMA_SIMD_REDUCTION(min, acc)
+            for (size_t i = first + 1; i < last; ++i) {
+                const V v = expr[i];
+                acc = v < acc ? v : acc;
+            }
+            return acc;
+        },
+        [](V a, V b) { return b < a ? b : a; });
+}
+
+/**
+ * @brief Largest element
+ * @throws std::runtime_error if the array is empty
+ */
+template <typename E, ssize_t Ndim> auto max(const ArrayExpr<E, Ndim> &expr) {
+    using V = detail::expr_value_t<E, Ndim>;
+    if (expr.size() == 0)
+        throw std::runtime_error(LOCATION + "max of an empty array");
+    return reduce_chunks(
+        static_cast<size_t>(expr.size()), V{},
+        [&expr](size_t first, size_t last) {
+            V acc = expr[first];
+            AARE_PRAGMA_SIMD_REDUCTION(max, acc)
+            for (size_t i = first + 1; i < last; ++i) {
+                const V v = expr[i];
+                acc = v > acc ? v : acc;
+            }
+            return acc;
+        },
+        [](V a, V b) { return b > a ? b : a; });
+}
+
+/**
+ * @brief Mean of all elements
+ * @throws std::runtime_error if the array is empty
+ */
+template <typename E, ssize_t Ndim>
+double mean(const ArrayExpr<E, Ndim> &expr) {
+    return detail::moments(expr, "mean").mean;
+}
+
+/**
+ * @brief Population standard deviation of all elements, computed in a single
+ * pass
+ * @throws std::runtime_error if the array is empty
+ */
+template <typename E, ssize_t Ndim>
+double stddev(const ArrayExpr<E, Ndim> &expr) {
+    return detail::moments(expr, "stddev").stddev();
+}
+
+/**
+ * @brief Sum along axis, e.g. sum(frames, 0) of a (frames, rows, cols) stack
+ * gives a (rows, cols) image. Negative axes count from the end.
+ * @throws std::runtime_error if axis is out of range or empty
+ */
+template <typename E, ssize_t Ndim>
+auto sum(const ArrayExpr<E, Ndim> &expr, ssize_t axis) {
+    using R = detail::sum_t<detail::expr_value_t<E, Ndim>>;
+    return detail::reduce_axis<R>(
+        expr, axis, [](auto v) { return static_cast<R>(v); },
+        [](R &acc, auto v) { acc += static_cast<R>(v); },
+        [](R acc, size_t) { return acc; });
+}
+
+/** @brief Minimum along axis */
+template <typename E, ssize_t Ndim>
+auto min(const ArrayExpr<E, Ndim> &expr, ssize_t axis) {
+    using V = detail::expr_value_t<E, Ndim>;
+    return detail::reduce_axis<V>(
+        expr, axis, [](V v) { return v; },
+        [](V &acc, V v) { acc = v < acc ? v : acc; },
+        [](V acc, size_t) { return acc; });
+}
+
+/** @brief Maximum along axis */
+template <typename E, ssize_t Ndim>
+auto max(const ArrayExpr<E, Ndim> &expr, ssize_t axis) {
+    using V = detail::expr_value_t<E, Ndim>;
+    return detail::reduce_axis<V>(
+        expr, axis, [](V v) { return v; },
+        [](V &acc, V v) { acc = v > acc ? v : acc; },
+        [](V acc, size_t) { return acc; });
+}
+
+/** @brief Mean along axis */
+template <typename E, ssize_t Ndim>
+NDArray<double, Ndim - 1> mean(const ArrayExpr<E, Ndim> &expr,
+                               ssize_t axis) {
+    return detail::reduce_axis<double>(
+        expr, axis, [](auto v) { return static_cast<double>(v); },
+        [](double &acc, auto v) { acc += static_cast<double>(v); },
+        [](double acc, size_t n) { return acc / static_cast<double>(n); });
+}
+
+/**
+ * @brief Population standard deviation along axis, mean and spread are
+ * accumulated in the same pass relative to the first value along the axis
+ */
+template <typename E, ssize_t Ndim>
+NDArray<double, Ndim - 1> stddev(const ArrayExpr<E, Ndim> &expr,
+                                 ssize_t axis) {
+    struct Acc {
+        double shift, sum, sum2;
+    };
+    return detail::reduce_axis<double>(
+        expr, axis,
+        [](auto v) { return Acc{static_cast<double>(v), 0.0, 0.0}; },
+        [](Acc &acc, auto v) {
+            const double d = static_cast<double>(v) - acc.shift;
+            acc.sum += d;
+            acc.sum2 += d * d;
+        },
+        [](const Acc &acc, size_t n) {
+            return detail::Moments::from_shifted(static_cast<double>(n),
+                                                 acc.shift, acc.sum, acc.sum2)
+                .stddev();
+        });
+}
+
 } // namespace aare
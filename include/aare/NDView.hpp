@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: MPL-2.0
 #pragma once
+#include "aare/ArrayEval.hpp"
 #include "aare/ArrayExpr.hpp"
 #include "aare/defs.hpp"
 
@@ -167,8 +168,8 @@ class NDView : public ArrayExpr<NDView<T, Ndim>, Ndim> {
     }
 
     NDView &operator=(const T val) {
-        for (auto it = begin(); it != end(); ++it)
-            *it = val;
+        T *data = buffer_;
+        for_each_element(size_, [data, val](size_t i) { data[i] = val; });
         return *this;
     }
 
@@ -224,16 +225,19 @@ class NDView : public ArrayExpr<NDView<T, Ndim>, Ndim> {
 
     template <class BinaryOperation>
     NDView &elemenwise(T val, BinaryOperation op) {
-        for (uint64_t i = 0; i != size_; ++i) {
-            buffer_[i] = op(buffer_[i], val);
-        }
+        T *data = buffer_;
+        for_each_element(size_, [data, val, op](size_t i) {
+            data[i] = op(data[i], val);
+        });
         return *this;
     }
     template <class BinaryOperation>
     NDView &elemenwise(const NDView &other, BinaryOperation op) {
-        for (uint64_t i = 0; i != size_; ++i) {
-            buffer_[i] = op(buffer_[i], other.buffer_[i]);
-        }
+        T *data = buffer_;
+        const T *src = other.buffer_;
+        for_each_element(size_, [data, src, op](size_t i) {
+            data[i] = op(data[i], src[i]);
+        });
         return *this;
     }
 };
@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include "aare/LMFit.hpp"
+#include "aare/NDView.hpp"
+#include "aare/utils/par.hpp"
+#include "aare/utils/task.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace aare {
+
+namespace poly {
+
+/**
+ * @brief Matrix T with par_x = T * par_t for a polynomial in
+ * t = (x - offset) / scale, used to map the fit in the centered variable
+ * back to the coefficients of x.
+ */
+template <std::size_t N>
+std::array<double, N * N> back_transform(double offset, double scale) {
+    // (x - offset)^k / scale^k = sum_j binom(k, j) x^j (-offset)^(k-j)
+    std::array<double, N * N> t{};
+    for (std::size_t k = 0; k < N; ++k) {
+        double binom = 1.0;
+        for (std::size_t j = 0; j <= k; ++j) {
+            if (j > 0)
+                binom = binom * static_cast<double>(k - j + 1) /
+                        static_cast<double>(j);
+            t[j * N + k] = binom * std::pow(-offset, static_cast<int>(k - j)) /
+                           std::pow(scale, static_cast<int>(k));
+        }
+    }
+    return t;
+}
+
+/**
+ * @brief Parameters of x from the normal equations in the centered variable,
+ * l is the Cholesky factor of A^T W A
+ */
+template <std::size_t N>
+void coefficients(const std::array<double, N * N> &l,
+                  const std::array<double, N * N> &transform,
+                  std::array<double, N> &par_t, double *par) {
+    lm::cholesky_solve<N>(l, par_t);
+    for (std::size_t j = 0; j < N; ++j) {
+        par[j] = 0.0;
+        for (std::size_t k = 0; k < N; ++k)
+            par[j] += transform[j * N + k] * par_t[k];
+    }
+}
+
+/**
+ * @brief Parameter errors of x, the diagonal of cov_x = T cov_t T^T with
+ * cov_t = (A^T W A)^-1, l is the Cholesky factor of A^T W A
+ */
+template <std::size_t N>
+void errors(const std::array<double, N * N> &l,
+            const std::array<double, N * N> &transform, double *err) {
+    std::array<double, N * N> cov{};
+    for (std::size_t k = 0; k < N; ++k) {
+        std::array<double, N> e{};
+        e[k] = 1.0;
+        lm::cholesky_solve<N>(l, e);
+        for (std::size_t i = 0; i < N; ++i)
+            cov[i * N + k] = e[i];
+    }
+    for (std::size_t j = 0; j < N; ++j) {
+        double var = 0.0;
+        for (std::size_t k = 0; k < N; ++k)
+            for (std::size_t i = 0; i < N; ++i)
+                var += transform[j * N + k] * cov[k * N + i] *
+                       transform[j * N + i];
+        err[j] = std::sqrt(var);
+    }
+}
+
+} // namespace poly
+
+/**
+ * @brief Weighted linear least squares fit of a polynomial to every pixel,
+ * solved in closed form from the normal equations instead of iterating.
+ *
+ * Gives the minimum of the same chi2 as fit_3d with Pol1 (Degree 1) or Pol2
+ * (Degree 2): parameters p0..pDegree, errors sqrt(diag((A^T W A)^-1)) and
+ * chi2 = sum_i w_i (y_i - f(x_i))^2, with w_i = 1/y_err_i^2 and points with
+ * y_err == 0 skipped, or w_i = 1 for an empty y_err.
+ *
+ * The fit is done in the centered and scaled variable
+ * t = (x - mean) / (range / 2) for numerical stability. Without weights A^T A
+ * is the same for all pixels and is factorised once, each pixel then only
+ * needs Degree + 1 dot products of its contiguous scan with the precomputed
+ * powers of t.
+ *
+ * Pixels with a singular normal matrix, for example with fewer valid points
+ * than parameters, get zero parameters and chi2 and are flagged in
+ * singular_out.
+ *
+ * @param x scan points, shape (n_scan)
+ * @param y data, shape (rows, cols, n_scan)
+ * @param y_err uncertainties with the shape of y, or empty
+ * @param par_out output parameters, shape (rows, cols, Degree + 1)
+ * @param err_out output errors, shape (rows, cols, Degree + 1), or empty to
+ * skip the errors
+ * @param chi2_out output chi2, shape (rows, cols)
+ * @param n_threads number of threads to split the rows over
+ * @param singular_out set to true for the pixels without a solution, false
+ * otherwise, shape (rows, cols), or empty
+ */
+template <std::size_t Degree>
+void fit_polynomial_3d(NDView<double, 1> x, NDView<double, 3> y,
+                       NDView<double, 3> y_err, NDView<double, 3> par_out,
+                       NDView<double, 3> err_out, NDView<double, 2> chi2_out,
+                       int n_threads, NDView<bool, 2> singular_out = {}) {
+    constexpr std::size_t N = Degree + 1;
+    const ssize_t n_scan = x.size();
+
+    if (n_scan != y.shape(2))
+        throw std::runtime_error(
+            "fit_polynomial_3d: x.size() must match y.shape(2).");
+    if (par_out.shape(0) != y.shape(0) || par_out.shape(1) != y.shape(1) ||
+        par_out.shape(2) != static_cast<ssize_t>(N))
+        throw std::runtime_error("par_out must have shape [rows, cols, npar].");
+    if (chi2_out.shape(0) != y.shape(0) || chi2_out.shape(1) != y.shape(1))
+        throw std::runtime_error("chi2_out must have shape [rows, cols].");
+
+    const bool weighted = y_err.size() > 0;
+    const bool want_errors = err_out.size() > 0;
+    if (weighted && y_err.shape() != y.shape())
+        throw std::runtime_error(
+            "fit_polynomial_3d: y and y_err must have identical shape.");
+    if (want_errors && err_out.shape() != par_out.shape())
+        throw std::runtime_error("err_out must have shape [rows, cols, npar].");
+    const bool want_singular = singular_out.size() > 0;
+    if (want_singular && (singular_out.shape(0) != y.shape(0) ||
+                          singular_out.shape(1) != y.shape(1)))
+        throw std::runtime_error("singular_out must have shape [rows, cols].");
+
+    // nothing to fit without scan points
+    if (n_scan == 0) {
+        for (ssize_t row = 0; row < y.shape(0); ++row) {
+            for (ssize_t col = 0; col < y.shape(1); ++col) {
+                for (std::size_t k = 0; k < N; ++k) {
+                    par_out(row, col, k) = 0.0;
+                    if (want_errors)
+                        err_out(row, col, k) = 0.0;
+                }
+                chi2_out(row, col) = 0.0;
+                if (want_singular)
+                    singular_out(row, col) = true;
+            }
+        }
+        return;
+    }
+
+    // powers of the centered scan points, power k of point i at k*n_scan+i
+    double x_min = x[0], x_max = x[0], x_mean = 0.0;
+    for (ssize_t i = 0; i < n_scan; ++i) {
+        x_min = std::min(x_min, x[i]);
+        x_max = std::max(x_max, x[i]);
+        x_mean += x[i];
+    }
+    x_mean /= static_cast<double>(n_scan);
+    const double x_scale = (x_max > x_min) ? 0.5 * (x_max - x_min) : 1.0;
+    std::vector<double> powers(2 * Degree * n_scan + n_scan, 1.0);
+    for (std::size_t k = 1; k <= 2 * Degree; ++k)
+        for (ssize_t i = 0; i < n_scan; ++i)
+            powers[k * n_scan + i] =
+                powers[(k - 1) * n_scan + i] * (x[i] - x_mean) / x_scale;
+    const auto transform = poly::back_transform<N>(x_mean, x_scale);
+
+    // without weights the normal matrix and the errors only depend on x
+    std::array<double, N * N> l_shared{};
+    for (std::size_t j = 0; j < N; ++j)
+        for (std::size_t k = 0; k < N; ++k)
+            for (ssize_t i = 0; i < n_scan; ++i)
+                l_shared[j * N + k] += powers[(j + k) * n_scan + i];
+    const bool shared_ok = lm::cholesky<N>(l_shared);
+    std::array<double, N> err_shared{};
+    if (shared_ok)
+        poly::errors<N>(l_shared, transform, err_shared.data());
+
+    auto process = [&](int first_row, int last_row) {
+        std::array<double, N> par_t{};
+        std::array<double, 2 * Degree + 1> moments{};
+        std::array<double, N * N> l{};
+        std::array<double, N> err{};
+
+        for (ssize_t row = first_row; row < last_row; ++row) {
+            for (ssize_t col = 0; col < y.shape(1); ++col) {
+                const double *values = &y(row, col, 0);
+                const double *sigma = weighted ? &y_err(row, col, 0) : nullptr;
+                double *par = &par_out(row, col, 0);
+
+                bool solved = shared_ok;
+                if (weighted) {
+                    moments.fill(0.0);
+                    par_t.fill(0.0);
+                    for (ssize_t i = 0; i < n_scan; ++i) {
+                        if (sigma[i] == 0.0)
+                            continue;
+                        const double w = 1.0 / (sigma[i] * sigma[i]);
+                        for (std::size_t k = 0; k <= 2 * Degree; ++k)
+                            moments[k] += w * powers[k * n_scan + i];
+                        for (std::size_t k = 0; k < N; ++k)
+                            par_t[k] += w * values[i] * powers[k * n_scan + i];
+                    }
+                    for (std::size_t j = 0; j < N; ++j)
+                        for (std::size_t k = 0; k < N; ++k)
+                            l[j * N + k] = moments[j + k];
+                    solved = lm::cholesky<N>(l);
+                    if (solved && want_errors)
+                        poly::errors<N>(l, transform, err.data());
+                } else {
+                    // A^T y as dot products with the contiguous scan
+                    for (std::size_t k = 0; k < N; ++k) {
+                        const double *p = &powers[k * n_scan];
+                        double sum = 0.0;
+                        for (ssize_t i = 0; i < n_scan; ++i)
+                            sum += values[i] * p[i];
+                        par_t[k] = sum;
+                    }
+                }
+
+                if (!solved) {
+                    for (std::size_t k = 0; k < N; ++k) {
+                        par[k] = 0.0;
+                        if (want_errors)
+                            err_out(row, col, k) = 0.0;
+                    }
+                    chi2_out(row, col) = 0.0;
+                    if (want_singular)
+                        singular_out(row, col) = true;
+                    continue;
+                }
+                if (want_singular)
+                    singular_out(row, col) = false;
+                poly::coefficients<N>(weighted ? l : l_shared, transform,
+                                      par_t, par);
+                if (want_errors) {
+                    const auto &e = weighted ? err : err_shared;
+                    for (std::size_t k = 0; k < N; ++k)
+                        err_out(row, col, k) = e[k];
+                }
+
+                // chi2 from the residuals, more accurate than from the sums
+                double chi2 = 0.0;
+                for (ssize_t i = 0; i < n_scan; ++i) {
+                    double f = 0.0;
+                    for (std::size_t k = 0; k < N; ++k)
+                        f += par_t[k] * powers[k * n_scan + i];
+                    const double r = values[i] - f;
+                    if (!weighted) {
+                        chi2 += r * r;
+                    } else if (sigma[i] != 0.0) {
+                        chi2 += r * r / (sigma[i] * sigma[i]);
+                    }
+                }
+                chi2_out(row, col) = chi2;
+            }
+        }
+    };
+
+    auto tasks = split_task(0, static_cast<int>(y.shape(0)), n_threads);
+    RunInParallel(process, tasks);
+}
+
+} // namespace aare
@@ -35,6 +35,13 @@ class RawFile : public FileInterface {
     /// @brief Geometries e.g. number of modules, size etc. for each ROI
     std::vector<ROIGeometry> m_ROI_geometries;
 
+    // scratch space of get_frame_into, kept between frames to not allocate
+    // for every frame
+    std::vector<size_t> m_frame_numbers;
+    std::vector<size_t> m_frame_indices;
+    std::vector<std::byte> m_part_buffer;
+    std::vector<DetectorHeader> m_header_buffer;
+
   public:
     /**
      * @brief RawFile constructor
@@ -49,6 +56,39 @@ class RawFile : public FileInterface {
     Frame read_frame(size_t frame_number) override;
     std::vector<Frame> read_n(size_t n_frames) override;
 
+    /**
+     * @brief Read the next n_frames frames into one contiguous array of
+     * shape (n_frames, rows, cols). The modules are synced once for the
+     * whole batch and each subfile is read sequentially.
+     * @tparam T pixel type, sizeof(T) has to match bytes_per_pixel()
+     * @param n_frames number of frames to read
+     * @param header optional, space for n_frames * n_modules() headers,
+     * stored frame after frame
+     * @throws std::runtime_error if multiple ROIs are defined, T does not
+     * match the bitdepth or less than n_frames frames are left in the file
+     */
+    template <typename T>
+    NDArray<T, 3> read_n_array(size_t n_frames,
+                               DetectorHeader *header = nullptr) {
+        if (num_rois() > 1) {
+            throw std::runtime_error(LOCATION +
+                                     "Cannot use read_n_array for multiple "
+                                     "ROIs. Use read_rois_into() instead.");
+        }
+        if (sizeof(T) != bytes_per_pixel()) {
+            throw std::runtime_error(
+                LOCATION + fmt::format("Pixel type of {} bytes does not match "
+                                       "the {} bytes per pixel of the file",
+                                       sizeof(T), bytes_per_pixel()));
+        }
+        NDArray<T, 3> frames(
+            {static_cast<ssize_t>(n_frames), static_cast<ssize_t>(rows()),
+             static_cast<ssize_t>(cols())});
+        read_frames_into(reinterpret_cast<std::byte *>(frames.data()),
+                         n_frames, header);
+        return frames;
+    }
+
     /**
      * @brief Read one ROI defined in the master file
      * @param roi_index index of the ROI to read
@@ -64,6 +104,24 @@ class RawFile : public FileInterface {
      */
     std::vector<Frame> read_rois();
 
+    /**
+     * @brief Read the next n_frames frames of all ROIs into caller owned
+     * buffers, e.g. one NDArray per ROI that is allocated once and reused
+     * for every call. Each frame is read ROI after ROI before moving on to
+     * the next one, so every subfile is read sequentially.
+     * @param roi_buffers one buffer per ROI, buffer r holds n_frames frames
+     * of bytes_per_frame(r) bytes one after the other
+     * @param n_frames number of frames to read
+     * @param roi_headers optional, one buffer per ROI with space for
+     * n_frames * n_modules_in_roi()[r] headers
+     * @throws std::runtime_error if no ROIs are defined, the number of
+     * buffers does not match num_rois() or less than n_frames frames are
+     * left in the file
+     */
+    void read_rois_into(const std::vector<std::byte *> &roi_buffers,
+                        size_t n_frames = 1,
+                        const std::vector<DetectorHeader *> &roi_headers = {});
+
     /**
      * @brief Read n frames for the given ROI index
      * @param n_frames number of frames to read
@@ -159,6 +217,26 @@ class RawFile : public FileInterface {
         size_t frame_index, std::byte *frame_buffer, const size_t roi_index = 0,
         DetectorHeader *header = nullptr); // TODO read_into updates it!!!!
 
+    /**
+     * @brief find the index of the frame in each subfile of the ROI that
+     * belongs to the frame at frame_index, result in m_frame_indices
+     */
+    void sync_frame_indices(size_t frame_index, const size_t roi_index);
+
+    /**
+     * @brief read the next frame of one module from its subfile and place
+     * it in the frame buffer
+     */
+    void read_module_into(const size_t roi_index, const size_t part_idx,
+                          std::byte *frame_buffer, DetectorHeader *header);
+
+    /**
+     * @brief read n_frames frames of the first ROI starting at the current
+     * frame, reading each subfile sequentially if the modules stay in sync
+     */
+    void read_frames_into(std::byte *image_buf, size_t n_frames,
+                          DetectorHeader *header);
+
     /**
      * @brief get the frame at the given frame index
      * @param frame_number frame number to read
@@ -7,6 +7,7 @@
 #include <filesystem>
 #include <map>
 #include <optional>
+#include <vector>
 
 namespace aare {
 
@@ -40,6 +41,8 @@ class RawSubFile {
     uint32_t m_pos_col{};
 
     std::optional<NDArray<ssize_t, 2>> m_pixel_map;
+    std::vector<std::byte> m_map_buffer; //!< raw frame before applying the
+                                         //!< pixel map
 
   public:
     /**
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+
+#include "aare/NDArray.hpp"
+#include "aare/NDView.hpp"
+#include "aare/RawFile.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace aare {
+
+/**
+ * @brief Per pixel counts of a threshold or energy scan, accumulated one
+ * scan step at a time.
+ *
+ * Only integer counts are kept, indexed (step, row, col) so that adding a
+ * frame is a contiguous pass. The double precision data and Poisson errors
+ * needed for fitting are produced per block of rows by fill_block(), see
+ * fit_scan() in Fit.hpp, instead of holding the full y and y_err cubes.
+ */
+class ScanAccumulator {
+    NDArray<double, 1> m_scan_points;
+    NDArray<uint32_t, 3> m_counts;   // (step, row, col)
+    NDArray<uint32_t, 1> m_n_frames; // frames added per step
+
+    template <typename T>
+    void add_frames_from(RawFile &file, size_t step, size_t n_frames,
+                         size_t batch_size);
+
+  public:
+    /**
+     * @brief Construct an empty scan
+     * @param rows number of rows of the frames
+     * @param cols number of columns of the frames
+     * @param scan_points threshold or energy of each scan step
+     * @throws std::invalid_argument if the frame size is not positive or
+     * there are no scan points
+     */
+    ScanAccumulator(ssize_t rows, ssize_t cols, NDView<double, 1> scan_points);
+
+    /**
+     * @brief Add the counts of one frame to scan step `step`. Counts
+     * saturate at the maximum of uint32_t.
+     * @throws std::invalid_argument if the frame shape does not match or
+     * step is out of range
+     */
+    template <typename T> void add_frame(size_t step, NDView<T, 2> frame);
+
+    /**
+     * @brief Add the next n_frames frames of `file` to scan step `step`.
+     * Frames are read in batches of batch_size, the next batch is read
+     * while the current one is being added.
+     * @throws std::invalid_argument if the frame size of the file does not
+     * match, or for pixel types other than 8, 16 or 32 bit
+     */
+    void add_frames(size_t step, RawFile &file, size_t n_frames,
+                    size_t batch_size = 100);
+
+    /**
+     * @brief Counts per frame of rows [first_row, last_row) as y and their
+     * Poisson errors as y_err, count / n and sqrt(max(count, 1)) / n for the
+     * n frames of each step. Both have shape (last_row - first_row, cols,
+     * n_steps) as expected by fit_3d. Steps without frames get y and y_err
+     * 0, which the weighted fits skip.
+     */
+    void fill_block(ssize_t first_row, ssize_t last_row, NDView<double, 3> y,
+                    NDView<double, 3> y_err) const;
+
+    /** @brief Accumulated counts indexed (step, row, col) */
+    const NDArray<uint32_t, 3> &counts() const { return m_counts; }
+    const NDArray<uint32_t, 1> &n_frames() const { return m_n_frames; }
+    const NDArray<double, 1> &scan_points() const { return m_scan_points; }
+
+    ssize_t n_steps() const { return m_counts.shape(0); }
+    ssize_t rows() const { return m_counts.shape(1); }
+    ssize_t cols() const { return m_counts.shape(2); }
+
+    void clear();
+};
+
+template <typename T>
+void ScanAccumulator::add_frame(size_t step, NDView<T, 2> frame) {
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T> &&
+                      sizeof(T) <= sizeof(uint32_t),
+                  "ScanAccumulator only accumulates unsigned integer counts "
+                  "of up to 32 bit");
+    if (frame.shape(0) != rows() || frame.shape(1) != cols()) {
+        throw std::invalid_argument(
+            "ScanAccumulator: frame shape does not match");
+    }
+    if (step >= static_cast<size_t>(n_steps())) {
+        throw std::invalid_argument("ScanAccumulator: step out of range");
+    }
+    uint32_t *counts = &m_counts(step, 0, 0);
+    const T *values = frame.data();
+    for (ssize_t i = 0; i < frame.size(); ++i) {
+        const auto value = static_cast<uint32_t>(values[i]);
+        const uint32_t sum = counts[i] + value;
+        counts[i] = sum < value ? std::numeric_limits<uint32_t>::max() : sum;
+    }
+    ++m_n_frames[step];
+}
+
+} // namespace aare
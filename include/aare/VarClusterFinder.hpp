@@ -2,15 +2,32 @@
 #pragma once
 
 #include <algorithm>
-#include <map>
-#include <unordered_map>
+#include <array>
+#include <thread>
 #include <vector>
 
 #include "aare/NDArray.hpp"
+#include "aare/defs.hpp"
+#include "aare/utils/task.hpp"
 
 const int MAX_CLUSTER_SIZE = 50;
 namespace aare {
 
+/**
+ * @brief Finds clusters of any size as connected regions of pixels above
+ * threshold.
+ *
+ * find_clusters() labels the image in two passes over run-length encoded
+ * rows: the first pass finds the runs of pixels above threshold and joins
+ * overlapping runs of neighbouring rows in an array based union-find, the
+ * second pass resolves the labels. Regions are 8-connected and numbered from
+ * 1 in the order of their first pixel (row major). With set_n_threads() the
+ * first pass runs on horizontal strips of the image in parallel and the
+ * strips are joined at their seams. All buffers are kept between frames.
+ *
+ * find_clusters_X() grows each cluster from its first pixel with an explicit
+ * stack, zeroing the pixels it has taken in the image.
+ */
 template <typename T> class VarClusterFinder {
   public:
     struct Hit {
@@ -29,36 +46,57 @@ template <typename T> class VarClusterFinder {
     };
 
   private:
+    // pixels [start, end) of a row above threshold
+    struct Run {
+        int row;
+        int start;
+        int end;
+        int label;
+    };
+
+    // Runs and union-find of a strip of rows. Labels are local to the strip
+    // and start at 0, parent[label] == label for the roots.
+    struct Strip {
+        std::vector<Run> runs;
+        std::vector<int> parent;
+        int first_row{};
+        int last_row{};
+        int label_offset{};
+    };
+
+    // stack entry of find_clusters_X, k is the next neighbour to look at
+    struct Seed {
+        int row;
+        int col;
+        int k;
+    };
+
     const std::array<ssize_t, 2> shape_;
     NDView<T, 2> original_;
     NDArray<int, 2> labeled_;
-    NDArray<int, 2> peripheral_labeled_;
-    NDArray<bool, 2> binary_; // over threshold flag
     T threshold_;
     NDView<T, 2> noiseMap;
     bool use_noise_map = false;
     int peripheralThresholdFactor_ = 5;
-    int current_label;
-    const std::array<int, 4> di{
-        {0, -1, -1, -1}}; // row ### 8-neighbour by scaning from left to right
-    const std::array<int, 4> dj{
-        {-1, -1, 0, 1}}; // col ### 8-neighbour by scaning from top to bottom
+    int current_label{};
+    int n_regions_{};
+    int n_threads_ = 1;
     const std::array<int, 8> di_{{0, 0, -1, 1, -1, 1, -1, 1}}; // row
     const std::array<int, 8> dj_{{-1, 1, 0, 0, 1, -1, -1, 1}}; // col
-    std::map<int, int> child;   // heirachy: key: child; val: parent
     int numberOfNeighbours = 8; // 4 or 8
     bool empty_surroundingPixels =
         true; // whether to set peripheral pixels to 0, to avoid potential
               // influence for pedestal updating
-    std::unordered_map<int, Hit> h_size;
+    std::vector<Strip> strips_;
+    std::vector<int> parent_;      // union-find over all labels of a frame
+    std::vector<int> final_label_; // root label -> label in labeled_
+    std::vector<Seed> stack_;
     std::vector<Hit> hits;
-    // std::vector<std::vector<int16_t>> row
-    int check_neighbours(int i, int j);
 
   public:
     VarClusterFinder(Shape<2> shape, T threshold)
-        : shape_(shape), labeled_(shape, 0), peripheral_labeled_(shape, 0),
-          binary_(shape), threshold_(threshold) {
+        : shape_(shape), labeled_(shape, 0), threshold_(threshold),
+          strips_(1) {
         hits.reserve(2000);
     }
 
@@ -81,9 +119,24 @@ template <typename T> class VarClusterFinder {
     void set_empty_surroundingPixels(bool empty) {
         empty_surroundingPixels = empty;
     }
+
+    /**
+     * @brief Number of threads used for the first pass of find_clusters().
+     * The result does not depend on it.
+     */
+    void set_n_threads(int n_threads) {
+        if (n_threads < 1)
+            throw std::invalid_argument(
+                LOCATION + "number of threads should be at least 1");
+        n_threads_ = n_threads;
+    }
+    int n_threads() const { return n_threads_; }
+
     void find_clusters(NDView<T, 2> img);
     void find_clusters_X(NDView<T, 2> img);
-    void rec_FillHit(int clusterIndex, int i, int j);
+    /**
+     * @brief Label img without storing the clusters
+     */
     void single_pass(NDView<T, 2> img);
     void first_pass();
     void second_pass();
@@ -98,8 +151,9 @@ template <typename T> class VarClusterFinder {
 
     void print_connections() {
         fmt::print("Connections:\n");
-        for (auto it = child.begin(); it != child.end(); ++it) {
-            fmt::print("{} -> {}\n", it->first, it->second);
+        for (size_t label = 1; label < parent_.size(); ++label) {
+            if (parent_[label] != static_cast<int>(label))
+                fmt::print("{} -> {}\n", label, parent_[label]);
         }
     }
     size_t total_clusters() const {
@@ -108,229 +162,256 @@ template <typename T> class VarClusterFinder {
     }
 
   private:
-    void add_link(int from, int to) {
-        // we want to add key from -> value to
-        // fmt::print("add_link({},{})\n", from, to);
-        auto it = child.find(from);
-        if (it == child.end()) {
-            child[from] = to;
-        } else {
-            // found need to disambiguate
-            if (it->second == to)
-                return;
-            else {
-                if (it->second > to) {
-                    // child[from] = to;
-                    auto old = it->second;
-                    it->second = to;
-                    add_link(old, to);
-                } else {
-                    // found value is smaller than what we want to link
-                    add_link(to, it->second);
-                }
-            }
-        }
-    }
-};
-template <typename T> int VarClusterFinder<T>::check_neighbours(int i, int j) {
-    std::vector<int> neighbour_labels;
-
-    for (int k = 0; k < 4; ++k) {
-        const auto row = i + di[k];
-        const auto col = j + dj[k];
-        if (row >= 0 && col >= 0 && row < shape_[0] && col < shape_[1]) {
-            auto tmp = labeled_(i + di[k], j + dj[k]);
-            if (tmp != 0)
-                neighbour_labels.push_back(tmp);
+    static int find_root(std::vector<int> &parent, int label) {
+        while (parent[label] != label) {
+            parent[label] = parent[parent[label]]; // path halving
+            label = parent[label];
         }
+        return label;
     }
 
-    if (neighbour_labels.size() == 0) {
-        return 0;
-    } else {
-
-        // need to sort and add to union field
-        std::sort(neighbour_labels.rbegin(), neighbour_labels.rend());
-        auto first = neighbour_labels.begin();
-        auto last = std::unique(first, neighbour_labels.end());
-        if (last - first == 1)
-            return *neighbour_labels.begin();
-
-        for (auto current = first; current != last - 1; ++current) {
-            auto next = current + 1;
-            add_link(*current, *next);
-        }
-        return neighbour_labels.back(); // already sorted
+    // the root is always the smaller label, i.e. the one seen first
+    static void join(std::vector<int> &parent, int a, int b) {
+        a = find_root(parent, a);
+        b = find_root(parent, b);
+        if (a < b)
+            parent[b] = a;
+        else if (b < a)
+            parent[a] = b;
     }
-}
+
+    // calls function(strip) for all strips, on one thread per strip
+    template <typename Function> void for_each_strip(Function &&function);
+    void label_strip(Strip &strip);
+    void add_pixel(Hit &hit, int i, int j, bool capped);
+    void fill_hit(Hit &hit, int i, int j);
+};
 
 template <typename T>
 void VarClusterFinder<T>::find_clusters(NDView<T, 2> img) {
     original_ = img;
-    labeled_ = 0;
-    peripheral_labeled_ = 0;
-    current_label = 0;
-    child.clear();
     first_pass();
-    // print_connections();
     second_pass();
     store_clusters();
 }
 
-template <typename T>
-void VarClusterFinder<T>::find_clusters_X(NDView<T, 2> img) {
+template <typename T> void VarClusterFinder<T>::single_pass(NDView<T, 2> img) {
     original_ = img;
-    int clusterIndex = 0;
-    for (int i = 0; i < shape_[0]; ++i) {
-        for (int j = 0; j < shape_[1]; ++j) {
-            if (use_noise_map)
-                threshold_ = 5 * noiseMap(i, j);
-            if (original_(i, j) > threshold_) {
-                // printf("========== Cluster index: %d\n", clusterIndex);
-                rec_FillHit(clusterIndex, i, j);
-                clusterIndex++;
+    first_pass();
+    second_pass();
+}
+
+template <typename T> void VarClusterFinder<T>::label_strip(Strip &strip) {
+    strip.runs.clear();
+    strip.parent.clear();
+    size_t previous_row = 0; // first run of the previous row
+    for (int i = strip.first_row; i < strip.last_row; ++i) {
+        const size_t current_row = strip.runs.size();
+        const T *row = &original_(i, 0);
+        const int n_cols = static_cast<int>(shape_[1]);
+        int j = 0;
+        while (j < n_cols) {
+            const T threshold =
+                use_noise_map ? 5 * noiseMap(i, j) : threshold_;
+            if (!(row[j] > threshold)) {
+                ++j;
+                continue;
+            }
+            Run run{i, j, j + 1, -1};
+            for (++j; j < n_cols; ++j) {
+                const T t = use_noise_map ? 5 * noiseMap(i, j) : threshold_;
+                if (!(row[j] > t))
+                    break;
             }
+            run.end = j;
+
+            // the runs of both rows are sorted, so the runs of the previous
+            // row ending before this one can be skipped for the following
+            // runs as well
+            while (previous_row < current_row &&
+                   strip.runs[previous_row].end < run.start)
+                ++previous_row;
+            for (size_t p = previous_row;
+                 p < current_row && strip.runs[p].start <= run.end; ++p) {
+                if (run.label < 0)
+                    run.label = strip.runs[p].label;
+                else
+                    join(strip.parent, run.label, strip.runs[p].label);
+            }
+            if (run.label < 0) {
+                run.label = static_cast<int>(strip.parent.size());
+                strip.parent.push_back(run.label);
+            }
+            strip.runs.push_back(run);
         }
+        previous_row = current_row;
     }
-    for (const auto &h : h_size)
-        hits.push_back(h.second);
-    h_size.clear();
 }
 
 template <typename T>
-void VarClusterFinder<T>::rec_FillHit(int clusterIndex, int i, int j) {
-    // printf("original_(%d, %d)=%f\n", i, j, original_(i,j));
-    // printf("h_size[%d].size=%d\n", clusterIndex, h_size[clusterIndex].size);
-    if (h_size[clusterIndex].size < MAX_CLUSTER_SIZE) {
-        h_size[clusterIndex].rows[h_size[clusterIndex].size] = i;
-        h_size[clusterIndex].cols[h_size[clusterIndex].size] = j;
-        h_size[clusterIndex].enes[h_size[clusterIndex].size] = original_(i, j);
+template <typename Function>
+void VarClusterFinder<T>::for_each_strip(Function &&function) {
+    if (strips_.size() == 1) {
+        function(strips_[0]);
+        return;
     }
-    h_size[clusterIndex].size += 1;
-    h_size[clusterIndex].energy += original_(i, j);
-    if (h_size[clusterIndex].max < original_(i, j)) {
-        h_size[clusterIndex].row = i;
-        h_size[clusterIndex].col = j;
-        h_size[clusterIndex].max = original_(i, j);
+    std::vector<std::thread> threads;
+    for (auto &strip : strips_) {
+        threads.emplace_back([&function, &strip]() { function(strip); });
     }
-    original_(i, j) = 0;
-
-    for (int k = 0; k < numberOfNeighbours; ++k) { //
-        const auto row = i + di_[k];
-        const auto col = j + dj_[k];
-        if (row >= 0 && col >= 0 && row < shape_[0] && col < shape_[1]) {
-            if (use_noise_map)
-                threshold_ = peripheralThresholdFactor_ * noiseMap(row, col);
-            if (original_(row, col) > threshold_) {
-                rec_FillHit(clusterIndex, row, col);
-            } else {
-                // if (h_size[clusterIndex].size < MAX_CLUSTER_SIZE){
-                //     h_size[clusterIndex].size += 1;
-                //     h_size[clusterIndex].rows[h_size[clusterIndex].size] =
-                //     row; h_size[clusterIndex].cols[h_size[clusterIndex].size]
-                //     = col;
-                //     h_size[clusterIndex].enes[h_size[clusterIndex].size] =
-                //     original_(row, col);
-                // }// ? weather to include peripheral pixels
-                if (empty_surroundingPixels) {
-                    original_(row, col) =
-                        0; // remove peripheral pixels, to avoid potential
-                           // influence for pedestal updating
-                }
-            }
-        }
+    for (auto &thread : threads) {
+        thread.join();
     }
 }
 
-template <typename T> void VarClusterFinder<T>::single_pass(NDView<T, 2> img) {
-    original_ = img;
-    labeled_ = 0;
-    current_label = 0;
-    child.clear();
-    first_pass();
-    // print_connections();
-    // second_pass();
-    // store_clusters();
-}
-
 template <typename T> void VarClusterFinder<T>::first_pass() {
-
-    for (ssize_t i = 0; i < original_.size(); ++i) {
-        if (use_noise_map)
-            threshold_ = 5 * noiseMap[i];
-        binary_[i] = (original_[i] > threshold_);
+    const auto tasks =
+        split_task(0, static_cast<int>(shape_[0]), n_threads_);
+    strips_.resize(std::max<size_t>(tasks.size(), 1));
+    for (size_t s = 0; s < tasks.size(); ++s) {
+        strips_[s].first_row = tasks[s].first;
+        strips_[s].last_row = tasks[s].second;
     }
-
-    for (int i = 0; i < shape_[0]; ++i) {
-        for (int j = 0; j < shape_[1]; ++j) {
-
-            // do we have something to process?
-            if (binary_(i, j)) {
-                auto tmp = check_neighbours(i, j);
-                if (tmp != 0) {
-                    labeled_(i, j) = tmp;
-                } else {
-                    labeled_(i, j) = ++current_label;
-                }
+    for_each_strip([this](Strip &strip) { label_strip(strip); });
+
+    // Global labels start at 1 and increase strip by strip, so the smallest
+    // label of a region is still the one of its first run.
+    parent_.assign(1, 0);
+    for (auto &strip : strips_) {
+        strip.label_offset = static_cast<int>(parent_.size());
+        for (int p : strip.parent)
+            parent_.push_back(p + strip.label_offset);
+    }
+    current_label = static_cast<int>(parent_.size()) - 1;
+
+    // join the regions across the seams: runs in the last row of a strip
+    // with the runs in the first row of the next one
+    for (size_t s = 1; s < strips_.size(); ++s) {
+        const auto &above = strips_[s - 1];
+        const auto &below = strips_[s];
+        auto a = std::lower_bound(above.runs.begin(), above.runs.end(),
+                                  above.last_row - 1,
+                                  [](const Run &r, int row) {
+                                      return r.row < row;
+                                  });
+        for (auto b = below.runs.begin();
+             b != below.runs.end() && b->row == below.first_row; ++b) {
+            while (a != above.runs.end() && a->end < b->start)
+                ++a;
+            for (auto c = a; c != above.runs.end() && c->start <= b->end;
+                 ++c) {
+                join(parent_, c->label + above.label_offset,
+                     b->label + below.label_offset);
             }
         }
     }
 }
 
 template <typename T> void VarClusterFinder<T>::second_pass() {
+    // number the regions 1, 2, ... in the order of their smallest label
+    final_label_.assign(parent_.size(), 0);
+    n_regions_ = 0;
+    for (size_t label = 1; label < parent_.size(); ++label) {
+        const int root = find_root(parent_, static_cast<int>(label));
+        final_label_[label] = root == static_cast<int>(label)
+                                  ? ++n_regions_
+                                  : final_label_[root];
+    }
 
-    for (ssize_t i = 0; i != labeled_.size(); ++i) {
-        auto cl = labeled_(i);
-        if (cl != 0) {
-            auto it = child.find(cl);
-            while (it != child.end()) {
-                cl = it->second;
-                it = child.find(cl);
-                // do this once before doing the second pass?
-                // all values point to the final one...
-            }
-            labeled_(i) = cl;
+    for_each_strip([this](const Strip &strip) {
+        std::fill(&labeled_(strip.first_row, 0),
+                  &labeled_(strip.first_row, 0) +
+                      (strip.last_row - strip.first_row) * shape_[1],
+                  0);
+        for (const auto &run : strip.runs) {
+            const int label = final_label_[run.label + strip.label_offset];
+            std::fill(&labeled_(run.row, run.start),
+                      &labeled_(run.row, run.start) + (run.end - run.start),
+                      label);
         }
-    }
+    });
 }
 
 template <typename T> void VarClusterFinder<T>::store_clusters() {
+    // one Hit per region, in the order of the labels
+    const size_t first = hits.size();
+    hits.resize(first + static_cast<size_t>(n_regions_));
+    for (const auto &strip : strips_) {
+        for (const auto &run : strip.runs) {
+            const int label = final_label_[run.label + strip.label_offset];
+            Hit &record = hits[first + static_cast<size_t>(label - 1)];
+            for (int j = run.start; j < run.end; ++j)
+                add_pixel(record, run.row, j, true);
+        }
+    }
+}
+
+template <typename T>
+void VarClusterFinder<T>::add_pixel(Hit &hit, int i, int j, bool capped) {
+    if (hit.size < MAX_CLUSTER_SIZE) {
+        hit.rows[hit.size] = i;
+        hit.cols[hit.size] = j;
+        hit.enes[hit.size] = original_(i, j);
+    } else if (capped) {
+        return;
+    }
+    hit.size += 1;
+    hit.energy += original_(i, j);
+    if (hit.max < original_(i, j)) {
+        hit.row = i;
+        hit.col = j;
+        hit.max = original_(i, j);
+    }
+}
 
-    // Accumulate hit information in a map
-    // Do we always have monotonic increasing
-    // labels? Then vector?
-    // here the translation is label -> Hit
-    std::unordered_map<int, Hit> h_map;
+template <typename T>
+void VarClusterFinder<T>::find_clusters_X(NDView<T, 2> img) {
+    original_ = img;
     for (int i = 0; i < shape_[0]; ++i) {
         for (int j = 0; j < shape_[1]; ++j) {
-            if (labeled_(i, j) != 0 || false
-                // (i-1 >= 0 and labeled_(i-1, j) != 0) or // another circle of
-                // peripheral pixels (j-1 >= 0 and labeled_(i, j-1) != 0) or
-                // (i+1 < shape_[0] and labeled_(i+1, j) != 0) or
-                // (j+1 < shape_[1] and labeled_(i, j+1) != 0)
-            ) {
-                Hit &record = h_map[labeled_(i, j)];
-                if (record.size < MAX_CLUSTER_SIZE) {
-                    record.rows[record.size] = i;
-                    record.cols[record.size] = j;
-                    record.enes[record.size] = original_(i, j);
-                } else {
-                    continue;
-                }
-                record.size += 1;
-                record.energy += original_(i, j);
-
-                if (record.max < original_(i, j)) {
-                    record.row = i;
-                    record.col = j;
-                    record.max = original_(i, j);
-                }
+            const T threshold =
+                use_noise_map ? 5 * noiseMap(i, j) : threshold_;
+            if (original_(i, j) > threshold) {
+                hits.emplace_back();
+                fill_hit(hits.back(), i, j);
             }
         }
     }
+}
 
-    for (const auto &h : h_map)
-        hits.push_back(h.second);
+template <typename T>
+void VarClusterFinder<T>::fill_hit(Hit &hit, int i, int j) {
+    // Depth first like a recursive fill, but with the stack on the heap.
+    // A pixel is added and zeroed when it is pushed, which keeps it from
+    // being found again.
+    stack_.clear();
+    add_pixel(hit, i, j, false);
+    original_(i, j) = 0;
+    stack_.push_back({i, j, 0});
+    while (!stack_.empty()) {
+        Seed &top = stack_.back();
+        if (top.k == numberOfNeighbours) {
+            stack_.pop_back();
+            continue;
+        }
+        const int row = top.row + di_[top.k];
+        const int col = top.col + dj_[top.k];
+        ++top.k;
+        if (row < 0 || col < 0 || row >= shape_[0] || col >= shape_[1])
+            continue;
+        const T threshold =
+            use_noise_map ? peripheralThresholdFactor_ * noiseMap(row, col)
+                          : threshold_;
+        if (original_(row, col) > threshold) {
+            add_pixel(hit, row, col, false);
+            original_(row, col) = 0;
+            stack_.push_back({row, col, 0});
+        } else if (empty_surroundingPixels) {
+            original_(row, col) = 0; // remove peripheral pixels, to avoid
+                                     // potential influence for pedestal
+                                     // updating
+        }
+    }
 }
 
 } // namespace aare
@@ -0,0 +1,330 @@
+#pragma once
+/*
+Serialisable, mergeable snapshot of a per-pixel histogram. Used to save the
+state of PixelHistogram / PedestalTrackingPixelHistogram to disk, e.g. as a
+checkpoint or to histogram parts of a run on different nodes and reduce the
+results at the end.
+
+File layout (native byte order):
+    char     magic[8]        "AAREHIST"
+    uint32_t version         currently 1
+    char     storage_type    Dtype format descriptor of StorageType
+    char     axis_type       Dtype format descriptor of AxisType
+    uint16_t reserved        0
+    uint32_t rows, cols, n_bins
+    double   xmin, xmax
+    uint64_t n_frames        frames accumulated into the snapshot
+    uint64_t payload_bytes
+    payload
+
+The payload holds the dense [rows x cols x n_bins] bins as a sequence of
+records (varint n_zeros, varint n_values, n_values raw StorageType values).
+Per-pixel histograms are mostly empty, so skipping the zero runs makes the
+files a fraction of the in-memory size.
+*/
+
+#include "aare/Dtype.hpp"
+#include "aare/NDArray.hpp"
+#include "aare/defs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace aare {
+
+namespace snapshot_detail {
+
+constexpr std::array<char, 8> magic{'A', 'A', 'R', 'E', 'H', 'I', 'S', 'T'};
+constexpr uint32_t version = 1;
+
+/// Longest LEB128 encoding of a uint64_t
+constexpr uint64_t max_varint_bytes = 10;
+
+inline void write_varint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t read_varint(const uint8_t *&pos, const uint8_t *end) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos == end) {
+            throw std::runtime_error(LOCATION +
+                                     "Truncated histogram snapshot payload");
+        }
+        const uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error(LOCATION + "Invalid varint in histogram snapshot");
+}
+
+template <typename T> void write_pod(std::ostream &os, const T &value) {
+    os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T read_pod(std::istream &is) {
+    T value{};
+    is.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+}
+
+} // namespace snapshot_detail
+
+template <typename StorageType, typename AxisType> class HistogramSnapshot {
+    NDArray<StorageType, 3> m_values;
+    AxisType m_xmin{};
+    AxisType m_xmax{};
+    uint64_t m_n_frames{};
+
+  public:
+    HistogramSnapshot() = default;
+
+    /**
+     * @brief Construct a snapshot from dense [rows x cols x n_bins] values
+     * of a histogram with regular binning on [xmin, xmax).
+     * @param n_frames number of frames that went into the values
+     */
+    HistogramSnapshot(NDArray<StorageType, 3> values, AxisType xmin,
+                      AxisType xmax, uint64_t n_frames = 0)
+        : m_values(std::move(values)), m_xmin(xmin), m_xmax(xmax),
+          m_n_frames(n_frames) {}
+
+    /**
+     * @brief Add the bins of `other` to this snapshot. Integral storage
+     * saturates at the maximum of StorageType, like the histograms do.
+     * @throws std::invalid_argument if the shape or axis do not match
+     */
+    void merge(const HistogramSnapshot &other) {
+        if (m_values.shape() != other.m_values.shape() ||
+            m_xmin != other.m_xmin || m_xmax != other.m_xmax) {
+            throw std::invalid_argument(
+                LOCATION + "Cannot merge histogram snapshots with different "
+                           "shape or axis");
+        }
+        StorageType *dst = m_values.data();
+        const StorageType *src = other.m_values.data();
+        const auto n = static_cast<size_t>(m_values.size());
+        for (size_t i = 0; i < n; ++i) {
+            if constexpr (std::is_integral_v<StorageType>) {
+                constexpr auto max = std::numeric_limits<StorageType>::max();
+                dst[i] = src[i] > max - dst[i]
+                             ? max
+                             : static_cast<StorageType>(dst[i] + src[i]);
+            } else {
+                dst[i] += src[i];
+            }
+        }
+        m_n_frames += other.m_n_frames;
+    }
+
+    /**
+     * @brief Write the snapshot to `fname`. The data is first written to a
+     * temporary file next to it and then renamed, so an existing snapshot
+     * (e.g. the previous checkpoint) is only replaced by a complete one.
+     * @throws std::runtime_error if the file could not be written
+     */
+    void save(const std::filesystem::path &fname) const {
+        using namespace snapshot_detail;
+        std::vector<uint8_t> payload = encode();
+
+        auto tmp = fname;
+        tmp += ".tmp";
+        {
+            std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+            if (!os) {
+                throw std::runtime_error(LOCATION +
+                                         "Could not open file for writing: " +
+                                         tmp.string());
+            }
+            os.write(magic.data(), magic.size());
+            write_pod(os, version);
+            write_pod(os, type_char<StorageType>());
+            write_pod(os, type_char<AxisType>());
+            write_pod(os, uint16_t{0});
+            write_pod(os, static_cast<uint32_t>(rows()));
+            write_pod(os, static_cast<uint32_t>(cols()));
+            write_pod(os, static_cast<uint32_t>(n_bins()));
+            write_pod(os, static_cast<double>(m_xmin));
+            write_pod(os, static_cast<double>(m_xmax));
+            write_pod(os, m_n_frames);
+            write_pod(os, static_cast<uint64_t>(payload.size()));
+            os.write(reinterpret_cast<const char *>(payload.data()),
+                     static_cast<std::streamsize>(payload.size()));
+            if (!os) {
+                throw std::runtime_error(LOCATION + "Could not write file: " +
+                                         tmp.string());
+            }
+        }
+        std::filesystem::rename(tmp, fname);
+    }
+
+    /**
+     * @brief Read a snapshot written by save().
+     * @throws std::runtime_error if the file could not be read or was
+     * written with a different storage or axis type
+     */
+    static HistogramSnapshot load(const std::filesystem::path &fname) {
+        using namespace snapshot_detail;
+        std::ifstream is(fname, std::ios::binary);
+        if (!is) {
+            throw std::runtime_error(LOCATION +
+                                     "Could not open file for reading: " +
+                                     fname.string());
+        }
+        std::array<char, 8> file_magic{};
+        is.read(file_magic.data(), file_magic.size());
+        const auto file_version = read_pod<uint32_t>(is);
+        if (!is || file_magic != magic || file_version != version) {
+            throw std::runtime_error(
+                LOCATION + "Not a histogram snapshot: " + fname.string());
+        }
+        const auto storage_type = read_pod<char>(is);
+        const auto axis_type = read_pod<char>(is);
+        if (storage_type != type_char<StorageType>() ||
+            axis_type != type_char<AxisType>()) {
+            throw std::runtime_error(
+                LOCATION + "Histogram snapshot type mismatch in " +
+                fname.string());
+        }
+        read_pod<uint16_t>(is);
+        const auto n_rows = read_pod<uint32_t>(is);
+        const auto n_cols = read_pod<uint32_t>(is);
+        const auto bins = read_pod<uint32_t>(is);
+        const auto xmin = static_cast<AxisType>(read_pod<double>(is));
+        const auto xmax = static_cast<AxisType>(read_pod<double>(is));
+        const auto n_frames = read_pod<uint64_t>(is);
+        const auto payload_bytes = read_pod<uint64_t>(is);
+        check_payload_size(is, fname, payload_bytes, n_rows, n_cols, bins);
+        std::vector<uint8_t> payload(payload_bytes);
+        is.read(reinterpret_cast<char *>(payload.data()),
+                static_cast<std::streamsize>(payload_bytes));
+        if (!is) {
+            throw std::runtime_error(
+                LOCATION + "Truncated histogram snapshot: " + fname.string());
+        }
+
+        HistogramSnapshot snapshot(
+            NDArray<StorageType, 3>({static_cast<ssize_t>(n_rows),
+                                     static_cast<ssize_t>(n_cols),
+                                     static_cast<ssize_t>(bins)}),
+            xmin, xmax, n_frames);
+        snapshot.decode(payload);
+        return snapshot;
+    }
+
+    const NDArray<StorageType, 3> &values() const { return m_values; }
+    AxisType xmin() const { return m_xmin; }
+    AxisType xmax() const { return m_xmax; }
+    uint64_t n_frames() const { return m_n_frames; }
+    ssize_t rows() const { return m_values.shape(0); }
+    ssize_t cols() const { return m_values.shape(1); }
+    ssize_t n_bins() const { return m_values.shape(2); }
+
+  private:
+    /**
+     * @brief Check payload_bytes from the header before it is allocated: it
+     * must fit in the rest of the file and can not exceed one record of two
+     * varints and one value per bin.
+     */
+    static void check_payload_size(std::istream &is,
+                                   const std::filesystem::path &fname,
+                                   uint64_t payload_bytes, uint32_t n_rows,
+                                   uint32_t n_cols, uint32_t bins) {
+        using snapshot_detail::max_varint_bytes;
+        const auto header_end = is.tellg();
+        is.seekg(0, std::ios::end);
+        const auto file_end = is.tellg();
+        is.seekg(header_end);
+        if (!is || header_end < 0 || file_end < header_end ||
+            payload_bytes > static_cast<uint64_t>(file_end - header_end)) {
+            throw std::runtime_error(
+                LOCATION + "Truncated histogram snapshot: " + fname.string());
+        }
+
+        // every record covers at least one bin, compared in records so that
+        // rows * cols * bins can not overflow a product with the record size
+        constexpr uint64_t record_bytes =
+            2 * max_varint_bytes + sizeof(StorageType);
+        const uint64_t n_records =
+            payload_bytes / record_bytes + (payload_bytes % record_bytes != 0);
+        const uint64_t pixels = uint64_t{n_rows} * n_cols;
+        const bool fits_any =
+            bins != 0 && pixels > std::numeric_limits<uint64_t>::max() / bins;
+        if (!fits_any && n_records > pixels * bins) {
+            throw std::runtime_error(
+                LOCATION + "Histogram snapshot payload larger than its " +
+                "bins: " + fname.string());
+        }
+    }
+
+    template <typename T> static char type_char() {
+        return Dtype(typeid(T)).format_descr()[0];
+    }
+
+    std::vector<uint8_t> encode() const {
+        using snapshot_detail::write_varint;
+        std::vector<uint8_t> out;
+        const StorageType *data = m_values.data();
+        const auto n = static_cast<size_t>(m_values.size());
+        size_t i = 0;
+        while (i < n) {
+            const size_t zeros_start = i;
+            while (i < n && data[i] == StorageType{0}) {
+                ++i;
+            }
+            const size_t values_start = i;
+            while (i < n && data[i] != StorageType{0}) {
+                ++i;
+            }
+            write_varint(out, values_start - zeros_start);
+            write_varint(out, i - values_start);
+            const auto bytes = (i - values_start) * sizeof(StorageType);
+            const auto pos = out.size();
+            out.resize(pos + bytes);
+            std::memcpy(out.data() + pos, data + values_start, bytes);
+        }
+        return out;
+    }
+
+    void decode(const std::vector<uint8_t> &payload) {
+        using snapshot_detail::read_varint;
+        StorageType *data = m_values.data();
+        const auto n = static_cast<uint64_t>(m_values.size());
+        const uint8_t *pos = payload.data();
+        const uint8_t *end = pos + payload.size();
+        uint64_t i = 0;
+        while (i < n) {
+            const uint64_t zeros = read_varint(pos, end);
+            const uint64_t n_values = read_varint(pos, end);
+            const auto bytes = n_values * sizeof(StorageType);
+            if (zeros + n_values == 0 || zeros + n_values > n - i ||
+                bytes > static_cast<uint64_t>(end - pos)) {
+                throw std::runtime_error(
+                    LOCATION + "Corrupt histogram snapshot payload");
+            }
+            std::fill(data + i, data + i + zeros, StorageType{0});
+            i += zeros;
+            std::memcpy(data + i, pos, bytes);
+            pos += bytes;
+            i += n_values;
+        }
+    }
+};
+
+} // namespace aare
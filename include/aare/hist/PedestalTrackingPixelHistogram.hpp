@@ -1,13 +1,14 @@
 #pragma once
+#include "aare/Metrics.hpp"
 #include "aare/NDArray.hpp"
 #include "aare/NDView.hpp"
 #include "aare/Pedestal.hpp"
 #include "aare/ProducerConsumerQueue.hpp"
+#include "aare/hist/HistogramSnapshot.hpp"
 #include "aare/hist/PixelHistogramImpl.hpp"
 
 #include <atomic>
 #include <chrono>
-#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
@@ -23,15 +24,42 @@ class PedestalTrackingPixelHistogram {
     using StorageType = uint16_t;
     using AxisType = float; // TODO: template on pedestal type if needed
     using FrameType = uint16_t;
+    using Snapshot = HistogramSnapshot<StorageType, AxisType>;
 
   private:
     using Hist = PixelHistogramImpl<AxisType, StorageType>;
-    using AsyncQueue = ProducerConsumerQueue<NDArray<FrameType, 2>>;
 
-    // What kind of fan-out work the worker pool should currently do.
-    // Set under work_mutex_; read by worker_loop after wakeup.
+    // What a worker should do with a task taken from its input ring.
     enum class WorkKind { PushPedestal, UpdateMean, FillWithThreshold };
 
+    // One unit of work for one worker: the worker's row band of a frame,
+    // copied out by the submitting thread ([local_rows x cols], empty for
+    // UpdateMean).
+    struct BandTask {
+        WorkKind kind;
+        NDArray<FrameType, 2> band;
+    };
+    using TaskQueue = ProducerConsumerQueue<BandTask>;
+    using BandQueue = ProducerConsumerQueue<NDArray<FrameType, 2>>;
+
+    // Everything one worker shares with the submitting thread. Each lane
+    // is its own allocation so the counters of different workers do not
+    // share a cache line.
+    struct alignas(hardware_destructive_interference_size) Lane {
+        explicit Lane(std::size_t max_pending)
+            : input(static_cast<std::uint32_t>(max_pending + 1)),
+              recycle(static_cast<std::uint32_t>(max_pending + 2)) {}
+        TaskQueue input;   // submitter -> worker
+        BandQueue recycle; // worker -> submitter, spent band buffers
+        std::atomic<std::size_t> submitted_tasks{0};
+        std::atomic<std::size_t> completed_tasks{0};
+        std::atomic<std::size_t> completed_fills{0};
+        // registered in the constructor, see metrics()
+        MetricCounter *busy{};
+        MetricCounter *idle{};
+        MetricGauge *queue_depth{};
+    };
+
     int rows_;
     int cols_;
     int n_threads_;
@@ -42,56 +70,59 @@ class PedestalTrackingPixelHistogram {
     std::vector<Hist> partial_hists_;
     // Per-thread pedestal sized [local_rows x cols]. Indexed by the
     // worker using the LOCAL row index (i.e. 0..row_count(t)-1), NOT the
-    // global row index. Owned exclusively by worker `t` during a
-    // dispatched fan-out.
+    // global row index. Owned exclusively by worker `t`; other threads
+    // only read it after flush().
     std::vector<Pedestal<AxisType>> partial_pedestals_;
     std::vector<NDArray<AxisType, 2>> partial_std_; // cached for pedestal
                                                     // tracking
 
-    // Thread pool members
+    // Each worker drains its own SPSC input ring, so workers never wait
+    // on each other or on a shared lock. Tasks for one band are processed
+    // in submission order, which is all the ordering the pipeline needs
+    // since the bands are independent.
+    std::vector<std::unique_ptr<Lane>> lanes_;
     std::vector<std::thread> workers_;
-    std::mutex work_mutex_;
-    std::condition_variable work_cv_;
-    std::condition_variable done_cv_;
-    WorkKind current_work_kind_;
-    const NDView<FrameType, 2> *current_image_;
-    const std::vector<NDView<FrameType, 2>> *current_images_;
-    int completed_threads_;
-    std::atomic<bool> stop_workers_;
-    int work_generation_;
-
-    // Serialises all fan-outs: `push_pedestal_no_update`, `update_mean`,
-    // and the async coordinator's batch fill dispatches.
-    // Always the outermost lock; work_mutex_ is taken briefly inside it.
-    mutable std::mutex fill_mutex_;
-
-    // Async producer/consumer pipeline. SPSC queue feeds the coordinator
-    // thread, which batches queued images before dispatching them.
-    std::unique_ptr<AsyncQueue> async_queue_;
-    std::thread coordinator_;
-    std::atomic<bool> stop_coordinator_{false};
-    std::atomic<bool> coordinator_busy_{false};
-    std::atomic<std::size_t> completed_async_fills_{0};
+    std::atomic<bool> stop_workers_{false};
     std::chrono::microseconds async_wait_{100};
-    std::size_t max_batch_size_;
     std::atomic<AxisType> n_sigma_;
 
-    // Private worker thread method
+    // Serialises submitting threads so every lane keeps a single
+    // producer. Never taken by the workers.
+    mutable std::mutex submit_mutex_;
+
+    // Telemetry, see metrics()
+    MetricsRegistry metrics_;
+    MetricCounter &frames_total_ =
+        metrics_.counter("pedestal_histogram_frames_total",
+                         "Frames submitted for filling");
+    MetricCounter &pedestal_frames_total_ =
+        metrics_.counter("pedestal_histogram_pedestal_frames_total",
+                         "Frames submitted to the pedestal");
+    MetricCounter &input_blocked_total_ = metrics_.counter(
+        "pedestal_histogram_input_blocked_total",
+        "Bands that had to wait for space in a full worker queue");
+    MetricCounter &input_blocked_seconds_ = metrics_.duration(
+        "pedestal_histogram_input_blocked_seconds_total",
+        "Time the submitting thread waited for space in the worker queues");
+    LatencyHistogram &submit_latency_ = metrics_.histogram(
+        "pedestal_histogram_submit_seconds",
+        "Time to split one frame into bands and queue them");
+    LatencyHistogram &task_latency_ =
+        metrics_.histogram("pedestal_histogram_task_seconds",
+                           "Time a worker spent on its band of one frame");
+
     void worker_loop(int thread_id);
-    void coordinator_loop();
     int row_start(int thread_id) const;
     int row_count(int thread_id) const;
 
-    // Sets up the work generation, wakes workers, and waits for them.
-    // Caller MUST already hold `fill_mutex_`. `image` may be nullptr
-    // for work kinds that don't need it (e.g. UpdateMean).
-    void dispatch_(WorkKind kind, const NDView<FrameType, 2> *image);
-    void dispatch_fill_batch_(const std::vector<NDView<FrameType, 2>> &images);
+    // Copy each worker's row band of `frame` (nullptr for UpdateMean)
+    // into a recycled buffer and push it to the worker's input ring,
+    // applying backpressure when a ring is full.
+    void submit_(WorkKind kind, const NDView<FrameType, 2> *frame);
+    NDArray<FrameType, 2> acquire_band_(int thread_id);
 
-    // Coordinator-facing entry point: takes fill_mutex_ and dispatches
-    // FillWithThreshold batches to the worker pool. Only ever called by the
-    // coordinator thread, on images already shape-checked by fill_async.
-    void fill_with_threshold_batch_(std::vector<NDArray<FrameType, 2>> &batch);
+    // Frames that every worker has finished filling.
+    std::size_t completed_fills_() const;
 
   public:
     PedestalTrackingPixelHistogram(int rows, int cols, int n_bins,
@@ -105,10 +136,17 @@ class PedestalTrackingPixelHistogram {
     void update_mean();
     NDArray<AxisType, 2> pedestal_mean() const;
 
+    // Both overloads copy the frame into the per-worker rings before
+    // returning, so the caller may reuse `image` immediately.
+    void fill_async(const NDView<FrameType, 2> &image);
     void fill_async(NDArray<FrameType, 2> &&image);
 
+    // With a non-empty checkpoint_path, a snapshot() is written there
+    // every checkpoint_interval frames (if > 0) and at the end of the file.
     void fill_from_file(const std::filesystem::path &fname,
-                        ssize_t max_frames = -1, bool verbose = false);
+                        ssize_t max_frames = -1, bool verbose = false,
+                        const std::filesystem::path &checkpoint_path = {},
+                        ssize_t checkpoint_interval = 0);
 
     void process_pedestal_file(const std::filesystem::path &fname,
                                ssize_t max_frames = -1, bool verbose = false);
@@ -123,11 +161,21 @@ class PedestalTrackingPixelHistogram {
     // is already drained.
     void flush() const;
 
+    // Telemetry: frames submitted, time the submitter was blocked by full
+    // worker queues, busy and idle time and queue depth per worker, and
+    // the latency of submitting a frame and of processing one band.
+    MetricsSnapshot metrics() const;
+
     // Implicitly flushes pending async fills first so the snapshot is
     // consistent with everything that was submitted up to the call.
     NDArray<StorageType, 3> values() const;
     NDArray<AxisType, 1> bin_centers() const;
     NDArray<AxisType, 1> bin_edges() const;
+
+    // Dense values() together with the axis and the number of frames
+    // filled so far, for saving to disk or merging with other snapshots.
+    // Flushes pending async fills first.
+    Snapshot snapshot() const;
 };
 
 } // namespace aare
@@ -1,7 +1,9 @@
 #pragma once
+#include "aare/Metrics.hpp"
 #include "aare/NDArray.hpp"
 #include "aare/NDView.hpp"
 #include "aare/ProducerConsumerQueue.hpp"
+#include "aare/hist/HistogramSnapshot.hpp"
 #include "aare/hist/PixelHistogramImpl.hpp"
 
 #include <algorithm>
@@ -14,6 +16,7 @@
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -42,34 +45,78 @@ class PixelHistogram {
     std::mutex work_mutex_;
     std::condition_variable work_cv_;
     std::condition_variable done_cv_;
-    const NDView<AxisType, 2> *current_image_;
+    const std::vector<NDView<AxisType, 2>> *current_images_;
     int completed_threads_;
     std::atomic<bool> stop_workers_;
     int work_generation_;
 
     // Async producer/consumer pipeline. SPSC queue feeds the coordinator
-    // thread, which fans each image out to the worker pool one at a time.
-    // TODO: batch processing?
-    // TODO: FIFO to avoid allocations?
+    // thread, which hands up to max_batch_size_ queued images to the worker
+    // pool per wakeup. Processed images are passed back to the producer
+    // through recycle_queue_ (SPSC in the opposite direction) so that
+    // acquire_buffer() can reuse them instead of allocating.
     std::unique_ptr<AsyncQueue> async_queue_;
+    std::unique_ptr<AsyncQueue> recycle_queue_;
     std::thread coordinator_;
     std::atomic<bool> stop_coordinator_{false};
     std::atomic<bool> coordinator_busy_{false};
+    std::atomic<std::size_t> completed_async_fills_{0};
     std::chrono::microseconds async_wait_{100};
+    std::size_t max_batch_size_;
+
+    // Telemetry, see metrics(). The per-worker counters are registered in
+    // the constructor.
+    MetricsRegistry metrics_;
+    MetricCounter &frames_total_ =
+        metrics_.counter("pixel_histogram_frames_total", "Frames histogrammed");
+    MetricCounter &batches_total_ = metrics_.counter(
+        "pixel_histogram_batches_total", "Batches handed to the workers");
+    MetricCounter &input_blocked_total_ = metrics_.counter(
+        "pixel_histogram_input_blocked_total",
+        "Frames that had to wait for space in the full queue");
+    MetricCounter &input_blocked_seconds_ = metrics_.duration(
+        "pixel_histogram_input_blocked_seconds_total",
+        "Time fill_async waited for space in the queue");
+    MetricCounter &buffer_allocations_total_ =
+        metrics_.counter("pixel_histogram_buffer_allocations_total",
+                         "Buffers allocated because none could be recycled");
+    MetricGauge &queue_depth_ = metrics_.gauge("pixel_histogram_queue_depth",
+                                               "Frames waiting in the queue");
+    LatencyHistogram &batch_latency_ =
+        metrics_.histogram("pixel_histogram_batch_seconds",
+                           "Time to histogram one batch of frames");
+    std::vector<MetricCounter *> worker_busy_;
+    std::vector<MetricCounter *> worker_idle_;
 
     // Private worker thread method
     void worker_loop(int thread_id);
     void coordinator_loop();
-    // Fan a single image out to the worker pool and block until every
+    // Fan a batch of images out to the worker pool and block until every
     // worker has merged its row band. Only ever called by the coordinator
     // thread, so no caller-serialisation lock is needed.
-    void dispatch(const NDView<AxisType, 2> &image);
+    void dispatch(const std::vector<NDView<AxisType, 2>> &images);
     int row_start(int thread_id) const;
     int row_count(int thread_id) const;
 
+    // Common constructor. `centers` is nullptr for dense storage, otherwise
+    // it selects windowed storage with window_bins bins per pixel.
+    PixelHistogram(int rows, int cols, const NDView<AxisType, 2> *centers,
+                   int window_bins, int n_bins, AxisType xmin, AxisType xmax,
+                   int n_threads, std::size_t max_pending,
+                   std::size_t batch_size);
+
   public:
+    // batch_size is the maximum number of queued images handed to each
+    // worker per wakeup. It is clamped to max_pending.
     PixelHistogram(int rows, int cols, int n_bins, AxisType xmin, AxisType xmax,
-                   int n_threads = 1, std::size_t max_pending = 16);
+                   int n_threads = 1, std::size_t max_pending = 16,
+                   std::size_t batch_size = 4);
+    // Windowed storage: only window_bins bins of the [xmin, xmax) axis are
+    // kept per pixel, centred on `centers` (typically the pedestal). The
+    // shape of `centers` sets rows and cols. values() is still dense.
+    PixelHistogram(const NDView<AxisType, 2> &centers, int window_bins,
+                   int n_bins, AxisType xmin, AxisType xmax, int n_threads = 1,
+                   std::size_t max_pending = 16, std::size_t batch_size = 4);
     ~PixelHistogram();
 
     // Asynchronous fill: takes ownership of `image`, enqueues it for the
@@ -78,15 +125,32 @@ class PixelHistogram {
     // backpressure loop, matching the convention in ClusterFinderMT).
     void fill_async(NDArray<AxisType, 2> &&image);
 
+    // Returns a (rows, cols) image buffer to fill and pass to fill_async.
+    // Buffers of images that have already been histogrammed are recycled,
+    // so a steady stream of fills does not allocate. The contents of the
+    // buffer are unspecified. Must be called from the thread that calls
+    // fill_async.
+    NDArray<AxisType, 2> acquire_buffer();
+
     // Wait for all queued async fills to complete. Cheap when the queue
     // is already drained.
     void flush() const;
 
+    // Telemetry: frames and batches histogrammed, queue depth, time
+    // fill_async was blocked by a full queue, busy and idle time per worker
+    // and the latency of each batch.
+    MetricsSnapshot metrics() const { return metrics_.snapshot(); }
+
     // Implicitly flushes pending async fills first so the snapshot is
     // consistent with everything that was submitted up to the call.
     NDArray<StorageType, 3> values() const;
     NDArray<AxisType, 1> bin_centers() const;
     NDArray<AxisType, 1> bin_edges() const;
+
+    // Dense values() together with the axis and the number of frames
+    // filled so far, for saving to disk or merging with other snapshots.
+    // Flushes pending async fills first.
+    HistogramSnapshot<StorageType, AxisType> snapshot() const;
 };
 
 template <typename StorageType, typename AxisType>
@@ -94,10 +158,28 @@ PixelHistogram<StorageType, AxisType>::PixelHistogram(int rows, int cols,
                                                       int n_bins, AxisType xmin,
                                                       AxisType xmax,
                                                       int n_threads,
-                                                      std::size_t max_pending)
+                                                      std::size_t max_pending,
+                                                      std::size_t batch_size)
+    : PixelHistogram(rows, cols, nullptr, n_bins, n_bins, xmin, xmax,
+                     n_threads, max_pending, batch_size) {}
+
+template <typename StorageType, typename AxisType>
+PixelHistogram<StorageType, AxisType>::PixelHistogram(
+    const NDView<AxisType, 2> &centers, int window_bins, int n_bins,
+    AxisType xmin, AxisType xmax, int n_threads, std::size_t max_pending,
+    std::size_t batch_size)
+    : PixelHistogram(static_cast<int>(centers.shape(0)),
+                     static_cast<int>(centers.shape(1)), &centers, window_bins,
+                     n_bins, xmin, xmax, n_threads, max_pending, batch_size) {}
+
+template <typename StorageType, typename AxisType>
+PixelHistogram<StorageType, AxisType>::PixelHistogram(
+    int rows, int cols, const NDView<AxisType, 2> *centers, int window_bins,
+    int n_bins, AxisType xmin, AxisType xmax, int n_threads,
+    std::size_t max_pending, std::size_t batch_size)
     : rows_(rows), cols_(cols), n_threads_(n_threads), xmin_(xmin), xmax_(xmax),
-      current_image_(nullptr), completed_threads_(0), stop_workers_(false),
-      work_generation_(0) {
+      current_images_(nullptr), completed_threads_(0), stop_workers_(false),
+      work_generation_(0), max_batch_size_(std::min(batch_size, max_pending)) {
     if (rows_ < 1 || cols_ < 1 || n_bins < 1) {
         throw std::invalid_argument(
             "PixelHistogram requires positive rows, cols and bins");
@@ -109,6 +191,9 @@ PixelHistogram<StorageType, AxisType>::PixelHistogram(int rows, int cols,
     if (max_pending < 1) {
         throw std::invalid_argument("PixelHistogram requires max_pending >= 1");
     }
+    if (batch_size < 1) {
+        throw std::invalid_argument("PixelHistogram requires batch_size >= 1");
+    }
 
     n_threads_ = std::min(n_threads_, rows_);
 
@@ -127,11 +212,28 @@ PixelHistogram<StorageType, AxisType>::PixelHistogram(int rows, int cols,
     }
     row_offsets_[n_threads_] = offset; // == rows_ by construction
 
-    // Initialize partial histograms for each thread
+    // Initialize partial histograms for each thread. With windowed
+    // storage every shard gets the centres of its own row band.
     partial_hists_.reserve(n_threads_);
     for (int i = 0; i < n_threads_; ++i) {
         const auto local_rows = row_count(i);
-        partial_hists_.emplace_back(local_rows, cols, n_bins, xmin, xmax);
+        if (centers == nullptr) {
+            partial_hists_.emplace_back(local_rows, cols, n_bins, xmin, xmax);
+        } else {
+            partial_hists_.emplace_back(
+                centers->sub_view(row_start(i), row_start(i) + local_rows),
+                window_bins, n_bins, xmin, xmax);
+        }
+    }
+
+    for (int i = 0; i < n_threads_; ++i) {
+        const MetricLabels labels{{"thread", std::to_string(i)}};
+        worker_busy_.push_back(
+            &metrics_.duration("pixel_histogram_busy_seconds_total",
+                               "Time spent filling", labels));
+        worker_idle_.push_back(
+            &metrics_.duration("pixel_histogram_idle_seconds_total",
+                               "Time spent waiting for frames", labels));
     }
 
     // Spawn worker threads
@@ -143,6 +245,10 @@ PixelHistogram<StorageType, AxisType>::PixelHistogram(int rows, int cols,
     // one to honour the requested max_pending.
     async_queue_ = std::make_unique<AsyncQueue>(
         static_cast<std::uint32_t>(max_pending + 1));
+    // At most max_pending images are queued and max_batch_size_ in flight,
+    // so this many recycled buffers cover the whole pipeline.
+    recycle_queue_ = std::make_unique<AsyncQueue>(
+        static_cast<std::uint32_t>(max_pending + max_batch_size_ + 1));
     coordinator_ = std::thread([this]() { this->coordinator_loop(); });
 }
 
@@ -186,34 +292,33 @@ void PixelHistogram<StorageType, AxisType>::worker_loop(int thread_id) {
     int last_generation = 0;
 
     while (true) {
+        const auto wait_start = MetricsClock::now();
         std::unique_lock<std::mutex> lock(work_mutex_);
         work_cv_.wait(lock, [this, last_generation]() {
             return work_generation_ != last_generation || stop_workers_;
         });
+        worker_idle_[thread_id]->add(elapsed_ns(wait_start));
 
         if (stop_workers_) {
             break;
         }
 
         // Get work assignment
-        const NDView<AxisType, 2> &image = *current_image_;
+        const std::vector<NDView<AxisType, 2>> &images = *current_images_;
         const int generation = work_generation_;
         const int first_row = row_start(thread_id);
         const int local_rows = row_count(thread_id);
 
         lock.unlock();
 
-        // Do the work: fill this thread's partial histogram. The
-        // [xmin, xmax) range gate lives inside PixelHistogramImpl::fill.
-        auto &my_hist = partial_hists_[thread_id];
-        const auto cols = image.shape(1);
-        for (int local_row = 0; local_row < local_rows; ++local_row) {
-            const auto row = static_cast<ssize_t>(first_row + local_row);
-            for (ssize_t col = 0; col < cols; ++col) {
-                const auto val = image(row, col);
-                my_hist.fill_unchecked(local_row, static_cast<int>(col), val);
-            }
+        // Do the work: fill this thread's partial histogram from its row
+        // band of every image in the batch. The [xmin, xmax) range gate
+        // lives inside the PixelHistogramImpl fill engine.
+        const auto work_start = MetricsClock::now();
+        if (local_rows > 0) {
+            partial_hists_[thread_id].fill_rows(images, first_row);
         }
+        worker_busy_[thread_id]->add(elapsed_ns(work_start));
 
         // Signal completion
         {
@@ -233,18 +338,17 @@ NDArray<StorageType, 3> PixelHistogram<StorageType, AxisType>::values() const {
     // the partial histograms. Cheap when the queue is already drained.
     flush();
 
-    const auto first_shard_view = partial_hists_.front().view();
-    const auto cols = static_cast<ssize_t>(first_shard_view.shape(1));
-    const auto bins = static_cast<ssize_t>(first_shard_view.shape(2));
+    const auto cols = static_cast<ssize_t>(cols_);
+    const auto bins = static_cast<ssize_t>(partial_hists_.front().n_bins());
     const auto rows = static_cast<ssize_t>(rows_);
 
     NDArray<StorageType, 3> data({rows, cols, bins});
 
     // Each thread owns a disjoint, contiguous range of rows. The shard's
-    // dense storage layout [local_row][col][bin] is identical to the slice
+    // dense layout [local_row][col][bin] is identical to the slice
     // [first_row .. first_row + local_rows)[col][bin] of `data`, so the
-    // merge is just one bulk copy per thread; no per-element accumulation
-    // and no upfront zeroing of `data` is needed.
+    // merge is just one bulk copy (or window expansion) per thread; no
+    // per-element accumulation and no upfront zeroing of `data` is needed.
     const size_t pixel_stride = static_cast<size_t>(cols) * bins;
     for (int t = 0; t < n_threads_; ++t) {
         const auto first_row = static_cast<size_t>(row_start(t));
@@ -252,9 +356,7 @@ NDArray<StorageType, 3> PixelHistogram<StorageType, AxisType>::values() const {
         if (local_rows == 0)
             continue;
 
-        const auto shard_view = partial_hists_[t].view();
-        std::memcpy(data.data() + first_row * pixel_stride, shard_view.data(),
-                    local_rows * pixel_stride * sizeof(StorageType));
+        partial_hists_[t].values_into(data.data() + first_row * pixel_stride);
     }
 
     return data;
@@ -262,7 +364,7 @@ NDArray<StorageType, 3> PixelHistogram<StorageType, AxisType>::values() const {
 
 template <typename StorageType, typename AxisType>
 void PixelHistogram<StorageType, AxisType>::dispatch(
-    const NDView<AxisType, 2> &image) {
+    const std::vector<NDView<AxisType, 2>> &images) {
     // Called only by the coordinator thread on images already shape-checked
     // by fill_async, so there is no need to re-validate or to serialise
     // against other callers.
@@ -271,7 +373,7 @@ void PixelHistogram<StorageType, AxisType>::dispatch(
     {
         std::unique_lock<std::mutex> lock(work_mutex_);
         completed_threads_ = 0;
-        current_image_ = &image;
+        current_images_ = &images;
         ++work_generation_;
     }
 
@@ -283,7 +385,7 @@ void PixelHistogram<StorageType, AxisType>::dispatch(
         std::unique_lock<std::mutex> lock(work_mutex_);
         done_cv_.wait(lock,
                       [this]() { return completed_threads_ == n_threads_; });
-        current_image_ = nullptr; // Clear work assignment
+        current_images_ = nullptr; // Clear work assignment
     }
 }
 
@@ -298,9 +400,26 @@ void PixelHistogram<StorageType, AxisType>::fill_async(
     // SPSC backpressure: spin with a short sleep until a slot frees up.
     // The std::move only consumes `image` on the iteration that succeeds
     // (placement-new inside write() runs only when the slot is free).
-    while (!async_queue_->write(std::move(image))) {
-        std::this_thread::sleep_for(async_wait_);
+    if (!async_queue_->write(std::move(image))) {
+        const auto start = MetricsClock::now();
+        while (!async_queue_->write(std::move(image))) {
+            std::this_thread::sleep_for(async_wait_);
+        }
+        input_blocked_total_.add();
+        input_blocked_seconds_.add(elapsed_ns(start));
     }
+    queue_depth_.set(static_cast<int64_t>(async_queue_->sizeGuess()));
+}
+
+template <typename StorageType, typename AxisType>
+NDArray<AxisType, 2> PixelHistogram<StorageType, AxisType>::acquire_buffer() {
+    NDArray<AxisType, 2> buffer;
+    if (!recycle_queue_->read(buffer)) {
+        buffer = NDArray<AxisType, 2>(
+            {static_cast<ssize_t>(rows_), static_cast<ssize_t>(cols_)});
+        buffer_allocations_total_.add();
+    }
+    return buffer;
 }
 
 template <typename StorageType, typename AxisType>
@@ -313,16 +432,56 @@ void PixelHistogram<StorageType, AxisType>::flush() const {
 
 template <typename StorageType, typename AxisType>
 void PixelHistogram<StorageType, AxisType>::coordinator_loop() {
-    NDArray<AxisType, 2> item;
+    std::vector<NDArray<AxisType, 2>> batch;
+    std::vector<NDView<AxisType, 2>> views;
+    batch.reserve(max_batch_size_);
+    views.reserve(max_batch_size_);
+
     while (!stop_coordinator_.load(std::memory_order_acquire) ||
            !async_queue_->isEmpty()) {
-        if (async_queue_->read(item)) {
-            coordinator_busy_.store(true, std::memory_order_release);
-            dispatch(item.view());
-            coordinator_busy_.store(false, std::memory_order_release);
-        } else {
+        batch.clear();
+        views.clear();
+
+        auto *first_item = async_queue_->frontPtr();
+        if (first_item == nullptr) {
             std::this_thread::sleep_for(async_wait_);
+            continue;
+        }
+
+        // Mark busy before popping so flush() never sees an empty queue
+        // while the batch is still in flight.
+        coordinator_busy_.store(true, std::memory_order_release);
+        batch.push_back(std::move(*first_item));
+        async_queue_->popFront();
+
+        while (batch.size() < max_batch_size_) {
+            auto *item = async_queue_->frontPtr();
+            if (item == nullptr) {
+                break;
+            }
+            batch.push_back(std::move(*item));
+            async_queue_->popFront();
+        }
+
+        queue_depth_.set(static_cast<int64_t>(async_queue_->sizeGuess()));
+
+        for (auto &image : batch) {
+            views.push_back(image.view());
         }
+        const auto start = MetricsClock::now();
+        dispatch(views);
+        batch_latency_.record(elapsed_ns(start));
+        frames_total_.add(batch.size());
+        batches_total_.add();
+        completed_async_fills_.fetch_add(batch.size(),
+                                         std::memory_order_release);
+
+        // Hand the buffers back to the producer. If the recycle queue is
+        // full the buffer is simply freed by the next batch.clear().
+        for (auto &image : batch) {
+            recycle_queue_->write(std::move(image));
+        }
+        coordinator_busy_.store(false, std::memory_order_release);
     }
 }
 
@@ -339,4 +498,14 @@ NDArray<AxisType, 1> PixelHistogram<StorageType, AxisType>::bin_edges() const {
     return partial_hists_.front().bin_edges();
 }
 
+template <typename StorageType, typename AxisType>
+HistogramSnapshot<StorageType, AxisType>
+PixelHistogram<StorageType, AxisType>::snapshot() const {
+    // values() flushes, so the frame count read afterwards matches it.
+    auto data = values();
+    return HistogramSnapshot<StorageType, AxisType>(
+        std::move(data), xmin_, xmax_,
+        completed_async_fills_.load(std::memory_order_acquire));
+}
+
 } // namespace aare
@@ -5,15 +5,36 @@ row, col are integers and the per pixel histogram axis is AxisType.
 
 Bin policy: regular binning on [xmin, xmax). Values outside this range are
 silently dropped.
+
+Bulk fills (fill(frame) and fill_rows) go through a cache-blocked engine:
+the band is walked in tiles of a few pixels, the bin indices of a tile are
+computed in a branch-free (auto-vectorisable) loop, and increments are
+staged in small uint8 counters that are spilled into the main storage with
+a saturating add. Each tile therefore only touches a small, cache-resident
+slice of the [rows x cols x n_bins] storage, and the overflow check is paid
+once per spill instead of once per increment.
+
+Storage policy: by default every pixel stores all n_bins bins (dense). A
+histogram constructed from a per-pixel centre (e.g. the pedestal from
+Pedestal::mean() or PedestalTrackingPixelHistogram::pedestal_mean()) and a
+window_bins count only stores a window of window_bins consecutive bins of the
+global axis per pixel, placed so that the centre falls into the middle of
+the window (clamped at the ends of the axis). Values inside [xmin, xmax)
+but outside a pixel's window are dropped. values() always returns the dense
+[rows x cols x n_bins] layout; view() exposes the compact storage.
 */
 
 #include "aare/NDArray.hpp"
 #include "aare/NDView.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 namespace aare {
 
@@ -25,26 +46,77 @@ template <typename T, typename StorageType> class PixelHistogramImpl {
     int m_rows;
     int m_cols;
     int m_n_bins;
+    // Bins stored per pixel. Equal to m_n_bins for dense storage.
+    int m_window_bins;
     T m_xmin;
     T m_xmax;
     // n_bins / (xmax - xmin), precomputed to keep the hot path
     // division-free.
     T m_scale;
+    // First global bin stored for each pixel. Empty for dense storage.
+    NDArray<int32_t, 2> m_offsets;
+
+    // Scratch buffers for the bulk fill engine, sized once in the
+    // constructor and reused for every call. m_stage holds
+    // [tile_pixels x window_bins] uint8 counters that are all zero between
+    // tiles, m_touched the offsets into m_stage that became non-zero and
+    // m_bin_idx the bin (or -1 if out of range) per pixel of the tile.
+    int m_tile_pixels;
+    std::vector<uint8_t> m_stage;
+    std::vector<uint32_t> m_touched;
+    std::vector<int32_t> m_bin_idx;
+
+    // Frames staged per spill. One increment per pixel and frame keeps the
+    // uint8 counters from wrapping.
+    static constexpr size_t max_staged_frames =
+        std::numeric_limits<uint8_t>::max();
+    // Target size in bytes of m_stage, small enough to stay in L1/L2.
+    static constexpr int stage_bytes = 32 * 1024;
+
+    void init_scratch();
+    void fill_band(const NDView<T, 2> *frames, size_t n_frames,
+                   int first_row);
+    void compute_bins(const T *src, int n, int32_t *bins) const;
+    void apply_window(const int32_t *offsets, int n, int32_t *bins) const;
+    void spill(StorageType *dst);
 
   public:
     PixelHistogramImpl(int rows, int cols, int n_bins, T xmin, T xmax);
+    // Windowed storage: rows and cols are taken from the shape of
+    // `centers`, and each pixel keeps window_bins bins around its centre.
+    PixelHistogramImpl(const NDView<T, 2> &centers, int window_bins,
+                       int n_bins, T xmin, T xmax);
 
     void fill(const NDView<T, 2> &frame);
     void fill(int row, int col, T value);
     void fill_unchecked(int row, int col, T value);
 
+    // Fill the histogram from rows [first_row, first_row + rows) of each
+    // frame, i.e. this histogram holds a row band of a larger image. All
+    // frames are processed per tile so the storage of a tile is reused
+    // across frames. Frames must have cols columns and at least
+    // first_row + rows rows; this is not checked.
+    void fill_rows(const NDView<T, 2> &frame, int first_row);
+    void fill_rows(const std::vector<NDView<T, 2>> &frames, int first_row);
+
+    // Dense [rows x cols x n_bins] copy of the histogram, expanded from
+    // the window if the storage is windowed.
     NDArray<StorageType, 3> values() const;
-    // Zero-copy view of the underlying [rows x cols x n_bins] storage.
+    // Write values() to a caller-owned buffer of rows * cols * n_bins
+    // elements.
+    void values_into(StorageType *dst) const;
+    // Zero-copy view of the underlying [rows x cols x window_bins] storage.
     // Lifetime is tied to *this. Use for low-level merge/stitching paths;
     // prefer values() for the public API where you want an owned copy.
     NDView<StorageType, 3> view() const;
+    // First global bin stored for each pixel, all zero for dense storage.
+    NDArray<int32_t, 2> offsets() const;
     NDArray<T, 1> bin_centers() const;
     NDArray<T, 1> bin_edges() const;
+
+    int n_bins() const { return m_n_bins; }
+    int window_bins() const { return m_window_bins; }
+    bool is_windowed() const { return m_offsets.size() != 0; }
 };
 
 template <typename T, typename StorageType>
@@ -56,8 +128,8 @@ PixelHistogramImpl<T, StorageType>::PixelHistogramImpl(int rows, int cols,
                                         static_cast<ssize_t>(n_bins)},
                                        StorageType{0})),
       m_edges(NDArray<T, 1>({static_cast<ssize_t>(n_bins + 1)})), m_rows(rows),
-      m_cols(cols), m_n_bins(n_bins), m_xmin(xmin), m_xmax(xmax),
-      m_scale(static_cast<T>(n_bins) / (xmax - xmin)) {
+      m_cols(cols), m_n_bins(n_bins), m_window_bins(n_bins), m_xmin(xmin),
+      m_xmax(xmax), m_scale(static_cast<T>(n_bins) / (xmax - xmin)) {
     if (rows < 1 || cols < 1 || n_bins < 1) {
         throw std::invalid_argument(
             "PixelHistogramImpl requires positive rows, cols and bins");
@@ -65,11 +137,55 @@ PixelHistogramImpl<T, StorageType>::PixelHistogramImpl(int rows, int cols,
     if (!(xmax > xmin)) {
         throw std::invalid_argument("PixelHistogramImpl requires xmax > xmin");
     }
+    init_scratch();
+}
+
+template <typename T, typename StorageType>
+PixelHistogramImpl<T, StorageType>::PixelHistogramImpl(
+    const NDView<T, 2> &centers, int window_bins, int n_bins, T xmin, T xmax)
+    : PixelHistogramImpl(static_cast<int>(centers.shape(0)),
+                         static_cast<int>(centers.shape(1)), 1, xmin, xmax) {
+    // Delegate with a single bin so the validation runs before anything
+    // large is allocated, then set up the real axis and window.
+    if (n_bins < 1 || window_bins < 1 || window_bins > n_bins) {
+        throw std::invalid_argument(
+            "PixelHistogramImpl requires 0 < window_bins <= n_bins");
+    }
+    m_n_bins = n_bins;
+    m_window_bins = window_bins;
+    m_scale = static_cast<T>(n_bins) / (xmax - xmin);
+    m_values = NDArray<StorageType, 3>({static_cast<ssize_t>(m_rows),
+                                        static_cast<ssize_t>(m_cols),
+                                        static_cast<ssize_t>(window_bins)},
+                                       StorageType{0});
+    m_offsets = NDArray<int32_t, 2>(centers.shape());
+
+    const int32_t max_offset = n_bins - window_bins;
+    for (ssize_t i = 0; i < centers.size(); ++i) {
+        // Non-finite centres fall back to the start of the axis.
+        const T c = std::isfinite(centers[i])
+                        ? std::clamp(centers[i], xmin, xmax)
+                        : xmin;
+        const auto center_bin = static_cast<int32_t>((c - xmin) * m_scale);
+        m_offsets[i] =
+            std::clamp(center_bin - window_bins / 2, int32_t{0}, max_offset);
+    }
+    init_scratch();
+}
 
-    const T range = xmax - xmin;
-    for (int i = 0; i <= n_bins; ++i) {
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::init_scratch() {
+    m_tile_pixels = std::clamp(stage_bytes / m_window_bins, 1, m_cols);
+    m_stage.assign(static_cast<size_t>(m_tile_pixels) * m_window_bins, 0);
+    m_touched.clear();
+    m_touched.reserve(static_cast<size_t>(m_tile_pixels) * max_staged_frames);
+    m_bin_idx.resize(static_cast<size_t>(m_tile_pixels));
+
+    m_edges = NDArray<T, 1>({static_cast<ssize_t>(m_n_bins + 1)});
+    const T range = m_xmax - m_xmin;
+    for (int i = 0; i <= m_n_bins; ++i) {
         m_edges(i) =
-            xmin + (static_cast<T>(i) * range) / static_cast<T>(n_bins);
+            m_xmin + (static_cast<T>(i) * range) / static_cast<T>(m_n_bins);
     }
 }
 
@@ -79,11 +195,7 @@ void PixelHistogramImpl<T, StorageType>::fill(const NDView<T, 2> &frame) {
         throw std::invalid_argument(
             "PixelHistogramImpl::fill: frame shape does not match histogram");
     }
-    for (int row = 0; row < m_rows; ++row) {
-        for (int col = 0; col < m_cols; ++col) {
-            fill_unchecked(row, col, frame(row, col));
-        }
-    }
+    fill_rows(frame, 0);
 }
 
 template <typename T, typename StorageType>
@@ -107,6 +219,12 @@ void PixelHistogramImpl<T, StorageType>::fill_unchecked(int row, int col,
     if (bin >= m_n_bins) {
         bin = m_n_bins - 1;
     }
+    if (is_windowed()) {
+        bin -= m_offsets(row, col);
+        if (bin < 0 || bin >= m_window_bins) {
+            return;
+        }
+    }
     if constexpr (std::is_integral_v<StorageType>) {
         if (m_values(row, col, bin) >=
             std::numeric_limits<StorageType>::max()) {
@@ -116,9 +234,142 @@ void PixelHistogramImpl<T, StorageType>::fill_unchecked(int row, int col,
     ++m_values(row, col, bin);
 }
 
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::fill_rows(const NDView<T, 2> &frame,
+                                                   int first_row) {
+    fill_band(&frame, 1, first_row);
+}
+
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::fill_rows(
+    const std::vector<NDView<T, 2>> &frames, int first_row) {
+    fill_band(frames.data(), frames.size(), first_row);
+}
+
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::fill_band(const NDView<T, 2> *frames,
+                                                   size_t n_frames,
+                                                   int first_row) {
+    const bool windowed = is_windowed();
+    for (int row = 0; row < m_rows; ++row) {
+        const auto src_row = static_cast<ssize_t>(first_row + row);
+        for (int col0 = 0; col0 < m_cols; col0 += m_tile_pixels) {
+            const int n = std::min(m_tile_pixels, m_cols - col0);
+            StorageType *dst = &m_values(row, col0, 0);
+
+            size_t staged = 0;
+            for (size_t f = 0; f < n_frames; ++f) {
+                const auto &frame = frames[f];
+                compute_bins(&frame(src_row, col0), n, m_bin_idx.data());
+                if (windowed) {
+                    apply_window(&m_offsets(row, col0), n, m_bin_idx.data());
+                }
+                for (int i = 0; i < n; ++i) {
+                    const int32_t bin = m_bin_idx[i];
+                    if (bin < 0) {
+                        continue;
+                    }
+                    const auto offset =
+                        static_cast<uint32_t>(i * m_window_bins + bin);
+                    if (m_stage[offset]++ == 0) {
+                        m_touched.push_back(offset);
+                    }
+                }
+                if (++staged == max_staged_frames) {
+                    spill(dst);
+                    staged = 0;
+                }
+            }
+            if (staged != 0) {
+                spill(dst);
+            }
+        }
+    }
+}
+
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::compute_bins(const T *src, int n,
+                                                      int32_t *bins) const {
+    // Branch-free so that the compiler can vectorise the loop. Out of range
+    // (and NaN) values are replaced by xmin before the conversion to keep
+    // the float -> int cast well defined, and then masked to -1.
+    const int32_t last_bin = m_n_bins - 1;
+    for (int i = 0; i < n; ++i) {
+        const T value = src[i];
+        const bool in_range = (value >= m_xmin) & (value < m_xmax);
+        const T x = in_range ? value : m_xmin;
+        int32_t bin = static_cast<int32_t>((x - m_xmin) * m_scale);
+        // Guard against floating-point rounding pushing val just below
+        // xmax to bin == n_bins.
+        bin = bin > last_bin ? last_bin : bin;
+        bins[i] = in_range ? bin : int32_t{-1};
+    }
+}
+
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::apply_window(const int32_t *offsets,
+                                                      int n,
+                                                      int32_t *bins) const {
+    // Translate global bins into window bins, masking everything that is
+    // outside the pixel's window. Branch-free like compute_bins.
+    for (int i = 0; i < n; ++i) {
+        const int32_t bin = bins[i] - offsets[i];
+        const bool keep = (bins[i] >= 0) & (bin >= 0) & (bin < m_window_bins);
+        bins[i] = keep ? bin : int32_t{-1};
+    }
+}
+
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::spill(StorageType *dst) {
+    // dst points at the first bin of the tile's first pixel. A tile spans
+    // consecutive columns of one row, so the stage and the storage share
+    // the same [pixel][bin] layout.
+    for (const uint32_t offset : m_touched) {
+        const uint8_t count = m_stage[offset];
+        m_stage[offset] = 0;
+        if constexpr (std::is_integral_v<StorageType>) {
+            // Saturating add, equivalent to count checked increments.
+            const StorageType current = dst[offset];
+            const auto headroom = static_cast<uint64_t>(
+                std::numeric_limits<StorageType>::max() - current);
+            dst[offset] = headroom < count
+                              ? std::numeric_limits<StorageType>::max()
+                              : static_cast<StorageType>(current + count);
+        } else {
+            dst[offset] += static_cast<StorageType>(count);
+        }
+    }
+    m_touched.clear();
+}
+
 template <typename T, typename StorageType>
 NDArray<StorageType, 3> PixelHistogramImpl<T, StorageType>::values() const {
-    return m_values;
+    if (!is_windowed()) {
+        return m_values;
+    }
+    NDArray<StorageType, 3> data({static_cast<ssize_t>(m_rows),
+                                  static_cast<ssize_t>(m_cols),
+                                  static_cast<ssize_t>(m_n_bins)});
+    values_into(data.data());
+    return data;
+}
+
+template <typename T, typename StorageType>
+void PixelHistogramImpl<T, StorageType>::values_into(StorageType *dst) const {
+    if (!is_windowed()) {
+        std::copy(m_values.begin(), m_values.end(), dst);
+        return;
+    }
+    const auto n_pixels = static_cast<ssize_t>(m_rows) * m_cols;
+    for (ssize_t i = 0; i < n_pixels; ++i) {
+        StorageType *pixel = dst + i * m_n_bins;
+        const StorageType *window = m_values.data() + i * m_window_bins;
+        const int32_t offset = m_offsets[i];
+        std::fill(pixel, pixel + offset, StorageType{0});
+        std::copy(window, window + m_window_bins, pixel + offset);
+        std::fill(pixel + offset + m_window_bins, pixel + m_n_bins,
+                  StorageType{0});
+    }
 }
 
 template <typename T, typename StorageType>
@@ -126,6 +377,15 @@ NDView<StorageType, 3> PixelHistogramImpl<T, StorageType>::view() const {
     return m_values.view();
 }
 
+template <typename T, typename StorageType>
+NDArray<int32_t, 2> PixelHistogramImpl<T, StorageType>::offsets() const {
+    if (!is_windowed()) {
+        return NDArray<int32_t, 2>(
+            {static_cast<ssize_t>(m_rows), static_cast<ssize_t>(m_cols)}, 0);
+    }
+    return m_offsets;
+}
+
 template <typename T, typename StorageType>
 NDArray<T, 1> PixelHistogramImpl<T, StorageType>::bin_centers() const {
     NDArray<T, 1> centers({static_cast<ssize_t>(m_n_bins)});
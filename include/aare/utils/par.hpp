@@ -2,6 +2,9 @@
 #pragma once
 #include "aare/NDView.hpp"
 #include "aare/utils/task.hpp"
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -20,6 +23,80 @@ void RunInParallel(F func, const std::vector<std::pair<int, int>> &tasks) {
     }
 }
 
+/**
+ * @brief Call func(first, last) for chunks of at most chunk_size items of
+ * [first, last), handed out on demand to n_threads threads. Threads that get
+ * cheap chunks pick up more of them instead of waiting for the others, use
+ * this over split_task/RunInParallel when the cost per item varies a lot.
+ */
+template <typename F>
+void RunInParallelDynamic(F func, int first, int last, int chunk_size,
+                          int n_threads) {
+    chunk_size = std::max(chunk_size, 1);
+    const int n_chunks = (last - first + chunk_size - 1) / chunk_size;
+    n_threads = std::min(std::max(n_threads, 1), std::max(n_chunks, 1));
+
+    std::atomic<int> next{first};
+    auto worker = [&]() {
+        for (;;) {
+            const int begin = next.fetch_add(chunk_size);
+            if (begin >= last)
+                return;
+            func(begin, std::min(begin + chunk_size, last));
+        }
+    };
+
+    if (n_threads == 1) {
+        worker();
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n_threads; ++i)
+        threads.emplace_back(worker);
+    for (auto &thread : threads)
+        thread.join();
+}
+
+/**
+ * @brief Split [first, last) with split_task and call func(task, first,
+ * last) for every range, on the calling thread if there is only one.
+ * split_task never returns more ranges than threads, so task (in [0,
+ * n_threads)) can select per thread state such as a partial histogram.
+ */
+template <typename F>
+void RunInParallelIndexed(F func, int first, int last, int n_threads) {
+    const auto tasks = split_task(first, last, n_threads);
+    if (tasks.size() <= 1) {
+        if (!tasks.empty())
+            func(0, tasks[0].first, tasks[0].second);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        threads.emplace_back(func, static_cast<int>(t), tasks[t].first,
+                             tasks[t].second);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Call consume(batch) for the batches returned by read() until it
+ * returns an empty one (size() == 0). The next batch is read on another
+ * thread while the current one is consumed, so read and consume must not
+ * share state.
+ */
+template <typename Read, typename Consume>
+void RunWithReadAhead(Read read, Consume consume) {
+    auto batch = read();
+    while (batch.size() > 0) {
+        auto next = std::async(std::launch::async, read);
+        consume(batch);
+        batch = next.get();
+    }
+}
+
 template <typename T>
 std::vector<NDView<T, 3>> make_subviews(NDView<T, 3> &data, ssize_t n_threads) {
     std::vector<NDView<T, 3>> subviews;
@@ -0,0 +1,26 @@
+# SPDX-License-Identifier: MPL-2.0
+
+
+from . import _aare 
+import numpy as np
+from .ClusterFinder import _get_class
+
+def ClusterArrays(clusters=None, cluster_size=(3,3), dtype = np.int32):
+    """
+    Factory function to create a ClusterArrays object, clusters stored as one
+    array per coordinate and pixel. If clusters is a ClusterVector its clusters
+    are copied and cluster_size and dtype are ignored.
+
+    .. code-block:: python
+
+        from aare import ClusterArrays
+        
+        arrays = ClusterArrays(cluster_vector)
+        arrays.pixels  # (n_pixels, n_clusters) view
+    """
+    if clusters is not None:
+        cls = getattr(_aare, type(clusters).__name__.replace("ClusterVector", "ClusterArrays"))
+        return cls(clusters)
+
+    cls = _get_class("ClusterArrays", cluster_size, dtype)
+    return cls()
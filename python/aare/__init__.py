@@ -16,13 +16,17 @@ from ._aare import corner
 from ._version import __version__
 from .ClusterFinder import ClusterFinder, ClusterCollector, ClusterFinderMT, ClusterFileSink, ClusterFile
 from .ClusterVector import ClusterVector
+from .ClusterArrays import ClusterArrays
 from .Cluster import Cluster
 
 from ._aare import Gaussian, RisingScurve, FallingScurve, Pol1, Pol2, GaussianErfcPlateau, GaussianChargeSharing, GaussianChargeSharingKb
 from ._aare import fit
 from ._aare import fit_gaus, fit_pol1, fit_scurve, fit_scurve2
-from ._aare import Interpolator
+from ._aare import Interpolator, InterpolatedImage, EtaCubeBuilder
+from ._aare import ScanAccumulator
+from ._aare import MetricsSnapshot, LatencySummary
 from ._aare import calculate_eta2, calculate_eta3, calculate_cross_eta3, calculate_full_eta2
+from ._aare import calculate_eta2_batch, calculate_eta3_batch, calculate_cross_eta3_batch, calculate_full_eta2_batch
 from ._aare import reduce_to_2x2, reduce_to_3x3
 
 from ._aare import apply_custom_weights
@@ -54,3 +58,12 @@ from ._aare import (
     PixelHistogram_u32,
     PixelHistogram_u64,
 )
+from ._aare import (
+    HistogramSnapshot_d,
+    HistogramSnapshot_f,
+    HistogramSnapshot_u8,
+    HistogramSnapshot_u16,
+    HistogramSnapshot_u16_f,
+    HistogramSnapshot_u32,
+    HistogramSnapshot_u64,
+)
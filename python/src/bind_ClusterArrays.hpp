@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/CalculateEta.hpp"
+#include "aare/ClusterArrays.hpp"
+#include "aare/ClusterVector.hpp"
+#include "np_helper.hpp"
+
+#include <cstdint>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+using namespace aare;
+
+// The arrays returned by the properties of ClusterArrays are views into its
+// storage. Weak references to them are kept in self._views, so that growing
+// the storage, which would leave them dangling, can be refused while any of
+// them is still alive.
+inline py::array register_view(py::object self, py::array view) {
+    if (!py::hasattr(self, "_views"))
+        self.attr("_views") = py::list();
+    py::list views = self.attr("_views");
+    views.append(py::weakref(view));
+    return view;
+}
+
+inline void check_no_views(py::object self) {
+    if (!py::hasattr(self, "_views"))
+        return;
+    py::list alive;
+    for (auto ref : py::list(self.attr("_views"))) {
+        if (!ref().is_none())
+            alive.append(ref);
+    }
+    self.attr("_views") = alive;
+    if (alive.size() > 0) {
+        PyErr_SetString(PyExc_BufferError,
+                        "ClusterArrays cannot grow while numpy views of it "
+                        "(x, y, frame_numbers, pixels) exist, delete them or "
+                        "reserve enough capacity up front");
+        throw py::error_already_set();
+    }
+}
+
+template <typename Type, uint8_t ClusterSizeX, uint8_t ClusterSizeY,
+          typename CoordType = uint16_t>
+void define_ClusterArrays(py::module &m, const std::string &typestr) {
+    using ClusterType = Cluster<Type, ClusterSizeX, ClusterSizeY, CoordType>;
+    using Arrays = ClusterArrays<ClusterType>;
+    auto class_name = fmt::format("ClusterArrays_{}", typestr);
+
+    // The arrays returned by the properties are views into the ClusterArrays
+    // and keep it alive. append and push_back raise a BufferError instead of
+    // reallocating while any of them exists.
+    py::class_<Arrays>(m, class_name.c_str(), py::dynamic_attr())
+        .def(py::init<size_t>(), py::arg("capacity") = 1024)
+        .def(py::init<const ClusterVector<ClusterType> &>(),
+             py::arg("clusters"))
+        .def(
+            "append",
+            [](py::object self, const ClusterVector<ClusterType> &clusters) {
+                auto &a = self.cast<Arrays &>();
+                if (a.size() + clusters.size() > a.capacity())
+                    check_no_views(self);
+                a.append(clusters);
+            },
+            py::arg("clusters"))
+        .def(
+            "push_back",
+            [](py::object self, const ClusterType &cluster,
+               int32_t frame_number) {
+                auto &a = self.cast<Arrays &>();
+                if (a.size() == a.capacity())
+                    check_no_views(self);
+                a.push_back(cluster, frame_number);
+            },
+            py::arg("cluster"), py::arg("frame_number") = 0)
+        .def("reserve",
+             [](py::object self, size_t capacity) {
+                 auto &a = self.cast<Arrays &>();
+                 if (capacity > a.capacity())
+                     check_no_views(self);
+                 a.reserve(capacity);
+             },
+             py::arg("capacity"))
+        .def("to_cluster_vector",
+             [](const Arrays &self) {
+                 return new ClusterVector<ClusterType>(
+                     self.to_cluster_vector());
+             })
+        .def(
+            "__call__",
+            [](const Arrays &self, py::array_t<bool> mask) {
+                return self(make_view_1d(mask));
+            },
+            py::arg("mask"), R"(
+            Create a copy containing only the clusters where mask is True.
+
+            Parameters
+            ----------
+
+            mask : 1d boolean numpy array
+                Must be the same length as the number of clusters.
+
+            )")
+        .def("sum",
+             [](const Arrays &self) {
+                 auto *vec = new std::vector<Type>(self.sum());
+                 return return_vector(vec);
+             })
+        .def("__len__", &Arrays::size)
+        .def_property_readonly("size", &Arrays::size)
+        .def_property_readonly("capacity", &Arrays::capacity)
+        .def_property_readonly("cluster_size_x", &Arrays::cluster_size_x)
+        .def_property_readonly("cluster_size_y", &Arrays::cluster_size_y)
+        .def_property_readonly(
+            "x",
+            [](py::object self) {
+                auto &a = self.cast<Arrays &>();
+                py::array_t<CoordType> view({a.size()}, {sizeof(CoordType)},
+                                            a.x_data(), self);
+                return register_view(self, view);
+            },
+            "x coordinates as a view, the ClusterArrays cannot grow while it "
+            "exists")
+        .def_property_readonly(
+            "y",
+            [](py::object self) {
+                auto &a = self.cast<Arrays &>();
+                py::array_t<CoordType> view({a.size()}, {sizeof(CoordType)},
+                                            a.y_data(), self);
+                return register_view(self, view);
+            },
+            "y coordinates as a view, the ClusterArrays cannot grow while it "
+            "exists")
+        .def_property_readonly(
+            "frame_numbers",
+            [](py::object self) {
+                auto &a = self.cast<Arrays &>();
+                py::array_t<int32_t> view({a.size()}, {sizeof(int32_t)},
+                                          a.frame_numbers_data(), self);
+                return register_view(self, view);
+            },
+            "frame numbers as a view, the ClusterArrays cannot grow while it "
+            "exists")
+        .def_property_readonly(
+            "pixels",
+            [](py::object self) {
+                auto &a = self.cast<Arrays &>();
+                // (pixel, cluster), planes are capacity apart
+                py::array_t<Type> view(
+                    {Arrays::n_pixels, a.size()},
+                    {a.capacity() * sizeof(Type), sizeof(Type)},
+                    a.pixel_data(0), self);
+                return register_view(self, view);
+            },
+            R"(pixel values as a (cluster_size_x*cluster_size_y, size) view,
+            row k holds pixel k of all clusters. Growing the ClusterArrays is
+            refused while it exists.)");
+
+    m.def(
+        "calculate_eta2_batch",
+        [](const Arrays &clusters) {
+            EtaArrays<Type> eta;
+            {
+                py::gil_scoped_release release;
+                eta = calculate_eta2_batch(clusters);
+            }
+            return return_eta_arrays(std::move(eta));
+        },
+        R"(calculates eta2x2 of all clusters, returns the numpy arrays
+        (x, y, sum, c) with c the corner as int)",
+        py::arg("clusters"));
+
+    m.def(
+        "calculate_full_eta2_batch",
+        [](const Arrays &clusters) {
+            EtaArrays<Type> eta;
+            {
+                py::gil_scoped_release release;
+                eta = calculate_full_eta2_batch(clusters);
+            }
+            return return_eta_arrays(std::move(eta));
+        },
+        R"(calculates full eta2x2 of all clusters, returns the numpy arrays
+        (x, y, sum, c) with c the corner as int)",
+        py::arg("clusters"));
+}
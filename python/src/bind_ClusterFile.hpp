@@ -28,7 +28,9 @@ void define_ClusterFile(py::module &m, const std::string &typestr) {
 
     auto class_name = fmt::format("ClusterFile_{}", typestr);
 
-    py::class_<ClusterFile<ClusterType>>(m, class_name.c_str())
+    py::class_<ClusterFile<ClusterType>>(m, class_name.c_str(), R"(
+        Not thread safe, the GIL is released while reading and writing. Do
+        not use the same object from several Python threads at once.)")
         .def(py::init<const std::filesystem::path &, size_t,
                       const std::string &>(),
              py::arg(), py::arg("chunk_size") = 1000, py::arg("mode") = "r")
@@ -39,12 +41,15 @@ void define_ClusterFile(py::module &m, const std::string &typestr) {
                     self.read_clusters(n_clusters));
                 return v;
             },
-            py::return_value_policy::take_ownership, py::arg("n_clusters"))
-        .def("read_frame",
-             [](ClusterFile<ClusterType> &self) {
-                 auto v = new ClusterVector<ClusterType>(self.read_frame());
-                 return v;
-             })
+            py::return_value_policy::take_ownership, py::arg("n_clusters"),
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "read_frame",
+            [](ClusterFile<ClusterType> &self) {
+                auto v = new ClusterVector<ClusterType>(self.read_frame());
+                return v;
+            },
+            py::call_guard<py::gil_scoped_release>())
         .def("set_roi", &ClusterFile<ClusterType>::set_roi, py::arg("roi"))
         .def("tell", &ClusterFile<ClusterType>::tell)
         .def(
@@ -62,7 +67,8 @@ void define_ClusterFile(py::module &m, const std::string &typestr) {
              })
 
         .def("close", &ClusterFile<ClusterType>::close)
-        .def("write_frame", &ClusterFile<ClusterType>::write_frame)
+        .def("write_frame", &ClusterFile<ClusterType>::write_frame,
+             py::call_guard<py::gil_scoped_release>())
         .def("__enter__", [](ClusterFile<ClusterType> &self) { return &self; })
         .def("__exit__",
              [](ClusterFile<ClusterType> &self,
@@ -73,9 +79,14 @@ void define_ClusterFile(py::module &m, const std::string &typestr) {
              })
         .def("__iter__", [](ClusterFile<ClusterType> &self) { return &self; })
         .def("__next__", [](ClusterFile<ClusterType> &self) {
-            auto v = new ClusterVector<ClusterType>(
-                self.read_clusters(self.chunk_size()));
+            ClusterVector<ClusterType> *v = nullptr;
+            {
+                py::gil_scoped_release release;
+                v = new ClusterVector<ClusterType>(
+                    self.read_clusters(self.chunk_size()));
+            }
             if (v->size() == 0) {
+                delete v;
                 throw py::stop_iteration();
             }
             return v;
@@ -32,7 +32,10 @@ void define_ClusterFileSink(py::module &m, const std::string &typestr) {
     py::class_<ClusterFileSink<ClusterType>>(m, class_name.c_str())
         .def(py::init<ClusterFinderMT<ClusterType, uint16_t, double> *,
                       const std::filesystem::path &>())
-        .def("stop", &ClusterFileSink<ClusterType>::stop);
+        .def("stop", &ClusterFileSink<ClusterType>::stop)
+        .def("metrics", &ClusterFileSink<ClusterType>::metrics,
+             R"(MetricsSnapshot with frames, clusters and bytes written,
+             busy and idle time and write latency)");
 }
 
 #pragma GCC diagnostic pop
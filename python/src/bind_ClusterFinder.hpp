@@ -30,7 +30,9 @@ void define_ClusterFinder(py::module &m, const std::string &typestr) {
     using ClusterType = Cluster<T, ClusterSizeX, ClusterSizeY, CoordType>;
 
     py::class_<ClusterFinder<ClusterType, uint16_t, pd_type>>(
-        m, class_name.c_str())
+        m, class_name.c_str(), R"(
+        Not thread safe, the GIL is released while finding clusters. Do not
+        use the same object from several Python threads at once.)")
         .def(py::init<Shape<2>, pd_type, size_t>(), py::arg("image_size"),
              py::arg("n_sigma") = 5.0, py::arg("capacity") = 1'000'000)
 
@@ -44,6 +46,7 @@ void define_ClusterFinder(py::module &m, const std::string &typestr) {
              [](ClusterFinder<ClusterType, uint16_t, pd_type> &self,
                 py::array_t<uint16_t> frame) {
                  auto view = make_view_2d(frame);
+                 py::gil_scoped_release release;
                  self.push_pedestal_frame(view);
              })
         .def("clear_pedestal",
@@ -76,8 +79,8 @@ void define_ClusterFinder(py::module &m, const std::string &typestr) {
             [](ClusterFinder<ClusterType, uint16_t, pd_type> &self,
                py::array_t<uint16_t> frame, uint64_t frame_number) {
                 auto view = make_view_2d(frame);
+                py::gil_scoped_release release;
                 self.find_clusters(view, frame_number);
-                return;
             },
             py::arg(), py::arg("frame_number") = 0);
 }
@@ -30,7 +30,9 @@ void define_ClusterFinderMT(py::module &m, const std::string &typestr) {
     using ClusterType = Cluster<T, ClusterSizeX, ClusterSizeY, CoordType>;
 
     py::class_<ClusterFinderMT<ClusterType, uint16_t, pd_type>>(
-        m, class_name.c_str())
+        m, class_name.c_str(), R"(
+        Frames have to be pushed from one Python thread at a time, the GIL is
+        released while a frame is queued.)")
         .def(py::init<Shape<2>, pd_type, size_t, size_t>(),
              py::arg("image_size"), py::arg("n_sigma") = 5.0,
              py::arg("capacity") = 2048, py::arg("n_threads") = 3)
@@ -38,6 +40,7 @@ void define_ClusterFinderMT(py::module &m, const std::string &typestr) {
              [](ClusterFinderMT<ClusterType, uint16_t, pd_type> &self,
                 py::array_t<uint16_t> frame) {
                  auto view = make_view_2d(frame);
+                 py::gil_scoped_release release;
                  self.push_pedestal_frame(view);
              })
         .def(
@@ -45,8 +48,8 @@ void define_ClusterFinderMT(py::module &m, const std::string &typestr) {
             [](ClusterFinderMT<ClusterType, uint16_t, pd_type> &self,
                py::array_t<uint16_t> frame, uint64_t frame_number) {
                 auto view = make_view_2d(frame);
+                py::gil_scoped_release release;
                 self.find_clusters(view, frame_number);
-                return;
             },
             py::arg(), py::arg("frame_number") = 0)
         .def_property_readonly(
@@ -56,8 +59,14 @@ void define_ClusterFinderMT(py::module &m, const std::string &typestr) {
             })
         .def("clear_pedestal",
              &ClusterFinderMT<ClusterType, uint16_t, pd_type>::clear_pedestal)
-        .def("sync", &ClusterFinderMT<ClusterType, uint16_t, pd_type>::sync)
-        .def("stop", &ClusterFinderMT<ClusterType, uint16_t, pd_type>::stop)
+        .def("sync", &ClusterFinderMT<ClusterType, uint16_t, pd_type>::sync,
+             py::call_guard<py::gil_scoped_release>())
+        .def("metrics",
+             &ClusterFinderMT<ClusterType, uint16_t, pd_type>::metrics,
+             R"(MetricsSnapshot with frames, clusters, per thread busy and
+             idle time, queue depths and latencies)")
+        .def("stop", &ClusterFinderMT<ClusterType, uint16_t, pd_type>::stop,
+             py::call_guard<py::gil_scoped_release>())
         .def("start", &ClusterFinderMT<ClusterType, uint16_t, pd_type>::start)
         .def(
             "pedestal",
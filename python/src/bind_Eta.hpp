@@ -1,4 +1,5 @@
 #include "aare/CalculateEta.hpp"
+#include "np_helper.hpp"
 
 #include <cstdint>
 // #include <pybind11/native_enum.h> only for version 3
@@ -21,6 +22,17 @@ void define_eta(py::module &m, const std::string &typestr) {
         .def_readwrite("sum", &Eta2<T>::sum, "photon energy of cluster");
 }
 
+/**
+ * @brief EtaArrays as a tuple of numpy arrays (x, y, sum, c)
+ */
+template <typename T> py::tuple return_eta_arrays(EtaArrays<T> &&eta) {
+    return py::make_tuple(
+        return_image_data(new NDArray<double, 1>(std::move(eta.x))),
+        return_image_data(new NDArray<double, 1>(std::move(eta.y))),
+        return_image_data(new NDArray<T, 1>(std::move(eta.sum))),
+        return_image_data(new NDArray<int, 1>(std::move(eta.c))));
+}
+
 void define_corner_enum(py::module &m) {
     py::enum_<corner>(m, "corner", "enum.Enum")
         .value("cTopLeft", corner::cTopLeft)
@@ -64,6 +76,34 @@ void register_calculate_2x2eta(py::module &m) {
             return return_vector(eta2);
         },
         R"(calculates full eta2x2)", py::arg("clusters"));
+
+    m.def(
+        "calculate_eta2_batch",
+        [](const aare::ClusterVector<ClusterType> &clusters) {
+            EtaArrays<Type> eta;
+            {
+                py::gil_scoped_release release;
+                eta = calculate_eta2_batch(clusters);
+            }
+            return return_eta_arrays(std::move(eta));
+        },
+        R"(calculates eta2x2 of all clusters, returns the numpy arrays
+        (x, y, sum, c) with c the corner as int)",
+        py::arg("clusters"));
+
+    m.def(
+        "calculate_full_eta2_batch",
+        [](const aare::ClusterVector<ClusterType> &clusters) {
+            EtaArrays<Type> eta;
+            {
+                py::gil_scoped_release release;
+                eta = calculate_full_eta2_batch(clusters);
+            }
+            return return_eta_arrays(std::move(eta));
+        },
+        R"(calculates full eta2x2 of all clusters, returns the numpy arrays
+        (x, y, sum, c) with c the corner as int)",
+        py::arg("clusters"));
 }
 
 template <typename Type, uint8_t ClusterSizeX, uint8_t ClusterSizeY,
@@ -101,4 +141,32 @@ void register_calculate_3x3eta(py::module &m) {
         },
         R"(calculates eta3x3 taking into account cross pixels in cluster)",
         py::arg("cluster"));
+
+    m.def(
+        "calculate_eta3_batch",
+        [](const aare::ClusterVector<ClusterType> &clusters) {
+            EtaArrays<Type> eta;
+            {
+                py::gil_scoped_release release;
+                eta = calculate_eta3_batch(clusters);
+            }
+            return return_eta_arrays(std::move(eta));
+        },
+        R"(calculates eta3x3 of all clusters, returns the numpy arrays
+        (x, y, sum, c))",
+        py::arg("clusters"));
+
+    m.def(
+        "calculate_cross_eta3_batch",
+        [](const aare::ClusterVector<ClusterType> &clusters) {
+            EtaArrays<Type> eta;
+            {
+                py::gil_scoped_release release;
+                eta = calculate_cross_eta3_batch(clusters);
+            }
+            return return_eta_arrays(std::move(eta));
+        },
+        R"(calculates cross eta3x3 of all clusters, returns the numpy arrays
+        (x, y, sum, c))",
+        py::arg("clusters"));
 }
\ No newline at end of file
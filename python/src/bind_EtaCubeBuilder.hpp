@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/CalculateEta.hpp"
+#include "aare/ClusterFile.hpp"
+#include "aare/EtaCubeBuilder.hpp"
+#include "np_helper.hpp"
+
+#include <cstdint>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+// clang-format off
+#define REGISTER_ETA_CUBE_BUILDER_ETA2(T, N, M, U)                             \
+    register_eta_cube_builder_fill<T, N, M, U,                                 \
+        aare::calculate_full_eta2<T, N, M, U>>(builder, "_full_eta2",          \
+                                               "full eta2");                   \
+    register_eta_cube_builder_fill<T, N, M, U,                                 \
+        aare::calculate_eta2<T, N, M, U>>(builder, "", "eta2");
+
+#define REGISTER_ETA_CUBE_BUILDER_ETA3(T, N, M, U)                             \
+    register_eta_cube_builder_fill<T, N, M, U,                                 \
+        aare::calculate_eta3<T, N, M, U>>(builder, "_eta3", "full eta3");      \
+    register_eta_cube_builder_fill<T, N, M, U,                                 \
+        aare::calculate_cross_eta3<T, N, M, U>>(builder, "_cross_eta3",        \
+                                                "cross eta3");
+// clang-format on
+
+template <typename Type, uint8_t CoordSizeX, uint8_t CoordSizeY,
+          typename CoordType, auto EtaFunction>
+void register_eta_cube_builder_fill(py::class_<aare::EtaCubeBuilder> &builder,
+                                    const std::string &typestr,
+                                    const std::string &doc_string_etatype) {
+
+    using ClusterType = Cluster<Type, CoordSizeX, CoordSizeY, CoordType>;
+
+    const std::string fill_docstring =
+        "Histogram " + doc_string_etatype + " and energy of the clusters";
+    builder.def(
+        fmt::format("fill{}", typestr).c_str(),
+        [](aare::EtaCubeBuilder &self,
+           const ClusterVector<ClusterType> &clusters) {
+            self.fill<EtaFunction, ClusterType>(clusters);
+        },
+        fill_docstring.c_str(), py::arg("cluster_vector"),
+        py::call_guard<py::gil_scoped_release>());
+
+    const std::string file_docstring = "Histogram " + doc_string_etatype +
+                                       " and energy of all remaining "
+                                       "clusters of the file";
+    builder.def(
+        fmt::format("fill_from_file{}", typestr).c_str(),
+        [](aare::EtaCubeBuilder &self, ClusterFile<ClusterType> &file,
+           size_t chunk_size) {
+            self.fill_from_file<EtaFunction, ClusterType>(file, chunk_size);
+        },
+        file_docstring.c_str(), py::arg("file"),
+        py::arg("chunk_size") = 100000,
+        py::call_guard<py::gil_scoped_release>());
+}
+
+void define_eta_cube_builder_bindings(py::module &m) {
+    auto builder =
+        py::class_<aare::EtaCubeBuilder>(
+            m, "EtaCubeBuilder",
+            "Histogram of eta_x, eta_y and photon energy of clusters, the "
+            "etacube used to construct an Interpolator")
+            .def(py::init([](py::array_t<double> xbins,
+                             py::array_t<double> ybins,
+                             py::array_t<double> ebins, int n_threads) {
+                     return aare::EtaCubeBuilder(
+                         make_view_1d(xbins), make_view_1d(ybins),
+                         make_view_1d(ebins), n_threads);
+                 }),
+                 R"(
+                Args:
+                    xbins: bin edges of etax
+                    ybins: bin edges of etay
+                    ebins: bin edges of photon energy
+                    n_threads: number of threads used to fill the etacube
+                )",
+                 py::arg("xbins"), py::arg("ybins"), py::arg("ebins"),
+                 py::arg("n_threads") = 1)
+            .def(
+                "values",
+                [](const aare::EtaCubeBuilder &self) {
+                    auto *ptr = new NDArray<double, 3>(self.values());
+                    return return_image_data(ptr);
+                },
+                R"(etacube indexed (eta_x, eta_y, energy))")
+            .def("clear", &aare::EtaCubeBuilder::clear);
+
+    REGISTER_ETA_CUBE_BUILDER_ETA3(int, 3, 3, uint16_t);
+    REGISTER_ETA_CUBE_BUILDER_ETA3(float, 3, 3, uint16_t);
+    REGISTER_ETA_CUBE_BUILDER_ETA3(double, 3, 3, uint16_t);
+
+    REGISTER_ETA_CUBE_BUILDER_ETA2(int, 3, 3, uint16_t);
+    REGISTER_ETA_CUBE_BUILDER_ETA2(float, 3, 3, uint16_t);
+    REGISTER_ETA_CUBE_BUILDER_ETA2(double, 3, 3, uint16_t);
+    REGISTER_ETA_CUBE_BUILDER_ETA2(int, 2, 2, uint16_t);
+    REGISTER_ETA_CUBE_BUILDER_ETA2(float, 2, 2, uint16_t);
+    REGISTER_ETA_CUBE_BUILDER_ETA2(double, 2, 2, uint16_t);
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/hist/HistogramSnapshot.hpp"
+#include "np_helper.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/stl/filesystem.h>
+
+namespace py = pybind11;
+using namespace ::aare;
+
+template <typename StorageType, typename AxisType>
+void define_histogram_snapshot_binding(py::module &m, const char *class_name) {
+    using Snapshot = HistogramSnapshot<StorageType, AxisType>;
+
+    py::class_<Snapshot>(m, class_name,
+                         "Serialisable, mergeable snapshot of a per-pixel "
+                         "histogram")
+        .def_static("load", &Snapshot::load,
+                    R"(
+             Read a snapshot written by save().
+
+             Args:
+                 fname: Path to the snapshot file
+             )",
+                    py::arg("fname"),
+                    py::call_guard<py::gil_scoped_release>())
+        .def("save", &Snapshot::save,
+             R"(
+             Write the snapshot to fname. The file is written to a
+             temporary name first and then renamed, so an existing
+             snapshot is only ever replaced by a complete one.
+
+             Args:
+                 fname: Path to the snapshot file
+             )",
+             py::arg("fname"), py::call_guard<py::gil_scoped_release>())
+        .def("merge", &Snapshot::merge,
+             R"(
+             Add the bins and frame count of another snapshot with the same
+             shape and axis to this one.
+
+             Args:
+                 other: Snapshot to add
+             )",
+             py::arg("other"), py::call_guard<py::gil_scoped_release>())
+        .def(
+            "values",
+            [](const Snapshot &self) {
+                auto ptr = new NDArray<StorageType, 3>(self.values());
+                return return_image_data(ptr);
+            },
+            R"(
+             Get the histogram data as a (rows, cols, n_bins) numpy array.
+             )")
+        .def_property_readonly("xmin", &Snapshot::xmin)
+        .def_property_readonly("xmax", &Snapshot::xmax)
+        .def_property_readonly("n_frames", &Snapshot::n_frames)
+        .def_property_readonly("rows", &Snapshot::rows)
+        .def_property_readonly("cols", &Snapshot::cols)
+        .def_property_readonly("n_bins", &Snapshot::n_bins);
+}
+
+void define_histogram_snapshot_bindings(py::module &m) {
+    define_histogram_snapshot_binding<double, double>(m, "HistogramSnapshot_d");
+    define_histogram_snapshot_binding<float, double>(m, "HistogramSnapshot_f");
+    define_histogram_snapshot_binding<std::uint64_t, double>(
+        m, "HistogramSnapshot_u64");
+    define_histogram_snapshot_binding<std::uint32_t, double>(
+        m, "HistogramSnapshot_u32");
+    define_histogram_snapshot_binding<std::uint16_t, double>(
+        m, "HistogramSnapshot_u16");
+    define_histogram_snapshot_binding<std::uint8_t, double>(
+        m, "HistogramSnapshot_u8");
+    // Snapshots of PedestalTrackingPixelHistogram (float32 residual axis)
+    define_histogram_snapshot_binding<std::uint16_t, float>(
+        m, "HistogramSnapshot_u16_f");
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/CalculateEta.hpp"
+#include "aare/ClusterFile.hpp"
+#include "aare/InterpolatedImage.hpp"
+#include "aare/Interpolator.hpp"
+#include "np_helper.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+// clang-format off
+#define REGISTER_INTERPOLATED_IMAGE_ETA2(T, N, M, U)                           \
+    register_interpolated_image_fill<T, N, M, U,                               \
+        aare::calculate_full_eta2<T, N, M, U>>(image, "_full_eta2",            \
+                                               "full eta2");                   \
+    register_interpolated_image_fill<T, N, M, U,                               \
+        aare::calculate_eta2<T, N, M, U>>(image, "", "eta2");
+
+#define REGISTER_INTERPOLATED_IMAGE_ETA3(T, N, M, U)                           \
+    register_interpolated_image_fill<T, N, M, U,                               \
+        aare::calculate_eta3<T, N, M, U>>(image, "_eta3", "full eta3");        \
+    register_interpolated_image_fill<T, N, M, U,                               \
+        aare::calculate_cross_eta3<T, N, M, U>>(image, "_cross_eta3",          \
+                                                "cross eta3");
+// clang-format on
+
+template <typename Type, uint8_t CoordSizeX, uint8_t CoordSizeY,
+          typename CoordType, auto EtaFunction>
+void register_interpolated_image_fill(
+    py::class_<aare::InterpolatedImage> &image, const std::string &typestr,
+    const std::string &doc_string_etatype) {
+
+    using ClusterType = Cluster<Type, CoordSizeX, CoordSizeY, CoordType>;
+
+    const std::string fill_docstring =
+        "Interpolate the clusters based on " + doc_string_etatype +
+        " and add the photons to the image";
+    image.def(
+        fmt::format("fill{}", typestr).c_str(),
+        [](aare::InterpolatedImage &self,
+           const aare::Interpolator &interpolator,
+           const ClusterVector<ClusterType> &clusters) {
+            self.fill<EtaFunction, ClusterType>(interpolator, clusters);
+        },
+        fill_docstring.c_str(), py::arg("interpolator"),
+        py::arg("cluster_vector"), py::call_guard<py::gil_scoped_release>());
+
+    const std::string file_docstring =
+        "Interpolate all remaining clusters of the file based on " +
+        doc_string_etatype + " and add the photons to the image";
+    image.def(
+        fmt::format("fill_from_file{}", typestr).c_str(),
+        [](aare::InterpolatedImage &self,
+           const aare::Interpolator &interpolator,
+           ClusterFile<ClusterType> &file, size_t chunk_size) {
+            self.fill_from_file<EtaFunction, ClusterType>(interpolator, file,
+                                                          chunk_size);
+        },
+        file_docstring.c_str(), py::arg("interpolator"), py::arg("file"),
+        py::arg("chunk_size") = 100000,
+        py::call_guard<py::gil_scoped_release>());
+}
+
+void define_interpolated_image_bindings(py::module &m) {
+    auto image =
+        py::class_<aare::InterpolatedImage>(
+            m, "InterpolatedImage",
+            "Super-resolution image filled directly from interpolated "
+            "clusters")
+            .def(py::init<ssize_t, ssize_t, int, double, double, int>(),
+                 R"(
+                Args:
+                    rows: number of detector rows
+                    cols: number of detector columns
+                    subpixels: image pixels per detector pixel along each
+                        axis, the image has shape
+                        (rows * subpixels, cols * subpixels)
+                    emin: photons with energy below emin are skipped
+                    emax: photons with energy at or above emax are skipped
+                    n_threads: number of threads used to fill the image
+                )",
+                 py::arg("rows"), py::arg("cols"), py::arg("subpixels"),
+                 py::arg("emin") = std::numeric_limits<double>::lowest(),
+                 py::arg("emax") = std::numeric_limits<double>::max(),
+                 py::arg("n_threads") = 1)
+            .def(
+                "values",
+                [](const aare::InterpolatedImage &self) {
+                    auto *ptr = new NDArray<uint32_t, 2>(self.values());
+                    return return_image_data(ptr);
+                },
+                R"(Photon counts per image pixel)")
+            .def_property_readonly("n_photons",
+                                   &aare::InterpolatedImage::n_photons)
+            .def_property_readonly("subpixels",
+                                   &aare::InterpolatedImage::subpixels)
+            .def_property_readonly("emin", &aare::InterpolatedImage::emin)
+            .def_property_readonly("emax", &aare::InterpolatedImage::emax)
+            .def("clear", &aare::InterpolatedImage::clear);
+
+    REGISTER_INTERPOLATED_IMAGE_ETA3(int, 3, 3, uint16_t);
+    REGISTER_INTERPOLATED_IMAGE_ETA3(float, 3, 3, uint16_t);
+    REGISTER_INTERPOLATED_IMAGE_ETA3(double, 3, 3, uint16_t);
+
+    REGISTER_INTERPOLATED_IMAGE_ETA2(int, 3, 3, uint16_t);
+    REGISTER_INTERPOLATED_IMAGE_ETA2(float, 3, 3, uint16_t);
+    REGISTER_INTERPOLATED_IMAGE_ETA2(double, 3, 3, uint16_t);
+    REGISTER_INTERPOLATED_IMAGE_ETA2(int, 2, 2, uint16_t);
+    REGISTER_INTERPOLATED_IMAGE_ETA2(float, 2, 2, uint16_t);
+    REGISTER_INTERPOLATED_IMAGE_ETA2(double, 2, 2, uint16_t);
+}
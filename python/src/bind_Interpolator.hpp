@@ -44,11 +44,46 @@ void register_interpolate(py::class_<aare::Interpolator> &interpolator,
         function_name.c_str(),
         [](aare::Interpolator &self,
            const ClusterVector<ClusterType> &clusters) {
-            auto photons = self.interpolate<EtaFunction, ClusterType>(clusters);
-            auto *ptr = new std::vector<Photon>{photons};
+            std::vector<Photon> photons;
+            {
+                py::gil_scoped_release release;
+                photons =
+                    self.interpolate<EtaFunction, ClusterType>(clusters);
+            }
+            auto *ptr = new std::vector<Photon>{std::move(photons)};
             return return_vector(ptr);
         },
         docstring.c_str(), py::arg("cluster_vector"));
+
+    const std::string batch_docstring =
+        "interpolation based on " + doc_string_etatype +
+        ", split over n_threads threads. Clusters with eta values out of "
+        "bounds of the eta distribution are flagged in valid instead of "
+        "raising (their x and y are NaN)."
+        "\n\nReturns:\n tuple of numpy arrays (x, y, energy, valid)";
+
+    auto batch_function_name = fmt::format("interpolate_batch{}", typestr);
+
+    interpolator.def(
+        batch_function_name.c_str(),
+        [](aare::Interpolator &self, const ClusterVector<ClusterType> &clusters,
+           int n_threads) {
+            PhotonArrays photons;
+            {
+                py::gil_scoped_release release;
+                photons = self.interpolate_batch<EtaFunction, ClusterType>(
+                    clusters, n_threads);
+            }
+            return py::make_tuple(
+                return_image_data(new NDArray<double, 1>(std::move(photons.x))),
+                return_image_data(new NDArray<double, 1>(std::move(photons.y))),
+                return_image_data(
+                    new NDArray<double, 1>(std::move(photons.energy))),
+                return_image_data(
+                    new NDArray<bool, 1>(std::move(photons.valid))));
+        },
+        batch_docstring.c_str(), py::arg("cluster_vector"),
+        py::arg("n_threads") = 1);
 }
 
 template <typename Type, uint8_t ClusterSizeX, uint8_t ClusterSizeY,
@@ -105,10 +140,10 @@ void define_interpolation_bindings(py::module &m) {
                                py::array::c_style | py::array::forcecast>
                        etacube,
                    py::array_t<double> xbins, py::array_t<double> ybins,
-                   py::array_t<double> ebins) {
+                   py::array_t<double> ebins, int n_threads) {
                     return Interpolator(
                         make_view_3d(etacube), make_view_1d(xbins),
-                        make_view_1d(ybins), make_view_1d(ebins));
+                        make_view_1d(ybins), make_view_1d(ebins), n_threads);
                 }), 
                 R"doc(
                 Constructor 
@@ -123,10 +158,12 @@ void define_interpolation_bindings(py::module &m) {
                     bin edges of etay
                 ebins: 
                     bin edges of photon energy
+                n_threads:
+                    number of threads to split the energy bins over when computing the CDFs
                 )doc",
                 py::arg("etacube"),
                 py::arg("xbins"), py::arg("ybins"),
-                py::arg("ebins"))
+                py::arg("ebins"), py::arg("n_threads") = 1)
 
             .def(py::init(
                 [](py::array_t<double> xbins, py::array_t<double> ybins,
@@ -153,16 +190,19 @@ void define_interpolation_bindings(py::module &m) {
                 [](Interpolator &self,
                    py::array_t<double,
                                py::array::c_style | py::array::forcecast>
-                       etacube) {
-                    return self.rosenblatttransform(make_view_3d(etacube));
+                       etacube, int n_threads) {
+                    return self.rosenblatttransform(make_view_3d(etacube),
+                                                    n_threads);
                 },
                 R"(
                 calculated the rosenblatttransform for the given distribution
                 
                 etacube: 
                     joint distribution of eta_x, eta_y and photon energy (**Note:** for the joint distribution first dimension is eta_x, second: eta_y, third: energy bins.)
+                n_threads:
+                    number of threads to split the energy bins over
                 )",
-                py::arg("etacube"))
+                py::arg("etacube"), py::arg("n_threads") = 1)
             .def("get_ietax",
                  [](Interpolator &self) {
                      auto *ptr = new NDArray<double, 3>{};
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/Metrics.hpp"
+
+#include <filesystem>
+#include <map>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/stl/filesystem.h>
+#include <string>
+
+namespace py = pybind11;
+
+namespace {
+
+py::dict labels_to_dict(const aare::MetricLabels &labels) {
+    py::dict d;
+    for (const auto &[key, value] : labels)
+        d[py::str(key)] = value;
+    return d;
+}
+
+py::list values_to_list(const std::vector<aare::MetricValue> &values) {
+    py::list out;
+    for (const auto &v : values) {
+        py::dict d;
+        d["name"] = v.name;
+        d["labels"] = labels_to_dict(v.labels);
+        d["value"] = v.value;
+        out.append(d);
+    }
+    return out;
+}
+
+} // namespace
+
+void define_metrics_bindings(py::module &m) {
+    py::class_<aare::LatencySummary>(
+        m, "LatencySummary",
+        "Latency histogram of a MetricsSnapshot, all values in seconds")
+        .def_readonly("name", &aare::LatencySummary::name)
+        .def_readonly("help", &aare::LatencySummary::help)
+        .def_property_readonly("labels",
+                               [](const aare::LatencySummary &self) {
+                                   return labels_to_dict(self.labels);
+                               })
+        .def_readonly("count", &aare::LatencySummary::count)
+        .def_readonly("sum", &aare::LatencySummary::sum)
+        .def_readonly("max", &aare::LatencySummary::max)
+        .def_readonly("buckets", &aare::LatencySummary::buckets,
+                      "(upper edge, count) of the non-empty buckets")
+        .def("mean", &aare::LatencySummary::mean)
+        .def("quantile", &aare::LatencySummary::quantile,
+             R"(
+             Upper edge of the bucket holding the q-quantile, accurate to
+             1/16 of the value. 0 if nothing was recorded.
+             )",
+             py::arg("q"));
+
+    py::class_<aare::MetricsSnapshot>(
+        m, "MetricsSnapshot",
+        "Telemetry of a processing pipeline, returned by the metrics() "
+        "method of ClusterFinderMT, ClusterFileSink, PixelHistogram and "
+        "PedestalTrackingPixelHistogram")
+        .def(py::init<>())
+        .def_readonly("seconds", &aare::MetricsSnapshot::seconds,
+                      "time since the metrics were created")
+        .def_property_readonly(
+            "counters",
+            [](const aare::MetricsSnapshot &self) {
+                return values_to_list(self.counters);
+            },
+            "list of dicts with name, labels and value")
+        .def_property_readonly(
+            "gauges",
+            [](const aare::MetricsSnapshot &self) {
+                return values_to_list(self.gauges);
+            },
+            "list of dicts with name, labels and value")
+        .def_readonly("histograms", &aare::MetricsSnapshot::histograms)
+        .def("total", &aare::MetricsSnapshot::total,
+             R"(
+             Sum of the counter or gauge `name` over all its labels.
+             Durations are in seconds.
+             )",
+             py::arg("name"))
+        .def(
+            "histogram",
+            [](const aare::MetricsSnapshot &self, const std::string &name,
+               const std::map<std::string, std::string> &labels) {
+                return self.histogram(
+                    name, aare::MetricLabels(labels.begin(), labels.end()));
+            },
+            py::arg("name"),
+            py::arg("labels") = std::map<std::string, std::string>{})
+        .def("append", &aare::MetricsSnapshot::append,
+             R"(
+             Add the metrics of another snapshot, e.g. to export a cluster
+             finder and its file sink together.
+             )",
+             py::arg("other"))
+        .def("to_json", &aare::MetricsSnapshot::to_json)
+        .def("to_prometheus", &aare::MetricsSnapshot::to_prometheus,
+             "Prometheus text exposition format", py::arg("prefix") = "aare_")
+        .def("write_json", &aare::MetricsSnapshot::write_json,
+             py::arg("fname"))
+        .def("write_prometheus", &aare::MetricsSnapshot::write_prometheus,
+             R"(
+             Write the snapshot as a Prometheus text file, e.g. for the
+             node_exporter textfile collector. The file is replaced
+             atomically.
+             )",
+             py::arg("fname"), py::arg("prefix") = "aare_");
+}
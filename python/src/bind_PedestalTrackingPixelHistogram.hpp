@@ -3,9 +3,11 @@
 #include "np_helper.hpp"
 
 #include <cstdint>
+#include <filesystem>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/stl/filesystem.h>
 
 namespace py = pybind11;
 using namespace ::aare;
@@ -31,7 +33,7 @@ void define_pedestal_tracking_pixel_histogram_bindings(py::module &m) {
                      pedestal and the histogram, so the partition
                      determines per-thread memory usage.
                  max_pending: Maximum number of frames that can be
-                     queued for asynchronous filling before
+                     queued per worker for asynchronous filling before
                      fill_async() applies backpressure
                      on the caller (default: 16).
                  n_sigma: Sigma multiplier used as the gate for the
@@ -70,17 +72,16 @@ void define_pedestal_tracking_pixel_histogram_bindings(py::module &m) {
         .def("update_mean", &PedestalTrackingPixelHistogram::update_mean,
              R"(
              Refresh each partial pedestal's cached per-pixel mean from
-             its running sums. Drains pending async fills first, then
-             dispatches the update to the worker pool so the writes to
-             each shard happen on the same thread that reads them in
-             fill_async().
+             its running sums. The update is queued to every worker behind
+             the frames already submitted, so the writes to each shard
+             happen on the same thread that reads them in fill_async().
              )",
              py::call_guard<py::gil_scoped_release>())
 
         .def(
             "pedestal_mean",
             [](const PedestalTrackingPixelHistogram &self) {
-                // pedestal_mean() flushes + locks + memcpys; do all of
+                // pedestal_mean() flushes + memcpys; do all of
                 // that without the GIL, only reacquire to wrap into a
                 // numpy array.
                 NDArray<PedestalTrackingPixelHistogram::AxisType, 2> *ptr =
@@ -106,17 +107,14 @@ void define_pedestal_tracking_pixel_histogram_bindings(py::module &m) {
             [](PedestalTrackingPixelHistogram &self,
                py::array_t<PedestalTrackingPixelHistogram::FrameType, 0>
                    image) {
-                // Copy the numpy buffer into an owned NDArray while we
-                // still hold the GIL so we don't depend on the array's
-                // backing storage outliving this call.
+                // fill_async copies the row bands out of the numpy buffer
+                // before returning, and `image` keeps the buffer alive
+                // until then. Release the GIL while enqueueing -
+                // fill_async can block on backpressure when the worker
+                // rings are full.
                 auto view = make_view_2d(image);
-                NDArray<PedestalTrackingPixelHistogram::FrameType, 2> owned(
-                    view);
-                // Release the GIL while enqueueing -
-                // fill_async can block on backpressure
-                // when the queue is full.
                 py::gil_scoped_release release;
-                self.fill_async(std::move(owned));
+                self.fill_async(view);
             },
             R"(
              Submit an image for asynchronous filling with sigma-clipped
@@ -153,9 +151,17 @@ void define_pedestal_tracking_pixel_histogram_bindings(py::module &m) {
              Args:
                  file_path: Path to the file to fill from
                  max_frames: Maximum number of frames to fill from the file (default: -1)
+                 verbose: Print progress (default: False)
+                 checkpoint_path: If set, a snapshot of the histogram is
+                     written to this path every checkpoint_interval frames
+                     and when the file is done (default: None)
+                 checkpoint_interval: Frames between checkpoints, 0 to only
+                     write at the end (default: 0)
              )",
              py::call_guard<py::gil_scoped_release>(), py::arg("fname"),
-             py::arg("max_frames") = -1, py::arg("verbose") = false)
+             py::arg("max_frames") = -1, py::arg("verbose") = false,
+             py::arg("checkpoint_path") = std::filesystem::path{},
+             py::arg("checkpoint_interval") = 0)
         .def("process_pedestal_file",
              &PedestalTrackingPixelHistogram::process_pedestal_file,
              R"(
@@ -177,6 +183,16 @@ void define_pedestal_tracking_pixel_histogram_bindings(py::module &m) {
              per-pixel evaluations inside the worker pool.
              )")
 
+        .def("snapshot", &PedestalTrackingPixelHistogram::snapshot,
+             R"(
+             Snapshot of the histogram that can be saved to disk and merged
+             with snapshots from other processes. Flushes pending fills.
+
+             Returns:
+                 A HistogramSnapshot_u16_f
+             )",
+             py::call_guard<py::gil_scoped_release>())
+
         .def("flush", &PedestalTrackingPixelHistogram::flush,
              R"(
              Block until all images submitted via
@@ -185,6 +201,13 @@ void define_pedestal_tracking_pixel_histogram_bindings(py::module &m) {
              )",
              py::call_guard<py::gil_scoped_release>())
 
+        .def("metrics", &PedestalTrackingPixelHistogram::metrics,
+             R"(
+             MetricsSnapshot with the frames submitted, the time the
+             caller was blocked by full worker queues, busy and idle time
+             and queue depth per worker and the submit and task latency.
+             )")
+
         .def(
             "values",
             [](const PedestalTrackingPixelHistogram &self) {
@@ -3,10 +3,13 @@
 #include "np_helper.hpp"
 
 #include <cstddef>
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <stdexcept>
 #include <string>
 
 namespace py = pybind11;
@@ -25,7 +28,8 @@ void define_pixel_histogram_binding(py::module &m, const char *class_name,
         storage_dtype + " bin storage";
 
     py::class_<Hist>(m, class_name, doc.c_str())
-        .def(py::init<int, int, int, double, double, int, std::size_t>(),
+        .def(py::init<int, int, int, double, double, int, std::size_t,
+                      std::size_t>(),
              R"(
              Initialize a PixelHistogram.
 
@@ -39,19 +43,66 @@ void define_pixel_histogram_binding(py::module &m, const char *class_name,
                  max_pending: Maximum number of images that can be queued for
                      asynchronous filling before fill_async() applies
                      backpressure on the caller (default: 16)
+                 batch_size: Maximum number of queued images handed to each
+                     worker thread per wakeup (default: 4)
              )",
              py::kw_only(), py::arg("rows"), py::arg("cols"), py::arg("n_bins"),
              py::arg("xmin"), py::arg("xmax"), py::arg("n_threads") = 1,
-             py::arg("max_pending") = std::size_t{16})
+             py::arg("max_pending") = std::size_t{16},
+             py::arg("batch_size") = std::size_t{4})
+
+        .def(py::init([](py::array_t<double, py::array::c_style |
+                                                py::array::forcecast>
+                             centers,
+                         int window_bins, int n_bins, double xmin, double xmax,
+                         int n_threads, std::size_t max_pending,
+                         std::size_t batch_size) {
+                 auto view = make_view_2d(centers);
+                 return std::make_unique<Hist>(view, window_bins, n_bins, xmin,
+                                               xmax, n_threads, max_pending,
+                                               batch_size);
+             }),
+             R"(
+             Initialize a PixelHistogram that only stores a window of bins
+             around a per-pixel centre.
+
+             Each pixel keeps window_bins consecutive bins of the
+             [xmin, xmax) axis, positioned so that its centre (typically the
+             pedestal) falls into the middle of the window. Values outside
+             the window are dropped. values() still returns the dense
+             (rows, cols, n_bins) array.
+
+             Args:
+                 centers: 2D array with the centre value of each pixel. Its
+                     shape sets rows and cols.
+                 window_bins: Number of bins stored per pixel
+                 n_bins: Number of histogram bins of the full axis
+                 xmin: Minimum value for histogram range
+                 xmax: Maximum value for histogram range
+                 n_threads: Number of threads for parallel filling (default: 1)
+                 max_pending: Maximum number of queued images (default: 16)
+                 batch_size: Maximum number of queued images handed to each
+                     worker thread per wakeup (default: 4)
+             )",
+             py::kw_only(), py::arg("centers"), py::arg("window_bins"),
+             py::arg("n_bins"), py::arg("xmin"), py::arg("xmax"),
+             py::arg("n_threads") = 1, py::arg("max_pending") = std::size_t{16},
+             py::arg("batch_size") = std::size_t{4})
 
         .def(
             "fill_async",
             [](Hist &self, py::array_t<double, 0> image) {
-                // Copy the numpy buffer into an owned NDArray while we
-                // still hold the GIL so we don't depend on the array's
-                // backing storage outliving this call.
+                // Copy the numpy buffer into an owned (recycled) NDArray
+                // while we still hold the GIL so we don't depend on the
+                // array's backing storage outliving this call.
                 auto view = make_view_2d(image);
-                NDArray<double, 2> owned(view);
+                NDArray<double, 2> owned = self.acquire_buffer();
+                if (view.shape() != owned.shape()) {
+                    throw std::invalid_argument("PixelHistogram image shape "
+                                                "does not match constructor "
+                                                "shape");
+                }
+                std::copy(view.begin(), view.end(), owned.begin());
                 // Release the GIL while enqueueing - fill_async can block
                 // on backpressure when the queue is full.
                 py::gil_scoped_release release;
@@ -71,6 +122,16 @@ void define_pixel_histogram_binding(py::module &m, const char *class_name,
              )",
             py::arg("image").noconvert())
 
+        .def("snapshot", &Hist::snapshot,
+             R"(
+             Snapshot of the histogram that can be saved to disk and merged
+             with snapshots from other processes. Flushes pending fills.
+
+             Returns:
+                 A HistogramSnapshot with the same storage type
+             )",
+             py::call_guard<py::gil_scoped_release>())
+
         .def("flush", &Hist::flush,
              R"(
              Block until all images submitted via fill_async() have been
@@ -78,6 +139,13 @@ void define_pixel_histogram_binding(py::module &m, const char *class_name,
              )",
              py::call_guard<py::gil_scoped_release>())
 
+        .def("metrics", &Hist::metrics,
+             R"(
+             MetricsSnapshot with the frames and batches histogrammed, the
+             queue depth, the time fill_async() was blocked, busy and idle
+             time per worker and the batch latency.
+             )")
+
         .def(
             "values",
             [](const Hist &self) {
@@ -11,6 +11,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <optional>
 #include <pybind11/iostream.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -22,7 +23,9 @@ namespace py = pybind11;
 using namespace ::aare;
 
 void define_raw_file_io_bindings(py::module &m) {
-    py::class_<RawFile>(m, "RawFile")
+    py::class_<RawFile>(m, "RawFile", R"(
+        Not thread safe, the GIL is released while reading. Do not use the
+        same object from several Python threads at once.)")
         .def(py::init<const std::filesystem::path &>())
         .def("read_frame",
              [](RawFile &self) {
@@ -41,12 +44,62 @@ void define_raw_file_io_bindings(py::module &m) {
 
                  py::array image =
                      allocate_image_data(self.bytes_per_pixel(), shape);
-                 self.read_into(
-                     reinterpret_cast<std::byte *>(image.mutable_data()),
-                     header.mutable_data());
+                 auto *image_data =
+                     reinterpret_cast<std::byte *>(image.mutable_data());
+                 auto *header_data = header.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     self.read_into(image_data, header_data);
+                 }
 
                  return py::make_tuple(header, image);
              })
+        .def(
+            "read_into",
+            [](RawFile &self, py::array out,
+               std::optional<py::array_t<DetectorHeader>> header) {
+                if (self.n_modules_in_roi().size() > 1) {
+                    throw std::runtime_error(
+                        LOCATION +
+                        "File contains multiple ROIs - use read_rois_into()");
+                }
+                const size_t n_frames = frames_in_buffer(
+                    out, self.bytes_per_pixel(), self.rows(), self.cols());
+                if (n_frames > self.total_frames() - self.tell()) {
+                    throw std::runtime_error(
+                        LOCATION + "Not enough frames left in file to fill "
+                                   "the array.");
+                }
+                auto *header_data = headers_in_buffer(
+                    header, n_frames * self.n_modules_in_roi()[0]);
+                auto *image_data =
+                    reinterpret_cast<std::byte *>(out.mutable_data());
+
+                py::gil_scoped_release release;
+                if (n_frames == 1)
+                    self.read_into(image_data, header_data);
+                else
+                    self.read_into(image_data, n_frames, header_data);
+            },
+            R"(
+            Read the next frames into a preallocated array without
+            allocating, for example an array that is reused for every frame.
+            The GIL is released while reading.
+
+            Parameters
+            ----------
+
+            out : numpy.ndarray
+                C contiguous array with shape (rows, cols) to read one frame
+                or (n_frames, rows, cols) to read n_frames. The dtype needs to
+                match the bitdepth of the file.
+
+            header : Optional[numpy.ndarray]
+                C contiguous array of DetectorHeader with space for
+                n_frames * n_modules headers.
+            )",
+            py::arg("out").noconvert(),
+            py::arg("header").noconvert() = py::none())
         .def(
             "read_n",
             [](RawFile &self, size_t n_frames) {
@@ -69,20 +122,27 @@ void define_raw_file_io_bindings(py::module &m) {
                 if (self.n_modules() == 1) {
                     header = py::array_t<DetectorHeader>(n_frames);
                 } else {
+                    // headers are stored frame after frame
                     header = py::array_t<DetectorHeader>(
-                        {self.n_modules_in_roi()[0], n_frames});
+                        {n_frames, self.n_modules_in_roi()[0]});
                 }
 
                 py::array images =
                     allocate_image_data(self.bytes_per_pixel(), shape);
-                self.read_into(
-                    reinterpret_cast<std::byte *>(images.mutable_data()),
-                    n_frames, header.mutable_data());
+                auto *image_data =
+                    reinterpret_cast<std::byte *>(images.mutable_data());
+                auto *header_data = header.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    self.read_into(image_data, n_frames, header_data);
+                }
 
                 return py::make_tuple(header, images);
             },
             R"(
-             Read n frames from the file.
+             Read n frames from the file. The frames are read as one batch
+             into a single (n_frames, rows, cols) array. For multi module
+             files the headers have the shape (n_frames, n_modules).
              )")
 
         .def(
@@ -109,9 +169,14 @@ void define_raw_file_io_bindings(py::module &m) {
                 py::array image =
                     allocate_image_data(self.bytes_per_pixel(), shape);
 
-                self.read_roi_into(
-                    reinterpret_cast<std::byte *>(image.mutable_data()),
-                    roi_index, self.tell(), header.mutable_data());
+                auto *image_data =
+                    reinterpret_cast<std::byte *>(image.mutable_data());
+                auto *header_data = header.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    self.read_roi_into(image_data, roi_index, self.tell(),
+                                       header_data);
+                }
 
                 self.seek(self.tell() + 1); // advance frame number so the
                 return py::make_tuple(header, image);
@@ -158,6 +223,8 @@ void define_raw_file_io_bindings(py::module &m) {
                         py::array_t<DetectorHeader>(self.n_modules_in_roi()[r]);
                 }
 
+                std::vector<std::byte *> buffers(number_of_ROIs);
+                std::vector<DetectorHeader *> header_buffers(number_of_ROIs);
                 for (size_t r = 0; r < number_of_ROIs; r++) {
                     std::vector<size_t> shape;
                     shape.reserve(2);
@@ -166,10 +233,15 @@ void define_raw_file_io_bindings(py::module &m) {
 
                     images[r] =
                         allocate_image_data(self.bytes_per_pixel(), shape);
-
-                    self.read_roi_into(
-                        reinterpret_cast<std::byte *>(images[r].mutable_data()),
-                        r, self.tell(), headers[r].mutable_data());
+                    buffers[r] =
+                        reinterpret_cast<std::byte *>(images[r].mutable_data());
+                    header_buffers[r] = headers[r].mutable_data();
+                }
+                {
+                    py::gil_scoped_release release;
+                    for (size_t r = 0; r < number_of_ROIs; r++)
+                        self.read_roi_into(buffers[r], r, self.tell(),
+                                           header_buffers[r]);
                 }
                 self.seek(self.tell() + 1); // advance frame number so the
                 return py::make_tuple(headers, images);
@@ -192,6 +264,80 @@ void define_raw_file_io_bindings(py::module &m) {
             list of numpy.ndarray
                 One array per ROI.)")
 
+        .def(
+            "read_rois_into",
+            [](RawFile &self, std::vector<py::array> images,
+               std::optional<std::vector<py::array_t<DetectorHeader>>>
+                   headers) {
+                const size_t n_rois = self.num_rois();
+                if (n_rois == 0) {
+                    throw std::runtime_error(LOCATION + "No ROIs defined.");
+                }
+                if (images.size() != n_rois) {
+                    throw std::runtime_error(LOCATION +
+                                             "Need one array per ROI.");
+                }
+                // (rows, cols) for one frame or (n_frames, rows, cols)
+                const size_t n_frames =
+                    images[0].ndim() == 3 ? images[0].shape(0) : 1;
+
+                std::vector<std::byte *> buffers(n_rois);
+                std::vector<DetectorHeader *> header_buffers;
+                for (size_t r = 0; r < n_rois; ++r) {
+                    auto &image = images[r];
+                    if (!(image.flags() & py::array::c_style) ||
+                        !image.writeable() || image.dtype().kind() != 'u' ||
+                        static_cast<size_t>(image.itemsize()) !=
+                            self.bytes_per_pixel() ||
+                        static_cast<size_t>(image.size()) !=
+                            n_frames * self.pixels_per_frame(r)) {
+                        throw std::runtime_error(
+                            LOCATION +
+                            fmt::format("Array for ROI {} needs to be a "
+                                        "writeable, C contiguous array of "
+                                        "{} frames of {}x{} pixels of dtype "
+                                        "uint{}",
+                                        r, n_frames, self.rows(r),
+                                        self.cols(r),
+                                        self.bytes_per_pixel() * 8));
+                    }
+                    buffers[r] =
+                        reinterpret_cast<std::byte *>(image.mutable_data());
+                }
+                if (headers) {
+                    if (headers->size() != n_rois) {
+                        throw std::runtime_error(
+                            LOCATION + "Need one header array per ROI.");
+                    }
+                    for (size_t r = 0; r < n_rois; ++r) {
+                        header_buffers.push_back(headers_in_buffer(
+                            (*headers)[r],
+                            n_frames * self.n_modules_in_roi()[r]));
+                    }
+                }
+
+                py::gil_scoped_release release;
+                self.read_rois_into(buffers, n_frames, header_buffers);
+            },
+            R"(
+            Read the next frames of all ROIs into preallocated arrays, for
+            example arrays that are reused for every frame.
+
+            Parameters
+            ----------
+
+            images : list of numpy.ndarray
+                One C contiguous array per ROI with shape (rows, cols) to
+                read one frame or (n_frames, rows, cols) to read n_frames.
+                The dtype needs to match the bitdepth of the file.
+
+            headers : Optional[list of numpy.ndarray]
+                One writeable, C contiguous array of DetectorHeader per ROI
+                with space for n_frames * n_modules_in_roi[roi] headers.
+            )",
+            py::arg("images").noconvert(),
+            py::arg("headers").noconvert() = py::none())
+
         .def(
             "read_n_with_roi",
             [](RawFile &self, const size_t num_frames, const size_t roi_index) {
@@ -225,12 +371,16 @@ void define_raw_file_io_bindings(py::module &m) {
                     reinterpret_cast<std::byte *>(images.mutable_data());
                 auto h = header.mutable_data();
 
-                for (size_t i = 0; i < n_frames; i++) {
-                    self.read_roi_into(image_buffer, roi_index, self.tell(), h);
+                {
+                    py::gil_scoped_release release;
+                    for (size_t i = 0; i < n_frames; i++) {
+                        self.read_roi_into(image_buffer, roi_index,
+                                           self.tell(), h);
 
-                    self.seek(self.tell() + 1); // advance frame number
-                    image_buffer += self.bytes_per_frame(roi_index);
-                    h += n_mod;
+                        self.seek(self.tell() + 1); // advance frame number
+                        image_buffer += self.bytes_per_frame(roi_index);
+                        h += n_mod;
+                    }
                 }
 
                 return py::make_tuple(header, images);
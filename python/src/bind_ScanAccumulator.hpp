@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/RawFile.hpp"
+#include "aare/ScanAccumulator.hpp"
+#include "np_helper.hpp"
+
+#include <cstdint>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+template <typename T>
+void register_scan_accumulator_add_frame(
+    py::class_<aare::ScanAccumulator> &scan) {
+    scan.def(
+        "add_frame",
+        [](aare::ScanAccumulator &self, size_t step,
+           py::array_t<T, py::array::c_style> frame) {
+            auto view = make_view_2d(frame);
+            py::gil_scoped_release release;
+            self.add_frame(step, view);
+        },
+        R"(Add the counts of one frame to scan step `step`)",
+        py::arg("step"), py::arg("frame"));
+}
+
+void define_scan_accumulator_bindings(py::module &m) {
+    auto scan =
+        py::class_<aare::ScanAccumulator>(
+            m, "ScanAccumulator",
+            "Per pixel counts of a threshold or energy scan, accumulated "
+            "one scan step at a time and fitted with Model.fit_scan")
+            .def(py::init([](ssize_t rows, ssize_t cols,
+                             py::array_t<double> scan_points) {
+                     return aare::ScanAccumulator(rows, cols,
+                                                  make_view_1d(scan_points));
+                 }),
+                 R"(
+                Args:
+                    rows: number of rows of the frames
+                    cols: number of columns of the frames
+                    scan_points: threshold or energy of each scan step
+                )",
+                 py::arg("rows"), py::arg("cols"), py::arg("scan_points"))
+            .def("add_frames", &aare::ScanAccumulator::add_frames,
+                 R"(
+                Add the next n_frames frames of a RawFile to scan step
+                `step`, reading the next batch while the current one is
+                being added.
+                )",
+                 py::arg("step"), py::arg("file"), py::arg("n_frames"),
+                 py::arg("batch_size") = 100,
+                 py::call_guard<py::gil_scoped_release>())
+            .def(
+                "counts",
+                [](const aare::ScanAccumulator &self) {
+                    auto *ptr = new NDArray<uint32_t, 3>(self.counts());
+                    return return_image_data(ptr);
+                },
+                R"(copy of the counts indexed (step, row, col))")
+            .def_property_readonly(
+                "n_frames",
+                [](const aare::ScanAccumulator &self) {
+                    auto *ptr = new NDArray<uint32_t, 1>(self.n_frames());
+                    return return_image_data(ptr);
+                })
+            .def_property_readonly(
+                "scan_points",
+                [](const aare::ScanAccumulator &self) {
+                    auto *ptr = new NDArray<double, 1>(self.scan_points());
+                    return return_image_data(ptr);
+                })
+            .def("clear", &aare::ScanAccumulator::clear);
+
+    register_scan_accumulator_add_frame<uint8_t>(scan);
+    register_scan_accumulator_add_frame<uint16_t>(scan);
+    register_scan_accumulator_add_frame<uint32_t>(scan);
+}
@@ -25,12 +25,14 @@ py::array_t<DataType> pybind_apply_calibration(
     if (data.ndim() == 3 && pedestal.ndim() == 3 && calibration.ndim() == 3) {
         auto ped = make_view_3d(pedestal);
         auto cal = make_view_3d(calibration);
+        py::gil_scoped_release release;
         aare::apply_calibration<DataType, 3>(res, data_span, ped, cal,
                                              n_threads);
     } else if (data.ndim() == 3 && pedestal.ndim() == 2 &&
                calibration.ndim() == 2) {
         auto ped = make_view_2d(pedestal);
         auto cal = make_view_2d(calibration);
+        py::gil_scoped_release release;
         aare::apply_calibration<DataType, 2>(res, data_span, ped, cal,
                                              n_threads);
     } else {
@@ -46,7 +48,10 @@ py::array_t<int> pybind_count_switching_pixels(
 
     auto data_span = make_view_3d(data);
     auto arr = new NDArray<int, 2>{};
-    *arr = aare::count_switching_pixels(data_span, n_threads);
+    {
+        py::gil_scoped_release release;
+        *arr = aare::count_switching_pixels(data_span, n_threads);
+    }
     return return_image_data(arr);
 }
 
@@ -57,7 +62,10 @@ py::array_t<T> pybind_calculate_pedestal(
 
     auto data_span = make_view_3d(data);
     auto arr = new NDArray<T, 3>{};
-    *arr = aare::calculate_pedestal<T, false>(data_span, n_threads);
+    {
+        py::gil_scoped_release release;
+        *arr = aare::calculate_pedestal<T, false>(data_span, n_threads);
+    }
     return return_image_data(arr);
 }
 
@@ -68,7 +76,10 @@ py::array_t<T> pybind_calculate_pedestal_g0(
 
     auto data_span = make_view_3d(data);
     auto arr = new NDArray<T, 2>{};
-    *arr = aare::calculate_pedestal<T, true>(data_span, n_threads);
+    {
+        py::gil_scoped_release release;
+        *arr = aare::calculate_pedestal<T, true>(data_span, n_threads);
+    }
     return return_image_data(arr);
 }
 
@@ -197,7 +197,9 @@ void define_ctb_raw_file_io_bindings(py::module &m) {
               return output;
           });
 
-    py::class_<CtbRawFile>(m, "CtbRawFile")
+    py::class_<CtbRawFile>(m, "CtbRawFile", R"(
+        Not thread safe, the GIL is released while reading. Do not use the
+        same object from several Python threads at once.)")
         .def(py::init<const std::filesystem::path &>())
         .def("read_frame",
              [](CtbRawFile &self) {
@@ -213,9 +215,13 @@ void define_ctb_raw_file_io_bindings(py::module &m) {
                  // always read bytes
                  image = py::array_t<uint8_t>(shape);
 
-                 self.read_into(
-                     reinterpret_cast<std::byte *>(image.mutable_data()),
-                     header.mutable_data());
+                 auto *data =
+                     reinterpret_cast<std::byte *>(image.mutable_data());
+                 auto *header_data = header.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     self.read_into(data, header_data);
+                 }
 
                  return py::make_tuple(header, image);
              })
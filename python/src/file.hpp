@@ -7,6 +7,7 @@
 #include "aare/RawSubFile.hpp"
 
 #include "aare/defs.hpp"
+#include "np_helper.hpp"
 // #include "aare/fClusterFileV2.hpp"
 
 #include <cstdint>
@@ -42,7 +43,9 @@ void define_file_io_bindings(py::module &m) {
                          bunchId, timestamp, modId, row, column, reserved,
                          debug, roundRNumber, detType, version, packetMask);
 
-    py::class_<File>(m, "File")
+    py::class_<File>(m, "File", R"(
+        Not thread safe, the GIL is released while reading. Do not use the
+        same object from several Python threads at once.)")
         .def(py::init([](const std::filesystem::path &fname) {
             return File(fname, "r", {});
         }))
@@ -81,8 +84,12 @@ void define_file_io_bindings(py::module &m) {
                  } else if (item_size == 4) {
                      image = py::array_t<uint32_t>(shape);
                  }
-                 self.read_into(
-                     reinterpret_cast<std::byte *>(image.mutable_data()));
+                 auto *data =
+                     reinterpret_cast<std::byte *>(image.mutable_data());
+                 {
+                     py::gil_scoped_release release;
+                     self.read_into(data);
+                 }
                  return image;
              })
         .def("read_frame",
@@ -101,8 +108,12 @@ void define_file_io_bindings(py::module &m) {
                  } else if (item_size == 4) {
                      image = py::array_t<uint32_t>(shape);
                  }
-                 self.read_into(
-                     reinterpret_cast<std::byte *>(image.mutable_data()));
+                 auto *data =
+                     reinterpret_cast<std::byte *>(image.mutable_data());
+                 {
+                     py::gil_scoped_release release;
+                     self.read_into(data);
+                 }
                  return image;
              })
         .def("read_n",
@@ -124,11 +135,45 @@ void define_file_io_bindings(py::module &m) {
                  } else if (item_size == 4) {
                      image = py::array_t<uint32_t>(shape);
                  }
-                 self.read_into(
-                     reinterpret_cast<std::byte *>(image.mutable_data()),
-                     n_frames);
+                 auto *data =
+                     reinterpret_cast<std::byte *>(image.mutable_data());
+                 {
+                     py::gil_scoped_release release;
+                     self.read_into(data, n_frames);
+                 }
                  return image;
              })
+        .def(
+            "read_into",
+            [](File &self, py::array out) {
+                const size_t n_frames = frames_in_buffer(
+                    out, self.bytes_per_pixel(), self.rows(), self.cols());
+                if (n_frames > self.total_frames() - self.tell()) {
+                    throw std::runtime_error(
+                        fmt::format("Cannot read {} frames, only {} left in "
+                                    "file",
+                                    n_frames,
+                                    self.total_frames() - self.tell()));
+                }
+                auto *data = reinterpret_cast<std::byte *>(out.mutable_data());
+                py::gil_scoped_release release;
+                self.read_into(data, n_frames);
+            },
+            R"(
+            Read the next frames into an existing array instead of allocating
+            a new one, e.g. to reuse the same buffer for every frame. The GIL
+            is released while reading. File does not give access to the frame
+            headers, use RawFile.read_into to read them as well.
+
+            Parameters
+            ----------
+
+            out : numpy.ndarray
+                Writeable, C contiguous array with shape (rows, cols) to read
+                one frame or (n_frames, rows, cols) to read n_frames. The
+                dtype needs to be the unsigned integer of bytes_per_pixel.
+            )",
+            py::arg("out").noconvert())
         .def("__enter__", [](File &self) { return &self; })
         .def("__exit__",
              [](File &self, const std::optional<pybind11::type> &exc_type,
@@ -152,8 +197,12 @@ void define_file_io_bindings(py::module &m) {
                 } else if (item_size == 4) {
                     image = py::array_t<uint32_t>(shape);
                 }
-                self.read_into(
-                    reinterpret_cast<std::byte *>(image.mutable_data()));
+                auto *data =
+                    reinterpret_cast<std::byte *>(image.mutable_data());
+                {
+                    py::gil_scoped_release release;
+                    self.read_into(data);
+                }
                 return image;
             } catch (std::runtime_error &e) {
                 throw py::stop_iteration();
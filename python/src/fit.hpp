@@ -18,7 +18,8 @@ py::object
 fit_dispatch(const aare::FitModel<Model> &model,
              py::array_t<double, py::array::c_style | py::array::forcecast> x,
              py::array_t<double, py::array::c_style | py::array::forcecast> y,
-             py::object y_err_obj, int n_threads);
+             py::object y_err_obj, int n_threads, py::object par_start_obj,
+             bool return_stats);
 
 template <typename Model> void bind_fit_model(py::module &m, const char *name) {
     using FM = aare::FitModel<Model>;
@@ -61,6 +62,12 @@ template <typename Model> void bind_fit_model(py::module &m, const char *name) {
         .def_property("tolerance", &FM::tolerance, &FM::SetTolerance)
         .def_property("compute_errors", &FM::compute_errors,
                       &FM::SetComputeErrors)
+        .def_property("use_lm", &FM::use_lm, &FM::SetUseLM,
+                      R"(fit with the built in Levenberg-Marquardt solver
+                      and fall back to Minuit2 only where it fails)")
+        .def_property("warm_start", &FM::warm_start, &FM::SetWarmStart,
+                      R"(in 3D fits start each pixel from the result of its
+                      left neighbour instead of the automatic estimate)")
         .def(
             "__call__",
             [](const FM & /*self*/,
@@ -84,9 +91,11 @@ template <typename Model> void bind_fit_model(py::module &m, const char *name) {
             [](const FM &self,
                py::array_t<double, py::array::c_style | py::array::forcecast> x,
                py::array_t<double, py::array::c_style | py::array::forcecast> y,
-               py::object y_err_obj, int n_threads) -> py::object {
+               py::object y_err_obj, int n_threads, py::object par_start_obj,
+               bool return_stats) -> py::object {
                 return fit_dispatch<Model, FCN>(self, x, y, y_err_obj,
-                                                n_threads);
+                                                n_threads, par_start_obj,
+                                                return_stats);
             },
             R"doc(
             Fit this model to 1D or 3D data using Minuit2.
@@ -101,9 +110,52 @@ template <typename Model> void bind_fit_model(py::module &m, const char *name) {
                 Per-point uncertainties. None for unweighted fit.
             n_threads : int
                 Number of threads for 3D parallel loop.
+            par_start : array_like or None
+                Start parameters for 3D data, shape (rows, cols, npar), e.g.
+                "par" of a previous scan.
+            return_stats : bool
+                For 3D data also return the convergence statistics.
             )doc",
             py::arg("x"), py::arg("y"), py::arg("y_err") = py::none(),
-            py::arg("n_threads") = 4);
+            py::arg("n_threads") = 4, py::arg("par_start") = py::none(),
+            py::arg("return_stats") = false)
+        .def(
+            "fit_scan",
+            [](const FM &self, const aare::ScanAccumulator &scan,
+               int n_threads, ssize_t block_rows) -> py::dict {
+                constexpr ssize_t npar = Model::npar;
+                const ssize_t rows = scan.rows();
+                const ssize_t cols = scan.cols();
+                auto par_out = new NDArray<double, 3>({rows, cols, npar}, 0.0);
+                auto err_out = new NDArray<double, 3>({rows, cols, npar}, 0.0);
+                auto chi2_out = new NDArray<double, 2>({rows, cols}, 0.0);
+                {
+                    py::gil_scoped_release release;
+                    aare::fit_scan<Model, FCN>(
+                        self, scan, par_out->view(), err_out->view(),
+                        chi2_out->view(), n_threads, block_rows);
+                }
+                py::dict result;
+                result["par"] = return_image_data(par_out);
+                if (self.compute_errors())
+                    result["par_err"] = return_image_data(err_out);
+                else
+                    delete err_out;
+                result["chi2"] = return_image_data(chi2_out);
+                return result;
+            },
+            R"doc(
+            Fit this model to every pixel of a ScanAccumulator, with the
+            scan points as x and the counts per frame of each step, with
+            their Poisson errors, as y and y_err. Steps without frames are
+            left out. The counts are converted block_rows rows at a time,
+            the full y and y_err cubes are never allocated.
+
+            Returns a dict with "par", "par_err" (if compute_errors) and
+            "chi2" like fit() for 3D data.
+            )doc",
+            py::arg("scan"), py::arg("n_threads") = 4,
+            py::arg("block_rows") = 64);
 }
 
 template <typename Model>
@@ -150,7 +202,10 @@ py::object
 fit_dispatch(const aare::FitModel<Model> &model,
              py::array_t<double, py::array::c_style | py::array::forcecast> x,
              py::array_t<double, py::array::c_style | py::array::forcecast> y,
-             py::object y_err_obj, int n_threads) {
+             py::object y_err_obj, int n_threads, py::object par_start_obj,
+             bool return_stats) {
+    using array_d =
+        py::array_t<double, py::array::c_style | py::array::forcecast>;
     constexpr std::size_t npar = Model::npar;
 
     if (y.ndim() == 3) {
@@ -161,10 +216,25 @@ fit_dispatch(const aare::FitModel<Model> &model,
         auto x_view = make_view_1d(x);
         auto y_view = make_view_3d(y);
 
+        array_d par_start;
+        NDView<double, 3> par_start_view{};
+        if (!par_start_obj.is_none()) {
+            par_start = py::cast<array_d>(par_start_obj);
+            if (par_start.ndim() != 3)
+                throw std::runtime_error(
+                    "par_start must have shape (rows, cols, npar).");
+            par_start_view = make_view_3d(par_start);
+        }
+
+        NDArray<double, 3> *stats_out = nullptr;
+        if (return_stats)
+            stats_out = new NDArray<double, 3>(
+                {y.shape(0), y.shape(1), aare::FitStat::size}, 0.0);
+        auto stats_view = stats_out ? stats_out->view() : NDView<double, 3>{};
+
+        py::dict result;
         if (!y_err_obj.is_none()) {
-            auto y_err = py::cast<
-                py::array_t<double, py::array::c_style | py::array::forcecast>>(
-                y_err_obj);
+            auto y_err = py::cast<array_d>(y_err_obj);
 
             if (y_err.ndim() != 3) {
                 throw std::runtime_error(
@@ -175,31 +245,38 @@ fit_dispatch(const aare::FitModel<Model> &model,
                 new NDArray<double, 3>({y.shape(0), y.shape(1), npar}, 0.0);
             auto y_view_err = make_view_3d(y_err);
 
-            aare::fit_3d<Model, FCN>(model, x_view, y_view, y_view_err,
-                                     par_out->view(), err_out->view(),
-                                     chi2_out->view(), n_threads);
+            {
+                py::gil_scoped_release release;
+                aare::fit_3d<Model, FCN>(model, x_view, y_view, y_view_err,
+                                         par_out->view(), err_out->view(),
+                                         chi2_out->view(), n_threads,
+                                         par_start_view, stats_view);
+            }
 
-            if (model.compute_errors()) {
-                return py::dict("par"_a = return_image_data(par_out),
-                                "par_err"_a = return_image_data(err_out),
-                                "chi2"_a = return_image_data(chi2_out));
-            } else {
+            result["par"] = return_image_data(par_out);
+            if (model.compute_errors())
+                result["par_err"] = return_image_data(err_out);
+            else
                 delete err_out;
-                return py::dict("par"_a = return_image_data(par_out),
-                                "chi2"_a = return_image_data(chi2_out));
-            }
         } else {
 
             NDView<double, 3> dummy_err{};
             NDView<double, 3> dummy_err_out{};
 
-            aare::fit_3d<Model, FCN>(model, x_view, y_view, dummy_err,
-                                     par_out->view(), dummy_err_out,
-                                     chi2_out->view(), n_threads);
+            {
+                py::gil_scoped_release release;
+                aare::fit_3d<Model, FCN>(model, x_view, y_view, dummy_err,
+                                         par_out->view(), dummy_err_out,
+                                         chi2_out->view(), n_threads,
+                                         par_start_view, stats_view);
+            }
 
-            return py::dict("par"_a = return_image_data(par_out),
-                            "chi2"_a = return_image_data(chi2_out));
+            result["par"] = return_image_data(par_out);
         }
+        result["chi2"] = return_image_data(chi2_out);
+        if (stats_out)
+            result["stats"] = return_image_data(stats_out);
+        return result;
     } else if (y.ndim() == 1) {
         NDArray<double, 1> result{};
 
@@ -328,7 +405,10 @@ void define_fit_bindings(py::module &m) {
                 auto par = new NDArray<double, 3>{};
                 auto y_view = make_view_3d(y);
                 auto x_view = make_view_1d(x);
-                *par = aare::fit_gaus(x_view, y_view, n_threads);
+                {
+                    py::gil_scoped_release release;
+                    *par = aare::fit_gaus(x_view, y_view, n_threads);
+                }
                 return return_image_data(par);
             } else if (y.ndim() == 1) {
                 auto par = new NDArray<double, 1>{};
@@ -374,8 +454,11 @@ void define_fit_bindings(py::module &m) {
                 auto y_view_err = make_view_3d(y_err);
                 auto x_view = make_view_1d(x);
 
-                aare::fit_gaus(x_view, y_view, y_view_err, par->view(),
-                               par_err->view(), chi2->view(), n_threads);
+                {
+                    py::gil_scoped_release release;
+                    aare::fit_gaus(x_view, y_view, y_view_err, par->view(),
+                                   par_err->view(), chi2->view(), n_threads);
+                }
 
                 return py::dict("par"_a = return_image_data(par),
                                 "par_err"_a = return_image_data(par_err),
@@ -431,7 +514,10 @@ void define_fit_bindings(py::module &m) {
 
                 auto x_view = make_view_1d(x);
                 auto y_view = make_view_3d(y);
-                *par = aare::fit_pol1(x_view, y_view, n_threads);
+                {
+                    py::gil_scoped_release release;
+                    *par = aare::fit_pol1(x_view, y_view, n_threads);
+                }
                 return return_image_data(par);
             } else if (y.ndim() == 1) {
                 auto par = new NDArray<double, 1>{};
@@ -463,8 +549,11 @@ void define_fit_bindings(py::module &m) {
 
                 auto chi2 = new NDArray<double, 2>({y.shape(0), y.shape(1)});
 
-                aare::fit_pol1(x_view, y_view, y_view_err, par->view(),
-                               par_err->view(), chi2->view(), n_threads);
+                {
+                    py::gil_scoped_release release;
+                    aare::fit_pol1(x_view, y_view, y_view_err, par->view(),
+                                   par_err->view(), chi2->view(), n_threads);
+                }
                 return py::dict("par"_a = return_image_data(par),
                                 "par_err"_a = return_image_data(par_err),
                                 "chi2"_a = return_image_data(chi2),
@@ -517,7 +606,10 @@ void define_fit_bindings(py::module &m) {
 
                 auto x_view = make_view_1d(x);
                 auto y_view = make_view_3d(y);
-                *par = aare::fit_scurve(x_view, y_view, n_threads);
+                {
+                    py::gil_scoped_release release;
+                    *par = aare::fit_scurve(x_view, y_view, n_threads);
+                }
                 return return_image_data(par);
             } else if (y.ndim() == 1) {
                 auto par = new NDArray<double, 1>{};
@@ -549,8 +641,11 @@ void define_fit_bindings(py::module &m) {
 
                 auto chi2 = new NDArray<double, 2>({y.shape(0), y.shape(1)});
 
-                aare::fit_scurve(x_view, y_view, y_view_err, par->view(),
-                                 par_err->view(), chi2->view(), n_threads);
+                {
+                    py::gil_scoped_release release;
+                    aare::fit_scurve(x_view, y_view, y_view_err, par->view(),
+                                     par_err->view(), chi2->view(), n_threads);
+                }
                 return py::dict("par"_a = return_image_data(par),
                                 "par_err"_a = return_image_data(par_err),
                                 "chi2"_a = return_image_data(chi2),
@@ -602,7 +697,10 @@ void define_fit_bindings(py::module &m) {
 
                 auto x_view = make_view_1d(x);
                 auto y_view = make_view_3d(y);
-                *par = aare::fit_scurve2(x_view, y_view, n_threads);
+                {
+                    py::gil_scoped_release release;
+                    *par = aare::fit_scurve2(x_view, y_view, n_threads);
+                }
                 return return_image_data(par);
             } else if (y.ndim() == 1) {
                 auto par = new NDArray<double, 1>{};
@@ -634,8 +732,11 @@ void define_fit_bindings(py::module &m) {
 
                 auto chi2 = new NDArray<double, 2>({y.shape(0), y.shape(1)});
 
-                aare::fit_scurve2(x_view, y_view, y_view_err, par->view(),
-                                  par_err->view(), chi2->view(), n_threads);
+                {
+                    py::gil_scoped_release release;
+                    aare::fit_scurve2(x_view, y_view, y_view_err, par->view(),
+                                      par_err->view(), chi2->view(), n_threads);
+                }
                 return py::dict("par"_a = return_image_data(par),
                                 "par_err"_a = return_image_data(par_err),
                                 "chi2"_a = return_image_data(chi2),
@@ -694,7 +795,8 @@ void define_fit_bindings(py::module &m) {
         [](py::object model_obj,
            py::array_t<double, py::array::c_style | py::array::forcecast> x,
            py::array_t<double, py::array::c_style | py::array::forcecast> y,
-           py::object y_err_obj, int n_threads) -> py::object {
+           py::object y_err_obj, int n_threads, py::object par_start_obj,
+           bool return_stats) -> py::object {
             using namespace aare::model;
             using namespace aare::func;
 
@@ -703,7 +805,8 @@ void define_fit_bindings(py::module &m) {
                 const auto &mdl =
                     model_obj.cast<const aare::FitModel<Pol1> &>();
                 return fit_dispatch<Pol1, Chi2Pol1>(mdl, x, y, y_err_obj,
-                                                    n_threads);
+                                                    n_threads, par_start_obj,
+                                                    return_stats);
             }
 
             // ── Polynomial of degree 2 ───────
@@ -711,14 +814,16 @@ void define_fit_bindings(py::module &m) {
                 const auto &mdl =
                     model_obj.cast<const aare::FitModel<Pol2> &>();
                 return fit_dispatch<Pol2, Chi2Pol2>(mdl, x, y, y_err_obj,
-                                                    n_threads);
+                                                    n_threads, par_start_obj,
+                                                    return_stats);
             }
             // ── Gaussian ───────
             if (py::isinstance<aare::FitModel<Gaussian>>(model_obj)) {
                 const auto &mdl =
                     model_obj.cast<const aare::FitModel<Gaussian> &>();
                 return fit_dispatch<Gaussian, Chi2Gaussian>(
-                    mdl, x, y, y_err_obj, n_threads);
+                    mdl, x, y, y_err_obj, n_threads, par_start_obj,
+                    return_stats);
             }
 
             // ── GaussianErfcPlateau ───────
@@ -729,7 +834,8 @@ void define_fit_bindings(py::module &m) {
                         .cast<const aare::FitModel<GaussianErfcPlateau> &>();
                 return fit_dispatch<GaussianErfcPlateau,
                                     Chi2GaussianErfcPlateau>(
-                    mdl, x, y, y_err_obj, n_threads);
+                    mdl, x, y, y_err_obj, n_threads, par_start_obj,
+                    return_stats);
             }
 
             // ── GaussianChargeSharing ───────
@@ -740,7 +846,8 @@ void define_fit_bindings(py::module &m) {
                         .cast<const aare::FitModel<GaussianChargeSharing> &>();
                 return fit_dispatch<GaussianChargeSharing,
                                     Chi2GaussianChargeSharing>(
-                    mdl, x, y, y_err_obj, n_threads);
+                    mdl, x, y, y_err_obj, n_threads, par_start_obj,
+                    return_stats);
             }
 
             // ── GaussianChargeSharingKb ───────
@@ -750,7 +857,8 @@ void define_fit_bindings(py::module &m) {
                     const aare::FitModel<GaussianChargeSharingKb> &>();
                 return fit_dispatch<GaussianChargeSharingKb,
                                     Chi2GaussianChargeSharingKb>(
-                    mdl, x, y, y_err_obj, n_threads);
+                    mdl, x, y, y_err_obj, n_threads, par_start_obj,
+                    return_stats);
             }
 
             // ── Rising Scurve ───────
@@ -758,7 +866,8 @@ void define_fit_bindings(py::module &m) {
                 const auto &mdl =
                     model_obj.cast<const aare::FitModel<RisingScurve> &>();
                 return fit_dispatch<RisingScurve, Chi2RisingScurve>(
-                    mdl, x, y, y_err_obj, n_threads);
+                    mdl, x, y, y_err_obj, n_threads, par_start_obj,
+                    return_stats);
             }
 
             // ── Falling Scurve ───────
@@ -766,7 +875,8 @@ void define_fit_bindings(py::module &m) {
                 const auto &mdl =
                     model_obj.cast<const aare::FitModel<FallingScurve> &>();
                 return fit_dispatch<FallingScurve, Chi2FallingScurve>(
-                    mdl, x, y, y_err_obj, n_threads);
+                    mdl, x, y, y_err_obj, n_threads, par_start_obj,
+                    return_stats);
             }
 
             throw std::runtime_error(
@@ -789,6 +899,12 @@ void define_fit_bindings(py::module &m) {
             Per-point uncertainties.  Same shape as y.  None → unweighted fit.
         n_threads : int
             Number of threads for the 3D parallel loop.
+        par_start : array_like or None
+            Start parameters for 3D data, shape (rows, cols, npar), e.g.
+            "par" of a previous scan. Invalid entries fall back to the
+            automatic estimate.
+        return_stats : bool
+            For 3D input also return the convergence statistics.
  
         Returns
         -------
@@ -801,7 +917,10 @@ void define_fit_bindings(py::module &m) {
               "par"     : (rows, cols, npar) fitted parameters.
               "par_err" : (rows, cols, npar) parameter errors (if compute_errors).
               "chi2"    : (rows, cols)       chi-squared per pixel.
+              "stats"   : (rows, cols, 3)    [calls, failed, seconds] per
+                                             pixel (if return_stats).
         )",
         py::arg("model"), py::arg("x"), py::arg("y"),
-        py::arg("y_err") = py::none(), py::arg("n_threads") = 4);
+        py::arg("y_err") = py::none(), py::arg("n_threads") = 4,
+        py::arg("par_start") = py::none(), py::arg("return_stats") = false);
 }
\ No newline at end of file
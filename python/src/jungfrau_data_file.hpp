@@ -2,9 +2,11 @@
 
 #include "aare/JungfrauDataFile.hpp"
 #include "aare/defs.hpp"
+#include "np_helper.hpp"
 
 #include <cstdint>
 #include <filesystem>
+#include <optional>
 #include <pybind11/iostream.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -24,8 +26,12 @@ auto read_dat_frame(JungfrauDataFile &self) {
     py::array_t<JungfrauDataHeader> header(1);
     py::array_t<uint16_t> image({self.rows(), self.cols()});
 
-    self.read_into(reinterpret_cast<std::byte *>(image.mutable_data()),
-                   header.mutable_data());
+    auto *data = reinterpret_cast<std::byte *>(image.mutable_data());
+    auto *header_data = header.mutable_data();
+    {
+        py::gil_scoped_release release;
+        self.read_into(data, header_data);
+    }
 
     return py::make_tuple(header, image);
 }
@@ -40,8 +46,12 @@ auto read_n_dat_frames(JungfrauDataFile &self, size_t n_frames) {
     py::array_t<JungfrauDataHeader> header(n_frames);
     py::array_t<uint16_t> image({n_frames, self.rows(), self.cols()});
 
-    self.read_into(reinterpret_cast<std::byte *>(image.mutable_data()),
-                   n_frames, header.mutable_data());
+    auto *data = reinterpret_cast<std::byte *>(image.mutable_data());
+    auto *header_data = header.mutable_data();
+    {
+        py::gil_scoped_release release;
+        self.read_into(data, n_frames, header_data);
+    }
 
     return py::make_tuple(header, image);
 }
@@ -50,7 +60,9 @@ void define_jungfrau_data_file_io_bindings(py::module &m) {
     // Make the JungfrauDataHeader usable from numpy
     PYBIND11_NUMPY_DTYPE(JungfrauDataHeader, framenum, bunchid);
 
-    py::class_<JungfrauDataFile>(m, "JungfrauDataFile")
+    py::class_<JungfrauDataFile>(m, "JungfrauDataFile", R"(
+        Not thread safe, the GIL is released while reading. Do not use the
+        same object from several Python threads at once.)")
         .def(py::init<const std::filesystem::path &>())
         .def("seek", &JungfrauDataFile::seek,
              R"(
@@ -81,6 +93,28 @@ void define_jungfrau_data_file_io_bindings(py::module &m) {
              R"(
                Read maximum n_frames frames from the file.
                )")
+        .def(
+            "read_into",
+            [](JungfrauDataFile &self, py::array out,
+               std::optional<py::array_t<JungfrauDataHeader>> header) {
+                const size_t n_frames = frames_in_buffer(
+                    out, self.bytes_per_pixel(), self.rows(), self.cols());
+                if (n_frames > self.total_frames() - self.tell()) {
+                    throw std::runtime_error(
+                        "Not enough frames left in file to fill the array");
+                }
+                auto *header_data = headers_in_buffer(header, n_frames);
+                auto *data = reinterpret_cast<std::byte *>(out.mutable_data());
+                py::gil_scoped_release release;
+                self.read_into(data, n_frames, header_data);
+            },
+            R"(
+               Read the next frames into an existing uint16 array, (rows,
+               cols) for one frame or (n_frames, rows, cols), and optionally
+               their headers. The GIL is released while reading.
+               )",
+            py::arg("out").noconvert(),
+            py::arg("header").noconvert() = py::none())
         .def(
             "read",
             [](JungfrauDataFile &self) {
@@ -3,6 +3,7 @@
 
 // New style file naming
 #include "bind_Cluster.hpp"
+#include "bind_ClusterArrays.hpp"
 #include "bind_ClusterCollector.hpp"
 #include "bind_ClusterFile.hpp"
 #include "bind_ClusterFileSink.hpp"
@@ -11,11 +12,16 @@
 #include "bind_ClusterVector.hpp"
 #include "bind_Defs.hpp"
 #include "bind_Eta.hpp"
+#include "bind_EtaCubeBuilder.hpp"
+#include "bind_HistogramSnapshot.hpp"
+#include "bind_InterpolatedImage.hpp"
 #include "bind_Interpolator.hpp"
+#include "bind_Metrics.hpp"
 #include "bind_PedestalTrackingPixelHistogram.hpp"
 #include "bind_PixelHistogram.hpp"
 #include "bind_PixelMap.hpp"
 #include "bind_RawFile.hpp"
+#include "bind_ScanAccumulator.hpp"
 #include "bind_calibration.hpp"
 
 // TODO! migrate the other names
@@ -47,6 +53,7 @@ double, 'f' for float)
 #define DEFINE_CLUSTER_BINDINGS(T, N, M, U, TYPE_CODE)                         \
     define_ClusterFile<T, N, M, U>(m, "Cluster" #N "x" #M #TYPE_CODE);         \
     define_ClusterVector<T, N, M, U>(m, "Cluster" #N "x" #M #TYPE_CODE);       \
+    define_ClusterArrays<T, N, M, U>(m, "Cluster" #N "x" #M #TYPE_CODE);       \
     define_Cluster<T, N, M, U>(m, #N "x" #M #TYPE_CODE);                       \
     register_calculate_2x2eta<T, N, M, U>(m);                                  \
     define_2x2_reduction<T, N, M, U>(m);                                       \
@@ -66,12 +73,17 @@ PYBIND11_MODULE(_aare, m) {
     define_raw_master_file_bindings(m);
     define_var_cluster_finder_bindings(m);
     define_pixel_map_bindings(m);
+    define_metrics_bindings(m);
+    define_histogram_snapshot_bindings(m);
     define_pixel_histogram_bindings(m);
     define_pedestal_tracking_pixel_histogram_bindings(m);
     define_pedestal_bindings<double>(m, "Pedestal_d");
     define_pedestal_bindings<float>(m, "Pedestal_f");
     define_fit_bindings(m);
     define_interpolation_bindings(m);
+    define_interpolated_image_bindings(m);
+    define_eta_cube_builder_bindings(m);
+    define_scan_accumulator_bindings(m);
     define_jungfrau_data_file_io_bindings(m);
 
     bind_calibration(m);
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <iostream>
+#include <optional>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -101,4 +102,52 @@ py::array allocate_image_data(size_t item_size,
         image_data = py::array_t<uint32_t>(shape);
     }
     return image_data;
-}
\ No newline at end of file
+}
+/**
+ * Helper function to check a caller provided array for the read_into methods
+ * of the file classes. The array needs to be writeable, C contiguous, of an
+ * unsigned integer dtype with item_size bytes per element and the shape
+ * (rows, cols) or (n_frames, rows, cols). Returns the number of frames it
+ * can hold. Bind out with .noconvert(), otherwise pybind11 could pass a
+ * converted copy and the caller would never see the data.
+ */
+size_t frames_in_buffer(const py::array &out, size_t item_size, size_t rows,
+                        size_t cols) {
+    const auto ndim = out.ndim();
+    const bool shape_ok = (ndim == 2 || ndim == 3) &&
+                          static_cast<size_t>(out.shape(ndim - 2)) == rows &&
+                          static_cast<size_t>(out.shape(ndim - 1)) == cols;
+    if (!(out.flags() & py::array::c_style) || !out.writeable() ||
+        out.dtype().kind() != 'u' ||
+        static_cast<size_t>(out.itemsize()) != item_size || !shape_ok) {
+        throw std::runtime_error(
+            fmt::format("out needs to be a writeable, C contiguous array of "
+                        "shape ({0}, {1}) or (n_frames, {0}, {1}) with dtype "
+                        "uint{2}",
+                        rows, cols, item_size * 8));
+    }
+    return ndim == 3 ? static_cast<size_t>(out.shape(0)) : 1;
+}
+
+/**
+ * Helper function to check a header array for the read_into methods. It
+ * needs to be writeable, C contiguous and hold at least n_headers elements.
+ * Returns a pointer to its data.
+ */
+template <typename T>
+T *headers_in_buffer(py::array_t<T> &header, size_t n_headers) {
+    if (!(header.flags() & py::array::c_style) || !header.writeable() ||
+        static_cast<size_t>(header.size()) < n_headers) {
+        throw std::runtime_error(
+            fmt::format("header needs to be a writeable, C contiguous array "
+                        "with space for {} headers",
+                        n_headers));
+    }
+    return header.mutable_data();
+}
+
+/** Same for an optional header array, nullptr if none was passed */
+template <typename T>
+T *headers_in_buffer(std::optional<py::array_t<T>> &header, size_t n_headers) {
+    return header ? headers_in_buffer(*header, n_headers) : nullptr;
+}
@@ -12,7 +12,9 @@ namespace py = pybind11;
 
 template <typename SUM_TYPE>
 void define_pedestal_bindings(py::module &m, const std::string &name) {
-    py::class_<Pedestal<SUM_TYPE>>(m, name.c_str())
+    py::class_<Pedestal<SUM_TYPE>>(m, name.c_str(), R"(
+        Not thread safe, the GIL is released while pushing frames. Do not use
+        the same object from several Python threads at once.)")
         .def(py::init<int, int, int>())
         .def(py::init<int, int>())
         .def("mean",
@@ -64,6 +66,7 @@ void define_pedestal_bindings(py::module &m, const std::string &name) {
         .def("push",
              [](Pedestal<SUM_TYPE> &pedestal, py::array_t<uint16_t> &f) {
                  auto v = make_view_2d(f);
+                 py::gil_scoped_release release;
                  pedestal.push(v);
              })
         .def(
@@ -73,6 +76,7 @@ void define_pedestal_bindings(py::module &m, const std::string &name) {
                py::array_t<SUM_TYPE, py::array::c_style> &threshold) {
                 auto frame_view = make_view_2d(f);
                 auto threshold_view = make_view_2d(threshold);
+                py::gil_scoped_release release;
                 pedestal.push_with_threshold(frame_view, threshold_view);
             },
             py::arg("frame").noconvert(), py::arg("threshold").noconvert())
@@ -81,6 +85,7 @@ void define_pedestal_bindings(py::module &m, const std::string &name) {
             [](Pedestal<SUM_TYPE> &pedestal,
                py::array_t<uint16_t, py::array::c_style> &f) {
                 auto v = make_view_2d(f);
+                py::gil_scoped_release release;
                 pedestal.push_no_update(v);
             },
             py::arg().noconvert())
@@ -7,10 +7,12 @@
 #include "aare/RawSubFile.hpp"
 
 #include "aare/defs.hpp"
+#include "np_helper.hpp"
 // #include "aare/fClusterFileV2.hpp"
 
 #include <cstdint>
 #include <filesystem>
+#include <optional>
 #include <pybind11/iostream.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -35,8 +37,12 @@ auto read_frame_from_RawSubFile(RawSubFile &self) {
     } else if (item_size == 4) {
         image = py::array_t<uint32_t>(shape);
     }
-    self.read_into(reinterpret_cast<std::byte *>(image.mutable_data()),
-                   header.mutable_data());
+    auto *data = reinterpret_cast<std::byte *>(image.mutable_data());
+    auto *header_data = header.mutable_data();
+    {
+        py::gil_scoped_release release;
+        self.read_into(data, header_data);
+    }
 
     return py::make_tuple(header, image);
 }
@@ -56,8 +62,12 @@ auto read_n_frames_from_RawSubFile(RawSubFile &self, size_t n_frames) {
     } else if (item_size == 4) {
         image = py::array_t<uint32_t>(shape);
     }
-    self.read_into(reinterpret_cast<std::byte *>(image.mutable_data()),
-                   n_frames, header.mutable_data());
+    auto *data = reinterpret_cast<std::byte *>(image.mutable_data());
+    auto *header_data = header.mutable_data();
+    {
+        py::gil_scoped_release release;
+        self.read_into(data, n_frames, header_data);
+    }
 
     return py::make_tuple(header, image);
 }
@@ -68,7 +78,9 @@ auto read_n_frames_from_RawSubFile(RawSubFile &self, size_t n_frames) {
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
 void define_raw_sub_file_io_bindings(py::module &m) {
-    py::class_<RawSubFile>(m, "RawSubFile")
+    py::class_<RawSubFile>(m, "RawSubFile", R"(
+        Not thread safe, the GIL is released while reading. Do not use the
+        same object from several Python threads at once.)")
         .def(py::init<const std::filesystem::path &, DetectorType, size_t,
                       size_t, size_t>())
         .def_property_readonly("bytes_per_frame", &RawSubFile::bytes_per_frame)
@@ -82,6 +94,28 @@ void define_raw_sub_file_io_bindings(py::module &m) {
         .def_property_readonly("frames_in_file", &RawSubFile::frames_in_file)
         .def("read_frame", &read_frame_from_RawSubFile)
         .def("read_n", &read_n_frames_from_RawSubFile)
+        .def(
+            "read_into",
+            [](RawSubFile &self, py::array out,
+               std::optional<py::array_t<DetectorHeader>> header) {
+                const size_t n_frames = frames_in_buffer(
+                    out, self.bytes_per_pixel(), self.rows(), self.cols());
+                if (n_frames > self.frames_in_file() - self.tell()) {
+                    throw std::runtime_error(
+                        "Not enough frames left in file to fill the array");
+                }
+                auto *header_data = headers_in_buffer(header, n_frames);
+                auto *data = reinterpret_cast<std::byte *>(out.mutable_data());
+                py::gil_scoped_release release;
+                self.read_into(data, n_frames, header_data);
+            },
+            R"(
+            Read the next frames into an existing array, (rows, cols) for one
+            frame or (n_frames, rows, cols), and optionally their headers.
+            The GIL is released while reading.
+            )",
+            py::arg("out").noconvert(),
+            py::arg("header").noconvert() = py::none())
         .def("read",
              [](RawSubFile &self) {
                  self.seek(0);
@@ -40,6 +40,8 @@ void define_var_cluster_finder_bindings(py::module &m) {
              &VarClusterFinder<double>::set_empty_surroundingPixels)
         .def("set_peripheralThresholdFactor",
              &VarClusterFinder<double>::set_peripheralThresholdFactor)
+        .def("set_n_threads", &VarClusterFinder<double>::set_n_threads,
+             py::arg("n_threads"))
         .def("find_clusters",
              [](VarClusterFinder<double> &self,
                 py::array_t<double, py::array::c_style | py::array::forcecast>
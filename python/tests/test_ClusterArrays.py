@@ -0,0 +1,33 @@
+# SPDX-License-Identifier: MPL-2.0
+import gc
+import pytest
+import numpy as np
+
+from aare import _aare
+
+
+def test_views_block_growth_until_released():
+    arrays = _aare.ClusterArrays_Cluster3x3i(2)
+    arrays.push_back(_aare.Cluster3x3i(1, 2, np.ones(9, dtype=np.int32)))
+
+    x = arrays.x
+    pixels = arrays.pixels
+    assert x[0] == 1
+    assert pixels.shape == (9, 1)
+
+    # fits into the capacity, the views stay valid
+    arrays.push_back(_aare.Cluster3x3i(3, 4, np.ones(9, dtype=np.int32)))
+    assert arrays.capacity == 2
+
+    # would reallocate and leave x and pixels dangling
+    with pytest.raises(BufferError):
+        arrays.push_back(_aare.Cluster3x3i(5, 6, np.ones(9, dtype=np.int32)))
+    with pytest.raises(BufferError):
+        arrays.reserve(10)
+    assert arrays.size == 2
+
+    del x, pixels
+    gc.collect()
+    arrays.push_back(_aare.Cluster3x3i(5, 6, np.ones(9, dtype=np.int32)))
+    assert arrays.size == 3
+    assert list(arrays.x) == [1, 3, 5]
@@ -0,0 +1,31 @@
+# SPDX-License-Identifier: MPL-2.0
+import pytest
+import numpy as np
+from aare import File
+
+
+@pytest.mark.withdata
+def test_read_into_a_preallocated_array(test_data_path):
+    fname = test_data_path / "dat/AldoJF500k_000000.dat"
+    with File(fname) as f:
+        frames = f.read_n(4)
+
+    with File(fname) as f:
+        frame = np.zeros((f.rows, f.cols), dtype=np.uint16)
+        f.read_into(frame)
+        assert np.all(frame == frames[0])
+
+        # the same buffer type for a batch of frames
+        batch = np.zeros((3, f.rows, f.cols), dtype=np.uint16)
+        f.read_into(batch)
+        assert np.all(batch == frames[1:])
+        assert f.tell() == 4
+
+        # wrong dtype or shape is rejected before reading
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((f.rows, f.cols), dtype=np.int32))
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((f.rows, f.cols), dtype=np.float16))
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((f.cols, f.rows), dtype=np.uint16))
+        assert f.tell() == 4
@@ -48,6 +48,34 @@ def test_read_rawfile_with_multiple_rois(test_data_path):
         _, frame = f.read_roi(0)
         assert frame.shape == (301, 101)
         assert f.tell() == 2
+
+
+@pytest.mark.withdata
+def test_read_rois_into_checks_the_header_arrays(test_data_path):
+    with RawFile(test_data_path / "raw/ROITestData/MultipleROIs/run_master_0.json") as f:
+        headers, frames = f.read_rois()
+        f.seek(0)
+
+        images = [np.zeros_like(frame) for frame in frames]
+        out_headers = [np.zeros_like(h) for h in headers]
+        f.read_rois_into(images, out_headers)
+        for image, frame in zip(images, frames):
+            assert (image == frame).all()
+        for h, ref in zip(out_headers, headers):
+            assert (h == ref).all()
+        assert f.tell() == 1
+
+        # strided, read only or too small header arrays are rejected
+        strided = [np.zeros(2*h.size, dtype=h.dtype)[::2] for h in headers]
+        with pytest.raises(RuntimeError):
+            f.read_rois_into(images, strided)
+        read_only = [np.zeros_like(h) for h in headers]
+        read_only[1].setflags(write=False)
+        with pytest.raises(RuntimeError):
+            f.read_rois_into(images, read_only)
+        with pytest.raises(RuntimeError):
+            f.read_rois_into(images, [h[:0] for h in out_headers])
+        assert f.tell() == 1
    
     
 
@@ -110,3 +138,28 @@ def test_read_rawfile_eiger_and_compare_to_numpy(test_data_path):
         header, image1 = f.read_frame()
 
     assert (image == image1).all()
+
+@pytest.mark.withdata
+def test_read_into_a_preallocated_array(test_data_path):
+    fname = test_data_path/'raw/eiger/Lab6_20500eV_2deg_20240629_master_7.json'
+    with RawFile(fname) as f:
+        header, image = f.read_frame()
+
+    with RawFile(fname) as f:
+        out = np.zeros_like(image)
+        out_header = np.zeros_like(header)
+        f.read_into(out, out_header)
+        assert (out == image).all()
+        assert (out_header == header).all()
+        assert f.tell() == 1
+
+        # same item size but not an unsigned integer, nothing is read
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros(image.shape, dtype=np.float32))
+        # a strided header view would be filled in the wrong places
+        with pytest.raises(RuntimeError):
+            f.read_into(out, np.zeros(2*header.size, dtype=header.dtype)[::2])
+        # no silent conversion to a temporary array
+        with pytest.raises(TypeError):
+            f.read_into(out.tolist())
+        assert f.tell() == 1
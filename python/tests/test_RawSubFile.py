@@ -38,3 +38,27 @@ def test_iterate_over_a_jungfrau_RawSubFile(test_data_path):
             i += 1
         assert i == 10
         assert header["frameNumber"] == 10
+
+@pytest.mark.withdata
+def test_read_into_a_preallocated_array(test_data_path):
+
+    data = np.load(test_data_path / "raw/jungfrau/jungfrau_single_0.npy")
+
+    with RawSubFile(test_data_path / "raw/jungfrau/jungfrau_single_d0_f0_0.raw", DetectorType.Jungfrau, 512, 1024, 16) as f:
+        frame = np.zeros((512, 1024), dtype=np.uint16)
+        f.read_into(frame)
+        assert np.all(frame == data[0])
+
+        # the same buffer can be reused, here for a batch of frames
+        frames = np.zeros((3, 512, 1024), dtype=np.uint16)
+        f.read_into(frames)
+        assert np.all(frames == data[1:4])
+
+        # wrong shape or dtype is rejected without reading
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((512, 512), dtype=np.uint16))
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((512, 1024), dtype=np.uint32))
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((512, 1024), dtype=np.int16))
+        assert f.tell() == 4
@@ -90,4 +90,25 @@ def test_read_single_chip(test_data_path):
 
     # Check that the data is the same
     assert np.all(ref_header == header)
-    assert np.all(ref_data == data)
\ No newline at end of file
+    assert np.all(ref_data == data)
+@pytest.mark.withdata
+def test_read_into_a_preallocated_array(test_data_path):
+    fname = test_data_path / "dat/AldoJF500k_000000.dat"
+    with JungfrauDataFile(fname) as f:
+        header, data = f.read_n(3)
+
+    with JungfrauDataFile(fname) as f:
+        out = np.zeros_like(data)
+        out_header = np.zeros_like(header)
+        f.read_into(out, out_header)
+        assert np.all(out == data)
+        assert np.all(out_header == header)
+        assert f.tell() == 3
+
+        # right shape but wrong dtype, the file must not advance without
+        # filling the callers array
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((512, 1024), dtype=np.int32))
+        with pytest.raises(RuntimeError):
+            f.read_into(np.zeros((512, 1024), dtype=np.float64))
+        assert f.tell() == 3
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/ArrayEval.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace aare {
+
+namespace {
+
+// Set while a thread works on chunks, so that evaluations started from
+// within a chunk run serially instead of waiting for the pool they run on
+thread_local bool in_eval_pool = false;
+
+// Set by set_serial_eval_on_this_thread()
+thread_local bool serial_eval = false;
+
+size_t hardware_threads() {
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+long current_pid() {
+#ifndef _WIN32
+    return static_cast<long>(getpid());
+#else
+    return 0;
+#endif
+}
+
+class EvalPool {
+  public:
+    size_t threads() const { return m_threads.load(std::memory_order_relaxed); }
+
+    void set_threads(size_t n_threads) {
+        std::lock_guard<std::mutex> job(m_job_mutex);
+        stop_workers();
+        m_threads.store(n_threads ? n_threads : hardware_threads(),
+                        std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Run the job on the pool. Returns false without running anything
+     * if the pool is busy, disabled or the caller should run serially.
+     */
+    bool run(size_t n_chunks, const std::function<void(size_t)> &func) {
+        if (threads() < 2 || n_chunks < 2)
+            return false;
+        std::unique_lock<std::mutex> job(m_job_mutex, std::try_to_lock);
+        if (!job.owns_lock())
+            return false;
+        // After a fork() only the forking thread exists in the child, the
+        // workers of the parent are gone for good
+        if (m_pid != 0 && m_pid != current_pid())
+            return false;
+        start_workers();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_func = &func;
+            m_n_chunks = n_chunks;
+            m_next.store(0, std::memory_order_relaxed);
+            m_error = nullptr;
+            m_busy = m_workers.size();
+            ++m_generation;
+        }
+        m_start.notify_all();
+        in_eval_pool = true;
+        work();
+        in_eval_pool = false;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_func = nullptr;
+        if (m_error)
+            std::rethrow_exception(m_error);
+        return true;
+    }
+
+  private:
+    void start_workers() {
+        if (!m_workers.empty())
+            return;
+        m_pid = current_pid();
+        m_stop = false;
+        const uint64_t generation = m_generation;
+        for (size_t i = 1; i < threads(); ++i)
+            m_workers.emplace_back(
+                [this, generation] { worker_loop(generation); });
+    }
+
+    void stop_workers() {
+        if (m_workers.empty() || m_pid != current_pid())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (auto &worker : m_workers)
+            worker.join();
+        m_workers.clear();
+    }
+
+    void worker_loop(uint64_t seen) {
+        in_eval_pool = true;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_start.wait(lock,
+                         [&] { return m_stop || m_generation != seen; });
+            if (m_stop)
+                return;
+            seen = m_generation;
+            lock.unlock();
+            work();
+            lock.lock();
+            if (--m_busy == 0)
+                m_done.notify_one();
+        }
+    }
+
+    void work() {
+        for (;;) {
+            const size_t chunk =
+                m_next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= m_n_chunks)
+                return;
+            try {
+                (*m_func)(chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error)
+                    m_error = std::current_exception();
+                m_next.store(m_n_chunks, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::atomic<size_t> m_threads{1}; // opt-in, see set_eval_threads()
+    std::mutex m_job_mutex; // held by the thread that owns the current job
+    std::vector<std::thread> m_workers;
+    long m_pid{};
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    bool m_stop{false};
+    uint64_t m_generation{};
+    size_t m_busy{};
+
+    const std::function<void(size_t)> *m_func{};
+    size_t m_n_chunks{};
+    std::atomic<size_t> m_next{0};
+    std::exception_ptr m_error;
+};
+
+// Never destroyed: the workers are left blocked at exit instead of being
+// joined from a static destructor, which would hang in a forked child
+EvalPool &pool() {
+    static auto *instance = new EvalPool;
+    return *instance;
+}
+
+} // namespace
+
+size_t eval_threads() { return pool().threads(); }
+
+void set_eval_threads(size_t n_threads) { pool().set_threads(n_threads); }
+
+bool set_serial_eval_on_this_thread(bool serial) {
+    return std::exchange(serial_eval, serial);
+}
+
+namespace detail {
+
+void run_chunks(size_t n_chunks, const std::function<void(size_t)> &func) {
+    if (!in_eval_pool && !serial_eval && pool().run(n_chunks, func))
+        return;
+    for (size_t chunk = 0; chunk < n_chunks; ++chunk)
+        func(chunk);
+}
+
+} // namespace detail
+
+} // namespace aare
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/ArrayEval.hpp"
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using aare::eval_chunk_size;
+
+TEST_CASE("for_each_chunk covers the range exactly once") {
+    for (size_t n : {size_t{0}, size_t{10}, eval_chunk_size,
+                     3 * eval_chunk_size + 17}) {
+        std::vector<std::atomic<int>> hits(n);
+        std::atomic<size_t> chunks{0};
+        aare::for_each_chunk(n, [&](size_t first, size_t last) {
+            REQUIRE(first % eval_chunk_size == 0);
+            REQUIRE(last - first <= eval_chunk_size);
+            for (size_t i = first; i < last; ++i)
+                ++hits[i];
+            ++chunks;
+        });
+        REQUIRE(chunks == (n + eval_chunk_size - 1) / eval_chunk_size);
+        for (auto &h : hits)
+            REQUIRE(h == 1);
+    }
+}
+
+TEST_CASE("reduce_chunks gives the same result for any number of threads") {
+    const size_t n = 10 * eval_chunk_size + 3;
+    std::vector<float> values(n);
+    for (size_t i = 0; i < n; ++i)
+        values[i] = 1.0F / static_cast<float>(i % 1000 + 1);
+
+    auto reduce = [&]() {
+        return aare::reduce_chunks(
+            n, 0.0F,
+            [&](size_t first, size_t last) {
+                float acc = 0.0F;
+                for (size_t i = first; i < last; ++i)
+                    acc += values[i];
+                return acc;
+            },
+            [](float a, float b) { return a + b; });
+    };
+
+    // the pool is opt-in
+    REQUIRE(aare::eval_threads() == 1);
+    const float serial = reduce();
+    aare::set_eval_threads(4);
+    REQUIRE(reduce() == serial);
+    aare::set_eval_threads(0);
+    REQUIRE(aare::eval_threads() >= 1);
+    REQUIRE(reduce() == serial);
+    aare::set_eval_threads(1);
+    REQUIRE(aare::reduce_chunks(
+                0, 42, [](size_t, size_t) { return 0; },
+                [](int a, int b) { return a + b; }) == 42);
+}
+
+TEST_CASE("Evaluation rethrows exceptions and allows nesting") {
+    aare::set_eval_threads(4);
+    const size_t n = 8 * eval_chunk_size;
+    REQUIRE_THROWS_AS(aare::for_each_chunk(n,
+                                           [](size_t first, size_t) {
+                                               if (first > 0)
+                                                   throw std::runtime_error(
+                                                       "chunk failed");
+                                           }),
+                      std::runtime_error);
+
+    // an evaluation started from within a chunk runs on the calling thread
+    std::atomic<size_t> total{0};
+    aare::for_each_chunk(n, [&](size_t first, size_t last) {
+        aare::for_each_element(
+            n, [&](size_t i) {
+                if (i == 0)
+                    total += last - first;
+            });
+    });
+    REQUIRE(total == n);
+    aare::set_eval_threads(1);
+}
+
+TEST_CASE("Serial evaluation on this thread keeps all chunks on the caller") {
+    aare::set_eval_threads(4);
+    REQUIRE_FALSE(aare::set_serial_eval_on_this_thread(true));
+
+    const auto caller = std::this_thread::get_id();
+    std::atomic<size_t> elsewhere{0};
+    aare::for_each_chunk(8 * eval_chunk_size, [&](size_t, size_t) {
+        if (std::this_thread::get_id() != caller)
+            ++elsewhere;
+    });
+    REQUIRE(elsewhere == 0);
+
+    // the setting is per thread
+    bool other_serial = true;
+    std::thread other([&other_serial] {
+        other_serial = aare::set_serial_eval_on_this_thread(false);
+    });
+    other.join();
+    REQUIRE_FALSE(other_serial);
+
+    REQUIRE(aare::set_serial_eval_on_this_thread(false));
+    aare::set_eval_threads(1);
+}
@@ -12,6 +12,8 @@
 #include <array>
 #include <catch2/catch_all.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <type_traits>
 
 using namespace aare;
 
@@ -177,4 +179,99 @@ TEST_CASE("Calculate full eta2 after reduction", "[eta_calculation]") {
     CHECK(expected_eta.sum == eta.sum);
     CHECK(expected_eta.x == eta.x);
     CHECK(expected_eta.y == eta.y);
-}
\ No newline at end of file
+}
+namespace {
+
+template <typename ClusterType>
+void fill_test_clusters(ClusterVector<ClusterType> &clusters, size_t n) {
+    using T = typename ClusterType::value_type;
+    // small values so that equal 2x2 sums and zero denominators are common
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> dist(-2, 6);
+    for (size_t i = 0; i < n; ++i) {
+        ClusterType cluster{};
+        cluster.x = static_cast<typename ClusterType::coord_type>(i % 100);
+        cluster.y = static_cast<typename ClusterType::coord_type>(i / 100);
+        for (auto &value : cluster.data) {
+            if constexpr (std::is_floating_point_v<T>) {
+                value = static_cast<T>(dist(gen)) * static_cast<T>(0.37);
+            } else {
+                value = static_cast<T>(dist(gen));
+            }
+        }
+        clusters.push_back(cluster);
+    }
+}
+
+template <typename ClusterType, typename BatchFunction,
+          typename ScalarFunction>
+void check_batch_eta(const ClusterVector<ClusterType> &clusters,
+                     BatchFunction batch, ScalarFunction scalar) {
+    const auto eta = batch(clusters);
+    REQUIRE(eta.size() == static_cast<ssize_t>(clusters.size()));
+    size_t mismatches = 0;
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        const auto expected = scalar(clusters[i]);
+        const auto k = static_cast<ssize_t>(i);
+        if (eta.x[k] != expected.x || eta.y[k] != expected.y ||
+            eta.sum[k] != expected.sum ||
+            eta.c[k] != static_cast<int>(expected.c)) {
+            ++mismatches;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+template <typename ClusterType> void check_batch_eta2(size_t n) {
+    ClusterVector<ClusterType> clusters;
+    fill_test_clusters(clusters, n);
+    check_batch_eta(
+        clusters, [](const auto &v) { return calculate_eta2_batch(v); },
+        [](const auto &c) { return calculate_eta2(c); });
+    check_batch_eta(
+        clusters, [](const auto &v) { return calculate_full_eta2_batch(v); },
+        [](const auto &c) { return calculate_full_eta2(c); });
+}
+
+template <typename ClusterType> void check_batch_eta3(size_t n) {
+    ClusterVector<ClusterType> clusters;
+    fill_test_clusters(clusters, n);
+    check_batch_eta(
+        clusters, [](const auto &v) { return calculate_eta3_batch(v); },
+        [](const auto &c) { return calculate_eta3(c); });
+    check_batch_eta(
+        clusters, [](const auto &v) { return calculate_cross_eta3_batch(v); },
+        [](const auto &c) { return calculate_cross_eta3(c); });
+}
+
+} // namespace
+
+TEST_CASE("Batch eta2 matches the single cluster functions",
+          "[eta_calculation]") {
+    // 1003 clusters so that the last tile is only partially filled
+    check_batch_eta2<Cluster<int, 3, 3>>(1003);
+    check_batch_eta2<Cluster<float, 3, 3>>(1003);
+    check_batch_eta2<Cluster<int, 2, 2>>(1003);
+    check_batch_eta2<Cluster<float, 2, 2>>(1003);
+    // layouts without a kernel use the single cluster functions
+    check_batch_eta2<Cluster<double, 3, 3>>(100);
+    check_batch_eta2<Cluster<int, 2, 2, int16_t>>(100);
+    check_batch_eta2<Cluster<int16_t, 3, 3>>(100);
+    check_batch_eta2<Cluster<int, 5, 5>>(100);
+}
+
+TEST_CASE("Batch eta3 matches the single cluster functions",
+          "[eta_calculation]") {
+    check_batch_eta3<Cluster<int, 3, 3>>(1003);
+    check_batch_eta3<Cluster<float, 3, 3>>(1003);
+    check_batch_eta3<Cluster<double, 3, 3>>(100);
+    check_batch_eta3<Cluster<int, 5, 5>>(100);
+}
+
+TEST_CASE("Batch eta of an empty ClusterVector", "[eta_calculation]") {
+    ClusterVector<Cluster<int, 3, 3>> clusters;
+    auto eta = calculate_eta2_batch(clusters);
+    REQUIRE(eta.size() == 0);
+    REQUIRE(eta.sum.size() == 0);
+    REQUIRE(eta.c.size() == 0);
+}
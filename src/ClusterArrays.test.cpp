@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/ClusterArrays.hpp"
+#include "aare/CalculateEta.hpp"
+#include "aare/GainMap.hpp"
+
+#include <cstdint>
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using aare::Cluster;
+using aare::ClusterArrays;
+using aare::ClusterVector;
+using aare::NDArray;
+using aare::NDView;
+
+namespace {
+
+template <typename ClusterType>
+void fill_clusters(ClusterVector<ClusterType> &clusters, size_t n) {
+    using T = typename ClusterType::value_type;
+    for (size_t i = 0; i < n; ++i) {
+        ClusterType cluster{};
+        cluster.x = static_cast<uint16_t>(i % 17);
+        cluster.y = static_cast<uint16_t>(i % 13);
+        for (size_t k = 0; k < cluster.data.size(); ++k) {
+            cluster.data[k] = static_cast<T>((i * 7 + k * 5) % 11);
+        }
+        clusters.push_back(cluster);
+    }
+}
+
+template <typename ClusterType>
+bool same_clusters(const ClusterVector<ClusterType> &a,
+                   const ClusterVector<ClusterType> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].data != b[i].data) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("ClusterArrays round trip through a ClusterVector") {
+    using C = Cluster<int32_t, 3, 3>;
+    ClusterVector<C> clusters(10, 42);
+    fill_clusters(clusters, 100);
+
+    ClusterArrays<C> arrays(clusters);
+    REQUIRE(arrays.size() == 100);
+    REQUIRE(arrays.frame_numbers()[99] == 42);
+    REQUIRE(arrays.x()[5] == clusters[5].x);
+    REQUIRE(arrays.y()[5] == clusters[5].y);
+    for (size_t k = 0; k < ClusterArrays<C>::n_pixels; ++k) {
+        REQUIRE(arrays.pixels(k)[17] == clusters[17].data[k]);
+    }
+
+    auto back = arrays.to_cluster_vector();
+    REQUIRE(back.frame_number() == 42);
+    REQUIRE(same_clusters(back, clusters));
+
+    // clusters from different frames give frame number 0
+    ClusterVector<C> other(10, 43);
+    fill_clusters(other, 3);
+    arrays.append(other);
+    REQUIRE(arrays.size() == 103);
+    REQUIRE(arrays.to_cluster_vector().frame_number() == 0);
+}
+
+TEST_CASE("ClusterArrays push_back beyond the capacity keeps the clusters") {
+    using C = Cluster<float, 2, 2>;
+    ClusterArrays<C> arrays(2);
+    ClusterVector<C> clusters;
+    fill_clusters(clusters, 2500);
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        arrays.push_back(clusters[i], static_cast<int32_t>(i));
+    }
+    REQUIRE(arrays.size() == 2500);
+    REQUIRE(arrays.capacity() >= 2500);
+    REQUIRE(arrays.frame_numbers()[2499] == 2499);
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        REQUIRE(arrays[i].data == clusters[i].data);
+    }
+}
+
+TEST_CASE("ClusterArrays sums match the ClusterVector sums") {
+    using C = Cluster<int32_t, 5, 5>;
+    ClusterVector<C> clusters;
+    fill_clusters(clusters, 200);
+    ClusterArrays<C> arrays(clusters);
+
+    REQUIRE(arrays.sum() == clusters.sum());
+    auto expected = clusters.sum_2x2();
+    auto sums_2x2 = arrays.sum_2x2();
+    REQUIRE(sums_2x2.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        CHECK(sums_2x2[i].sum == expected[i].sum);
+        CHECK(sums_2x2[i].index == expected[i].index);
+    }
+}
+
+TEST_CASE("ClusterArrays mask keeps the selected clusters") {
+    using C = Cluster<int32_t, 3, 3>;
+    ClusterVector<C> clusters;
+    fill_clusters(clusters, 10);
+    ClusterArrays<C> arrays(clusters);
+
+    NDArray<bool, 1> mask({10}, false);
+    mask[2] = true;
+    mask[7] = true;
+    auto selected = arrays(mask.view());
+    REQUIRE(selected.size() == 2);
+    REQUIRE(selected[0].data == clusters[2].data);
+    REQUIRE(selected[1].data == clusters[7].data);
+    REQUIRE(selected[1].x == clusters[7].x);
+
+    NDArray<bool, 1> wrong_size({9}, true);
+    REQUIRE_THROWS_AS(arrays(wrong_size.view()), std::runtime_error);
+}
+
+TEST_CASE("Batch eta of ClusterArrays matches the ClusterVector version") {
+    using C = Cluster<int32_t, 3, 3>;
+    ClusterVector<C> clusters;
+    fill_clusters(clusters, 1000);
+    ClusterArrays<C> arrays(clusters);
+
+    auto expected = aare::calculate_eta2_batch(clusters);
+    auto eta = aare::calculate_eta2_batch(arrays);
+    REQUIRE((eta.x == expected.x));
+    REQUIRE((eta.y == expected.y));
+    REQUIRE((eta.sum == expected.sum));
+    REQUIRE((eta.c == expected.c));
+
+    auto expected3 = aare::calculate_eta3_batch(clusters);
+    auto eta3 = aare::calculate_eta3_batch(arrays);
+    REQUIRE((eta3.x == expected3.x));
+    REQUIRE((eta3.y == expected3.y));
+
+    // layout without a kernel
+    using C5 = Cluster<double, 5, 5>;
+    ClusterVector<C5> clusters5;
+    fill_clusters(clusters5, 100);
+    ClusterArrays<C5> arrays5(clusters5);
+    auto expected5 = aare::calculate_full_eta2_batch(clusters5);
+    auto eta5 = aare::calculate_full_eta2_batch(arrays5);
+    REQUIRE((eta5.x == expected5.x));
+    REQUIRE((eta5.c == expected5.c));
+}
+
+TEST_CASE("Gain map of ClusterArrays matches the ClusterVector version") {
+    using C = Cluster<int32_t, 3, 3>;
+    NDArray<double, 2> gain({13, 17});
+    for (ssize_t i = 0; i < gain.size(); ++i) {
+        gain[i] = 0.5 + 0.01 * static_cast<double>(i);
+    }
+    ClusterVector<C> clusters;
+    fill_clusters(clusters, 300);
+    ClusterArrays<C> arrays(clusters);
+
+    aare::InvertedGainMap gain_map(gain);
+    gain_map.apply_gain_map(clusters);
+    gain_map.apply_gain_map(arrays);
+    REQUIRE(same_clusters(arrays.to_cluster_vector(), clusters));
+}
@@ -69,4 +69,44 @@ TEST_CASE("Construct a cluster finder") {
 //                 REQUIRE(clusters[0].get<double>(i * 3 + j) == 0);
 //         }
 //     }
-// }
\ No newline at end of file
+// }
+TEST_CASE("ClusterFinder finds photons at the border and in the interior") {
+    constexpr ssize_t rows = 20;
+    constexpr ssize_t cols = 30;
+    ClusterFinder<Cluster<int32_t, 3, 3>, uint16_t, double> finder(
+        {rows, cols});
+
+    // pedestal of 100 with a noise of about 1
+    NDArray<uint16_t, 2> frame({rows, cols});
+    for (int i = 0; i < 100; ++i) {
+        for (ssize_t j = 0; j < frame.size(); ++j)
+            frame[j] = static_cast<uint16_t>(99 + (i + j) % 3);
+        finder.push_pedestal_frame(frame.view());
+    }
+
+    frame = 100;
+    frame(0, 0) = 200;    // corner
+    frame(10, 29) = 300;  // right border
+    frame(10, 10) = 400;  // interior
+    frame(10, 11) = 150;
+    finder.find_clusters(frame.view());
+    auto clusters = finder.steal_clusters();
+    REQUIRE(clusters.size() == 3);
+
+    REQUIRE(clusters[0].x == 0);
+    REQUIRE(clusters[0].y == 0);
+    // pixels outside of the frame stay 0
+    REQUIRE(clusters[0].data == std::array<int32_t, 9>{0, 0, 0, 0, 100, 0, 0,
+                                                       0, 0});
+
+    REQUIRE(clusters[1].x == 10);
+    REQUIRE(clusters[1].y == 10);
+    REQUIRE(clusters[1].data == std::array<int32_t, 9>{0, 0, 0, 0, 300, 50, 0,
+                                                       0, 0});
+
+    REQUIRE(clusters[2].x == 29);
+    REQUIRE(clusters[2].y == 10);
+    REQUIRE(clusters[2].data[3] == 0);
+    REQUIRE(clusters[2].data[4] == 200);
+    REQUIRE(clusters[2].data[5] == 0);
+}
@@ -100,3 +100,35 @@ TEST_CASE("multithreaded cluster finder", "[.with-data]") {
     auto clustervec = clustercollector.steal_clusters();
     // CHECK(clustervec.size() == ) //dont know how many clusters to expect
 }
+
+TEST_CASE("ClusterFinderMT counts frames and clusters in its metrics") {
+    using ClusterType = Cluster<int32_t, 3, 3>;
+    const size_t n_threads = 2;
+    ClusterFinderMT<ClusterType> cf({20, 30}, 5, 100, n_threads);
+
+    // the pedestal needs its full 1000 samples before cluster finding,
+    // alternating frames give it a sigma of 0.5
+    NDArray<uint16_t, 2> frame({20, 30}, 100);
+    NDArray<uint16_t, 2> noisy({20, 30}, 101);
+    for (int i = 0; i < 1000; ++i)
+        cf.push_pedestal_frame(i % 2 ? noisy.view() : frame.view());
+    frame(10, 15) = 1000;
+    frame(5, 5) = 1000;
+    for (uint64_t i = 0; i < 6; ++i)
+        cf.find_clusters(frame.view(), i);
+    cf.stop();
+
+    auto metrics = cf.metrics();
+    CHECK(metrics.total("cluster_finder_frames_total") == 6);
+    CHECK(metrics.total("cluster_finder_pedestal_frames_total") ==
+          1000 * n_threads);
+    CHECK(metrics.total("cluster_finder_clusters_total") == 12);
+    CHECK(metrics.total("cluster_finder_sink_queue_depth") == 6);
+    CHECK(metrics.histogram("cluster_finder_frame_seconds").count == 6);
+    CHECK(metrics.histogram("cluster_finder_queue_latency_seconds").count ==
+          6);
+    CHECK(metrics.total("cluster_finder_busy_seconds_total") > 0);
+    auto prom = metrics.to_prometheus();
+    CHECK(prom.find("aare_cluster_finder_input_queue_depth{thread=\"1\"}") !=
+          std::string::npos);
+}
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/EtaCubeBuilder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace aare {
+
+EtaCubeBuilder::EtaCubeBuilder(NDView<double, 1> xbins,
+                               NDView<double, 1> ybins,
+                               NDView<double, 1> ebins, int n_threads)
+    : m_etabinsx(xbins), m_etabinsy(ybins), m_energy_bins(ebins),
+      m_n_threads(n_threads) {
+    if (xbins.size() < 2 || ybins.size() < 2 || ebins.size() < 2) {
+        throw std::invalid_argument(
+            "EtaCubeBuilder requires at least one bin along each axis");
+    }
+    if (n_threads < 1) {
+        throw std::invalid_argument(
+            "EtaCubeBuilder requires at least one thread");
+    }
+    const std::array<ssize_t, 3> shape{xbins.size() - 1, ybins.size() - 1,
+                                       ebins.size() - 1};
+    m_partial_cubes.reserve(n_threads);
+    for (int i = 0; i < n_threads; ++i) {
+        m_partial_cubes.emplace_back(shape, 0.0);
+    }
+}
+
+ssize_t EtaCubeBuilder::bin_index(const NDArray<double, 1> &edges,
+                                  double value) {
+    const double *first = edges.data();
+    const double *last = first + edges.size();
+    if (!(value >= first[0] && value <= last[-1])) {
+        return -1;
+    }
+    const auto bin = std::upper_bound(first, last, value) - first - 1;
+    return std::min(bin, static_cast<ssize_t>(edges.size() - 2));
+}
+
+NDArray<double, 3> EtaCubeBuilder::values() const {
+    NDArray<double, 3> cube(m_partial_cubes.front());
+    for (size_t t = 1; t < m_partial_cubes.size(); ++t) {
+        const auto &partial = m_partial_cubes[t];
+        for (ssize_t i = 0; i < cube.size(); ++i) {
+            cube[i] += partial[i];
+        }
+    }
+    return cube;
+}
+
+void EtaCubeBuilder::clear() {
+    for (auto &partial : m_partial_cubes) {
+        partial = 0.0;
+    }
+}
+
+} // namespace aare
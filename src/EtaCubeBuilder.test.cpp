@@ -0,0 +1,124 @@
+#include "aare/EtaCubeBuilder.hpp"
+#include "aare/ClusterVector.hpp"
+#include "aare/Interpolator.hpp"
+#include "aare/NDArray.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "test_utils.hpp"
+
+using namespace aare;
+using aare::test::linspace;
+
+TEST_CASE("EtaCubeBuilder histograms eta and energy of all clusters",
+          "[Interpolation]") {
+    const auto xbins = linspace(0.0, 1.0, 11);
+    const auto ybins = linspace(0.0, 1.0, 9);
+    const auto ebins = linspace(0.0, 40.0, 5);
+
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> pixel(0.0, 10.0);
+    ClusterVector<Cluster<double, 3, 3>> clusters;
+    for (int n = 0; n < 2000; ++n) {
+        Cluster<double, 3, 3> cluster{10, 10, {}};
+        for (auto &value : cluster.data) {
+            value = pixel(gen);
+        }
+        clusters.push_back(cluster);
+    }
+
+    NDArray<double, 3> expected(std::array<ssize_t, 3>{10, 8, 4}, 0.0);
+    for (size_t n = 0; n < clusters.size(); ++n) {
+        const auto eta = calculate_eta2(clusters[n]);
+        if (eta.x < 0 || eta.x > 1 || eta.y < 0 || eta.y > 1 ||
+            eta.sum < 0 || eta.sum > 40) {
+            continue;
+        }
+        // the last bin includes the last edge
+        const auto ix = std::min(static_cast<ssize_t>(eta.x * 10), ssize_t{9});
+        const auto iy = std::min(static_cast<ssize_t>(eta.y * 8), ssize_t{7});
+        const auto ie =
+            std::min(static_cast<ssize_t>(eta.sum / 10), ssize_t{3});
+        expected(ix, iy, ie) += 2.0;
+    }
+
+    const int n_threads = GENERATE(1, 4);
+    EtaCubeBuilder builder(xbins.view(), ybins.view(), ebins.view(),
+                           n_threads);
+    builder.fill<calculate_eta2<double, 3, 3>>(clusters);
+    builder.fill<calculate_eta2<double, 3, 3>>(clusters);
+    const auto cube = builder.values();
+
+    REQUIRE(cube.shape() == expected.shape());
+    CHECK((cube == expected));
+    CHECK(std::accumulate(cube.begin(), cube.end(), 0.0) > 0.0);
+
+    builder.clear();
+    const auto cleared = builder.values();
+    CHECK(std::accumulate(cleared.begin(), cleared.end(), 0.0) == 0.0);
+}
+
+TEST_CASE("EtaCubeBuilder rejects axes without bins", "[Interpolation]") {
+    const auto bins = linspace(0.0, 1.0, 5);
+    NDArray<double, 1> one_edge(std::array<ssize_t, 1>{1}, 0.0);
+    CHECK_THROWS_AS(EtaCubeBuilder(bins.view(), bins.view(), one_edge.view()),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(EtaCubeBuilder(bins.view(), bins.view(), bins.view(), 0),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Interpolator CDFs do not depend on the number of threads",
+          "[Interpolation]") {
+    const auto xbins = linspace(0.0, 1.0, 8);
+    const auto ybins = linspace(0.0, 1.0, 6);
+    const auto ebins = linspace(0.0, 100.0, 10);
+    NDArray<double, 3> etacube(std::array<ssize_t, 3>{7, 5, 9});
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<double> counts(0.0, 100.0);
+    for (auto &value : etacube) {
+        value = counts(gen);
+    }
+    // An empty energy bin must not produce NaNs
+    for (ssize_t i = 0; i < 7; ++i) {
+        for (ssize_t j = 0; j < 5; ++j) {
+            etacube(i, j, 4) = 0.0;
+        }
+    }
+
+    Interpolator serial(etacube.view(), xbins.view(), ybins.view(),
+                        ebins.view());
+    Interpolator parallel(etacube.view(), xbins.view(), ybins.view(),
+                          ebins.view(), 4);
+    CHECK((serial.get_ietax() == parallel.get_ietax()));
+    CHECK((serial.get_ietay() == parallel.get_ietay()));
+
+    serial.rosenblatttransform(etacube.view());
+    parallel.rosenblatttransform(etacube.view(), 4);
+    CHECK((serial.get_ietax() == parallel.get_ietax()));
+    CHECK((serial.get_ietay() == parallel.get_ietay()));
+
+    // marginal CDF of eta_x for energy bin 2 from its definition
+    const auto ietax = parallel.get_ietax();
+    double total = 0;
+    for (ssize_t i = 1; i < 7; ++i) {
+        for (ssize_t j = 0; j < 5; ++j) {
+            total += etacube(i, j, 2);
+        }
+    }
+    double cumulative = 0;
+    for (ssize_t i = 1; i < 7; ++i) {
+        for (ssize_t j = 0; j < 5; ++j) {
+            cumulative += etacube(i, j, 2);
+        }
+        CHECK(ietax(i, 3, 2) == Catch::Approx(cumulative / total));
+    }
+    CHECK(ietax(0, 0, 4) == 0.0);
+    CHECK(ietax(6, 0, 4) == 0.0);
+}
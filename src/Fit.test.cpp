@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/Fit.hpp"
+#include "aare/Chi2.hpp"
+#include "aare/NDArray.hpp"
+#include "aare/ScanAccumulator.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+
+#include "test_utils.hpp"
+
+using aare::FitModel;
+using aare::NDArray;
+using aare::NDView;
+using aare::test::linspace;
+using aare::model::Gaussian;
+using Catch::Approx;
+
+namespace {
+
+NDArray<double, 1> gaussian(const NDArray<double, 1> &x,
+                            const std::array<double, 3> &par,
+                            double noise = 0.0, unsigned int seed = 1234) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    NDArray<double, 1> y(x.shape());
+    for (ssize_t i = 0; i < x.size(); ++i)
+        y[i] = Gaussian::eval(x[i], par) + noise * dist(rng);
+    return y;
+}
+
+} // namespace
+
+TEST_CASE("lm_options takes the call budget and tolerance of the model") {
+    FitModel<Gaussian> model(0, 200, 0.5, true);
+    model.SetParLimits("mu", -1.0, 1.0);
+    model.FixParameter("A", 10.0);
+
+    auto opt = aare::lm_options(model);
+    CHECK(opt.max_calls == 200);
+    CHECK(opt.max_iterations == 100);
+    CHECK(opt.abs_tolerance == Approx(0.001));
+    CHECK(opt.compute_errors);
+    CHECK(opt.fixed[0]);
+    CHECK_FALSE(opt.fixed[1]);
+    CHECK(opt.lower[1] == -1.0);
+    CHECK(opt.upper[1] == 1.0);
+}
+
+TEST_CASE("fit_pixel falls back to Minuit2 if Levenberg-Marquardt fails") {
+    auto x = linspace(-5, 5, 60);
+    auto y = gaussian(x, {100.0, 0.7, 1.3}, 1.0);
+
+    // a zero width start value is rejected by the Levenberg-Marquardt
+    // solver, so the pixel has to be fitted by Minuit2
+    FitModel<Gaussian> model;
+    model.SetUseLM(true);
+    model.SetParameter("sigma", 0.0);
+
+    aare::LMResult<Gaussian::npar> lm;
+    REQUIRE_FALSE(aare::fit_pixel_lm(model, aare::lm_options(model),
+                                     x.view(), y.view(), NDView<double, 1>{},
+                                     lm));
+
+    auto res = aare::fit_pixel<Gaussian, aare::func::Chi2Gaussian>(
+        model, x.view(), y.view());
+    auto upar = model.upar();
+    auto ref = aare::fit_pixel_minuit<Gaussian, aare::func::Chi2Gaussian>(
+        model, upar, x.view(), y.view(), NDView<double, 1>{});
+    REQUIRE(res.size() == ref.size());
+    for (ssize_t i = 0; i < res.size(); ++i)
+        CHECK(res[i] == ref[i]);
+}
+
+TEST_CASE("fit_scan fits a synthetic threshold scan") {
+    using aare::model::RisingScurve;
+    const ssize_t rows = 5;
+    const ssize_t cols = 3;
+    auto thresholds = linspace(0, 100, 51);
+    aare::ScanAccumulator scan(rows, cols, thresholds.view());
+
+    // every pixel has its own inflection point, counts are the rounded
+    // expectation so the fit has to recover the parameters closely
+    auto truth = [](ssize_t row, ssize_t col) {
+        return std::array<double, 6>{
+            5.0, 0.0, 40.0 + 2.0 * static_cast<double>(row) +
+                          static_cast<double>(col),
+            4.0, 1000.0, 2.0};
+    };
+    NDArray<uint32_t, 2> frame({rows, cols});
+    for (ssize_t step = 0; step < thresholds.size(); ++step) {
+        for (ssize_t row = 0; row < rows; ++row)
+            for (ssize_t col = 0; col < cols; ++col)
+                frame(row, col) = static_cast<uint32_t>(std::lround(
+                    RisingScurve::eval(thresholds[step], truth(row, col))));
+        // every other step has twice the frames, the fit uses the counts
+        // per frame and must not notice
+        for (ssize_t n = 0; n < 1 + step % 2; ++n)
+            scan.add_frame(static_cast<size_t>(step), frame.view());
+    }
+
+    FitModel<RisingScurve> model(0, 1000, 0.5, true);
+    model.SetUseLM(true);
+    NDArray<double, 3> par({rows, cols, 6});
+    NDArray<double, 3> err({rows, cols, 6});
+    NDArray<double, 2> chi2({rows, cols});
+    // blocks of two rows, the last block is a single row
+    aare::fit_scan<RisingScurve, aare::func::Chi2RisingScurve>(
+        model, scan, par.view(), err.view(), chi2.view(), 2, 2);
+
+    for (ssize_t row = 0; row < rows; ++row) {
+        for (ssize_t col = 0; col < cols; ++col) {
+            const auto expected = truth(row, col);
+            CHECK(par(row, col, 2) == Approx(expected[2]).margin(0.1));
+            CHECK(par(row, col, 3) == Approx(expected[3]).margin(0.1));
+            CHECK(par(row, col, 4) == Approx(expected[4]).epsilon(0.02));
+            CHECK(err(row, col, 2) > 0.0);
+            CHECK(chi2(row, col) < static_cast<double>(thresholds.size()));
+        }
+    }
+
+    NDArray<double, 3> wrong({rows, cols, 5});
+    CHECK_THROWS_AS((aare::fit_scan<RisingScurve,
+                                    aare::func::Chi2RisingScurve>(
+                        model, scan, wrong.view(), err.view(), chi2.view(),
+                        1)),
+                    std::runtime_error);
+}
+
+namespace {
+
+/// Two peaks, the automatic estimate starts on the higher one at 30
+NDArray<double, 1> two_peaks(const NDArray<double, 1> &x) {
+    auto y = gaussian(x, {100.0, 30.0, 3.0});
+    auto second = gaussian(x, {80.0, 70.0, 3.0});
+    for (ssize_t i = 0; i < y.size(); ++i)
+        y[i] += second[i];
+    return y;
+}
+
+/// Fill all pixels of a (rows, cols, n) cube with the same values
+NDArray<double, 3> repeat(const NDArray<double, 1> &y, ssize_t rows,
+                          ssize_t cols) {
+    NDArray<double, 3> cube({rows, cols, y.size()});
+    for (ssize_t row = 0; row < rows; ++row)
+        for (ssize_t col = 0; col < cols; ++col)
+            for (ssize_t i = 0; i < y.size(); ++i)
+                cube(row, col, i) = y[i];
+    return cube;
+}
+
+} // namespace
+
+TEST_CASE("fit_3d tries Levenberg-Marquardt first") {
+    auto x = linspace(-5, 5, 60);
+    const ssize_t cols = 3;
+    NDArray<double, 3> y({1, cols, x.size()});
+    for (ssize_t col = 0; col < cols; ++col) {
+        auto values = gaussian(x, {100.0, 0.5 * static_cast<double>(col), 1.2},
+                               1.0, static_cast<unsigned int>(col));
+        for (ssize_t i = 0; i < x.size(); ++i)
+            y(0, col, i) = values[i];
+    }
+
+    FitModel<Gaussian> model;
+    model.SetUseLM(true);
+    NDArray<double, 3> par({1, cols, 3});
+    NDArray<double, 2> chi2({1, cols});
+    NDArray<double, 3> stats({1, cols, aare::FitStat::size});
+    aare::fit_3d<Gaussian, aare::func::Chi2Gaussian>(
+        model, x.view(), y.view(), {}, par.view(), {}, chi2.view(), 2, {},
+        stats.view());
+
+    // Minuit2 would add its calls, so the statistics only match the
+    // Levenberg-Marquardt fit if it is the only solver that ran
+    const auto opt = aare::lm_options(model);
+    for (ssize_t col = 0; col < cols; ++col) {
+        NDView<double, 1> values(&y(0, col, 0), {x.size()});
+        aare::LMResult<Gaussian::npar> lm;
+        REQUIRE(aare::fit_pixel_lm(model, opt, x.view(), values,
+                                   NDView<double, 1>{}, lm));
+        for (ssize_t k = 0; k < 3; ++k)
+            CHECK(par(0, col, k) == lm.par[k]);
+        CHECK(chi2(0, col) == lm.chi2);
+        CHECK(stats(0, col, aare::FitStat::calls) == lm.n_calls);
+        CHECK(stats(0, col, aare::FitStat::failed) == 0.0);
+        CHECK(stats(0, col, aare::FitStat::seconds) >= 0.0);
+    }
+}
+
+TEST_CASE("fit_3d starts from par_start") {
+    auto x = linspace(0, 100, 101);
+    auto y = repeat(two_peaks(x), 1, 3);
+
+    // a valid start wins over the warm start, an invalid one is ignored
+    NDArray<double, 3> start({1, 3, 3}, 0.0);
+    start(0, 0, 0) = 80.0;
+    start(0, 0, 1) = 70.0;
+    start(0, 0, 2) = 3.0;
+    start(0, 1, 0) = 100.0;
+    start(0, 1, 1) = 30.0;
+    start(0, 1, 2) = 3.0;
+
+    FitModel<Gaussian> model;
+    model.SetWarmStart(true);
+    SECTION("Levenberg-Marquardt") { model.SetUseLM(true); }
+    SECTION("Minuit2") { model.SetUseLM(false); }
+
+    NDArray<double, 3> par({1, 3, 3});
+    NDArray<double, 2> chi2({1, 3});
+    aare::fit_3d<Gaussian, aare::func::Chi2Gaussian>(
+        model, x.view(), y.view(), {}, par.view(), {}, chi2.view(), 1,
+        start.view());
+
+    CHECK(par(0, 0, 1) == Approx(70.0).margin(0.1));
+    CHECK(par(0, 1, 1) == Approx(30.0).margin(0.1));
+    CHECK(par(0, 2, 1) == Approx(30.0).margin(0.1));
+
+    NDArray<double, 3> wrong({1, 2, 3}, 0.0);
+    CHECK_THROWS_AS((aare::fit_3d<Gaussian, aare::func::Chi2Gaussian>(
+                        model, x.view(), y.view(), {}, par.view(), {},
+                        chi2.view(), 1, wrong.view())),
+                    std::runtime_error);
+}
+
+TEST_CASE("fit_3d warm starts from the left neighbour") {
+    auto x = linspace(0, 100, 101);
+    const ssize_t cols = 4;
+    auto y = repeat(two_peaks(x), 1, cols);
+
+    // only the first pixel starts on the lower peak
+    NDArray<double, 3> start({1, cols, 3}, 0.0);
+    start(0, 0, 0) = 80.0;
+    start(0, 0, 1) = 70.0;
+    start(0, 0, 2) = 3.0;
+
+    FitModel<Gaussian> model;
+    SECTION("Levenberg-Marquardt") { model.SetUseLM(true); }
+    SECTION("Minuit2") { model.SetUseLM(false); }
+
+    NDArray<double, 3> par({1, cols, 3});
+    NDArray<double, 2> chi2({1, cols});
+    auto fit = [&]() {
+        aare::fit_3d<Gaussian, aare::func::Chi2Gaussian>(
+            model, x.view(), y.view(), {}, par.view(), {}, chi2.view(), 1,
+            start.view());
+    };
+
+    fit();
+    CHECK(par(0, 0, 1) == Approx(70.0).margin(0.1));
+    for (ssize_t col = 1; col < cols; ++col)
+        CHECK(par(0, col, 1) == Approx(30.0).margin(0.1));
+
+    model.SetWarmStart(true);
+    fit();
+    for (ssize_t col = 0; col < cols; ++col)
+        CHECK(par(0, col, 1) == Approx(70.0).margin(0.1));
+}
+
+TEST_CASE("fit_3d refits a failed warm start from the estimate") {
+    auto x = linspace(-5, 5, 60);
+    auto y = repeat(gaussian(x, {100.0, 0.7, 1.3}, 1.0), 1, 2);
+
+    // too few calls for Migrad to converge, every fit fails
+    FitModel<Gaussian> model(0, 5);
+    NDArray<double, 3> start({1, 2, 3}, 0.0);
+    start(0, 0, 0) = 50.0;
+    start(0, 0, 1) = 1.0;
+    start(0, 0, 2) = 2.0;
+
+    NDArray<double, 3> par({1, 2, 3}, 1.0);
+    NDArray<double, 2> chi2({1, 2}, 1.0);
+    NDArray<double, 3> stats({1, 2, aare::FitStat::size});
+    aare::fit_3d<Gaussian, aare::func::Chi2Gaussian>(
+        model, x.view(), y.view(), {}, par.view(), {}, chi2.view(), 1,
+        start.view(), stats.view());
+
+    for (ssize_t col = 0; col < 2; ++col) {
+        CHECK(stats(0, col, aare::FitStat::failed) == 1.0);
+        CHECK(stats(0, col, aare::FitStat::calls) > 0.0);
+        CHECK(chi2(0, col) == 0.0);
+        for (ssize_t k = 0; k < 3; ++k)
+            CHECK(par(0, col, k) == 0.0);
+    }
+    // same data, the seeded pixel ran Migrad once more from its start
+    CHECK(stats(0, 0, aare::FitStat::calls) >
+          stats(0, 1, aare::FitStat::calls));
+}
+
+TEST_CASE("fit_3d reports only singular polynomial fits as failed") {
+    using aare::model::Pol1;
+    auto x = linspace(0, 10, 11);
+    NDArray<double, 3> y({1, 3, x.size()}, 0.0);
+    NDArray<double, 3> y_err({1, 3, x.size()}, 1.0);
+    for (ssize_t i = 0; i < x.size(); ++i) {
+        y(0, 1, i) = 2.0 + 0.5 * x[i];
+        y_err(0, 2, i) = i == 4 ? 1.0 : 0.0; // a single valid point
+    }
+
+    // pixel 0 is dead, zero is the correct fit and not a failure
+    FitModel<Pol1> model;
+    NDArray<double, 3> par({1, 3, 2});
+    NDArray<double, 3> err({1, 3, 2});
+    NDArray<double, 2> chi2({1, 3});
+    NDArray<double, 3> stats({1, 3, aare::FitStat::size});
+    aare::fit_3d<Pol1, aare::func::Chi2Pol1>(
+        model, x.view(), y.view(), y_err.view(), par.view(), err.view(),
+        chi2.view(), 1, {}, stats.view());
+
+    CHECK(par(0, 0, 0) == 0.0);
+    CHECK(par(0, 0, 1) == 0.0);
+    CHECK(stats(0, 0, aare::FitStat::failed) == 0.0);
+    CHECK(par(0, 1, 0) == Approx(2.0));
+    CHECK(par(0, 1, 1) == Approx(0.5));
+    CHECK(stats(0, 1, aare::FitStat::failed) == 0.0);
+    CHECK(stats(0, 2, aare::FitStat::failed) == 1.0);
+}
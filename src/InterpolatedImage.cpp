@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/InterpolatedImage.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace aare {
+
+InterpolatedImage::InterpolatedImage(ssize_t rows, ssize_t cols,
+                                     int subpixels, double emin, double emax,
+                                     int n_threads)
+    : m_rows(rows), m_cols(cols), m_subpixels(subpixels), m_emin(emin),
+      m_emax(emax), m_n_threads(n_threads) {
+    if (rows < 1 || cols < 1 || subpixels < 1) {
+        throw std::invalid_argument(
+            "InterpolatedImage requires positive rows, cols and subpixels");
+    }
+    if (n_threads < 1) {
+        throw std::invalid_argument(
+            "InterpolatedImage requires at least one thread");
+    }
+    if (!(emin < emax)) {
+        throw std::invalid_argument("InterpolatedImage requires emin < emax");
+    }
+    m_partial_images.reserve(n_threads);
+    for (int i = 0; i < n_threads; ++i) {
+        m_partial_images.emplace_back(
+            std::array<ssize_t, 2>{rows * subpixels, cols * subpixels}, 0);
+    }
+    m_partial_photons.resize(n_threads, 0);
+}
+
+NDArray<uint32_t, 2> InterpolatedImage::values() const {
+    NDArray<uint32_t, 2> image(m_partial_images.front());
+    for (size_t t = 1; t < m_partial_images.size(); ++t) {
+        const auto &partial = m_partial_images[t];
+        for (ssize_t i = 0; i < image.size(); ++i) {
+            image[i] += partial[i];
+        }
+    }
+    return image;
+}
+
+size_t InterpolatedImage::n_photons() const {
+    size_t total = 0;
+    for (const auto n : m_partial_photons) {
+        total += n;
+    }
+    return total;
+}
+
+void InterpolatedImage::clear() {
+    for (auto &partial : m_partial_images) {
+        partial = 0;
+    }
+    std::fill(m_partial_photons.begin(), m_partial_photons.end(), 0);
+}
+
+} // namespace aare
@@ -0,0 +1,131 @@
+#include "aare/InterpolatedImage.hpp"
+#include "aare/ClusterFile.hpp"
+#include "aare/ClusterVector.hpp"
+#include "aare/Interpolator.hpp"
+#include "aare/NDArray.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+using namespace aare;
+
+namespace {
+
+Interpolator make_interpolator() {
+    NDArray<double, 1> etax_bins(std::array<ssize_t, 1>{21});
+    NDArray<double, 1> etay_bins(std::array<ssize_t, 1>{21});
+    for (ssize_t i = 0; i < 21; ++i) {
+        etax_bins[i] = -0.05 + 1.1 * static_cast<double>(i) / 20.0;
+        etay_bins[i] = etax_bins[i];
+    }
+    NDArray<double, 1> energy_bins(std::array<double, 3>{0.0, 50.0, 100.0});
+    NDArray<double, 3> eta_distribution(std::array<ssize_t, 3>{20, 20, 2});
+    std::iota(eta_distribution.begin(), eta_distribution.end(), 1.0);
+    return Interpolator(eta_distribution.view(), etax_bins.view(),
+                        etay_bins.view(), energy_bins.view());
+}
+
+ClusterVector<Cluster<double, 3, 3>> make_clusters(int n_clusters) {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> pixel(0.0, 10.0);
+    ClusterVector<Cluster<double, 3, 3>> clusters;
+    for (int n = 0; n < n_clusters; ++n) {
+        Cluster<double, 3, 3> cluster{static_cast<uint16_t>(1 + n % 30),
+                                      static_cast<uint16_t>(1 + n / 30 % 20),
+                                      {}};
+        for (auto &value : cluster.data) {
+            value = pixel(gen);
+        }
+        clusters.push_back(cluster);
+    }
+    return clusters;
+}
+
+} // namespace
+
+TEST_CASE("InterpolatedImage bins the photons of interpolate()",
+          "[Interpolation]") {
+    const auto interpolator = make_interpolator();
+    const auto clusters = make_clusters(3000);
+    const int subpixels = 4;
+    const double emin = 10.0;
+    const double emax = 30.0;
+    const int n_threads = GENERATE(1, 4);
+
+    InterpolatedImage image(20, 32, subpixels, emin, emax, n_threads);
+    image.fill<calculate_eta2<double, 3, 3>>(interpolator, clusters);
+    image.fill<calculate_eta2<double, 3, 3>>(interpolator, clusters);
+
+    NDArray<uint32_t, 2> expected(std::array<ssize_t, 2>{80, 128}, 0);
+    size_t n_expected = 0;
+    for (const auto &photon :
+         interpolator.interpolate<calculate_eta2<double, 3, 3>>(clusters)) {
+        if (photon.energy < emin || photon.energy >= emax) {
+            continue;
+        }
+        const auto row = static_cast<ssize_t>(std::floor(photon.y * 4));
+        const auto col = static_cast<ssize_t>(std::floor(photon.x * 4));
+        if (row < 0 || row >= 80 || col < 0 || col >= 128) {
+            continue;
+        }
+        expected(row, col) += 2;
+        n_expected += 2;
+    }
+    REQUIRE(n_expected > 0);
+
+    const auto values = image.values();
+    REQUIRE(values.shape(0) == 80);
+    REQUIRE(values.shape(1) == 128);
+    CHECK((values == expected));
+    CHECK(image.n_photons() == n_expected);
+
+    image.clear();
+    CHECK(image.n_photons() == 0);
+    const auto cleared = image.values();
+    CHECK(std::all_of(cleared.begin(), cleared.end(),
+                      [](uint32_t v) { return v == 0; }));
+}
+
+TEST_CASE("InterpolatedImage fill_from_file reads the whole file",
+          "[Interpolation]") {
+    const auto interpolator = make_interpolator();
+    const auto clusters = make_clusters(1000);
+    const auto fname =
+        std::filesystem::temp_directory_path() / "aare_interpolated.clust";
+    {
+        ClusterFile<Cluster<double, 3, 3>> file(fname, 1000, "w");
+        file.write_frame(clusters);
+        file.write_frame(clusters);
+    }
+
+    InterpolatedImage reference(20, 32, 2, 0.0, 100.0);
+    reference.fill<calculate_eta2<double, 3, 3>>(interpolator, clusters);
+    reference.fill<calculate_eta2<double, 3, 3>>(interpolator, clusters);
+
+    InterpolatedImage image(20, 32, 2, 0.0, 100.0, 3);
+    ClusterFile<Cluster<double, 3, 3>> file(fname);
+    image.fill_from_file<calculate_eta2<double, 3, 3>>(interpolator, file,
+                                                       300);
+    file.close();
+    std::filesystem::remove(fname);
+
+    CHECK(image.n_photons() == reference.n_photons());
+    CHECK((image.values() == reference.values()));
+}
+
+TEST_CASE("InterpolatedImage rejects invalid arguments", "[Interpolation]") {
+    CHECK_THROWS_AS(InterpolatedImage(0, 10, 2), std::invalid_argument);
+    CHECK_THROWS_AS(InterpolatedImage(10, 10, 0), std::invalid_argument);
+    CHECK_THROWS_AS(InterpolatedImage(10, 10, 2, 5.0, 5.0),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(InterpolatedImage(10, 10, 2, 0.0, 1.0, 0),
+                    std::invalid_argument);
+}
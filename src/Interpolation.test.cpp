@@ -5,7 +5,12 @@
 #include <array>
 #include <catch2/catch_all.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <cmath>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
 
 using namespace aare;
 
@@ -163,4 +168,125 @@ TEST_CASE("Test Rosenblatt", "[Interpolation]") {
                   Catch::Approx(expected_ietay[i * ietay.shape(1) + j]));
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("transform_eta_values matches a linear search over the bins",
+          "[Interpolation]") {
+    // Uniform eta bins take the direct index path, the energy bins the
+    // binary search fallback.
+    const bool uniform_eta = GENERATE(true, false);
+    NDArray<double, 1> etax_bins(std::array<ssize_t, 1>{11});
+    NDArray<double, 1> etay_bins(std::array<ssize_t, 1>{9});
+    for (ssize_t i = 0; i < etax_bins.size(); ++i) {
+        const double u = static_cast<double>(i) / 10.0;
+        etax_bins[i] = uniform_eta ? -0.1 + 1.2 * u : -0.1 + 1.2 * u * u;
+    }
+    for (ssize_t i = 0; i < etay_bins.size(); ++i) {
+        etay_bins[i] = -0.1 + 1.2 * static_cast<double>(i) / 8.0;
+    }
+    NDArray<double, 1> energy_bins(
+        std::array<double, 5>{0.0, 10.0, 50.0, 60.0, 200.0});
+
+    NDArray<double, 3> eta_distribution(std::array<ssize_t, 3>{10, 8, 4});
+    std::iota(eta_distribution.begin(), eta_distribution.end(), 1.0);
+    Interpolator interpolator(eta_distribution.view(), etax_bins.view(),
+                              etay_bins.view(), energy_bins.view());
+    const auto ietax = interpolator.get_ietax();
+    const auto ietay = interpolator.get_ietay();
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> eta_dist(-0.2, 1.1);
+    std::uniform_real_distribution<double> energy_dist(0.0, 200.0);
+    std::vector<Eta2<double>> etas;
+    for (int n = 0; n < 2000; ++n) {
+        etas.push_back(Eta2<double>{eta_dist(gen), eta_dist(gen),
+                                    corner::cTopLeft, energy_dist(gen)});
+    }
+    // Values on the bin edges must land in the same bin as well.
+    for (ssize_t i = 0; i < etax_bins.size(); ++i) {
+        etas.push_back(Eta2<double>{etax_bins[i], etay_bins[i % 9],
+                                    corner::cTopLeft, energy_bins[i % 5]});
+    }
+
+    for (const auto &eta : etas) {
+        const auto ix = last_smaller(etax_bins, eta.x);
+        const auto iy = last_smaller(etay_bins, eta.y);
+        const auto ie = last_smaller(energy_bins, eta.sum);
+        if (ix >= 10 || iy >= 8 || ie >= 4) {
+            CHECK_THROWS_AS(interpolator.transform_eta_values(eta),
+                            std::runtime_error);
+            continue;
+        }
+        const auto uniform = interpolator.transform_eta_values(eta);
+        CHECK(uniform.x == Catch::Approx(ietax(ix, iy, ie)).margin(1e-6));
+        CHECK(uniform.y == Catch::Approx(ietay(ix, iy, ie)).margin(1e-6));
+    }
+}
+
+TEST_CASE("interpolate_batch matches interpolate and flags out of bounds "
+          "clusters",
+          "[Interpolation]") {
+    NDArray<double, 1> etax_bins(std::array<ssize_t, 1>{21});
+    NDArray<double, 1> etay_bins(std::array<ssize_t, 1>{21});
+    for (ssize_t i = 0; i < 21; ++i) {
+        etax_bins[i] = -0.05 + 1.1 * static_cast<double>(i) / 20.0;
+        etay_bins[i] = etax_bins[i];
+    }
+    NDArray<double, 1> energy_bins(std::array<double, 3>{0.0, 50.0, 100.0});
+    NDArray<double, 3> eta_distribution(std::array<ssize_t, 3>{20, 20, 2});
+    std::iota(eta_distribution.begin(), eta_distribution.end(), 1.0);
+    Interpolator interpolator(eta_distribution.view(), etax_bins.view(),
+                              etay_bins.view(), energy_bins.view());
+
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> pixel(0.0, 8.0);
+    ClusterVector<Cluster<double, 3, 3>> clusters;
+    for (int n = 0; n < 500; ++n) {
+        Cluster<double, 3, 3> cluster{static_cast<uint16_t>(n % 100),
+                                      static_cast<uint16_t>(n / 100),
+                                      {}};
+        for (auto &value : cluster.data) {
+            value = pixel(gen);
+        }
+        clusters.push_back(cluster);
+    }
+
+    const int n_threads = GENERATE(1, 3);
+    const auto reference =
+        interpolator.interpolate<calculate_eta2<double, 3, 3>>(clusters);
+    const auto batch =
+        interpolator.interpolate_batch<calculate_eta2<double, 3, 3>>(
+            clusters, n_threads);
+    REQUIRE(batch.x.size() == 500);
+    for (size_t i = 0; i < reference.size(); ++i) {
+        const auto n = static_cast<ssize_t>(i);
+        CHECK(batch.valid[n]);
+        CHECK(batch.x[n] == Catch::Approx(reference[i].x));
+        CHECK(batch.y[n] == Catch::Approx(reference[i].y));
+        CHECK(batch.energy[n] == reference[i].energy);
+    }
+
+    // A cluster sum above the last energy bin throws in interpolate() but
+    // is only flagged by the batch API.
+    clusters.push_back(Cluster<double, 3, 3>{
+        1, 1, std::array<double, 9>{50, 50, 50, 50, 50, 50, 50, 50, 50}});
+    CHECK_THROWS_AS(
+        (interpolator.interpolate<calculate_eta2<double, 3, 3>>(clusters)),
+        std::runtime_error);
+    const auto flagged =
+        interpolator.interpolate_batch<calculate_eta2<double, 3, 3>>(
+            clusters, n_threads);
+    CHECK_FALSE(flagged.valid[500]);
+    CHECK(std::isnan(flagged.x[500]));
+    CHECK(flagged.energy[500] == 200.0); // sum of the 2x2 subcluster
+    CHECK(flagged.valid[499]);
+
+    NDArray<double, 1> too_short(std::array<ssize_t, 1>{10});
+    NDArray<bool, 1> valid(std::array<ssize_t, 1>{501});
+    using Eta2Function = decltype(&calculate_eta2<double, 3, 3>);
+    constexpr Eta2Function eta2 = &calculate_eta2<double, 3, 3>;
+    CHECK_THROWS_AS(
+        (interpolator.interpolate_into<eta2>(clusters, too_short.view(),
+                                             too_short.view(),
+                                             too_short.view(), valid.view())),
+        std::invalid_argument);
+}
@@ -1,147 +1,234 @@
 // SPDX-License-Identifier: MPL-2.0
 #include "aare/Interpolator.hpp"
 
-namespace aare {
+#include "aare/utils/par.hpp"
+#include "aare/utils/task.hpp"
 
-Interpolator::Interpolator(NDView<double, 1> xbins, NDView<double, 1> ybins,
-                           NDView<double, 1> ebins)
-    : m_etabinsx(xbins), m_etabinsy(ybins), m_energy_bins(ebins) {}
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
-Interpolator::Interpolator(NDView<double, 3> etacube, NDView<double, 1> xbins,
-                           NDView<double, 1> ybins, NDView<double, 1> ebins)
-    : m_etabinsx(xbins), m_etabinsy(ybins), m_energy_bins(ebins) {
-    if (etacube.shape(0) + 1 != xbins.size() ||
-        etacube.shape(1) + 1 != ybins.size() ||
-        etacube.shape(2) + 1 != ebins.size()) {
-        throw std::invalid_argument(
-            "The shape of the etacube does not match the shape of the bins");
-    }
+namespace aare {
 
-    m_ietax = NDArray<double, 3>(etacube);
+namespace {
 
-    m_ietay = NDArray<double, 3>(etacube);
-    // TODO: etacube should have different strides energy should come first
-    //  prefix sum - conditional CDF
-    for (ssize_t i = 0; i < m_ietax.shape(0); i++) {
-        for (ssize_t j = 0; j < m_ietax.shape(1); j++) {
-            for (ssize_t k = 0; k < m_ietax.shape(2); k++) {
-                m_ietax(i, j, k) += (i == 0) ? 0 : m_ietax(i - 1, j, k);
+// The etacube is indexed (eta_x, eta_y, energy), so each energy bin is a
+// strided [n_x x n_y] slice. The CDFs of different energy bins are
+// independent; they are computed on a contiguous copy of the slice and
+// split over threads by energy bin.
 
-                m_ietay(i, j, k) += (j == 0) ? 0 : m_ietay(i, j - 1, k);
-            }
-        }
+template <typename F>
+void for_each_energy_bin(ssize_t n_bins, int n_threads, F func) {
+    if (n_threads <= 1) {
+        func(0, static_cast<int>(n_bins));
+        return;
     }
+    RunInParallel(func, split_task(0, static_cast<int>(n_bins), n_threads));
+}
 
-    // Standardize, if norm less than 1 don't do anything
-    for (ssize_t i = 0; i < m_ietax.shape(0); i++) {
-        for (ssize_t j = 0; j < m_ietax.shape(1); j++) {
-            for (ssize_t k = 0; k < m_ietax.shape(2); k++) {
-                auto shift_x = etacube(0, j, k);
-                auto val_etax = m_ietax(m_ietax.shape(0) - 1, j, k) - shift_x;
-                double norm_etax = val_etax == 0 ? 1 : val_etax;
-                m_ietax(i, j, k) -= shift_x;
-                m_ietax(i, j, k) /= norm_etax;
-                auto shift_y = etacube(i, 0, k);
-                auto val_etay = m_ietay(i, m_ietay.shape(1) - 1, k) - shift_y;
-                double norm_etay = val_etay == 0 ? 1 : val_etay;
-                m_ietay(i, j, k) -= shift_y;
-
-                m_ietay(i, j, k) /= norm_etay;
-            }
+void gather_energy_bin(NDView<double, 3> etacube, ssize_t k,
+                       std::vector<double> &slice) {
+    double *dst = slice.data();
+    for (ssize_t i = 0; i < etacube.shape(0); ++i) {
+        for (ssize_t j = 0; j < etacube.shape(1); ++j) {
+            *dst++ = etacube(i, j, k);
         }
     }
 }
 
-void Interpolator::rosenblatttransform(NDView<double, 3> etacube) {
+void scatter_energy_bin(const std::vector<double> &slice, ssize_t k,
+                        NDArray<double, 3> &cube) {
+    const double *src = slice.data();
+    for (ssize_t i = 0; i < cube.shape(0); ++i) {
+        for (ssize_t j = 0; j < cube.shape(1); ++j) {
+            cube(i, j, k) = *src++;
+        }
+    }
+}
 
-    if (etacube.shape(0) + 1 != m_etabinsx.size() ||
-        etacube.shape(1) + 1 != m_etabinsy.size() ||
-        etacube.shape(2) + 1 != m_energy_bins.size()) {
-        throw std::invalid_argument(
-            "The shape of the etacube does not match the shape of the bins");
+// CDF of eta_x conditioned on eta_y, shifted so that the first bin is 0
+// and normalized, if the norm is zero don't do anything
+void conditional_cdf_x(const std::vector<double> &p, std::vector<double> &cdf,
+                       ssize_t n_x, ssize_t n_y) {
+    for (ssize_t i = 0; i < n_x; ++i) {
+        for (ssize_t j = 0; j < n_y; ++j) {
+            cdf[i * n_y + j] =
+                p[i * n_y + j] + ((i == 0) ? 0 : cdf[(i - 1) * n_y + j]);
+        }
     }
+    for (ssize_t j = 0; j < n_y; ++j) {
+        const double shift = p[j];
+        const double val = cdf[(n_x - 1) * n_y + j] - shift;
+        const double norm = val == 0 ? 1 : val;
+        for (ssize_t i = 0; i < n_x; ++i) {
+            cdf[i * n_y + j] -= shift;
+            cdf[i * n_y + j] /= norm;
+        }
+    }
+}
 
-    // TODO: less loops and better performance if ebins is first dimension
-    // (violates backwardscompatibility ieta_x and ieta_y public getters,
-    // previously generated etacubes)
-    //  TODO: maybe more loops is better then storing total_sum_y and
-    //  total_sum_x
+// CDF of eta_y conditioned on eta_x, shifted and normalized like
+// conditional_cdf_x
+void conditional_cdf_y(const std::vector<double> &p, std::vector<double> &cdf,
+                       ssize_t n_x, ssize_t n_y) {
+    for (ssize_t i = 0; i < n_x; ++i) {
+        const double *row = p.data() + i * n_y;
+        double *out = cdf.data() + i * n_y;
+        for (ssize_t j = 0; j < n_y; ++j) {
+            out[j] = row[j] + ((j == 0) ? 0 : out[j - 1]);
+        }
+        const double shift = row[0];
+        const double val = out[n_y - 1] - shift;
+        const double norm = val == 0 ? 1 : val;
+        for (ssize_t j = 0; j < n_y; ++j) {
+            out[j] -= shift;
+            out[j] /= norm;
+        }
+    }
+}
 
-    // marginal CDF for eta_x
-    NDArray<double, 2> marg_CDF_EtaX(
-        std::array<ssize_t, 2>{m_etabinsx.size() - 1, m_energy_bins.size() - 1},
-        0.0); // simulate proper probability distribution with zero at start
+// Marginal CDF of eta_x, broadcast along eta_y. The first bin is set to
+// zero to simulate a proper probability distribution with zero at start.
+void marginal_cdf_x(const std::vector<double> &p, std::vector<double> &cdf,
+                    ssize_t n_x, ssize_t n_y) {
+    std::vector<double> marg(static_cast<size_t>(n_x), 0.0);
+    for (ssize_t i = 0; i < n_x; ++i) {
+        for (ssize_t j = 0; j < n_y; ++j) {
+            marg[i] += p[i * n_y + j];
+        }
+    }
+    if (n_x > 1) {
+        marg[0] = 0.0;
+    }
+    for (ssize_t i = 1; i < n_x; ++i) {
+        marg[i] += marg[i - 1];
+    }
+    const double norm = marg[n_x - 1] == 0 ? 1 : marg[n_x - 1];
+    for (ssize_t i = 1; i < n_x; ++i) {
+        marg[i] /= norm;
+    }
+    for (ssize_t i = 0; i < n_x; ++i) {
+        std::fill(cdf.begin() + i * n_y, cdf.begin() + (i + 1) * n_y,
+                  marg[i]);
+    }
+}
 
-    // conditional CDF for eta_y
-    NDArray<double, 3> cond_CDF_EtaY(etacube);
+} // namespace
 
-    for (ssize_t i = 0; i < cond_CDF_EtaY.shape(0); ++i) {
-        for (ssize_t j = 0; j < cond_CDF_EtaY.shape(1); ++j) {
-            for (ssize_t k = 0; k < cond_CDF_EtaY.shape(2); ++k) {
-                // cumsum along y-axis
-                marg_CDF_EtaX(i, k) +=
-                    etacube(i, j,
-                            k); // marginal probability for etaX
+Interpolator::Interpolator(NDView<double, 1> xbins, NDView<double, 1> ybins,
+                           NDView<double, 1> ebins)
+    : m_etabinsx(xbins), m_etabinsy(ybins), m_energy_bins(ebins),
+      m_xindex(make_bin_index(m_etabinsx)),
+      m_yindex(make_bin_index(m_etabinsy)),
+      m_eindex(make_bin_index(m_energy_bins)) {}
 
-                // cumsum along y-axis
-                cond_CDF_EtaY(i, j, k) +=
-                    (j == 0) ? 0 : cond_CDF_EtaY(i, j - 1, k);
-            }
-        }
+Interpolator::Interpolator(NDView<double, 3> etacube, NDView<double, 1> xbins,
+                           NDView<double, 1> ybins, NDView<double, 1> ebins,
+                           int n_threads)
+    : Interpolator(xbins, ybins, ebins) {
+    if (etacube.shape(0) + 1 != xbins.size() ||
+        etacube.shape(1) + 1 != ybins.size() ||
+        etacube.shape(2) + 1 != ebins.size()) {
+        throw std::invalid_argument(
+            "The shape of the etacube does not match the shape of the bins");
     }
 
-    // cumsum along x-axis
-    for (ssize_t i = 1; i < marg_CDF_EtaX.shape(0); ++i) {
-        for (ssize_t k = 0; k < marg_CDF_EtaX.shape(1); ++k) {
-            marg_CDF_EtaX(0, k) =
-                0.0; // shift by first value to ensure values between 0 and 1
-
-            marg_CDF_EtaX(i, k) += marg_CDF_EtaX(i - 1, k);
+    m_ietax = NDArray<double, 3>(etacube.shape());
+    m_ietay = NDArray<double, 3>(etacube.shape());
+
+    const ssize_t n_x = etacube.shape(0);
+    const ssize_t n_y = etacube.shape(1);
+    for_each_energy_bin(etacube.shape(2), n_threads, [&](int first, int last) {
+        std::vector<double> slice(static_cast<size_t>(n_x * n_y));
+        std::vector<double> cdf_x(slice.size());
+        std::vector<double> cdf_y(slice.size());
+        for (ssize_t k = first; k < last; ++k) {
+            gather_energy_bin(etacube, k, slice);
+            // prefix sum - conditional CDF, standardized
+            conditional_cdf_x(slice, cdf_x, n_x, n_y);
+            conditional_cdf_y(slice, cdf_y, n_x, n_y);
+            scatter_energy_bin(cdf_x, k, m_ietax);
+            scatter_energy_bin(cdf_y, k, m_ietay);
         }
-    }
+    });
+    compile_lut();
+}
 
-    // normalize marg_CDF_EtaX
-    for (ssize_t i = 1; i < marg_CDF_EtaX.shape(0); ++i) {
-        for (ssize_t k = 0; k < marg_CDF_EtaX.shape(1); ++k) {
-            double norm = marg_CDF_EtaX(marg_CDF_EtaX.shape(0) - 1, k) == 0
-                              ? 1
-                              : marg_CDF_EtaX(marg_CDF_EtaX.shape(0) - 1, k);
-            marg_CDF_EtaX(i, k) /= norm;
+Interpolator::BinIndex
+Interpolator::make_bin_index(const NDArray<double, 1> &edges) {
+    BinIndex index;
+    const ssize_t n = edges.size();
+    if (n < 2) {
+        return index;
+    }
+    const double width = (edges[n - 1] - edges[0]) / static_cast<double>(n - 1);
+    if (!(width > 0) || !std::isfinite(width)) {
+        return index;
+    }
+    // find_bin corrects the computed index against the real edges, so the
+    // tolerance only decides whether that correction stays a single step.
+    for (ssize_t i = 0; i < n; ++i) {
+        const double expected = edges[0] + static_cast<double>(i) * width;
+        if (std::abs(edges[i] - expected) > 1e-6 * width) {
+            return index;
         }
     }
+    index.first = edges[0];
+    index.inv_width = 1.0 / width;
+    index.uniform = true;
+    return index;
+}
 
-    // standardize, normalize conditional CDF for etaY
-    // Note P(EtaY|EtaX) = P(EtaY,EtaX)/P(EtaX) we dont divide by P(EtaX) as it
-    // cancels out during normalization
-    for (ssize_t i = 0; i < cond_CDF_EtaY.shape(0); ++i) {
-        for (ssize_t j = 0; j < cond_CDF_EtaY.shape(1); ++j) {
-            for (ssize_t k = 0; k < cond_CDF_EtaY.shape(2); ++k) {
-                double shift = etacube(i, 0, k);
-                double norm =
-                    (cond_CDF_EtaY(i, cond_CDF_EtaY.shape(1) - 1, k) - shift) ==
-                            0
-                        ? 1
-                        : cond_CDF_EtaY(i, cond_CDF_EtaY.shape(1) - 1, k) -
-                              shift;
-                cond_CDF_EtaY(i, j, k) -= shift;
-                cond_CDF_EtaY(i, j, k) /= norm;
+void Interpolator::compile_lut() {
+    const ssize_t n_x = m_ietax.shape(0);
+    const ssize_t n_y = m_ietax.shape(1);
+    const ssize_t n_e = m_ietax.shape(2);
+    m_lut.resize(static_cast<size_t>(n_x * n_y * n_e) * 2);
+    float *dst = m_lut.data();
+    for (ssize_t k = 0; k < n_e; ++k) {
+        for (ssize_t i = 0; i < n_x; ++i) {
+            for (ssize_t j = 0; j < n_y; ++j) {
+                *dst++ = static_cast<float>(m_ietax(i, j, k));
+                *dst++ = static_cast<float>(m_ietay(i, j, k));
             }
         }
     }
+}
+
+void Interpolator::rosenblatttransform(NDView<double, 3> etacube,
+                                       int n_threads) {
 
-    m_ietay = std::move(
-        cond_CDF_EtaY); // TODO maybe rename m_ietay to lookup or CDF_EtaY_cond
+    if (etacube.shape(0) + 1 != m_etabinsx.size() ||
+        etacube.shape(1) + 1 != m_etabinsy.size() ||
+        etacube.shape(2) + 1 != m_energy_bins.size()) {
+        throw std::invalid_argument(
+            "The shape of the etacube does not match the shape of the bins");
+    }
 
     // TODO: should actually be only 2dimensional keep three dimension due to
     // consistency with Annas code change though
-    m_ietax = NDArray<double, 3>(
-        std::array<ssize_t, 3>{m_etabinsx.size() - 1, m_etabinsy.size() - 1,
-                               m_energy_bins.size() - 1});
-
-    for (ssize_t i = 0; i < m_etabinsx.size() - 1; ++i)
-        for (ssize_t j = 0; j < m_etabinsy.size() - 1; ++j)
-            for (ssize_t k = 0; k < m_energy_bins.size() - 1; ++k)
-                m_ietax(i, j, k) = marg_CDF_EtaX(i, k);
+    m_ietax = NDArray<double, 3>(etacube.shape());
+    // TODO maybe rename m_ietay to lookup or CDF_EtaY_cond
+    m_ietay = NDArray<double, 3>(etacube.shape());
+
+    const ssize_t n_x = etacube.shape(0);
+    const ssize_t n_y = etacube.shape(1);
+    for_each_energy_bin(etacube.shape(2), n_threads, [&](int first, int last) {
+        std::vector<double> slice(static_cast<size_t>(n_x * n_y));
+        std::vector<double> marg_cdf_x(slice.size());
+        std::vector<double> cond_cdf_y(slice.size());
+        for (ssize_t k = first; k < last; ++k) {
+            gather_energy_bin(etacube, k, slice);
+            marginal_cdf_x(slice, marg_cdf_x, n_x, n_y);
+            // Note P(EtaY|EtaX) = P(EtaY,EtaX)/P(EtaX) we dont divide by
+            // P(EtaX) as it cancels out during normalization
+            conditional_cdf_y(slice, cond_cdf_y, n_x, n_y);
+            scatter_energy_bin(marg_cdf_x, k, m_ietax);
+            scatter_energy_bin(cond_cdf_y, k, m_ietay);
+        }
+    });
+
+    compile_lut();
 }
 
 } // namespace aare
\ No newline at end of file
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/LMFit.hpp"
+#include "aare/NDArray.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+
+#include "test_utils.hpp"
+
+using aare::lm_fit;
+using aare::LMOptions;
+using aare::NDArray;
+using aare::NDView;
+using aare::test::linspace;
+using Catch::Approx;
+
+namespace {
+
+template <typename Model>
+NDArray<double, 1> evaluate(const NDArray<double, 1> &x,
+                            const std::array<double, Model::npar> &par,
+                            double noise = 0.0) {
+    std::mt19937 rng(1234);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    NDArray<double, 1> y(x.shape());
+    for (ssize_t i = 0; i < x.size(); ++i)
+        y[i] = Model::eval(x[i], par) + noise * dist(rng);
+    return y;
+}
+
+// Straight line through the origin that only accepts a slope of exactly
+// 1, so every step away from the start is invalid and the fit gets stuck
+struct StuckLine {
+    static constexpr std::size_t npar = 1;
+    static constexpr std::array<aare::model::ParamInfo, npar> param_info = {
+        {{"slope", -aare::model::no_bound, aare::model::no_bound}}};
+
+    template <typename Par> static double eval(double x, const Par &par) {
+        return par[0] * x;
+    }
+    template <typename Par>
+    static void eval_and_grad(double x, const Par &par, double &f,
+                              std::array<double, npar> &g) {
+        f = par[0] * x;
+        g[0] = x;
+    }
+    template <typename Par> static bool is_valid(const Par &par) {
+        return par[0] == 1.0;
+    }
+};
+
+} // namespace
+
+TEST_CASE("lm_fit recovers the parameters of noise free data") {
+    using aare::model::Pol2;
+    auto x = linspace(-10, 30, 50);
+    auto y = evaluate<Pol2>(x, {3.0, -0.5, 0.02});
+
+    auto res = lm_fit<Pol2>(x.view(), y.view(), NDView<double, 1>{},
+                            {0.0, 0.0, 0.0}, LMOptions<Pol2>{});
+    REQUIRE(res.converged);
+    CHECK(res.par[0] == Approx(3.0).epsilon(1e-8));
+    CHECK(res.par[1] == Approx(-0.5).epsilon(1e-8));
+    CHECK(res.par[2] == Approx(0.02).epsilon(1e-8));
+    CHECK(res.chi2 < 1e-12);
+    CHECK(res.n_calls >= res.iterations + 1);
+}
+
+TEST_CASE("lm_fit errors match the weighted straight line formula") {
+    using aare::model::Pol1;
+    auto x = linspace(0, 10, 20);
+    auto y = evaluate<Pol1>(x, {1.0, 2.0}, 0.3);
+    NDArray<double, 1> y_err(x.shape(), 0.3);
+    y_err[5] = 0.6;
+
+    LMOptions<Pol1> opt;
+    opt.compute_errors = true;
+    auto res = lm_fit<Pol1>(x.view(), y.view(), y_err.view(),
+                            Pol1::estimate_par(x.view(), y.view()), opt);
+    REQUIRE(res.converged);
+
+    double s = 0, sx = 0, sxx = 0;
+    for (ssize_t i = 0; i < x.size(); ++i) {
+        const double w = 1.0 / (y_err[i] * y_err[i]);
+        s += w;
+        sx += w * x[i];
+        sxx += w * x[i] * x[i];
+    }
+    const double delta = s * sxx - sx * sx;
+    CHECK(res.err[0] == Approx(std::sqrt(sxx / delta)).epsilon(1e-9));
+    CHECK(res.err[1] == Approx(std::sqrt(s / delta)).epsilon(1e-9));
+    CHECK(res.par[1] == Approx(2.0).margin(0.1));
+}
+
+TEST_CASE("lm_fit converges for the peak models from the estimates") {
+    SECTION("Gaussian") {
+        using aare::model::Gaussian;
+        auto x = linspace(-5, 5, 60);
+        auto y = evaluate<Gaussian>(x, {100.0, 0.7, 1.3}, 1.0);
+        auto res =
+            lm_fit<Gaussian>(x.view(), y.view(), NDView<double, 1>{},
+                             Gaussian::estimate_par(x.view(), y.view()),
+                             LMOptions<Gaussian>{});
+        REQUIRE(res.converged);
+        CHECK(res.par[0] == Approx(100.0).margin(2.0));
+        CHECK(res.par[1] == Approx(0.7).margin(0.05));
+        CHECK(res.par[2] == Approx(1.3).margin(0.05));
+    }
+    SECTION("GaussianErfcPlateau") {
+        using aare::model::GaussianErfcPlateau;
+        auto x = linspace(0, 20, 100);
+        auto y = evaluate<GaussianErfcPlateau>(x, {200.0, 40.0, 12.0, 1.5},
+                                               2.0);
+        auto res = lm_fit<GaussianErfcPlateau>(
+            x.view(), y.view(), NDView<double, 1>{},
+            GaussianErfcPlateau::estimate_par(x.view(), y.view()),
+            LMOptions<GaussianErfcPlateau>{});
+        REQUIRE(res.converged);
+        CHECK(res.par[0] == Approx(200.0).margin(4.0));
+        CHECK(res.par[1] == Approx(40.0).margin(2.0));
+        CHECK(res.par[2] == Approx(12.0).margin(0.05));
+        CHECK(res.par[3] == Approx(1.5).margin(0.05));
+    }
+}
+
+TEST_CASE("lm_fit keeps fixed parameters and respects bounds") {
+    using aare::model::Gaussian;
+    auto x = linspace(-5, 5, 60);
+    auto y = evaluate<Gaussian>(x, {100.0, 0.0, 1.0});
+
+    LMOptions<Gaussian> opt;
+    opt.fixed[1] = true;
+    opt.lower[2] = 1.5;
+    auto res = lm_fit<Gaussian>(x.view(), y.view(), NDView<double, 1>{},
+                                {80.0, 0.25, 2.0}, opt);
+    REQUIRE(res.converged);
+    CHECK(res.par[1] == 0.25);
+    CHECK(res.par[2] == 1.5);
+
+    // invalid start values are not fitted
+    opt = LMOptions<Gaussian>{};
+    opt.lower[2] = -aare::model::no_bound;
+    res = lm_fit<Gaussian>(x.view(), y.view(), NDView<double, 1>{},
+                           {80.0, 0.0, 0.0}, opt);
+    CHECK_FALSE(res.converged);
+    CHECK(res.iterations == 0);
+}
+
+TEST_CASE("lm_fit does not report a stuck fit as converged") {
+    auto x = linspace(1, 10, 10);
+    NDArray<double, 1> y(x.shape());
+    for (ssize_t i = 0; i < x.size(); ++i)
+        y[i] = 2.0 * x[i];
+
+    // no valid step reduces chi2 but the gradient does not vanish
+    auto res = lm_fit<StuckLine>(x.view(), y.view(), NDView<double, 1>{},
+                                 {1.0}, LMOptions<StuckLine>{});
+    CHECK_FALSE(res.converged);
+    CHECK(res.par[0] == 1.0);
+
+    // residuals orthogonal to x, so a slope of 1 is the minimum
+    for (ssize_t i = 0; i < x.size(); ++i)
+        y[i] = x[i];
+    y[0] += 0.2;
+    y[1] -= 0.1;
+    res = lm_fit<StuckLine>(x.view(), y.view(), NDView<double, 1>{}, {1.0},
+                            LMOptions<StuckLine>{});
+    CHECK(res.converged);
+}
+
+TEST_CASE("lm_fit stops when the call budget is used up") {
+    using aare::model::Gaussian;
+    auto x = linspace(-5, 5, 60);
+    auto y = evaluate<Gaussian>(x, {100.0, 0.7, 1.3}, 1.0);
+
+    LMOptions<Gaussian> opt;
+    opt.max_calls = 3;
+    auto res = lm_fit<Gaussian>(x.view(), y.view(), NDView<double, 1>{},
+                                {20.0, -2.0, 3.0}, opt);
+    CHECK_FALSE(res.converged);
+    CHECK(res.n_calls <= opt.max_calls + 1);
+}
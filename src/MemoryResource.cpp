@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/MemoryResource.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace aare {
+
+namespace {
+
+bool is_power_of_two(size_t value) {
+    return value && (value & (value - 1)) == 0;
+}
+
+std::atomic<MemoryResource *> &default_resource_ptr() {
+    static std::atomic<MemoryResource *> resource{aligned_memory_resource()};
+    return resource;
+}
+
+} // namespace
+
+AlignedMemoryResource::AlignedMemoryResource(size_t alignment,
+                                             size_t huge_page_threshold)
+    : m_alignment(alignment), m_huge_page_threshold(huge_page_threshold) {
+    if (!is_power_of_two(alignment))
+        throw std::invalid_argument("Alignment must be a power of two");
+}
+
+std::pair<size_t, size_t>
+AlignedMemoryResource::layout(size_t bytes, size_t alignment) const {
+    alignment = std::max(alignment, m_alignment);
+    if (m_huge_page_threshold && bytes >= m_huge_page_threshold) {
+        // whole huge pages, otherwise the kernel has to back the tail with
+        // small pages
+        alignment = std::max(alignment, huge_page_size);
+        bytes = (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+    return {bytes, alignment};
+}
+
+void *AlignedMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    const auto [size, align] = layout(bytes, alignment);
+    void *p = ::operator new(size, std::align_val_t(align));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (align >= huge_page_size)
+        madvise(p, size, MADV_HUGEPAGE); // only a hint, failure is harmless
+#endif
+    return p;
+}
+
+void AlignedMemoryResource::do_deallocate(void *p, size_t bytes,
+                                          size_t alignment) noexcept {
+    const auto [size, align] = layout(bytes, alignment);
+    ::operator delete(p, size, std::align_val_t(align));
+}
+
+PoolMemoryResource::PoolMemoryResource(size_t max_cached_bytes)
+    : PoolMemoryResource(*aligned_memory_resource(), max_cached_bytes) {}
+
+PoolMemoryResource::PoolMemoryResource(MemoryResource &upstream,
+                                       size_t max_cached_bytes)
+    : m_upstream(&upstream), m_max_cached_bytes(max_cached_bytes) {}
+
+PoolMemoryResource::~PoolMemoryResource() { release(); }
+
+void PoolMemoryResource::release() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &[key, blocks] : m_free) {
+        for (auto *p : blocks)
+            m_upstream->deallocate(p, key.first, key.second);
+    }
+    m_free.clear();
+    m_cached_bytes = 0;
+}
+
+size_t PoolMemoryResource::cached_bytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cached_bytes;
+}
+
+size_t PoolMemoryResource::hits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+size_t PoolMemoryResource::misses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+void *PoolMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_free.find({bytes, alignment});
+        if (it != m_free.end() && !it->second.empty()) {
+            void *p = it->second.back();
+            it->second.pop_back();
+            m_cached_bytes -= bytes;
+            ++m_hits;
+            return p;
+        }
+        ++m_misses;
+    }
+    // allocate outside the lock, upstream might be slow for large blocks
+    return m_upstream->allocate(bytes, alignment);
+}
+
+void PoolMemoryResource::do_deallocate(void *p, size_t bytes,
+                                       size_t alignment) noexcept {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_cached_bytes + bytes <= m_max_cached_bytes) {
+            try {
+                m_free[{bytes, alignment}].push_back(p);
+                m_cached_bytes += bytes;
+                return;
+            } catch (const std::bad_alloc &) {
+                // fall through and give the block back to upstream
+            }
+        }
+    }
+    m_upstream->deallocate(p, bytes, alignment);
+}
+
+// Never destroyed, so NDArrays with static storage duration can still free
+// their data during shutdown
+MemoryResource *aligned_memory_resource() noexcept {
+    static auto *resource = new AlignedMemoryResource;
+    return resource;
+}
+
+MemoryResource *huge_page_memory_resource() noexcept {
+    static auto *resource =
+        new AlignedMemoryResource(default_alignment, huge_page_size);
+    return resource;
+}
+
+MemoryResource *default_memory_resource() noexcept {
+    return default_resource_ptr().load(std::memory_order_acquire);
+}
+
+MemoryResource *set_default_memory_resource(MemoryResource *resource) noexcept {
+    if (!resource)
+        resource = aligned_memory_resource();
+    return default_resource_ptr().exchange(resource,
+                                           std::memory_order_acq_rel);
+}
+
+} // namespace aare
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/MemoryResource.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <stdexcept>
+
+using aare::AlignedMemoryResource;
+using aare::PoolMemoryResource;
+
+namespace {
+bool aligned_to(const void *p, size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+} // namespace
+
+TEST_CASE("AlignedMemoryResource aligns to at least its alignment") {
+    AlignedMemoryResource resource(128);
+    for (size_t bytes : {1, 7, 64, 1000, 1 << 20}) {
+        void *p = resource.allocate(bytes, 8);
+        REQUIRE(aligned_to(p, 128));
+        resource.deallocate(p, bytes, 8);
+    }
+    void *p = resource.allocate(100, 4096);
+    REQUIRE(aligned_to(p, 4096));
+    resource.deallocate(p, 100, 4096);
+
+    REQUIRE(resource.allocate(0) == nullptr);
+    REQUIRE_THROWS_AS(AlignedMemoryResource(48), std::invalid_argument);
+}
+
+TEST_CASE("Large huge page allocations are aligned to the page size") {
+    auto *resource = aare::huge_page_memory_resource();
+    const size_t large = 3 * aare::huge_page_size + 5;
+    void *p = resource->allocate(large);
+    REQUIRE(aligned_to(p, aare::huge_page_size));
+    static_cast<char *>(p)[large - 1] = 1;
+    resource->deallocate(p, large);
+
+    void *small = resource->allocate(1000);
+    REQUIRE(aligned_to(small, aare::default_alignment));
+    resource->deallocate(small, 1000);
+}
+
+TEST_CASE("PoolMemoryResource reuses freed blocks of the same size") {
+    PoolMemoryResource pool(4096);
+
+    void *a = pool.allocate(1024);
+    void *b = pool.allocate(1024);
+    REQUIRE(pool.misses() == 2);
+    pool.deallocate(a, 1024);
+    REQUIRE(pool.cached_bytes() == 1024);
+
+    // same size comes from the cache, a different size or alignment does not
+    REQUIRE(pool.allocate(1024) == a);
+    REQUIRE(pool.hits() == 1);
+    pool.deallocate(a, 1024);
+    void *c = pool.allocate(2048);
+    void *d = pool.allocate(1024, 128);
+    REQUIRE(pool.misses() == 4);
+    REQUIRE(pool.cached_bytes() == 1024);
+
+    // blocks beyond max_cached_bytes go back upstream
+    pool.deallocate(b, 1024);
+    pool.deallocate(c, 2048);
+    pool.deallocate(d, 1024, 128);
+    REQUIRE(pool.cached_bytes() == 4096);
+
+    pool.release();
+    REQUIRE(pool.cached_bytes() == 0);
+}
+
+TEST_CASE("The default memory resource can be replaced and restored") {
+    REQUIRE(aare::default_memory_resource() == aare::aligned_memory_resource());
+    PoolMemoryResource pool;
+    auto *previous = aare::set_default_memory_resource(&pool);
+    REQUIRE(previous == aare::aligned_memory_resource());
+    REQUIRE(aare::default_memory_resource() == &pool);
+    aare::set_default_memory_resource(nullptr);
+    REQUIRE(aare::default_memory_resource() == aare::aligned_memory_resource());
+}
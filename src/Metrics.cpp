@@ -0,0 +1,389 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/Metrics.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+namespace aare {
+
+namespace {
+
+constexpr double ns_to_s = 1e-9;
+
+// Upper edge of the last LatencyHistogram bucket is 2^64 ns
+constexpr int max_latency_exponent = 64;
+
+bool valid_metric_name(const std::string &name) {
+    if (name.empty())
+        return false;
+    for (size_t i = 0; i < name.size(); ++i) {
+        const auto c = static_cast<unsigned char>(name[i]);
+        const bool ok = std::isalpha(c) || c == '_' || c == ':' ||
+                        (i > 0 && std::isdigit(c));
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+std::string escape_label_value(const std::string &value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"')
+            out += '\\';
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+// {a="x",b="y"}, with `extra` (e.g. le="0.1") appended, empty if no labels
+std::string format_labels(const MetricLabels &labels,
+                          const std::string &extra = {}) {
+    if (labels.empty() && extra.empty())
+        return {};
+    std::string out = "{";
+    for (const auto &[key, value] : labels) {
+        if (out.size() > 1)
+            out += ',';
+        out += fmt::format("{}=\"{}\"", key, escape_label_value(value));
+    }
+    if (!extra.empty()) {
+        if (out.size() > 1)
+            out += ',';
+        out += extra;
+    }
+    out += '}';
+    return out;
+}
+
+// HELP and TYPE are written once per name, before the first sample
+template <typename Metric, typename WriteSamples>
+void write_family(std::string &out, const std::vector<Metric> &metrics,
+                  const std::string &prefix, const char *type,
+                  WriteSamples write_samples) {
+    std::vector<bool> done(metrics.size(), false);
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        if (done[i])
+            continue;
+        const auto &name = metrics[i].name;
+        out += fmt::format("# HELP {}{} {}\n", prefix, name, metrics[i].help);
+        out += fmt::format("# TYPE {}{} {}\n", prefix, name, type);
+        for (size_t j = i; j < metrics.size(); ++j) {
+            if (metrics[j].name == name) {
+                write_samples(metrics[j], prefix + name);
+                done[j] = true;
+            }
+        }
+    }
+}
+
+nlohmann::json labels_to_json(const MetricLabels &labels) {
+    auto j = nlohmann::json::object();
+    for (const auto &[key, value] : labels)
+        j[key] = value;
+    return j;
+}
+
+nlohmann::json values_to_json(const std::vector<MetricValue> &values) {
+    auto j = nlohmann::json::array();
+    for (const auto &v : values) {
+        j.push_back({{"name", v.name},
+                     {"labels", labels_to_json(v.labels)},
+                     {"value", v.value}});
+    }
+    return j;
+}
+
+void write_atomically(const std::filesystem::path &fname,
+                      const std::string &content) {
+    auto tmp = fname;
+    tmp += ".tmp";
+    {
+        std::ofstream os(tmp, std::ios::trunc);
+        if (!os) {
+            throw std::runtime_error("Could not open " + tmp.string() +
+                                     " for writing");
+        }
+        os << content;
+        if (!os) {
+            throw std::runtime_error("Could not write " + tmp.string());
+        }
+    }
+    std::filesystem::rename(tmp, fname);
+}
+
+} // namespace
+
+double LatencyHistogram::bucket_upper(size_t i) {
+    if (i < sub_buckets)
+        return static_cast<double>(i + 1);
+    const auto exponent =
+        static_cast<int>(i / sub_buckets) + sub_bucket_bits - 1;
+    const auto sub = static_cast<double>(i % sub_buckets);
+    return std::ldexp(static_cast<double>(sub_buckets) + sub + 1,
+                      exponent - sub_bucket_bits);
+}
+
+double LatencySummary::mean() const {
+    return count > 0 ? sum / static_cast<double>(count) : 0.0;
+}
+
+double LatencySummary::quantile(double q) const {
+    if (count == 0)
+        return 0.0;
+    q = std::clamp(q, 0.0, 1.0);
+    const auto rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (const auto &[upper, n] : buckets) {
+        seen += n;
+        if (seen >= rank)
+            return std::min(upper, max);
+    }
+    return max;
+}
+
+double MetricsSnapshot::total(const std::string &name) const {
+    double sum = 0.0;
+    bool found = false;
+    for (const auto *values : {&counters, &gauges}) {
+        for (const auto &v : *values) {
+            if (v.name == name) {
+                sum += v.value;
+                found = true;
+            }
+        }
+    }
+    if (!found)
+        throw std::invalid_argument("No metric named " + name);
+    return sum;
+}
+
+const LatencySummary &
+MetricsSnapshot::histogram(const std::string &name,
+                           const MetricLabels &labels) const {
+    for (const auto &h : histograms) {
+        if (h.name == name && h.labels == labels)
+            return h;
+    }
+    throw std::invalid_argument("No histogram named " + name);
+}
+
+void MetricsSnapshot::append(const MetricsSnapshot &other) {
+    seconds = std::max(seconds, other.seconds);
+    counters.insert(counters.end(), other.counters.begin(),
+                    other.counters.end());
+    gauges.insert(gauges.end(), other.gauges.begin(), other.gauges.end());
+    histograms.insert(histograms.end(), other.histograms.begin(),
+                      other.histograms.end());
+}
+
+std::string MetricsSnapshot::to_json() const {
+    nlohmann::json j;
+    j["seconds"] = seconds;
+    j["counters"] = values_to_json(counters);
+    j["gauges"] = values_to_json(gauges);
+    j["histograms"] = nlohmann::json::array();
+    for (const auto &h : histograms) {
+        auto buckets = nlohmann::json::array();
+        for (const auto &[upper, n] : h.buckets)
+            buckets.push_back({upper, n});
+        j["histograms"].push_back({{"name", h.name},
+                                   {"labels", labels_to_json(h.labels)},
+                                   {"count", h.count},
+                                   {"sum", h.sum},
+                                   {"max", h.max},
+                                   {"mean", h.mean()},
+                                   {"p50", h.quantile(0.5)},
+                                   {"p90", h.quantile(0.9)},
+                                   {"p99", h.quantile(0.99)},
+                                   {"p999", h.quantile(0.999)},
+                                   {"buckets", buckets}});
+    }
+    return j.dump(2);
+}
+
+std::string MetricsSnapshot::to_prometheus(const std::string &prefix) const {
+    std::string out;
+    auto write_value = [&out](const MetricValue &v, const std::string &name) {
+        out += fmt::format("{}{} {}\n", name, format_labels(v.labels), v.value);
+    };
+    write_family(out, counters, prefix, "counter", write_value);
+    write_family(out, gauges, prefix, "gauge", write_value);
+    write_family(out, histograms, prefix, "histogram",
+                 [&out](const LatencySummary &h, const std::string &name) {
+                     // Prometheus buckets are cumulative and need the same
+                     // edges in every scrape, so write every power of two
+                     // edge of the LatencyHistogram range, empty or not.
+                     // Each of its buckets lies between two of them.
+                     uint64_t cumulative = 0;
+                     auto bucket = h.buckets.begin();
+                     for (int k = 0; k <= max_latency_exponent; ++k) {
+                         const double le = std::ldexp(1.0, k) * ns_to_s;
+                         for (; bucket != h.buckets.end() &&
+                                bucket->first <= le;
+                              ++bucket)
+                             cumulative += bucket->second;
+                         out += fmt::format(
+                             "{}_bucket{} {}\n", name,
+                             format_labels(h.labels,
+                                           fmt::format("le=\"{}\"", le)),
+                             cumulative);
+                     }
+                     out += fmt::format("{}_bucket{} {}\n", name,
+                                        format_labels(h.labels, "le=\"+Inf\""),
+                                        h.count);
+                     out += fmt::format("{}_sum{} {}\n", name,
+                                        format_labels(h.labels), h.sum);
+                     out += fmt::format("{}_count{} {}\n", name,
+                                        format_labels(h.labels), h.count);
+                 });
+    return out;
+}
+
+void MetricsSnapshot::write_json(const std::filesystem::path &fname) const {
+    write_atomically(fname, to_json());
+}
+
+void MetricsSnapshot::write_prometheus(const std::filesystem::path &fname,
+                                       const std::string &prefix) const {
+    write_atomically(fname, to_prometheus(prefix));
+}
+
+MetricsRegistry::MetricsRegistry() : m_created(MetricsClock::now()) {}
+
+size_t MetricsRegistry::find_or_add(Kind kind, const std::string &name,
+                                    const std::string &help,
+                                    const MetricLabels &labels) {
+    if (!valid_metric_name(name))
+        throw std::invalid_argument("Invalid metric name: " + name);
+    for (const auto &label : labels) {
+        if (!valid_metric_name(label.first) ||
+            label.first.find(':') != std::string::npos) {
+            throw std::invalid_argument("Invalid label name: " + label.first);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &entry : m_entries) {
+        if (entry.name != name)
+            continue;
+        if (entry.kind != kind) {
+            throw std::invalid_argument(
+                "Metric " + name + " is already registered as another kind");
+        }
+        if (entry.labels == labels)
+            return entry.index;
+    }
+
+    size_t index = 0;
+    switch (kind) {
+    case Kind::Counter:
+    case Kind::Duration:
+        index = m_counters.size();
+        m_counters.emplace_back();
+        break;
+    case Kind::Gauge:
+        index = m_gauges.size();
+        m_gauges.emplace_back();
+        break;
+    case Kind::Histogram:
+        index = m_histograms.size();
+        m_histograms.emplace_back();
+        break;
+    }
+    m_entries.push_back({kind, name, help, labels, index});
+    return index;
+}
+
+MetricCounter &MetricsRegistry::counter(const std::string &name,
+                                        const std::string &help,
+                                        const MetricLabels &labels) {
+    const auto index = find_or_add(Kind::Counter, name, help, labels);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counters[index];
+}
+
+MetricCounter &MetricsRegistry::duration(const std::string &name,
+                                         const std::string &help,
+                                         const MetricLabels &labels) {
+    const auto index = find_or_add(Kind::Duration, name, help, labels);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counters[index];
+}
+
+MetricGauge &MetricsRegistry::gauge(const std::string &name,
+                                    const std::string &help,
+                                    const MetricLabels &labels) {
+    const auto index = find_or_add(Kind::Gauge, name, help, labels);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gauges[index];
+}
+
+LatencyHistogram &MetricsRegistry::histogram(const std::string &name,
+                                             const std::string &help,
+                                             const MetricLabels &labels) {
+    const auto index = find_or_add(Kind::Histogram, name, help, labels);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_histograms[index];
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MetricsSnapshot snap;
+    snap.seconds = static_cast<double>(elapsed_ns(m_created)) * ns_to_s;
+    for (const auto &entry : m_entries) {
+        switch (entry.kind) {
+        case Kind::Counter:
+            snap.counters.push_back(
+                {entry.name, entry.help, entry.labels,
+                 static_cast<double>(m_counters[entry.index].value())});
+            break;
+        case Kind::Duration:
+            snap.counters.push_back(
+                {entry.name, entry.help, entry.labels,
+                 static_cast<double>(m_counters[entry.index].value()) *
+                     ns_to_s});
+            break;
+        case Kind::Gauge:
+            snap.gauges.push_back(
+                {entry.name, entry.help, entry.labels,
+                 static_cast<double>(m_gauges[entry.index].value())});
+            break;
+        case Kind::Histogram: {
+            const auto &hist = m_histograms[entry.index];
+            LatencySummary summary;
+            summary.name = entry.name;
+            summary.help = entry.help;
+            summary.labels = entry.labels;
+            for (size_t i = 0; i < LatencyHistogram::n_buckets; ++i) {
+                if (const auto n = hist.bucket(i); n > 0) {
+                    summary.buckets.emplace_back(
+                        LatencyHistogram::bucket_upper(i) * ns_to_s, n);
+                    summary.count += n;
+                }
+            }
+            // Read the buckets first and derive the count from them, so
+            // count and buckets agree even while other threads record
+            summary.sum = static_cast<double>(hist.sum()) * ns_to_s;
+            summary.max = static_cast<double>(hist.max()) * ns_to_s;
+            snap.histograms.push_back(std::move(summary));
+            break;
+        }
+        }
+    }
+    return snap;
+}
+
+} // namespace aare
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/Metrics.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using aare::LatencyHistogram;
+using aare::MetricsRegistry;
+using Catch::Approx;
+
+TEST_CASE("LatencyHistogram buckets cover uint64 with 1/16 precision") {
+    for (uint64_t v = 0; v < 16; ++v) {
+        REQUIRE(LatencyHistogram::bucket_index(v) == v);
+        REQUIRE(LatencyHistogram::bucket_upper(v) == v + 1);
+    }
+
+    // bucket edges are contiguous and every value falls below the upper
+    // edge of its bucket and at or above the upper edge of the previous one
+    for (uint64_t v : {16ULL, 17ULL, 31ULL, 32ULL, 1000ULL, 123456789ULL,
+                       (1ULL << 40) + 12345, (1ULL << 63) + 3}) {
+        const auto i = LatencyHistogram::bucket_index(v);
+        REQUIRE(i < LatencyHistogram::n_buckets);
+        const double upper = LatencyHistogram::bucket_upper(i);
+        const double lower = LatencyHistogram::bucket_upper(i - 1);
+        REQUIRE(static_cast<double>(v) < upper);
+        REQUIRE(static_cast<double>(v) >= lower);
+        REQUIRE((upper - lower) / lower <= 1.0 / 16);
+    }
+    REQUIRE(LatencyHistogram::bucket_index(~0ULL) ==
+            LatencyHistogram::n_buckets - 1);
+}
+
+TEST_CASE("MetricsRegistry snapshots and exports its metrics") {
+    MetricsRegistry registry;
+    auto &frames = registry.counter("frames_total", "Frames");
+    auto &busy0 =
+        registry.duration("busy_seconds_total", "Busy", {{"thread", "0"}});
+    auto &busy1 =
+        registry.duration("busy_seconds_total", "Busy", {{"thread", "1"}});
+    auto &depth = registry.gauge("queue_depth", "Depth");
+    auto &latency = registry.histogram("latency_seconds", "Latency");
+
+    // same name and labels give the same metric, a different kind throws
+    REQUIRE(&registry.counter("frames_total", "Frames") == &frames);
+    REQUIRE(&busy0 != &busy1);
+    REQUIRE_THROWS_AS(registry.gauge("frames_total", "Frames"),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(registry.counter("3frames", "Frames"),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(registry.counter("frames", "Frames", {{"a-b", "0"}}),
+                      std::invalid_argument);
+
+    // updated concurrently from several threads
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (uint64_t i = 1; i <= 1000; ++i) {
+                frames.add();
+                latency.record(i * 1000); // 1 us to 1 ms
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    busy0.add(1500000000);
+    busy1.add(500000000);
+    depth.set(7);
+    depth.add(-2);
+
+    auto snap = registry.snapshot();
+    REQUIRE(snap.seconds > 0);
+    REQUIRE(snap.total("frames_total") == 4000);
+    REQUIRE(snap.total("busy_seconds_total") == Approx(2.0));
+    REQUIRE(snap.total("queue_depth") == 5);
+    REQUIRE_THROWS_AS(snap.total("missing"), std::invalid_argument);
+
+    const auto &h = snap.histogram("latency_seconds");
+    REQUIRE(h.count == 4000);
+    REQUIRE(h.max == Approx(1e-3));
+    REQUIRE(h.mean() == Approx(500.5e-6));
+    REQUIRE(h.quantile(0.5) == Approx(500e-6).epsilon(1.0 / 16));
+    REQUIRE(h.quantile(0.99) == Approx(990e-6).epsilon(1.0 / 16));
+    REQUIRE(h.quantile(1.0) == Approx(1e-3));
+
+    const auto prom = snap.to_prometheus();
+    REQUIRE(prom.find("# TYPE aare_frames_total counter\n"
+                      "aare_frames_total 4000\n") != std::string::npos);
+    REQUIRE(prom.find("aare_busy_seconds_total{thread=\"1\"} 0.5\n") !=
+            std::string::npos);
+    REQUIRE(prom.find("aare_latency_seconds_bucket{le=\"+Inf\"} 4000\n") !=
+            std::string::npos);
+    REQUIRE(prom.find("aare_latency_seconds_count 4000\n") !=
+            std::string::npos);
+    // fixed bucket layout, empty buckets included
+    size_t n_edges = 0;
+    for (auto pos = prom.find("aare_latency_seconds_bucket{");
+         pos != std::string::npos;
+         pos = prom.find("aare_latency_seconds_bucket{", pos + 1))
+        ++n_edges;
+    REQUIRE(n_edges == 66);
+    REQUIRE(LatencyHistogram::bucket_upper(LatencyHistogram::n_buckets - 1) ==
+            std::ldexp(1.0, 64));
+    REQUIRE(prom.find("aare_latency_seconds_bucket{le=\"1e-09\"} 0\n") !=
+            std::string::npos);
+    REQUIRE(prom.find("aare_latency_seconds_bucket{le=\"1.024e-06\"} 4\n") !=
+            std::string::npos);
+    // HELP and TYPE once per name, not per label set
+    REQUIRE(prom.find("# TYPE aare_busy_seconds_total") ==
+            prom.rfind("# TYPE aare_busy_seconds_total"));
+
+    auto json = nlohmann::json::parse(snap.to_json());
+    REQUIRE(json["counters"][0]["name"] == "frames_total");
+    REQUIRE(json["counters"][0]["value"] == 4000);
+    REQUIRE(json["counters"][2]["labels"]["thread"] == "1");
+    REQUIRE(json["histograms"][0]["count"] == 4000);
+
+    auto fname = std::filesystem::temp_directory_path() / "aare_metrics.prom";
+    snap.write_prometheus(fname);
+    std::ifstream ifs(fname);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    REQUIRE(ss.str() == prom);
+    REQUIRE_FALSE(std::filesystem::exists(fname.string() + ".tmp"));
+    std::filesystem::remove(fname);
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/Models.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+using Catch::Approx;
+
+namespace {
+
+// eval and eval_and_grad agree, and the gradient matches central differences
+template <typename Model>
+void check_model(const std::array<double, Model::npar> &par, double x_min,
+                 double x_max) {
+    std::array<double, Model::npar> g{};
+    double f = 0.0;
+    for (double x = x_min; x <= x_max; x += (x_max - x_min) / 17) {
+        Model::eval_and_grad(x, par, f, g);
+        REQUIRE(f == Approx(Model::eval(x, par)).epsilon(1e-14));
+        for (std::size_t k = 0; k < Model::npar; ++k) {
+            auto p = par;
+            const double h = 1e-6 * std::max(1.0, std::abs(par[k]));
+            p[k] = par[k] + h;
+            const double f_plus = Model::eval(x, p);
+            p[k] = par[k] - h;
+            const double f_minus = Model::eval(x, p);
+            // fast_erf is only accurate to ~1e-7, so is its derivative
+            CHECK(g[k] == Approx((f_plus - f_minus) / (2 * h))
+                              .margin(1e-4 * std::max(1.0, std::abs(f))));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("fast_erf with a precomputed exponential") {
+    using aare::model::fast_erf;
+    for (double x = -4.0; x <= 4.0; x += 0.37) {
+        REQUIRE(fast_erf(x, std::exp(-x * x)) == fast_erf(x));
+        REQUIRE(fast_erf(x) == Approx(std::erf(x)).margin(2e-7));
+    }
+}
+
+TEST_CASE("Model gradients match their values") {
+    using namespace aare::model;
+    check_model<Gaussian>({100.0, 1.5, 2.0}, -5, 8);
+    check_model<GaussianErfcPlateau>({200.0, 40.0, 12.0, 1.5}, 0, 20);
+    check_model<GaussianChargeSharing>({1.0, 0.01, 25.0, 3.0, 100.0, 0.3},
+                                       0, 50);
+    check_model<GaussianChargeSharingKb>(
+        {1.0, 0.01, 25.0, 3.0, 100.0, 0.3, 1.1, 0.2}, 0, 50);
+    check_model<RisingScurve>({1.0, 0.01, 20.0, 2.0, 100.0, 0.5}, 0, 40);
+    check_model<FallingScurve>({1.0, 0.01, 20.0, 2.0, 100.0, 0.5}, 0, 40);
+}
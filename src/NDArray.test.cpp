@@ -2,7 +2,11 @@
 #include "aare/NDArray.hpp"
 #include <array>
 #include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_all.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <new>
 #include <numeric>
 
 using aare::NDArray;
@@ -548,3 +552,202 @@ TEST_CASE(
     NDArray<int, 3> a({{2, 2, 2}}, 0);
     REQUIRE_THROWS(NDArray<int, 2>(std::move(a)));
 }
+
+TEST_CASE("NDArray data is cache line aligned") {
+    for (ssize_t n : {1, 3, 17, 1000}) {
+        NDArray<uint16_t, 1> a({n});
+        REQUIRE(reinterpret_cast<std::uintptr_t>(a.data()) %
+                    aare::default_alignment ==
+                0);
+    }
+    NDArray<double, 2> empty({0, 5});
+    REQUIRE(empty.data() == nullptr);
+    REQUIRE(empty.begin() == empty.end());
+}
+
+TEST_CASE("NDArray returns its data to the resource it was allocated from") {
+    aare::PoolMemoryResource pool;
+    {
+        NDArray<double, 2> a({100, 100}, pool);
+        REQUIRE(a.resource() == &pool);
+
+        // moves keep the resource, copies use the default one
+        NDArray<double, 1> flat({10000}, 1.0);
+        NDArray<double, 2> b(std::move(a));
+        REQUIRE(b.resource() == &pool);
+        NDArray<double, 2> c(b);
+        REQUIRE(c.resource() == aare::default_memory_resource());
+        flat = NDArray<double, 1>({10000}, pool);
+        REQUIRE(flat.resource() == &pool);
+    }
+    REQUIRE(pool.cached_bytes() == 2 * 10000 * sizeof(double));
+
+    // the next array of the same shape reuses a cached block
+    NDArray<double, 2> d({100, 100}, pool);
+    REQUIRE(pool.hits() == 1);
+    REQUIRE(pool.cached_bytes() == 10000 * sizeof(double));
+}
+
+TEST_CASE("Copy assignment keeps the allocation if the size matches") {
+    NDArray<int, 2> a({4, 5}, 1);
+    NDArray<int, 2> b({5, 4}, 2);
+    const int *data = b.data();
+    b = a;
+    REQUIRE(b.data() == data);
+    REQUIRE(b.shape() == Shape<2>{4, 5});
+    REQUIRE(b == a);
+}
+
+namespace {
+// Hands out one allocation, every further one throws
+class SingleAllocationResource : public aare::MemoryResource {
+    bool m_used{false};
+
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        if (m_used)
+            throw std::bad_alloc();
+        m_used = true;
+        return aare::default_memory_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, size_t bytes,
+                       size_t alignment) noexcept override {
+        aare::default_memory_resource()->deallocate(p, bytes, alignment);
+    }
+};
+} // namespace
+
+TEST_CASE("Copy assignment leaves the array unchanged if allocation fails") {
+    SingleAllocationResource resource;
+    NDArray<int, 2> a({2, 2}, resource);
+    a = 7;
+    const int *data = a.data();
+    NDArray<int, 2> b({3, 3}, 1);
+
+    REQUIRE_THROWS_AS(a = b, std::bad_alloc);
+    REQUIRE(a.data() == data);
+    REQUIRE(a.size() == 4);
+    REQUIRE(a.shape() == Shape<2>{2, 2});
+    for (auto v : a)
+        REQUIRE(v == 7);
+}
+
+TEST_CASE("Elementwise operations on arrays larger than one chunk") {
+    aare::set_eval_threads(4);
+    const ssize_t n = 3 * static_cast<ssize_t>(aare::eval_chunk_size) + 5;
+    NDArray<int, 1> a({n});
+    NDArray<int, 1> b({n});
+    for (ssize_t i = 0; i < n; ++i) {
+        a[i] = static_cast<int>(i % 100);
+        b[i] = 2;
+    }
+
+    NDArray<int, 1> c = a * b + b;
+    c += a;
+    c -= b;
+    c *= 2;
+    c /= 2;
+    for (ssize_t i = 0; i < n; ++i)
+        REQUIRE(c[i] == 3 * static_cast<int>(i % 100));
+
+    auto ratio = aare::safe_divide<double>(a, b);
+    REQUIRE(ratio[n - 1] == (static_cast<double>((n - 1) % 100) / 2));
+    aare::set_eval_threads(1);
+}
+
+TEST_CASE("Reductions over all elements fuse the expression") {
+    NDArray<double, 2> a({300, 400});
+    NDArray<double, 2> b({300, 400}, 1.5);
+    double expected_sum = 0;
+    for (ssize_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<double>(i % 1000) + 1000.0;
+        expected_sum += a[i] - 1.5;
+    }
+    const double n = static_cast<double>(a.size());
+    const double expected_mean = expected_sum / n;
+    double m2 = 0;
+    for (ssize_t i = 0; i < a.size(); ++i)
+        m2 += (a[i] - 1.5 - expected_mean) * (a[i] - 1.5 - expected_mean);
+
+    REQUIRE(aare::sum(a - b) == Catch::Approx(expected_sum));
+    REQUIRE(aare::mean(a - b) == Catch::Approx(expected_mean));
+    REQUIRE(aare::stddev(a - b) == Catch::Approx(std::sqrt(m2 / n)));
+    REQUIRE(aare::min(a - b) == 998.5);
+    REQUIRE(aare::max(a - b) == 1997.5);
+
+    NDArray<uint16_t, 1> counts({4});
+    counts = std::array<uint16_t, 4>{65535, 65535, 2, 1};
+    REQUIRE(aare::sum(counts) == uint64_t{131073});
+    REQUIRE(aare::sum(NDArray<int, 1>({0})) == 0);
+    REQUIRE_THROWS(aare::mean(NDArray<int, 1>({0})));
+    REQUIRE_THROWS(aare::max(NDArray<int, 1>({0})));
+}
+
+TEST_CASE("Reductions along an axis") {
+    NDArray<int, 3> a({2, 3, 4});
+    for (ssize_t i = 0; i < a.size(); ++i)
+        a[i] = static_cast<int>(i);
+
+    auto s0 = aare::sum(a, 0);
+    REQUIRE(s0.shape() == Shape<2>{3, 4});
+    auto s1 = aare::sum(a, 1);
+    REQUIRE(s1.shape() == Shape<2>{2, 4});
+    auto s2 = aare::sum(a, -1);
+    REQUIRE(s2.shape() == Shape<2>{2, 3});
+    auto mn = aare::min(a, 1);
+    auto mx = aare::max(a, 2);
+    auto mean = aare::mean(a, 0);
+    auto sd = aare::stddev(a, 0);
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            int row_sum = 0;
+            for (int k = 0; k < 4; ++k) {
+                row_sum += a(i, j, k);
+                REQUIRE(s0(j, k) == a(0, j, k) + a(1, j, k));
+                REQUIRE(mean(j, k) == Catch::Approx(a(0, j, k) + 6.0));
+                REQUIRE(sd(j, k) == Catch::Approx(6.0));
+            }
+            REQUIRE(s2(i, j) == row_sum);
+            REQUIRE(mx(i, j) == a(i, j, 3));
+        }
+        for (int k = 0; k < 4; ++k) {
+            REQUIRE(s1(i, k) == a(i, 0, k) + a(i, 1, k) + a(i, 2, k));
+            REQUIRE(mn(i, k) == a(i, 0, k));
+        }
+    }
+
+    REQUIRE_THROWS(aare::sum(a, 3));
+    REQUIRE_THROWS(aare::sum(a, -4));
+    REQUIRE_THROWS(aare::sum(NDArray<int, 2>({0, 3}), 0));
+}
+
+TEST_CASE("Reducing a frame stack along axis 0 matches a serial loop") {
+    aare::set_eval_threads(4);
+    // more pixels than one chunk so the output is split between threads
+    const ssize_t frames = 5;
+    const ssize_t rows = 300;
+    const ssize_t cols = 500;
+    NDArray<uint16_t, 3> stack({frames, rows, cols});
+    for (ssize_t i = 0; i < stack.size(); ++i)
+        stack[i] = static_cast<uint16_t>((i * 7919) % 4096);
+    NDArray<double, 2> pedestal({rows, cols}, 100.0);
+
+    auto sums = aare::sum(stack, 0);
+    auto sd = aare::stddev(stack, 0);
+    for (ssize_t r = 0; r < rows; r += 37) {
+        for (ssize_t c = 0; c < cols; c += 41) {
+            uint64_t s = 0;
+            double s2 = 0;
+            for (ssize_t f = 0; f < frames; ++f) {
+                s += stack(f, r, c);
+                s2 += static_cast<double>(stack(f, r, c)) * stack(f, r, c);
+            }
+            const double m = static_cast<double>(s) / frames;
+            REQUIRE(sums(r, c) == s);
+            REQUIRE(sd(r, c) ==
+                    Catch::Approx(std::sqrt(s2 / frames - m * m)).margin(1e-9));
+        }
+    }
+    REQUIRE(aare::mean(aare::mean(stack, 0) - pedestal) ==
+            Catch::Approx(aare::mean(stack) - 100.0));
+    aare::set_eval_threads(1);
+}
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/PolynomialFit.hpp"
+#include "aare/NDArray.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+
+using aare::fit_polynomial_3d;
+using aare::LMOptions;
+using aare::NDArray;
+using aare::NDView;
+using Catch::Approx;
+
+namespace {
+
+// data following p0 + p1*x + p2*x^2 with different parameters per pixel
+NDArray<double, 3> make_data(const NDArray<double, 1> &x, ssize_t rows,
+                             ssize_t cols, double noise) {
+    std::mt19937 rng(42);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    NDArray<double, 3> y({rows, cols, x.size()});
+    for (ssize_t r = 0; r < rows; ++r)
+        for (ssize_t c = 0; c < cols; ++c)
+            for (ssize_t i = 0; i < x.size(); ++i)
+                y(r, c, i) = 50.0 + r - 0.5 * c * (x[i] - 1000.0) +
+                             1e-3 * r * (x[i] - 1000.0) * (x[i] - 1000.0) +
+                             noise * dist(rng);
+    return y;
+}
+
+// fit every pixel with the iterative solver as a reference
+template <typename Model>
+void check_against_lm(const NDArray<double, 1> &x, NDArray<double, 3> &y,
+                      NDView<double, 3> y_err) {
+    constexpr ssize_t npar = Model::npar;
+    NDArray<double, 3> par({y.shape(0), y.shape(1), npar});
+    NDArray<double, 3> err({y.shape(0), y.shape(1), npar});
+    NDArray<double, 2> chi2({y.shape(0), y.shape(1)});
+    fit_polynomial_3d<npar - 1>(x.view(), y.view(), y_err, par.view(),
+                                err.view(), chi2.view(), 3);
+
+    LMOptions<Model> opt;
+    opt.compute_errors = true;
+    for (ssize_t r = 0; r < y.shape(0); ++r) {
+        for (ssize_t c = 0; c < y.shape(1); ++c) {
+            NDView<double, 1> values(&y(r, c, 0), {y.shape(2)});
+            NDView<double, 1> errors =
+                y_err.size() > 0 ? NDView<double, 1>(&y_err(r, c, 0),
+                                                     {y_err.shape(2)})
+                                 : NDView<double, 1>{};
+            auto start = Model::estimate_par(x.view(), values);
+            auto ref =
+                aare::lm_fit<Model>(x.view(), values, errors, start, opt);
+            REQUIRE(ref.converged);
+            for (ssize_t k = 0; k < npar; ++k) {
+                CHECK(par(r, c, k) ==
+                      Approx(ref.par[k]).epsilon(1e-6).margin(1e-9));
+                CHECK(err(r, c, k) == Approx(ref.err[k]).epsilon(1e-6));
+            }
+            CHECK(chi2(r, c) == Approx(ref.chi2).epsilon(1e-6));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Closed form polynomial fit matches the iterative fit") {
+    NDArray<double, 1> x({40});
+    for (ssize_t i = 0; i < x.size(); ++i)
+        x[i] = 1000.0 + 2.5 * static_cast<double>(i);
+    auto y = make_data(x, 4, 3, 0.5);
+    NDArray<double, 3> y_err(y.shape(), 0.5);
+    for (ssize_t i = 0; i < y_err.size(); i += 7)
+        y_err[i] = 1.5;
+
+    SECTION("Pol1 unweighted") {
+        check_against_lm<aare::model::Pol1>(x, y, NDView<double, 3>{});
+    }
+    SECTION("Pol1 weighted") {
+        check_against_lm<aare::model::Pol1>(x, y, y_err.view());
+    }
+    SECTION("Pol2 unweighted") {
+        check_against_lm<aare::model::Pol2>(x, y, NDView<double, 3>{});
+    }
+    SECTION("Pol2 weighted") {
+        check_against_lm<aare::model::Pol2>(x, y, y_err.view());
+    }
+}
+
+TEST_CASE("Closed form polynomial fit of exact data and dead pixels") {
+    NDArray<double, 1> x({5});
+    for (ssize_t i = 0; i < x.size(); ++i)
+        x[i] = static_cast<double>(i);
+    NDArray<double, 3> y({1, 2, 5});
+    NDArray<double, 3> y_err({1, 2, 5}, 1.0);
+    for (ssize_t i = 0; i < x.size(); ++i) {
+        y(0, 0, i) = 3.0 - 2.0 * x[i] + 0.5 * x[i] * x[i];
+        y(0, 1, i) = 7.0;
+        y_err(0, 1, i) = 0.0; // no valid points
+    }
+    NDArray<double, 3> par({1, 2, 3});
+    NDArray<double, 2> chi2({1, 2});
+    NDArray<bool, 2> singular({1, 2}, false);
+    fit_polynomial_3d<2>(x.view(), y.view(), y_err.view(), par.view(),
+                         NDView<double, 3>{}, chi2.view(), 1,
+                         singular.view());
+    CHECK_FALSE(singular(0, 0));
+    CHECK(singular(0, 1));
+    CHECK(par(0, 0, 0) == Approx(3.0));
+    CHECK(par(0, 0, 1) == Approx(-2.0));
+    CHECK(par(0, 0, 2) == Approx(0.5));
+    CHECK(chi2(0, 0) == Approx(0.0).margin(1e-20));
+    CHECK(par(0, 1, 0) == 0.0);
+    CHECK(chi2(0, 1) == 0.0);
+
+    NDArray<double, 3> wrong({1, 2, 2});
+    REQUIRE_THROWS(fit_polynomial_3d<2>(x.view(), y.view(), y_err.view(),
+                                        wrong.view(), NDView<double, 3>{},
+                                        chi2.view(), 1));
+}
+
+TEST_CASE("Closed form polynomial fit without scan points") {
+    NDArray<double, 1> x({0});
+    NDArray<double, 3> y({2, 3, 0});
+    NDArray<double, 3> par({2, 3, 2}, 1.0);
+    NDArray<double, 3> err({2, 3, 2}, 1.0);
+    NDArray<double, 2> chi2({2, 3}, 1.0);
+    NDArray<bool, 2> singular({2, 3}, false);
+    fit_polynomial_3d<1>(x.view(), y.view(), NDView<double, 3>{}, par.view(),
+                         err.view(), chi2.view(), 2, singular.view());
+    for (ssize_t i = 0; i < par.size(); ++i) {
+        CHECK(par[i] == 0.0);
+        CHECK(err[i] == 0.0);
+    }
+    for (ssize_t i = 0; i < chi2.size(); ++i) {
+        CHECK(chi2[i] == 0.0);
+        CHECK(singular[i]);
+    }
+}
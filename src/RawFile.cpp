@@ -82,6 +82,41 @@ std::vector<Frame> RawFile::read_rois() {
     return frames;
 }
 
+void RawFile::read_rois_into(const std::vector<std::byte *> &roi_buffers,
+                             size_t n_frames,
+                             const std::vector<DetectorHeader *> &roi_headers) {
+    if (!m_master.rois()) {
+        throw std::runtime_error(LOCATION +
+                                 "No ROIs defined in the master file.");
+    }
+    const size_t n_rois = m_ROI_geometries.size();
+    if (roi_buffers.size() != n_rois) {
+        throw std::runtime_error(
+            LOCATION + fmt::format("Expected {} ROI buffers, got {}", n_rois,
+                                   roi_buffers.size()));
+    }
+    if (!roi_headers.empty() && roi_headers.size() != n_rois) {
+        throw std::runtime_error(
+            LOCATION + fmt::format("Expected {} ROI header buffers, got {}",
+                                   n_rois, roi_headers.size()));
+    }
+    if (m_current_frame + n_frames > total_frames()) {
+        throw std::runtime_error(LOCATION + "Not enough frames left in file");
+    }
+
+    for (size_t i = 0; i < n_frames; ++i) {
+        for (size_t r = 0; r < n_rois; ++r) {
+            DetectorHeader *header = nullptr;
+            if (!roi_headers.empty() && roi_headers[r])
+                header = roi_headers[r] +
+                         i * m_ROI_geometries[r].num_modules_in_roi();
+            get_frame_into(m_current_frame,
+                           roi_buffers[r] + i * bytes_per_frame(r), r, header);
+        }
+        ++m_current_frame;
+    }
+}
+
 Frame RawFile::read_frame() {
     if (m_master.rois().has_value() && m_master.rois()->size() > 1) {
         throw std::runtime_error(LOCATION +
@@ -102,23 +137,19 @@ Frame RawFile::read_frame(size_t frame_number) {
 }
 
 void RawFile::read_into(std::byte *image_buf, size_t n_frames) {
-    // TODO: implement this in a more efficient way
     if (m_master.rois().has_value() && m_master.rois()->size() > 1) {
         throw std::runtime_error(LOCATION +
                                  "Cannot use read_into for multiple ROIs.");
     }
-
-    for (size_t i = 0; i < n_frames; i++) {
-        this->get_frame_into(m_current_frame++, image_buf);
-        image_buf += bytes_per_frame();
-    }
+    read_frames_into(image_buf, n_frames, nullptr);
 }
 
 void RawFile::read_into(std::byte *image_buf) {
     if (m_master.rois().has_value() && m_master.rois()->size() > 1) {
         throw std::runtime_error(LOCATION +
                                  "Cannot use read_into for multiple ROIs. Use "
-                                 "read_roi_into() for a single ROI instead.");
+                                 "read_rois_into() or read_roi_into() "
+                                 "instead.");
     }
     return get_frame_into(m_current_frame++, image_buf);
 }
@@ -139,7 +170,8 @@ void RawFile::read_into(std::byte *image_buf, DetectorHeader *header) {
     if (m_master.rois().has_value() && m_master.rois()->size() > 1) {
         throw std::runtime_error(LOCATION +
                                  "Cannot use read_into for multiple ROIs. Use "
-                                 "read_roi_into() for a single ROI instead.");
+                                 "read_rois_into() or read_roi_into() "
+                                 "instead.");
     }
     return get_frame_into(m_current_frame++, image_buf, 0, header);
 }
@@ -156,13 +188,7 @@ void RawFile::read_into(std::byte *image_buf, size_t n_frames,
                                                         // use read_into for a
                                                         // specific ROI
     }
-
-    for (size_t i = 0; i < n_frames; i++) {
-        this->get_frame_into(m_current_frame++, image_buf, 0, header);
-        image_buf += bytes_per_frame();
-        if (header)
-            header += m_ROI_geometries[0].num_modules_in_roi();
-    }
+    read_frames_into(image_buf, n_frames, header);
 }
 
 size_t RawFile::bytes_per_frame() {
@@ -322,135 +348,181 @@ void RawFile::get_frame_into(size_t frame_index, std::byte *frame_buffer,
     if (frame_index >= total_frames()) {
         throw std::runtime_error(LOCATION + "Frame number out of range");
     }
-    std::vector<size_t> frame_numbers(
-        m_ROI_geometries[roi_index].num_modules_in_roi());
-    std::vector<size_t> frame_indices(
-        m_ROI_geometries[roi_index].num_modules_in_roi(), frame_index);
+    sync_frame_indices(frame_index, roi_index);
+
+    // get the part from each subfile and copy it to the frame
+    for (size_t part_idx = 0;
+         part_idx != m_ROI_geometries[roi_index].num_modules_in_roi();
+         ++part_idx) {
+        m_subfiles[roi_index][part_idx]->seek(m_frame_indices[part_idx]);
+        read_module_into(roi_index, part_idx, frame_buffer, header);
+        if (header)
+            ++header;
+    }
+}
 
-    // sync the frame numbers
+void RawFile::sync_frame_indices(size_t frame_index, const size_t roi_index) {
+    auto &frame_numbers = m_frame_numbers;
+    auto &frame_indices = m_frame_indices;
+    frame_numbers.assign(m_ROI_geometries[roi_index].num_modules_in_roi(), 0);
+    frame_indices.assign(m_ROI_geometries[roi_index].num_modules_in_roi(),
+                         frame_index);
 
-    if (m_ROI_geometries[roi_index].num_modules_in_roi() !=
-        1) { // if we have more than one module
-        for (size_t part_idx = 0;
-             part_idx != m_ROI_geometries[roi_index].num_modules_in_roi();
-             ++part_idx) {
-            frame_numbers[part_idx] =
-                m_subfiles[roi_index][part_idx]->frame_number(frame_index);
-        }
+    if (m_ROI_geometries[roi_index].num_modules_in_roi() ==
+        1) { // nothing to sync
+        return;
+    }
 
-        // 1. if frame number vector is the same break
-        while (!all_equal(frame_numbers)) {
+    for (size_t part_idx = 0;
+         part_idx != m_ROI_geometries[roi_index].num_modules_in_roi();
+         ++part_idx) {
+        frame_numbers[part_idx] =
+            m_subfiles[roi_index][part_idx]->frame_number(frame_index);
+    }
 
-            // 2. find the index of the minimum frame number,
-            auto min_frame_idx = std::distance(
-                frame_numbers.begin(),
-                std::min_element(frame_numbers.begin(), frame_numbers.end()));
+    // 1. if frame number vector is the same break
+    while (!all_equal(frame_numbers)) {
 
-            // 3. increase its index and update its respective frame
-            // number
-            frame_indices[min_frame_idx]++;
+        // 2. find the index of the minimum frame number,
+        auto min_frame_idx = std::distance(
+            frame_numbers.begin(),
+            std::min_element(frame_numbers.begin(), frame_numbers.end()));
 
-            // 4. if we can't increase its index => throw error
-            if (frame_indices[min_frame_idx] >= total_frames()) {
-                throw std::runtime_error(LOCATION +
-                                         "Frame number out of range");
-            }
+        // 3. increase its index and update its respective frame
+        // number
+        frame_indices[min_frame_idx]++;
 
-            frame_numbers[min_frame_idx] =
-                m_subfiles[roi_index][min_frame_idx]->frame_number(
-                    frame_indices[min_frame_idx]);
+        // 4. if we can't increase its index => throw error
+        if (frame_indices[min_frame_idx] >= total_frames()) {
+            throw std::runtime_error(LOCATION + "Frame number out of range");
         }
+
+        frame_numbers[min_frame_idx] =
+            m_subfiles[roi_index][min_frame_idx]->frame_number(
+                frame_indices[min_frame_idx]);
     }
+}
+
+void RawFile::read_module_into(const size_t roi_index, const size_t part_idx,
+                               std::byte *frame_buffer,
+                               DetectorHeader *header) {
+    auto pos = m_geometry.get_module_geometries(
+        m_ROI_geometries[roi_index].module_indices_in_roi(part_idx));
 
     if (m_master.geometry().col == 1) {
-        // get the part from each subfile and copy it to the frame
-        for (size_t part_idx = 0;
-             part_idx != m_ROI_geometries[roi_index].num_modules_in_roi();
-             ++part_idx) {
-            auto corrected_idx = frame_indices[part_idx];
-
-            // This is where we start writing
-            auto offset =
-                (m_geometry
-                         .get_module_geometries(
-                             m_ROI_geometries[roi_index].module_indices_in_roi(
-                                 part_idx))
-                         .origin_y *
-                     m_ROI_geometries[roi_index].pixels_x() +
-                 m_geometry
-                     .get_module_geometries(
-                         m_ROI_geometries[roi_index].module_indices_in_roi(
-                             part_idx))
-                     .origin_x) *
-                m_master.bitdepth() / 8;
-
-            if (m_geometry
-                    .get_module_geometries(
-                        m_ROI_geometries[roi_index].module_indices_in_roi(
-                            part_idx))
-                    .origin_x != 0)
-                throw std::runtime_error(
-                    LOCATION +
-                    " Implementation error. x pos not 0."); // TODO:
-                                                            // origin
-                                                            // can still
-                                                            // change if
-                                                            // roi
-                                                            // changes
-            // TODO! What if the files don't match?
-            m_subfiles[roi_index][part_idx]->seek(corrected_idx);
-            m_subfiles[roi_index][part_idx]->read_into(frame_buffer + offset,
-                                                       header);
-            if (header)
-                ++header;
+        // This is where we start writing
+        auto offset =
+            (pos.origin_y * m_ROI_geometries[roi_index].pixels_x() +
+             pos.origin_x) *
+            m_master.bitdepth() / 8;
+
+        if (pos.origin_x != 0)
+            throw std::runtime_error(
+                LOCATION + " Implementation error. x pos not 0."); // TODO:
+                                                                   // origin
+                                                                   // can still
+                                                                   // change if
+                                                                   // roi
+                                                                   // changes
+        // TODO! What if the files don't match?
+        m_subfiles[roi_index][part_idx]->read_into(frame_buffer + offset,
+                                                   header);
+        return;
+    }
+
+    // TODO! should we read row by row?
+
+    // create a buffer large enough to hold a full module
+    auto bytes_per_part =
+        m_master.pixels_y() * m_master.pixels_x() * m_master.bitdepth() /
+        8; // TODO! replace with image_size_in_bytes // TODO
+           // shouldnt it only be the module size? - check
+
+    m_part_buffer.resize(bytes_per_part);
+    auto *part_buffer = m_part_buffer.data();
+
+    // TODO! if we have many submodules we should reorder them on
+    // the module level
+    m_subfiles[roi_index][part_idx]->read_into(part_buffer, header);
+
+    for (size_t cur_row = 0; cur_row < static_cast<size_t>(pos.height);
+         cur_row++) {
+
+        auto irow = (pos.origin_y + cur_row);
+        auto icol = pos.origin_x;
+        auto dest = (irow * m_ROI_geometries[roi_index].pixels_x() + icol);
+        dest = dest * m_master.bitdepth() / 8;
+        memcpy(frame_buffer + dest,
+               part_buffer + cur_row * pos.width * m_master.bitdepth() / 8,
+               pos.width * m_master.bitdepth() / 8);
+    }
+}
+
+void RawFile::read_frames_into(std::byte *image_buf, size_t n_frames,
+                               DetectorHeader *header) {
+    if (n_frames == 0)
+        return;
+    if (m_current_frame + n_frames > total_frames()) {
+        throw std::runtime_error(
+            LOCATION + fmt::format("Cannot read {} frames, only {} frames "
+                                   "left in the file",
+                                   n_frames, total_frames() - m_current_frame));
+    }
+    const size_t n_mod = m_ROI_geometries[0].num_modules_in_roi();
+    const size_t frame_size = bytes_per_frame(0);
+
+    // Sync the modules once for the whole batch. If all modules start at
+    // the current frame and have enough frames left we can read each
+    // subfile in one sequential pass instead of seeking back and forth
+    // between the modules for every frame.
+    sync_frame_indices(m_current_frame, 0);
+    bool sequential = true;
+    for (size_t part_idx = 0; part_idx != n_mod; ++part_idx) {
+        if (m_frame_indices[part_idx] != m_current_frame ||
+            m_current_frame + n_frames >
+                m_subfiles[0][part_idx]->frames_in_file()) {
+            sequential = false;
         }
+    }
 
-    } else {
-        // TODO! should we read row by row?
-
-        // create a buffer large enough to hold a full module
-        auto bytes_per_part =
-            m_master.pixels_y() * m_master.pixels_x() * m_master.bitdepth() /
-            8; // TODO! replace with image_size_in_bytes // TODO
-               // shouldnt it only be the module size? - check
-
-        auto *part_buffer = new std::byte[bytes_per_part];
-
-        // TODO! if we have many submodules we should reorder them on
-        // the module level
-
-        for (size_t part_idx = 0;
-             part_idx != m_ROI_geometries[roi_index].num_modules_in_roi();
-             ++part_idx) {
-            auto pos = m_geometry.get_module_geometries(
-                m_ROI_geometries[roi_index].module_indices_in_roi(part_idx));
-            auto corrected_idx = frame_indices[part_idx];
-
-            m_subfiles[roi_index][part_idx]->seek(corrected_idx);
-            m_subfiles[roi_index][part_idx]->read_into(part_buffer, header);
-            if (header)
-                ++header;
-
-            for (size_t cur_row = 0; cur_row < static_cast<size_t>(pos.height);
-                 cur_row++) {
-
-                auto irow = (pos.origin_y + cur_row);
-                auto icol = pos.origin_x;
-                auto dest =
-                    (irow * m_ROI_geometries[roi_index].pixels_x() + icol);
-                dest = dest * m_master.bitdepth() / 8;
-                memcpy(frame_buffer + dest,
-                       part_buffer +
-                           cur_row * pos.width * m_master.bitdepth() / 8,
-                       pos.width * m_master.bitdepth() / 8);
+    if (sequential) {
+        // headers are needed to verify that no module dropped a frame
+        // inside the batch
+        DetectorHeader *headers = header;
+        if (!headers) {
+            m_header_buffer.resize(n_frames * n_mod);
+            headers = m_header_buffer.data();
+        }
+        for (size_t part_idx = 0; part_idx != n_mod; ++part_idx) {
+            m_subfiles[0][part_idx]->seek(m_current_frame);
+            for (size_t i = 0; i < n_frames; ++i) {
+                read_module_into(0, part_idx, image_buf + i * frame_size,
+                                 headers + i * n_mod + part_idx);
+            }
+        }
+        for (size_t i = 0; i < n_frames && sequential; ++i) {
+            for (size_t part_idx = 1; part_idx != n_mod; ++part_idx) {
+                if (headers[i * n_mod + part_idx].frameNumber !=
+                    headers[i * n_mod].frameNumber) {
+                    sequential = false;
+                    break;
+                }
             }
         }
-        delete[] part_buffer;
     }
+
+    if (!sequential) {
+        // modules out of sync, fall back to syncing every frame
+        for (size_t i = 0; i < n_frames; ++i) {
+            get_frame_into(m_current_frame + i, image_buf + i * frame_size, 0,
+                           header ? header + i * n_mod : nullptr);
+        }
+    }
+    m_current_frame += n_frames;
 }
 
 std::vector<Frame> RawFile::read_n(size_t n_frames) {
-    // TODO: implement this in a more efficient way
+    // one Frame per frame, use read_n_array() to read into a single buffer
     if (num_rois() > 1) {
         throw std::runtime_error(LOCATION +
                                  "Multiple ROIs defined in the master "
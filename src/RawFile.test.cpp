@@ -5,6 +5,7 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
+#include <cstring>
 #include <filesystem>
 
 #include "test_config.hpp"
@@ -215,6 +216,35 @@ TEST_CASE("Read multipart files", "[.with-data][RawFile]") {
     }
 }
 
+TEST_CASE("Read multipart files as one batch", "[.with-data][RawFile]") {
+    auto fpath =
+        test_data_path() / "raw/jungfrau" / "jungfrau_double_master_0.json";
+    REQUIRE(std::filesystem::exists(fpath));
+
+    RawFile f(fpath, "r");
+    RawFile reference(fpath, "r");
+    std::vector<DetectorHeader> headers(10 * f.n_modules());
+    auto frames = f.read_n_array<uint16_t>(10, headers.data());
+    REQUIRE(frames.shape() == std::array<ssize_t, 3>{10, 512, 1024});
+    REQUIRE(f.tell() == 10);
+
+    for (size_t i = 0; i < 10; i++) {
+        std::vector<DetectorHeader> frame_headers(f.n_modules());
+        Frame frame(512, 1024, Dtype::UINT16);
+        reference.read_into(frame.data(), frame_headers.data());
+        CHECK(std::memcmp(frame.data(), &frames(i, 0, 0), frame.bytes()) ==
+              0);
+        for (size_t m = 0; m < f.n_modules(); m++) {
+            CHECK(headers[i * f.n_modules() + m].frameNumber ==
+                  frame_headers[m].frameNumber);
+        }
+    }
+
+    REQUIRE_THROWS(f.read_n_array<uint16_t>(1));
+    f.seek(0);
+    REQUIRE_THROWS(f.read_n_array<uint32_t>(1));
+}
+
 struct TestParameters {
     const std::string master_filename{};
     const uint8_t num_ports{};
@@ -388,6 +418,44 @@ TEST_CASE("Open multi module file with two ROIs",
     }
 }
 
+TEST_CASE("Read all ROIs into reused buffers",
+          "[.width-data][read_rois][RawFile]") {
+
+    auto fpath =
+        test_data_path() / "raw/ROITestData/MultipleROIs/run_master_0.json";
+    REQUIRE(std::filesystem::exists(fpath));
+
+    RawFile f(fpath, "r");
+    REQUIRE(f.num_rois() == 2);
+    auto expected = f.read_rois();
+    f.seek(0);
+
+    constexpr size_t n_frames = 2;
+    NDArray<uint16_t, 3> roi0({n_frames, 301, 101});
+    NDArray<uint16_t, 3> roi1({n_frames, 101, 101});
+    std::vector<DetectorHeader> headers0(n_frames * f.n_modules_in_roi()[0]);
+    std::vector<std::byte *> buffers{
+        reinterpret_cast<std::byte *>(roi0.data()),
+        reinterpret_cast<std::byte *>(roi1.data())};
+
+    f.read_rois_into(buffers, n_frames, {headers0.data(), nullptr});
+    CHECK(f.tell() == n_frames);
+    CHECK(headers0[0].frameNumber == f.frame_number(0));
+
+    auto first = expected[0].view<uint16_t>();
+    for (ssize_t i = 0; i < first.size(); ++i)
+        REQUIRE(roi0[i] == first[i]);
+    auto second = expected[1].view<uint16_t>();
+    for (ssize_t i = 0; i < second.size(); ++i)
+        REQUIRE(roi1[i] == second[i]);
+
+    // the same buffers can be used again for the next frame
+    f.read_rois_into(buffers);
+    CHECK(f.tell() == n_frames + 1);
+
+    CHECK_THROWS(f.read_rois_into({buffers[0]}));
+}
+
 TEST_CASE("Read file with unordered frames", "[.with-data][RawFile]") {
     // TODO! Better explanation and error message
     auto fpath = test_data_path() / "raw/mythen/scan242_master_3.raw";
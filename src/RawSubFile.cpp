@@ -114,14 +114,14 @@ void RawSubFile::read_into(std::byte *image_buf, size_t n_frames,
 }
 
 template <typename T> void RawSubFile::read_with_map(std::byte *image_buf) {
-    auto part_buffer = new std::byte[bytes_per_frame()];
-    m_file.read(reinterpret_cast<char *>(part_buffer), bytes_per_frame());
+    m_map_buffer.resize(bytes_per_frame());
+    m_file.read(reinterpret_cast<char *>(m_map_buffer.data()),
+                bytes_per_frame());
     auto *data = reinterpret_cast<T *>(image_buf);
-    auto *part_data = reinterpret_cast<T *>(part_buffer);
+    auto *part_data = reinterpret_cast<T *>(m_map_buffer.data());
     for (size_t i = 0; i < pixels_per_frame(); i++) {
         data[i] = part_data[(*m_pixel_map)(i)];
     }
-    delete[] part_buffer;
 }
 size_t RawSubFile::rows() const { return m_rows; }
 size_t RawSubFile::cols() const { return m_cols; }
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/ScanAccumulator.hpp"
+#include "aare/utils/par.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace aare {
+
+ScanAccumulator::ScanAccumulator(ssize_t rows, ssize_t cols,
+                                 NDView<double, 1> scan_points)
+    : m_scan_points(scan_points) {
+    if (rows < 1 || cols < 1) {
+        throw std::invalid_argument(
+            "ScanAccumulator requires a positive frame size");
+    }
+    if (scan_points.size() < 1) {
+        throw std::invalid_argument(
+            "ScanAccumulator requires at least one scan point");
+    }
+    m_counts = NDArray<uint32_t, 3>({scan_points.size(), rows, cols}, 0);
+    m_n_frames = NDArray<uint32_t, 1>({scan_points.size()}, 0);
+}
+
+template <typename T>
+void ScanAccumulator::add_frames_from(RawFile &file, size_t step,
+                                      size_t n_frames, size_t batch_size) {
+    if (n_frames == 0)
+        return;
+    batch_size = std::max<size_t>(batch_size, 1);
+    size_t remaining = n_frames;
+    RunWithReadAhead(
+        [&file, &remaining, batch_size]() {
+            if (remaining == 0)
+                return NDArray<T, 3>{};
+            const size_t n = std::min(remaining, batch_size);
+            remaining -= n;
+            return file.read_n_array<T>(n);
+        },
+        [this, step](NDArray<T, 3> &frames) {
+            for (ssize_t i = 0; i < frames.shape(0); ++i) {
+                add_frame(step, NDView<T, 2>(&frames(i, 0, 0),
+                                             {frames.shape(1),
+                                              frames.shape(2)}));
+            }
+        });
+}
+
+void ScanAccumulator::add_frames(size_t step, RawFile &file, size_t n_frames,
+                                 size_t batch_size) {
+    if (static_cast<ssize_t>(file.rows()) != rows() ||
+        static_cast<ssize_t>(file.cols()) != cols()) {
+        throw std::invalid_argument(
+            "ScanAccumulator: frame size of the file does not match");
+    }
+    if (step >= static_cast<size_t>(n_steps())) {
+        throw std::invalid_argument("ScanAccumulator: step out of range");
+    }
+    switch (file.bytes_per_pixel()) {
+    case 1:
+        add_frames_from<uint8_t>(file, step, n_frames, batch_size);
+        break;
+    case 2:
+        add_frames_from<uint16_t>(file, step, n_frames, batch_size);
+        break;
+    case 4:
+        add_frames_from<uint32_t>(file, step, n_frames, batch_size);
+        break;
+    default:
+        throw std::invalid_argument(
+            "ScanAccumulator: unsupported bytes per pixel");
+    }
+}
+
+void ScanAccumulator::fill_block(ssize_t first_row, ssize_t last_row,
+                                 NDView<double, 3> y,
+                                 NDView<double, 3> y_err) const {
+    const ssize_t n_rows = last_row - first_row;
+    if (first_row < 0 || last_row > rows() || n_rows < 1) {
+        throw std::invalid_argument("ScanAccumulator: invalid row range");
+    }
+    const std::array<ssize_t, 3> shape{n_rows, cols(), n_steps()};
+    if (y.shape() != shape || y_err.shape() != shape) {
+        throw std::invalid_argument(
+            "ScanAccumulator: y and y_err must have shape "
+            "(last_row - first_row, cols, n_steps)");
+    }
+    for (ssize_t step = 0; step < n_steps(); ++step) {
+        // steps can have different numbers of frames, fit the rate per frame
+        const uint32_t n = m_n_frames[step];
+        const double scale = n > 0 ? 1.0 / static_cast<double>(n) : 0.0;
+        for (ssize_t row = 0; row < n_rows; ++row) {
+            const uint32_t *counts = &m_counts(step, first_row + row, 0);
+            for (ssize_t col = 0; col < cols(); ++col) {
+                const double c = counts[col];
+                y(row, col, step) = c * scale;
+                y_err(row, col, step) = std::sqrt(std::max(c, 1.0)) * scale;
+            }
+        }
+    }
+}
+
+void ScanAccumulator::clear() {
+    m_counts = 0;
+    m_n_frames = 0;
+}
+
+} // namespace aare
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/ScanAccumulator.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+
+#include "test_config.hpp"
+
+using aare::NDArray;
+using aare::NDView;
+using aare::ScanAccumulator;
+
+TEST_CASE("ScanAccumulator sums frames per step and fills blocks") {
+    NDArray<double, 1> thresholds({3});
+    thresholds[0] = 10;
+    thresholds[1] = 20;
+    thresholds[2] = 30;
+    ScanAccumulator scan(4, 5, thresholds.view());
+    REQUIRE(scan.n_steps() == 3);
+
+    NDArray<uint16_t, 2> frame({4, 5}, 0);
+    for (ssize_t i = 0; i < frame.size(); ++i)
+        frame[i] = static_cast<uint16_t>(i);
+    scan.add_frame(0, frame.view());
+    scan.add_frame(0, frame.view());
+    scan.add_frame(2, frame.view());
+
+    REQUIRE(scan.n_frames()[0] == 2);
+    REQUIRE(scan.n_frames()[1] == 0);
+    REQUIRE(scan.n_frames()[2] == 1);
+    REQUIRE(scan.counts()(0, 3, 4) == 2 * 19);
+    REQUIRE(scan.counts()(1, 3, 4) == 0);
+    REQUIRE(scan.counts()(2, 3, 4) == 19);
+
+    // rows 1 and 2 in the (row, col, step) layout of fit_3d
+    NDArray<double, 3> y({2, 5, 3});
+    NDArray<double, 3> y_err({2, 5, 3});
+    scan.fill_block(1, 3, y.view(), y_err.view());
+    // counts per frame, the step without frames is left out of the fit
+    REQUIRE(y(0, 2, 0) == 7);
+    REQUIRE(y(1, 4, 2) == 14);
+    REQUIRE(y(1, 4, 1) == 0);
+    REQUIRE(y_err(0, 2, 0) == std::sqrt(14.0) / 2);
+    REQUIRE(y_err(1, 4, 2) == std::sqrt(14.0));
+    REQUIRE(y_err(1, 4, 1) == 0.0);
+
+    REQUIRE_THROWS_AS(scan.add_frame(3, frame.view()), std::invalid_argument);
+    NDArray<uint16_t, 2> wrong({5, 4}, 0);
+    REQUIRE_THROWS_AS(scan.add_frame(0, wrong.view()), std::invalid_argument);
+    REQUIRE_THROWS_AS(scan.fill_block(1, 2, y.view(), y_err.view()),
+                      std::invalid_argument);
+
+    scan.clear();
+    REQUIRE(scan.counts()(0, 3, 4) == 0);
+    REQUIRE(scan.n_frames()[0] == 0);
+}
+
+TEST_CASE("ScanAccumulator counts saturate instead of wrapping") {
+    NDArray<double, 1> thresholds({1}, 0.0);
+    ScanAccumulator scan(1, 2, thresholds.view());
+    NDArray<uint32_t, 2> frame({1, 2}, 0);
+    frame(0, 0) = std::numeric_limits<uint32_t>::max() - 1;
+    frame(0, 1) = 1;
+    scan.add_frame(0, frame.view());
+    scan.add_frame(0, frame.view());
+    REQUIRE(scan.counts()(0, 0, 0) == std::numeric_limits<uint32_t>::max());
+    REQUIRE(scan.counts()(0, 0, 1) == 2);
+}
+
+TEST_CASE("ScanAccumulator adds frames from a RawFile in batches",
+          "[.with-data]") {
+    auto fpath =
+        test_data_path() / "raw/jungfrau/jungfrau_double_master_0.json";
+    REQUIRE(std::filesystem::exists(fpath));
+
+    aare::RawFile file(fpath);
+    NDArray<double, 1> steps({2}, 0.0);
+    ScanAccumulator scan(file.rows(), file.cols(), steps.view());
+    scan.add_frames(1, file, 7, 3);
+    REQUIRE(scan.n_frames()[1] == 7);
+    REQUIRE(file.tell() == 7);
+
+    file.seek(0);
+    auto frames = file.read_n_array<uint16_t>(7);
+    for (ssize_t row = 0; row < scan.rows(); row += 97) {
+        for (ssize_t col = 0; col < scan.cols(); col += 101) {
+            uint32_t sum = 0;
+            for (ssize_t i = 0; i < 7; ++i)
+                sum += frames(i, row, col);
+            REQUIRE(scan.counts()(1, row, col) == sum);
+            REQUIRE(scan.counts()(0, row, col) == 0);
+        }
+    }
+}
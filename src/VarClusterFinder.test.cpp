@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: MPL-2.0
+#include "aare/VarClusterFinder.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+
+using aare::NDArray;
+using aare::VarClusterFinder;
+
+TEST_CASE("VarClusterFinder labels regions in the order of their first pixel") {
+    // clang-format off
+    NDArray<double, 2> img({6, 8}, 0.0);
+    const int pixels[6][8] = {{0, 0, 0, 0, 0, 0, 0, 9},
+                              {3, 0, 0, 0, 0, 0, 9, 0},  // diagonal to the 9
+                              {3, 0, 5, 0, 5, 0, 0, 0},  // U shape joined
+                              {3, 0, 5, 5, 5, 0, 0, 0},  // in this row
+                              {0, 0, 0, 0, 0, 0, 0, 0},
+                              {0, 0, 0, 0, 0, 0, 0, 7}};
+    // clang-format on
+    for (ssize_t i = 0; i < 6; ++i)
+        for (ssize_t j = 0; j < 8; ++j)
+            img(i, j) = pixels[i][j];
+
+    VarClusterFinder<double> finder({6, 8}, 1.0);
+    finder.find_clusters(img.view());
+    auto labeled = finder.labeled();
+    REQUIRE(labeled(0, 7) == 1);
+    REQUIRE(labeled(1, 6) == 1);
+    REQUIRE(labeled(1, 0) == 2);
+    REQUIRE(labeled(3, 0) == 2);
+    REQUIRE(labeled(2, 2) == 3);
+    REQUIRE(labeled(2, 4) == 3);
+    REQUIRE(labeled(5, 7) == 4);
+    REQUIRE(labeled(0, 0) == 0);
+
+    auto hits = finder.steal_hits();
+    REQUIRE(hits.size() == 4);
+    REQUIRE(hits[0].size == 2);
+    REQUIRE(hits[0].energy == 18.0);
+    REQUIRE(hits[1].size == 3);
+    REQUIRE(hits[1].energy == 9.0);
+    REQUIRE(hits[2].size == 5);
+    REQUIRE(hits[2].energy == 25.0);
+    REQUIRE(hits[2].rows[0] == 2);
+    REQUIRE(hits[2].cols[0] == 2);
+    REQUIRE(hits[3].size == 1);
+    REQUIRE(hits[3].max == 7.0);
+    REQUIRE(hits[3].row == 5);
+    REQUIRE(hits[3].col == 7);
+}
+
+TEST_CASE("VarClusterFinder gives the same result with strips") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    NDArray<double, 2> img({97, 64}, 0.0);
+    for (ssize_t i = 0; i < img.size(); ++i)
+        img[i] = dist(rng) < 0.4 ? 10.0 : 0.0;
+
+    VarClusterFinder<double> finder(img.shape(), 5.0);
+    finder.find_clusters(img.view());
+    auto expected = finder.labeled();
+    auto expected_hits = finder.steal_hits();
+
+    for (int n_threads : {2, 3, 8, 200}) {
+        finder.set_n_threads(n_threads);
+        finder.find_clusters(img.view());
+        REQUIRE((finder.labeled() == expected));
+        auto hits = finder.steal_hits();
+        REQUIRE(hits.size() == expected_hits.size());
+        for (size_t i = 0; i < hits.size(); ++i) {
+            REQUIRE(hits[i].size == expected_hits[i].size);
+            REQUIRE(hits[i].energy == expected_hits[i].energy);
+        }
+    }
+    REQUIRE_THROWS_AS(finder.set_n_threads(0), std::invalid_argument);
+}
+
+TEST_CASE("VarClusterFinder find_clusters_X handles a frame sized cluster") {
+    // one cluster covering the whole frame, deep enough to overflow the stack
+    // of a recursive fill
+    NDArray<double, 2> img({180, 180}, 10.0);
+    VarClusterFinder<double> finder(img.shape(), 5.0);
+    finder.find_clusters_X(img.view());
+    auto hits = finder.steal_hits();
+    REQUIRE(hits.size() == 1);
+    REQUIRE(hits[0].size == 180 * 180);
+    REQUIRE(hits[0].energy == 10.0 * 180 * 180);
+    for (ssize_t i = 0; i < img.size(); ++i)
+        REQUIRE(img[i] == 0.0);
+}
+
+TEST_CASE("VarClusterFinder find_clusters_X with 4 neighbours") {
+    NDArray<double, 2> img({3, 3}, 0.0);
+    img(0, 0) = 10;
+    img(1, 1) = 10;
+    img(2, 1) = 10;
+    VarClusterFinder<double> finder(img.shape(), 5.0);
+    finder.set_numberOfNeighbours(4);
+    finder.set_empty_surroundingPixels(false);
+    finder.find_clusters_X(img.view());
+    auto hits = finder.steal_hits();
+    REQUIRE(hits.size() == 2);
+    REQUIRE(hits[0].size == 1);
+    REQUIRE(hits[1].size == 2);
+}
@@ -0,0 +1,146 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "aare/hist/HistogramSnapshot.hpp"
+#include "aare/hist/PixelHistogram.hpp"
+
+using aare::HistogramSnapshot;
+using aare::NDArray;
+using aare::PixelHistogram;
+
+namespace {
+
+std::filesystem::path temp_file(const char *name) {
+    return std::filesystem::temp_directory_path() / name;
+}
+
+} // namespace
+
+TEST_CASE("HistogramSnapshot survives a save/load round trip") {
+    NDArray<uint32_t, 3> values({3, 4, 50}, 0);
+    values(0, 0, 0) = 1;
+    values(1, 2, 17) = 123456;
+    values(1, 2, 18) = 7;
+    values(2, 3, 49) = 42;
+    HistogramSnapshot<uint32_t, double> snapshot(values, -5.0, 20.0, 11);
+
+    const auto fname = temp_file("aare_snapshot_round_trip.bin");
+    snapshot.save(fname);
+    REQUIRE_FALSE(std::filesystem::exists(fname.string() + ".tmp"));
+
+    auto loaded = HistogramSnapshot<uint32_t, double>::load(fname);
+    std::filesystem::remove(fname);
+
+    REQUIRE(loaded.rows() == 3);
+    REQUIRE(loaded.cols() == 4);
+    REQUIRE(loaded.n_bins() == 50);
+    REQUIRE(loaded.xmin() == -5.0);
+    REQUIRE(loaded.xmax() == 20.0);
+    REQUIRE(loaded.n_frames() == 11);
+    REQUIRE((loaded.values() == values));
+}
+
+TEST_CASE("HistogramSnapshot load rejects a different storage type") {
+    HistogramSnapshot<uint16_t, float> snapshot(
+        NDArray<uint16_t, 3>({2, 2, 8}, 0), 0.0F, 1.0F);
+    const auto fname = temp_file("aare_snapshot_type.bin");
+    snapshot.save(fname);
+    REQUIRE_THROWS_AS((HistogramSnapshot<uint32_t, float>::load(fname)),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS((HistogramSnapshot<uint16_t, double>::load(fname)),
+                      std::runtime_error);
+    REQUIRE_NOTHROW(HistogramSnapshot<uint16_t, float>::load(fname));
+    std::filesystem::remove(fname);
+}
+
+TEST_CASE("HistogramSnapshot load checks the payload size of the header") {
+    NDArray<uint16_t, 3> values({2, 2, 8}, 0);
+    values(1, 1, 3) = 5;
+    HistogramSnapshot<uint16_t, float> snapshot(values, 0.0F, 1.0F);
+    const auto fname = temp_file("aare_snapshot_payload.bin");
+
+    // payload_bytes is the last field of the 60 byte header, extra bytes
+    // are appended after the payload
+    auto load_with = [&](uint64_t payload_bytes, size_t extra_bytes) {
+        snapshot.save(fname);
+        std::fstream fs(fname,
+                        std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekp(52);
+        fs.write(reinterpret_cast<const char *>(&payload_bytes),
+                 sizeof(payload_bytes));
+        fs.seekp(0, std::ios::end);
+        const std::vector<char> extra(extra_bytes, 0);
+        fs.write(extra.data(), static_cast<std::streamsize>(extra.size()));
+        fs.close();
+        return HistogramSnapshot<uint16_t, float>::load(fname);
+    };
+
+    snapshot.save(fname);
+    const auto payload_bytes = std::filesystem::file_size(fname) - 60;
+    REQUIRE_NOTHROW(load_with(payload_bytes, 0));
+    // larger than the file, e.g. a corrupt header asking for terabytes
+    REQUIRE_THROWS_AS(load_with(uint64_t{1} << 40, 0), std::runtime_error);
+    // in the file, but more than 32 bins can need
+    REQUIRE_THROWS_AS(load_with(2000, 2000), std::runtime_error);
+    std::filesystem::remove(fname);
+}
+
+TEST_CASE("HistogramSnapshot merge adds bins and saturates") {
+    NDArray<uint8_t, 3> a({1, 2, 4}, 0);
+    NDArray<uint8_t, 3> b({1, 2, 4}, 0);
+    a(0, 0, 0) = 200;
+    b(0, 0, 0) = 100;
+    a(0, 1, 3) = 3;
+    b(0, 1, 3) = 4;
+    HistogramSnapshot<uint8_t, double> sa(a, 0.0, 4.0, 2);
+    HistogramSnapshot<uint8_t, double> sb(b, 0.0, 4.0, 3);
+
+    sa.merge(sb);
+    REQUIRE(sa.values()(0, 0, 0) == 255);
+    REQUIRE(sa.values()(0, 1, 3) == 7);
+    REQUIRE(sa.values()(0, 0, 1) == 0);
+    REQUIRE(sa.n_frames() == 5);
+
+    HistogramSnapshot<uint8_t, double> other_axis(b, 0.0, 5.0);
+    REQUIRE_THROWS_AS(sa.merge(other_axis), std::invalid_argument);
+    HistogramSnapshot<uint8_t, double> other_shape(
+        NDArray<uint8_t, 3>({1, 2, 5}, 0), 0.0, 4.0);
+    REQUIRE_THROWS_AS(sa.merge(other_shape), std::invalid_argument);
+}
+
+TEST_CASE("Merged PixelHistogram snapshots equal one histogram of all frames") {
+    const int rows = 6;
+    const int cols = 5;
+    PixelHistogram<uint32_t, double> full(rows, cols, 16, 0.0, 16.0, 2);
+    PixelHistogram<uint32_t, double> first(rows, cols, 16, 0.0, 16.0);
+    PixelHistogram<uint32_t, double> second(rows, cols, 16, 0.0, 16.0, 3);
+
+    for (int f = 0; f < 10; ++f) {
+        NDArray<double, 2> image({rows, cols});
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                image(r, c) = static_cast<double>((f * 3 + r + c) % 17);
+            }
+        }
+        NDArray<double, 2> copy(image);
+        full.fill_async(std::move(image));
+        (f < 4 ? first : second).fill_async(std::move(copy));
+    }
+
+    auto merged = first.snapshot();
+    REQUIRE(merged.n_frames() == 4);
+    merged.merge(second.snapshot());
+
+    const auto fname = temp_file("aare_snapshot_merged.bin");
+    merged.save(fname);
+    auto loaded = HistogramSnapshot<uint32_t, double>::load(fname);
+    std::filesystem::remove(fname);
+
+    REQUIRE(loaded.n_frames() == 10);
+    REQUIRE((loaded.values() == full.values()));
+}
@@ -6,6 +6,7 @@
 #include <cmath>
 #include <cstring>
 #include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -16,9 +17,7 @@ PedestalTrackingPixelHistogram::PedestalTrackingPixelHistogram(
     int rows, int cols, int n_bins, AxisType xmin, AxisType xmax, int n_threads,
     std::size_t max_pending, AxisType n_sigma)
     : rows_(rows), cols_(cols), n_threads_(n_threads), xmin_(xmin), xmax_(xmax),
-      current_work_kind_(WorkKind::FillWithThreshold), current_image_(nullptr),
-      current_images_(nullptr), completed_threads_(0), stop_workers_(false),
-      work_generation_(0), max_batch_size_(max_pending / 3), n_sigma_(n_sigma) {
+      n_sigma_(n_sigma) {
     if (rows_ < 1 || cols_ < 1 || n_bins < 1) {
         throw std::invalid_argument("PedestalTrackingPixelHistogram requires "
                                     "positive rows, cols and bins");
@@ -52,10 +51,12 @@ PedestalTrackingPixelHistogram::PedestalTrackingPixelHistogram(
     // Initialize partial histograms, partial pedestals and the cached
     // per-pixel std for each thread. All three are sized to the
     // thread's row slice and indexed by local_row (0..local_rows-1),
-    // so the worker can address them with the same coordinates.
+    // so the worker can address them with the same coordinates as the
+    // band it receives.
     partial_hists_.reserve(n_threads_);
     partial_pedestals_.reserve(n_threads_);
     partial_std_.reserve(n_threads_);
+    lanes_.reserve(n_threads_);
     for (int i = 0; i < n_threads_; ++i) {
         const auto local_rows = row_count(i);
         partial_hists_.emplace_back(local_rows, cols, n_bins, xmin, xmax);
@@ -64,37 +65,29 @@ PedestalTrackingPixelHistogram::PedestalTrackingPixelHistogram(
         partial_std_.emplace_back(NDArray<AxisType, 2>(
             {static_cast<ssize_t>(local_rows), static_cast<ssize_t>(cols)},
             0.0));
+        lanes_.push_back(std::make_unique<Lane>(max_pending));
+
+        auto &lane = *lanes_.back();
+        const MetricLabels labels{{"thread", std::to_string(i)}};
+        lane.busy = &metrics_.duration("pedestal_histogram_busy_seconds_total",
+                                       "Time spent processing bands", labels);
+        lane.idle = &metrics_.duration("pedestal_histogram_idle_seconds_total",
+                                       "Time spent waiting for bands", labels);
+        lane.queue_depth =
+            &metrics_.gauge("pedestal_histogram_queue_depth",
+                            "Bands waiting in the worker queue", labels);
     }
 
     // Spawn worker threads
     for (int i = 0; i < n_threads_; ++i) {
         workers_.emplace_back([this, i]() { this->worker_loop(i); });
     }
-
-    // Async pipeline. The PCQ holds (size - 1) usable slots, so size up by
-    // one to honour the requested max_pending.
-    async_queue_ = std::make_unique<AsyncQueue>(
-        static_cast<std::uint32_t>(max_pending + 1));
-    coordinator_ = std::thread([this]() { this->coordinator_loop(); });
 }
 
 PedestalTrackingPixelHistogram::~PedestalTrackingPixelHistogram() {
-    // Drain any pending async fills before tearing down the worker pool.
-    // The coordinator's loop keeps processing while stop_coordinator_ is
-    // true as long as the queue is non-empty (mirrors ClusterFinderMT).
-    if (coordinator_.joinable()) {
-        stop_coordinator_ = true;
-        coordinator_.join();
-    }
-
-    // Signal all workers to stop
-    {
-        std::unique_lock<std::mutex> lock(work_mutex_);
-        stop_workers_ = true;
-    }
-    work_cv_.notify_all();
-
-    // Join all worker threads
+    // Workers drain their input rings before they exit, so everything
+    // submitted before destruction is still processed.
+    stop_workers_.store(true, std::memory_order_release);
     for (auto &thread : workers_) {
         if (thread.joinable()) {
             thread.join();
@@ -110,48 +103,54 @@ int PedestalTrackingPixelHistogram::row_count(int thread_id) const {
     return row_offsets_[thread_id + 1] - row_offsets_[thread_id];
 }
 
-void PedestalTrackingPixelHistogram::dispatch_(
-    WorkKind kind, const NDView<FrameType, 2> *image) {
-    // Caller must already hold fill_mutex_. Reset counters, publish the
-    // new work item, wake the workers, wait for completion.
-    {
-        std::unique_lock<std::mutex> lock(work_mutex_);
-        completed_threads_ = 0;
-        current_work_kind_ = kind;
-        current_image_ = image;
-        current_images_ = nullptr;
-        ++work_generation_;
-    }
-    work_cv_.notify_all();
-    {
-        std::unique_lock<std::mutex> lock(work_mutex_);
-        done_cv_.wait(lock,
-                      [this]() { return completed_threads_ == n_threads_; });
-        current_image_ = nullptr;
-        current_images_ = nullptr;
+NDArray<PedestalTrackingPixelHistogram::FrameType, 2>
+PedestalTrackingPixelHistogram::acquire_band_(int thread_id) {
+    NDArray<FrameType, 2> band;
+    if (lanes_[thread_id]->recycle.read(band)) {
+        return band;
     }
+    return NDArray<FrameType, 2>({static_cast<ssize_t>(row_count(thread_id)),
+                                  static_cast<ssize_t>(cols_)});
 }
 
-void PedestalTrackingPixelHistogram::dispatch_fill_batch_(
-    const std::vector<NDView<FrameType, 2>> &images) {
-    // Caller must already hold fill_mutex_. `images` is owned by
-    // fill_with_threshold_batch_ and stays alive until this blocking dispatch
-    // returns.
-    {
-        std::unique_lock<std::mutex> lock(work_mutex_);
-        completed_threads_ = 0;
-        current_work_kind_ = WorkKind::FillWithThreshold;
-        current_image_ = nullptr;
-        current_images_ = &images;
-        ++work_generation_;
+void PedestalTrackingPixelHistogram::submit_(
+    WorkKind kind, const NDView<FrameType, 2> *frame) {
+    // Caller has checked the frame shape. The bands are contiguous row
+    // ranges of the C-ordered frame, so each one is a single memcpy.
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    const auto start = MetricsClock::now();
+    for (int t = 0; t < n_threads_; ++t) {
+        auto &lane = *lanes_[t];
+        BandTask task{kind, {}};
+        if (frame != nullptr) {
+            task.band = acquire_band_(t);
+            std::memcpy(task.band.data(),
+                        frame->data() + static_cast<size_t>(row_start(t)) *
+                                            static_cast<size_t>(cols_),
+                        static_cast<size_t>(task.band.size()) *
+                            sizeof(FrameType));
+        }
+        lane.submitted_tasks.fetch_add(1, std::memory_order_release);
+
+        // SPSC backpressure: spin with a short sleep until a slot frees
+        // up. write() only moves from `task` once it has a free slot.
+        if (!lane.input.write(std::move(task))) {
+            const auto blocked = MetricsClock::now();
+            while (!lane.input.write(std::move(task))) {
+                std::this_thread::sleep_for(async_wait_);
+            }
+            input_blocked_total_.add();
+            input_blocked_seconds_.add(elapsed_ns(blocked));
+        }
+        lane.queue_depth->set(static_cast<int64_t>(lane.input.sizeGuess()));
     }
-    work_cv_.notify_all();
-    {
-        std::unique_lock<std::mutex> lock(work_mutex_);
-        done_cv_.wait(lock,
-                      [this]() { return completed_threads_ == n_threads_; });
-        current_images_ = nullptr;
+
+    if (kind == WorkKind::FillWithThreshold) {
+        frames_total_.add();
+    } else if (kind == WorkKind::PushPedestal) {
+        pedestal_frames_total_.add();
     }
+    submit_latency_.record(elapsed_ns(start));
 }
 
 void PedestalTrackingPixelHistogram::push_pedestal_no_update(
@@ -161,44 +160,41 @@ void PedestalTrackingPixelHistogram::push_pedestal_no_update(
             "PedestalTrackingPixelHistogram frame shape does not match "
             "constructor shape");
     }
-    std::lock_guard<std::mutex> fill_lock(fill_mutex_);
-    dispatch_(WorkKind::PushPedestal, &frame);
+    submit_(WorkKind::PushPedestal, &frame);
 }
 
 void PedestalTrackingPixelHistogram::update_mean() {
-    // Drain any in-flight async fills first; the coordinator does NOT
-    // hold fill_mutex_ at that point, so we can grab it safely after.
-    flush();
-    std::lock_guard<std::mutex> fill_lock(fill_mutex_);
-    dispatch_(WorkKind::UpdateMean, nullptr);
+    // Queued behind everything already submitted to each worker, so the
+    // mean includes all pushes made before this call and is in place
+    // before any fill submitted after it.
+    submit_(WorkKind::UpdateMean, nullptr);
 }
 
 void PedestalTrackingPixelHistogram::worker_loop(int thread_id) {
-    int last_generation = 0;
+    auto &lane = *lanes_[thread_id];
+    auto &my_pedestal = partial_pedestals_[thread_id];
+    auto &my_hist = partial_hists_[thread_id];
+    auto &my_std = partial_std_[thread_id];
+    const int local_rows = row_count(thread_id);
 
     while (true) {
-        std::unique_lock<std::mutex> lock(work_mutex_);
-        work_cv_.wait(lock, [this, last_generation]() {
-            return work_generation_ != last_generation || stop_workers_;
-        });
-
-        if (stop_workers_) {
-            break;
+        BandTask *task = lane.input.frontPtr();
+        if (task == nullptr) {
+            // stop_workers_ is only set once nothing more will be
+            // submitted, so an empty ring after seeing it means done.
+            if (stop_workers_.load(std::memory_order_acquire) &&
+                lane.input.isEmpty()) {
+                break;
+            }
+            const auto idle_start = MetricsClock::now();
+            std::this_thread::sleep_for(async_wait_);
+            lane.idle->add(elapsed_ns(idle_start));
+            continue;
         }
 
-        // Snapshot the work assignment under the lock so we don't race
-        // against the next dispatch publishing new state.
-        const WorkKind kind = current_work_kind_;
-        const NDView<FrameType, 2> *image = current_image_;
-        const std::vector<NDView<FrameType, 2>> *images = current_images_;
-        const int generation = work_generation_;
-        const int first_row = row_start(thread_id);
-        const int local_rows = row_count(thread_id);
-
-        lock.unlock();
-
-        auto &my_pedestal = partial_pedestals_[thread_id];
-        auto &my_hist = partial_hists_[thread_id];
+        const auto start = MetricsClock::now();
+        const WorkKind kind = task->kind;
+        const auto &band = task->band;
 
         switch (kind) {
         case WorkKind::PushPedestal: {
@@ -206,22 +202,19 @@ void PedestalTrackingPixelHistogram::worker_loop(int thread_id) {
             // shard. Uses the pixel-level push_no_update which only
             // touches m_sum/m_sum2/m_cur_samples (no m_mean writes).
             for (int local_row = 0; local_row < local_rows; ++local_row) {
-                const auto row = static_cast<ssize_t>(first_row + local_row);
-                for (ssize_t col = 0; col < image->shape(1); ++col) {
+                for (int col = 0; col < cols_; ++col) {
                     my_pedestal.template push_no_update<FrameType>(
                         static_cast<uint32_t>(local_row),
-                        static_cast<uint32_t>(col), (*image)(row, col));
+                        static_cast<uint32_t>(col), band(local_row, col));
                 }
             }
             break;
         }
         case WorkKind::UpdateMean: {
-            // Recompute m_mean from the running sums. Only touches this
-            // thread's shard. Also refresh the cached per-pixel std so
-            // FillWithThreshold can read it without recomputing on the
-            // hot path.
+            // Recompute m_mean from the running sums. Also refresh the
+            // cached per-pixel std so FillWithThreshold can read it
+            // without recomputing on the hot path.
             my_pedestal.update_mean();
-            auto &my_std = partial_std_[thread_id];
             for (int local_row = 0; local_row < local_rows; ++local_row) {
                 for (int col = 0; col < cols_; ++col) {
                     my_std(local_row, col) = static_cast<AxisType>(
@@ -242,76 +235,62 @@ void PedestalTrackingPixelHistogram::worker_loop(int thread_id) {
             const auto n_sigma = n_sigma_.load(std::memory_order_relaxed);
             if (n_sigma <= AxisType{0.0}) {
                 // Fill without pedestal tracking.
-                for (const auto &frame : *images) {
-                    const auto cols = frame.shape(1);
-                    for (int local_row = 0; local_row < local_rows;
-                         ++local_row) {
-                        const auto row =
-                            static_cast<ssize_t>(first_row + local_row);
-                        for (ssize_t col = 0; col < cols; ++col) {
-                            const FrameType raw = frame(row, col);
-                            const AxisType val =
-                                static_cast<AxisType>(raw) -
-                                static_cast<AxisType>(my_pedestal.mean(
-                                    static_cast<uint32_t>(local_row),
-                                    static_cast<uint32_t>(col)));
-                            my_hist.fill_unchecked(local_row,
-                                                   static_cast<int>(col), val);
-                        }
+                for (int local_row = 0; local_row < local_rows; ++local_row) {
+                    for (int col = 0; col < cols_; ++col) {
+                        const AxisType val =
+                            static_cast<AxisType>(band(local_row, col)) -
+                            static_cast<AxisType>(my_pedestal.mean(
+                                static_cast<uint32_t>(local_row),
+                                static_cast<uint32_t>(col)));
+                        my_hist.fill_unchecked(local_row, col, val);
                     }
                 }
-                break;
             } else {
                 // Do pedestal tracking. Duplicated code for clean hot path.
-
-                auto &my_std = partial_std_[thread_id];
-                for (const auto &frame : *images) {
-                    const auto cols = frame.shape(1);
-                    for (int local_row = 0; local_row < local_rows;
-                         ++local_row) {
-                        const auto row =
-                            static_cast<ssize_t>(first_row + local_row);
-                        for (ssize_t col = 0; col < cols; ++col) {
-                            const FrameType raw = frame(row, col);
-                            const AxisType val =
-                                static_cast<AxisType>(raw) -
-                                static_cast<AxisType>(my_pedestal.mean(
-                                    static_cast<uint32_t>(local_row),
-                                    static_cast<uint32_t>(col)));
-                            my_hist.fill_unchecked(local_row,
-                                                   static_cast<int>(col), val);
-                            const AxisType sigma = my_std(local_row, col);
-                            if (sigma > AxisType{0.0} &&
-                                std::abs(static_cast<AxisType>(val)) <
-                                    n_sigma * sigma) {
-                                my_pedestal.template push<FrameType>(
-                                    static_cast<uint32_t>(local_row),
-                                    static_cast<uint32_t>(col), raw);
-                            }
+                for (int local_row = 0; local_row < local_rows; ++local_row) {
+                    for (int col = 0; col < cols_; ++col) {
+                        const FrameType raw = band(local_row, col);
+                        const AxisType val =
+                            static_cast<AxisType>(raw) -
+                            static_cast<AxisType>(my_pedestal.mean(
+                                static_cast<uint32_t>(local_row),
+                                static_cast<uint32_t>(col)));
+                        my_hist.fill_unchecked(local_row, col, val);
+                        const AxisType sigma = my_std(local_row, col);
+                        if (sigma > AxisType{0.0} &&
+                            std::abs(val) < n_sigma * sigma) {
+                            my_pedestal.template push<FrameType>(
+                                static_cast<uint32_t>(local_row),
+                                static_cast<uint32_t>(col), raw);
                         }
                     }
                 }
-                break;
             }
+            break;
         }
         }
 
-        // Signal completion
-        {
-            std::unique_lock<std::mutex> done_lock(work_mutex_);
-            last_generation = generation;
-            completed_threads_++;
-            if (completed_threads_ == n_threads_) {
-                done_cv_.notify_one();
-            }
+        // Hand the band buffer back for reuse; dropped if the recycle
+        // ring is full.
+        if (kind != WorkKind::UpdateMean) {
+            lane.recycle.write(std::move(task->band));
+        }
+        lane.input.popFront();
+        lane.queue_depth->set(static_cast<int64_t>(lane.input.sizeGuess()));
+        const auto ns = elapsed_ns(start);
+        lane.busy->add(ns);
+        task_latency_.record(ns);
+        if (kind == WorkKind::FillWithThreshold) {
+            lane.completed_fills.fetch_add(1, std::memory_order_release);
         }
+        lane.completed_tasks.fetch_add(1, std::memory_order_release);
     }
 }
 
 NDArray<PedestalTrackingPixelHistogram::StorageType, 3>
 PedestalTrackingPixelHistogram::values() const {
     // Make sure any pending async fills are merged in before we snapshot
-    // the partial histograms. Cheap when the queue is already drained.
+    // the partial histograms. Cheap when the rings are already drained.
     flush();
 
     const auto first_shard_view = partial_hists_.front().view();
@@ -343,12 +322,9 @@ PedestalTrackingPixelHistogram::values() const {
 
 NDArray<PedestalTrackingPixelHistogram::AxisType, 2>
 PedestalTrackingPixelHistogram::pedestal_mean() const {
-    // Drain in-flight async fills and serialise with all other fan-outs
-    // (Fill / PushPedestal / UpdateMean). m_mean is overwritten wholesale
-    // by Pedestal::update_mean, so without the lock we could read torn
-    // rows mid-update.
+    // After flush() the workers are idle until the next submission, so
+    // the shards can be read without racing Pedestal::update_mean.
     flush();
-    std::lock_guard<std::mutex> lock(fill_mutex_);
 
     NDArray<AxisType, 2> data(
         {static_cast<ssize_t>(rows_), static_cast<ssize_t>(cols_)});
@@ -372,35 +348,18 @@ PedestalTrackingPixelHistogram::pedestal_mean() const {
     return data;
 }
 
-void PedestalTrackingPixelHistogram::fill_with_threshold_batch_(
-    std::vector<NDArray<FrameType, 2>> &batch) {
-    // Called only by the coordinator thread on images already shape-checked
-    // by fill_async, so there is no need to re-validate. fill_mutex_ is
-    // still required: push_pedestal_no_update / update_mean / pedestal_mean
-    // can run concurrently and must not race this fan-out.
-    std::vector<NDView<FrameType, 2>> views;
-    views.reserve(batch.size());
-    for (auto &frame : batch) {
-        views.push_back(frame.view());
-    }
-
-    std::lock_guard<std::mutex> fill_lock(fill_mutex_);
-    dispatch_fill_batch_(views);
-}
-
-void PedestalTrackingPixelHistogram::fill_async(NDArray<FrameType, 2> &&image) {
+void PedestalTrackingPixelHistogram::fill_async(
+    const NDView<FrameType, 2> &image) {
     if (image.shape(0) != rows_ || image.shape(1) != cols_) {
         throw std::invalid_argument(
             "PedestalTrackingPixelHistogram image shape does not match "
             "constructor shape");
     }
+    submit_(WorkKind::FillWithThreshold, &image);
+}
 
-    // SPSC backpressure: spin with a short sleep until a slot frees up.
-    // The std::move only consumes `image` on the iteration that succeeds
-    // (placement-new inside write() runs only when the slot is free).
-    while (!async_queue_->write(std::move(image))) {
-        std::this_thread::sleep_for(async_wait_);
-    }
+void PedestalTrackingPixelHistogram::fill_async(NDArray<FrameType, 2> &&image) {
+    fill_async(image.view());
 }
 
 PedestalTrackingPixelHistogram::AxisType
@@ -414,44 +373,26 @@ void PedestalTrackingPixelHistogram::set_n_sigma(
 }
 
 void PedestalTrackingPixelHistogram::flush() const {
-    while (!async_queue_->isEmpty() ||
-           coordinator_busy_.load(std::memory_order_acquire)) {
-        std::this_thread::sleep_for(async_wait_);
-    }
-}
-
-void PedestalTrackingPixelHistogram::coordinator_loop() {
-    std::vector<NDArray<FrameType, 2>> batch;
-    batch.reserve(max_batch_size_);
-
-    while (!stop_coordinator_.load(std::memory_order_acquire) ||
-           !async_queue_->isEmpty()) {
-        batch.clear();
-
-        auto *first_item = async_queue_->frontPtr();
-        if (first_item == nullptr) {
+    for (const auto &lane : lanes_) {
+        while (lane->completed_tasks.load(std::memory_order_acquire) <
+               lane->submitted_tasks.load(std::memory_order_acquire)) {
             std::this_thread::sleep_for(async_wait_);
-            continue;
         }
+    }
+}
 
-        coordinator_busy_.store(true, std::memory_order_release);
-        batch.push_back(std::move(*first_item));
-        async_queue_->popFront();
-
-        while (batch.size() < max_batch_size_) {
-            auto *item = async_queue_->frontPtr();
-            if (item == nullptr) {
-                break;
-            }
-            batch.push_back(std::move(*item));
-            async_queue_->popFront();
-        }
+MetricsSnapshot PedestalTrackingPixelHistogram::metrics() const {
+    return metrics_.snapshot();
+}
 
-        fill_with_threshold_batch_(batch);
-        completed_async_fills_.fetch_add(batch.size(),
-                                         std::memory_order_release);
-        coordinator_busy_.store(false, std::memory_order_release);
+std::size_t PedestalTrackingPixelHistogram::completed_fills_() const {
+    std::size_t done = lanes_.front()->completed_fills.load(
+        std::memory_order_acquire);
+    for (const auto &lane : lanes_) {
+        done = std::min(
+            done, lane->completed_fills.load(std::memory_order_acquire));
     }
+    return done;
 }
 
 NDArray<PedestalTrackingPixelHistogram::AxisType, 1>
@@ -466,16 +407,23 @@ PedestalTrackingPixelHistogram::bin_edges() const {
     return partial_hists_.front().bin_edges();
 }
 
+PedestalTrackingPixelHistogram::Snapshot
+PedestalTrackingPixelHistogram::snapshot() const {
+    // values() flushes, so the frame count read afterwards matches it.
+    auto data = values();
+    return Snapshot(std::move(data), xmin_, xmax_, completed_fills_());
+}
+
 void PedestalTrackingPixelHistogram::fill_from_file(
-    const std::filesystem::path &fname, ssize_t max_frames, bool verbose) {
+    const std::filesystem::path &fname, ssize_t max_frames, bool verbose,
+    const std::filesystem::path &checkpoint_path,
+    ssize_t checkpoint_interval) {
     constexpr std::size_t progress_interval = 66;
     auto last = std::chrono::steady_clock::now();
-    const auto completed_start =
-        completed_async_fills_.load(std::memory_order_acquire);
+    const auto completed_start = completed_fills_();
     std::size_t last_reported = 0;
     const auto completed_for_this_file = [&]() {
-        return completed_async_fills_.load(std::memory_order_acquire) -
-               completed_start;
+        return completed_fills_() - completed_start;
     };
 
     const auto wait_for_completed = [&](std::size_t target) {
@@ -512,17 +460,27 @@ void PedestalTrackingPixelHistogram::fill_from_file(
         last_reported = done;
     };
 
+    // This thread only reads and splits frames; the workers histogram
+    // them concurrently, so the read of frame i + 1 overlaps the fill of
+    // frame i. fill_async copies the bands out, so one buffer is enough.
+    aare::NDArray<uint16_t> frame({rows_, cols_});
     for (ssize_t i = 0; i < n_frames; ++i) {
-        aare::NDArray<uint16_t> frame({rows_, cols_});
         f.read_into(reinterpret_cast<std::byte *>(frame.data()));
-        fill_async(std::move(frame));
+        fill_async(frame.view());
 
         if (verbose && (i + 1) % progress_interval == 0) {
             wait_for_completed(static_cast<std::size_t>(i + 1));
             print_progress(static_cast<std::size_t>(i + 1));
         }
+        if (!checkpoint_path.empty() && checkpoint_interval > 0 &&
+            (i + 1) % checkpoint_interval == 0 && i + 1 < n_frames) {
+            snapshot().save(checkpoint_path);
+        }
     }
     flush();
+    if (!checkpoint_path.empty()) {
+        snapshot().save(checkpoint_path);
+    }
     if (verbose) {
         const auto done = completed_for_this_file();
         if (done > last_reported) {
@@ -0,0 +1,115 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "aare/hist/PedestalTrackingPixelHistogram.hpp"
+
+using aare::NDArray;
+using aare::PedestalTrackingPixelHistogram;
+
+namespace {
+
+std::vector<NDArray<uint16_t, 2>> make_frames(int n_frames, int rows,
+                                              int cols, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> noise(0.0F, 3.0F);
+    std::vector<NDArray<uint16_t, 2>> frames;
+    for (int f = 0; f < n_frames; ++f) {
+        NDArray<uint16_t, 2> frame({rows, cols});
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                frame(r, c) = static_cast<uint16_t>(1000 + 10 * r + c +
+                                                    noise(gen));
+            }
+        }
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+} // namespace
+
+TEST_CASE("PedestalTrackingPixelHistogram without tracking histograms the "
+          "residual to the pedestal") {
+    const int rows = 7;
+    const int cols = 9;
+    const int n_threads = GENERATE(1, 3, 8);
+    const auto pedestal_frames = make_frames(20, rows, cols, 1);
+    const auto frames = make_frames(30, rows, cols, 2);
+
+    PedestalTrackingPixelHistogram hist(rows, cols, 40, -20.0F, 20.0F,
+                                        n_threads, 4, 0.0F);
+    for (const auto &frame : pedestal_frames) {
+        hist.push_pedestal_no_update(frame.view());
+    }
+    hist.update_mean();
+    for (const auto &frame : frames) {
+        hist.fill_async(frame.view());
+    }
+
+    NDArray<float, 2> mean({rows, cols}, 0.0F);
+    for (const auto &frame : pedestal_frames) {
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                mean(r, c) += static_cast<float>(frame(r, c)) / 20.0F;
+            }
+        }
+    }
+    const auto pedestal = hist.pedestal_mean();
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            REQUIRE(std::abs(pedestal(r, c) - mean(r, c)) < 1e-3F);
+        }
+    }
+
+    NDArray<uint16_t, 3> expected({rows, cols, 40}, 0);
+    for (const auto &frame : frames) {
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                const float val = static_cast<float>(frame(r, c)) -
+                                  pedestal(r, c);
+                if (val >= -20.0F && val < 20.0F) {
+                    ++expected(r, c, static_cast<int>(val + 20.0F));
+                }
+            }
+        }
+    }
+    const auto values = hist.values();
+    REQUIRE(values.shape() == expected.shape());
+    REQUIRE(std::equal(values.begin(), values.end(), expected.begin()));
+    REQUIRE(hist.snapshot().n_frames() == 30);
+}
+
+TEST_CASE("PedestalTrackingPixelHistogram with tracking does not depend on "
+          "the number of workers") {
+    const int rows = 10;
+    const int cols = 6;
+    const auto pedestal_frames = make_frames(15, rows, cols, 3);
+    const auto frames = make_frames(25, rows, cols, 4);
+
+    const auto run = [&](int n_threads) {
+        PedestalTrackingPixelHistogram hist(rows, cols, 64, -16.0F, 16.0F,
+                                            n_threads, 2, 2.0F);
+        for (const auto &frame : pedestal_frames) {
+            hist.push_pedestal_no_update(frame.view());
+        }
+        hist.update_mean();
+        for (const auto &frame : frames) {
+            NDArray<uint16_t, 2> copy(frame);
+            hist.fill_async(std::move(copy));
+        }
+        hist.update_mean();
+        return std::make_pair(hist.values(), hist.pedestal_mean());
+    };
+
+    const auto [ref_values, ref_mean] = run(1);
+    const auto [values, mean] = run(4);
+    REQUIRE((values == ref_values));
+    REQUIRE((mean == ref_mean));
+}
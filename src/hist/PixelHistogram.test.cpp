@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <random>
@@ -317,3 +318,93 @@ TEST_CASE("PixelHistogram supports custom storage and axis types") {
     STATIC_REQUIRE(std::is_same_v<decltype(centers(0)), double &>);
     CHECK(centers.shape(0) == 4);
 }
+
+TEST_CASE("Batched fills with recycled buffers match a reference") {
+    constexpr int rows = 9;
+    constexpr int cols = 13;
+    constexpr int n_bins = 16;
+    constexpr float xmin = 0.0f;
+    constexpr float xmax = 1.0f;
+    constexpr int n_frames = 40;
+    const auto batch_size = GENERATE(std::size_t{1}, std::size_t{3},
+                                     std::size_t{8}, std::size_t{64});
+
+    PixelHistogram hist(rows, cols, n_bins, xmin, xmax, 3, 8, batch_size);
+    NDArray<uint16_t, 3> expected({rows, cols, n_bins}, uint16_t{0});
+
+    std::mt19937 rng(0xBA7C4);
+    std::uniform_real_distribution<float> dist(xmin - 0.1f, xmax);
+    for (int f = 0; f < n_frames; ++f) {
+        auto img = hist.acquire_buffer();
+        REQUIRE(img.shape(0) == rows);
+        REQUIRE(img.shape(1) == cols);
+        for (ssize_t r = 0; r < rows; ++r) {
+            for (ssize_t c = 0; c < cols; ++c) {
+                img(r, c) = dist(rng);
+                if (img(r, c) >= xmin) {
+                    const auto bin =
+                        std::min(static_cast<int>((img(r, c) - xmin) * n_bins),
+                                 n_bins - 1);
+                    ++expected(r, c, bin);
+                }
+            }
+        }
+        hist.fill_async(std::move(img));
+    }
+
+    auto h = hist.values();
+    CHECK(std::equal(h.begin(), h.end(), expected.begin(), expected.end()));
+}
+
+TEST_CASE("Windowed PixelHistogram centres each pixel on its own pedestal") {
+    constexpr int rows = 7;
+    constexpr int cols = 5;
+    constexpr int n_bins = 100;
+    constexpr int window_bins = 10;
+    constexpr float xmin = 0.0f;
+    constexpr float xmax = 100.0f;
+
+    // Pedestal rises along the image, values scatter +-3 around it
+    NDArray<float, 2> pedestal({rows, cols});
+    for (ssize_t i = 0; i < pedestal.size(); ++i) {
+        pedestal(i) = 10.0f + 2.0f * static_cast<float>(i);
+    }
+
+    PixelHistogram hist(pedestal.view(), window_bins, n_bins, xmin, xmax, 3);
+    PixelHistogram dense(rows, cols, n_bins, xmin, xmax, 2);
+    for (int f = 0; f < 7; ++f) {
+        NDArray<float, 2> img({rows, cols});
+        for (ssize_t i = 0; i < img.size(); ++i) {
+            img(i) = pedestal(i) + static_cast<float>(f) - 3.0f;
+        }
+        hist.fill_async(NDArray<float, 2>(img));
+        dense.fill_async(std::move(img));
+    }
+
+    auto h = hist.values();
+    auto expected = dense.values();
+    REQUIRE(h.shape(2) == n_bins);
+    CHECK(std::equal(h.begin(), h.end(), expected.begin(), expected.end()));
+}
+
+TEST_CASE("PixelHistogram reports frames, batches and worker time") {
+    PixelHistogram hist(6, 5, 8, 0.0, 1.0, 2, 4, 2);
+    for (int f = 0; f < 10; ++f) {
+        auto image = hist.acquire_buffer();
+        for (ssize_t i = 0; i < image.size(); ++i)
+            image[i] = 0.5f;
+        hist.fill_async(std::move(image));
+    }
+    hist.flush();
+
+    auto metrics = hist.metrics();
+    CHECK(metrics.total("pixel_histogram_frames_total") == 10);
+    const auto batches = metrics.total("pixel_histogram_batches_total");
+    CHECK(batches >= 5); // at most 2 frames per batch
+    CHECK(batches <= 10);
+    CHECK(metrics.histogram("pixel_histogram_batch_seconds").count ==
+          static_cast<uint64_t>(batches));
+    CHECK(metrics.total("pixel_histogram_busy_seconds_total") > 0);
+    CHECK(metrics.total("pixel_histogram_buffer_allocations_total") >= 1);
+    CHECK(metrics.total("pixel_histogram_buffer_allocations_total") <= 10);
+}
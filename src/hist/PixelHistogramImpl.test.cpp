@@ -4,6 +4,11 @@
 #include "aare/NDArray.hpp"
 #include "aare/hist/PixelHistogramImpl.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
 TEST_CASE("PixelHistogramImpl construct a small histogram and fill with a few "
           "values") {
     int rows = 3;
@@ -138,3 +143,132 @@ TEST_CASE("Check that row and column bounds are checked") {
     auto total = std::accumulate(v.begin(), v.end(), 0);
     REQUIRE(total == 0);
 }
+
+TEST_CASE("fill_rows matches per pixel fills for a row band of many frames") {
+    // The band engine tiles the columns and stages counts in uint8, so use
+    // enough bins for several tiles per row and more than 255 frames to
+    // exercise the periodic spill.
+    constexpr int rows = 4;
+    constexpr int cols = 37;
+    constexpr int n_bins = 2000;
+    constexpr int first_row = 2;
+    constexpr int n_frames = 300;
+    constexpr float xmin = -10.0f;
+    constexpr float xmax = 10.0f;
+
+    std::vector<aare::NDArray<float, 2>> frames;
+    std::vector<aare::NDView<float, 2>> views;
+    for (int f = 0; f < n_frames; ++f) {
+        aare::NDArray<float, 2> frame({first_row + rows + 1, cols});
+        for (ssize_t i = 0; i < frame.size(); ++i) {
+            // Deterministic mix of in-range, out of range and repeated values
+            frame(i) = static_cast<float>((i * 7 + f * 13) % 25) - 12.5f;
+        }
+        frames.push_back(std::move(frame));
+    }
+    for (auto &frame : frames) {
+        views.push_back(frame.view());
+    }
+
+    aare::PixelHistogramImpl<float, uint32_t> band(rows, cols, n_bins, xmin,
+                                                   xmax);
+    aare::PixelHistogramImpl<float, uint32_t> reference(rows, cols, n_bins,
+                                                        xmin, xmax);
+    band.fill_rows(views, first_row);
+    for (const auto &frame : frames) {
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                reference.fill(row, col, frame(first_row + row, col));
+            }
+        }
+    }
+    const auto got = band.view();
+    const auto want = reference.view();
+    REQUIRE(std::equal(got.begin(), got.end(), want.begin(), want.end()));
+}
+
+TEST_CASE("fill_rows saturates integral storage like fill") {
+    aare::PixelHistogramImpl<double, uint8_t> hist(1, 2, 10, 0.0, 1.0);
+    aare::NDArray<double, 2> frame({1, 2});
+    frame(0, 0) = 0.05;
+    frame(0, 1) = 0.95;
+    std::vector<aare::NDView<double, 2>> views(600, frame.view());
+
+    hist.fill_rows(views, 0);
+    hist.fill_rows(frame.view(), 0);
+
+    auto v = hist.view();
+    REQUIRE(v(0, 0, 0) == 255);
+    REQUIRE(v(0, 1, 9) == 255);
+    REQUIRE(std::accumulate(v.begin(), v.end(), 0) == 2 * 255);
+}
+
+TEST_CASE("Windowed storage keeps only bins around the pixel centre") {
+    // 20 bins of width 1 on [0, 20), 5 bins stored per pixel
+    aare::NDArray<double, 2> centers({1, 3});
+    centers(0, 0) = 10.2; // window [8, 13)
+    centers(0, 1) = 0.5;  // clamped to [0, 5)
+    centers(0, 2) = 19.9; // clamped to [15, 20)
+    aare::PixelHistogramImpl<double, uint16_t> hist(centers.view(), 5, 20, 0.0,
+                                                    20.0);
+
+    REQUIRE(hist.is_windowed());
+    REQUIRE(hist.view().shape(2) == 5);
+    auto offsets = hist.offsets();
+    CHECK(offsets(0, 0) == 8);
+    CHECK(offsets(0, 1) == 0);
+    CHECK(offsets(0, 2) == 15);
+
+    aare::NDArray<double, 2> frame({1, 3});
+    frame(0, 0) = 8.5;  // first bin of the window
+    frame(0, 1) = 4.5;  // last bin of the window
+    frame(0, 2) = 14.5; // just below the window, dropped
+    hist.fill(frame.view());
+    hist.fill(0, 0, 12.5); // last bin of the window
+    hist.fill(0, 0, 13.0); // just above the window, dropped
+
+    auto v = hist.view();
+    CHECK(v(0, 0, 0) == 1);
+    CHECK(v(0, 0, 4) == 1);
+    CHECK(v(0, 1, 4) == 1);
+    CHECK(std::accumulate(v.begin(), v.end(), 0) == 3);
+
+    auto dense = hist.values();
+    REQUIRE(dense.shape(2) == 20);
+    CHECK(dense(0, 0, 8) == 1);
+    CHECK(dense(0, 0, 12) == 1);
+    CHECK(dense(0, 1, 4) == 1);
+    CHECK(std::accumulate(dense.begin(), dense.end(), 0) == 3);
+}
+
+TEST_CASE("Windowed storage with a full width window matches dense storage") {
+    constexpr int rows = 3;
+    constexpr int cols = 4;
+    constexpr int n_bins = 12;
+    aare::NDArray<float, 2> centers({rows, cols}, 3.0f);
+    aare::PixelHistogramImpl<float, uint32_t> windowed(centers.view(), n_bins,
+                                                       n_bins, 0.0f, 6.0f);
+    aare::PixelHistogramImpl<float, uint32_t> dense(rows, cols, n_bins, 0.0f,
+                                                    6.0f);
+
+    aare::NDArray<float, 2> frame({rows, cols});
+    for (int f = 0; f < 20; ++f) {
+        for (ssize_t i = 0; i < frame.size(); ++i) {
+            frame(i) = static_cast<float>((i * 5 + f * 3) % 14) * 0.5f - 0.5f;
+        }
+        windowed.fill(frame.view());
+        dense.fill(frame.view());
+    }
+    const auto a = windowed.values();
+    const auto b = dense.values();
+    REQUIRE(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+}
+
+TEST_CASE("Windowed storage rejects invalid window sizes") {
+    aare::NDArray<double, 2> centers({2, 2}, 0.0);
+    using Hist = aare::PixelHistogramImpl<double, uint16_t>;
+    REQUIRE_THROWS_AS(Hist(centers.view(), 0, 10, 0.0, 1.0),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(Hist(centers.view(), 11, 10, 0.0, 1.0),
+                      std::invalid_argument);
+}
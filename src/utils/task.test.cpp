@@ -1,8 +1,12 @@
 // SPDX-License-Identifier: MPL-2.0
+#include "aare/utils/par.hpp"
 #include "aare/utils/task.hpp"
 
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <mutex>
+#include <vector>
 
 TEST_CASE("Split a range into multiple tasks") {
 
@@ -26,4 +30,70 @@ TEST_CASE("Split a range into multiple tasks") {
         REQUIRE(tasks[i].first == i);
         REQUIRE(tasks[i].second == i + 1);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("RunInParallelDynamic covers the range exactly once") {
+    for (int n_threads : {1, 3, 16}) {
+        for (int chunk : {1, 4, 100}) {
+            std::vector<int> count(37, 0);
+            int largest = 0;
+            std::mutex m;
+            aare::RunInParallelDynamic(
+                [&](int first, int last) {
+                    std::lock_guard<std::mutex> lock(m);
+                    largest = std::max(largest, last - first);
+                    for (int i = first; i < last; ++i)
+                        count[i - 5]++;
+                },
+                5, 42, chunk, n_threads);
+            REQUIRE(largest <= chunk);
+            for (auto c : count)
+                REQUIRE(c == 1);
+        }
+    }
+
+    // empty range, nothing to call
+    int calls = 0;
+    aare::RunInParallelDynamic([&](int, int) { ++calls; }, 3, 3, 1, 4);
+    REQUIRE(calls == 0);
+}
+
+TEST_CASE("RunInParallelIndexed gives every thread its own task index") {
+    for (int n_threads : {1, 3, 50}) {
+        std::vector<int> count(37, 0);
+        std::vector<int> calls_per_task(static_cast<size_t>(n_threads), 0);
+        aare::RunInParallelIndexed(
+            [&](int task, int first, int last) {
+                // each task index is used by exactly one thread
+                calls_per_task[static_cast<size_t>(task)]++;
+                for (int i = first; i < last; ++i)
+                    count[i - 5]++;
+            },
+            5, 42, n_threads);
+        for (auto c : count)
+            REQUIRE(c == 1);
+        for (auto c : calls_per_task)
+            REQUIRE(c <= 1);
+    }
+
+    int calls = 0;
+    aare::RunInParallelIndexed([&](int, int, int) { ++calls; }, 3, 3, 4);
+    REQUIRE(calls == 0);
+}
+
+TEST_CASE("RunWithReadAhead consumes all batches in order") {
+    int next = 0;
+    auto read = [&next]() {
+        std::vector<int> batch;
+        for (int i = 0; i < 3 && next < 10; ++i)
+            batch.push_back(next++);
+        return batch;
+    };
+    std::vector<int> seen;
+    aare::RunWithReadAhead(read, [&](const std::vector<int> &batch) {
+        seen.insert(seen.end(), batch.begin(), batch.end());
+    });
+    REQUIRE(seen.size() == 10);
+    for (int i = 0; i < 10; ++i)
+        REQUIRE(seen[static_cast<size_t>(i)] == i);
+}
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: MPL-2.0
+#pragma once
+// Helpers shared by the tests in src/
+
+#include "aare/NDArray.hpp"
+
+namespace aare::test {
+
+/** @brief n evenly spaced points from start to stop, both included */
+inline NDArray<double, 1> linspace(double start, double stop, ssize_t n) {
+    NDArray<double, 1> x({n});
+    for (ssize_t i = 0; i < n; ++i)
+        x[i] = start + (stop - start) * static_cast<double>(i) /
+                           static_cast<double>(n - 1);
+    return x;
+}
+
+} // namespace aare::test